@@ -1085,32 +1085,26 @@ int RTPFakeTransmitter::ProcessAddAcceptIgnoreEntry(uint32_t ip,uint16_t port)
 		if (port == 0) // select all ports
 		{
 			portinf->all = true;
-			portinf->portlist.clear();
+			portinf->ports.Clear();
 		}
 		else if (!portinf->all)
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = portinf->portlist.begin();
-			end = portinf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == port) // already in list
-					return 0;
-			}
-			portinf->portlist.push_front(port);
-		}
+			return portinf->ports.Add(port); // nothing happens if it's already in the set
 	}
 	else // got to create an entry for this IP address
 	{
 		PortInfo *portinf;
 		int status;
 		
-		portinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREPORTINFO) PortInfo();
+		portinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREPORTINFO) PortInfo(GetMemoryManager());
+		if (portinf == 0)
+			return ERR_RTP_OUTOFMEM;
 		if (port == 0) // select all ports
 			portinf->all = true;
-		else
-			portinf->portlist.push_front(port);
+		else if ((status = portinf->ports.Add(port)) < 0)
+		{
+			RTPDelete(portinf,GetMemoryManager());
+			return status;
+		}
 		
 		status = acceptignoreinfo.AddElement(ip,portinf);
 		if (status < 0)
@@ -1149,120 +1143,47 @@ int RTPFakeTransmitter::ProcessDeleteAcceptIgnoreEntry(uint32_t ip,uint16_t port
 	if (port == 0) // delete all entries
 	{
 		inf->all = false;
-		inf->portlist.clear();
+		inf->ports.Clear();
 	}
 	else // a specific port was selected
 	{
-		if (inf->all) // currently, all ports are selected. Add the one to remove to the list
-		{
-			// we have to check if the list doesn't contain the port already
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == port) // already in list: this means we already deleted the entry
-					return ERR_RTP_FAKETRANS_NOSUCHENTRY;
-			}
-			inf->portlist.push_front(port);
-		}
-		else // check if we can find the port in the list
+		if (inf->all) // currently, all ports are selected. Add the one to remove to the set
 		{
-			std::list<uint16_t>::iterator it,begin,end;
-			
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; ++it)
-			{
-				if (*it == port) // found it!
-				{
-					inf->portlist.erase(it);
-					return 0;
-				}
-			}
-			// didn't find it
-			return ERR_RTP_FAKETRANS_NOSUCHENTRY;			
+			if (inf->ports.Contains(port)) // this means we already deleted the entry
+				return ERR_RTP_FAKETRANS_NOSUCHENTRY;
+			return inf->ports.Add(port);
 		}
+		else if (!inf->ports.Remove(port)) // didn't find it
+			return ERR_RTP_FAKETRANS_NOSUCHENTRY;
 	}
 	return 0;
 }
 
 bool RTPFakeTransmitter::ShouldAcceptData(uint32_t srcip,uint16_t srcport)
 {
+	PortInfo *inf;
+
+	acceptignoreinfo.GotoElement(srcip);
 	if (receivemode == RTPTransmitter::AcceptSome)
 	{
-		PortInfo *inf;
-
-		acceptignoreinfo.GotoElement(srcip);
 		if (!acceptignoreinfo.HasCurrentElement())
 			return false;
 		
+		// If 'all' is set, accept all ports except the ones in the set,
+		// otherwise only accept the ones in the set
 		inf = acceptignoreinfo.GetCurrentElement();
-		if (!inf->all) // only accept the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return true;
-			}
-			return false;
-		}
-		else // accept all, except the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return false;
-			}
-			return true;
-		}
+		return (inf->ports.Contains(srcport) != inf->all);
 	}
 	else // IgnoreSome
 	{
-		PortInfo *inf;
-
-		acceptignoreinfo.GotoElement(srcip);
 		if (!acceptignoreinfo.HasCurrentElement())
 			return true;
 		
+		// If 'all' is set, ignore all ports except the ones in the set,
+		// otherwise only ignore the ones in the set
 		inf = acceptignoreinfo.GetCurrentElement();
-		if (!inf->all) // ignore the ports in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return false;
-			}
-			return true;
-		}
-		else // ignore all, except the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return true;
-			}
-			return false;
-		}
+		return (inf->ports.Contains(srcport) == inf->all);
 	}
-	return true;
 }
 
 int RTPFakeTransmitter::CreateLocalIPList()
@@ -1453,17 +1374,15 @@ void RTPFakeTransmitter::Dump()
 					if (pinfo->all)
 					{
 						std::cout << "All ports";
-						if (!pinfo->portlist.empty())
+						if (!pinfo->ports.IsEmpty())
 							std::cout << ", except ";
 					}
 					
-					std::list<uint16_t>::const_iterator it;
-					
-					for (it = pinfo->portlist.begin() ; it != pinfo->portlist.end() ; )
+					for (int port = pinfo->ports.GetNextPort(-1) ; port >= 0 ; )
 					{
-						std::cout << (*it);
-						it++;
-						if (it != pinfo->portlist.end())
+						std::cout << port;
+						port = pinfo->ports.GetNextPort(port);
+						if (port >= 0)
 							std::cout << ", ";
 					}
 					std::cout << std::endl;
@@ -50,8 +50,12 @@
 
 #include "rtptransmitter.h"
 #include "rtpipv4destination.h"
+#include "rtphashutilities.h"
 #include "rtphashtable.h"
 #include "rtpkeyhashtable.h"
+#include "rtpopenhashtable.h"
+#include "rtpopenkeyhashtable.h"
+#include "rtpportset.h"
 #include <list>
 
 #ifdef RTP_SUPPORT_THREAD
@@ -128,13 +132,15 @@ private:
 class RTPFakeTrans_GetHashIndex_IPv4Dest
 {
 public:
-	static int GetIndex(const RTPIPv4Destination &d)					{ return d.GetIP()%RTPFAKETRANS_HASHSIZE; }
+	static uint32_t GetHash(const RTPIPv4Destination &d)					{ return RTPHashCombine(RTPHashMix(d.GetIP()),ntohs(d.GetRTPPort_NBO())); }
+	static int GetIndex(const RTPIPv4Destination &d)					{ return (int)(GetHash(d)%RTPFAKETRANS_HASHSIZE); }
 };
 
 class RTPFakeTrans_GetHashIndex_uint32_t
 {
 public:
-	static int GetIndex(const uint32_t &k)							{ return k%RTPFAKETRANS_HASHSIZE; }
+	static uint32_t GetHash(const uint32_t &k)						{ return RTPHashMix(k); }
+	static int GetIndex(const uint32_t &k)							{ return (int)(GetHash(k)%RTPFAKETRANS_HASHSIZE); }
 };
 
 #define RTPFAKETRANS_HEADERSIZE						(20+8)
@@ -212,9 +218,9 @@ private:
 	uint8_t *localhostname;
 	size_t localhostnamelength;
 	
-	RTPHashTable<const RTPIPv4Destination,RTPFakeTrans_GetHashIndex_IPv4Dest,RTPFAKETRANS_HASHSIZE> destinations;
+	RTPOpenHashTable<const RTPIPv4Destination,RTPFakeTrans_GetHashIndex_IPv4Dest> destinations;
 #ifdef RTP_SUPPORT_IPV4MULTICAST
-//	RTPHashTable<const uint32_t,RTPFakeTrans_GetHashIndex_uint32_t,RTPFAKETRANS_HASHSIZE> multicastgroups;
+//	RTPOpenHashTable<const uint32_t,RTPFakeTrans_GetHashIndex_uint32_t> multicastgroups;
 #endif // RTP_SUPPORT_IPV4MULTICAST
 	std::list<RTPRawPacket*> rawpacketlist;
 
@@ -224,13 +230,13 @@ private:
 	class PortInfo
 	{
 	public:
-		PortInfo() { all = false; }
+		PortInfo(RTPMemoryManager *mgr) : ports(mgr) { all = false; }
 		
 		bool all;
-		std::list<uint16_t> portlist;
+		RTPPortSet ports;
 	};
 
-	RTPKeyHashTable<const uint32_t,PortInfo*,RTPFakeTrans_GetHashIndex_uint32_t,RTPFAKETRANS_HASHSIZE> acceptignoreinfo;
+	RTPOpenKeyHashTable<const uint32_t,PortInfo*,RTPFakeTrans_GetHashIndex_uint32_t> acceptignoreinfo;
 
 	int CreateAbortDescriptors();
 	void DestroyAbortDescriptors();
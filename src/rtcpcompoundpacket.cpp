@@ -32,6 +32,7 @@
 
 #include "rtcpcompoundpacket.h"
 #include "rtprawpacket.h"
+#include "rtpreceivebufferpool.h"
 #include "rtperrors.h"
 #include "rtpstructs.h"
 #include "rtpdefines.h"
@@ -54,6 +55,8 @@ RTCPCompoundPacket::RTCPCompoundPacket(RTPRawPacket &rawpack, RTPMemoryManager *
 {
 	compoundpacket = 0;
 	compoundpacketlength = 0;
+	bufferpool = 0;
+	headroom = 0;
 	error = 0;
 	
 	if (rawpack.IsRTP())
@@ -72,6 +75,8 @@ RTCPCompoundPacket::RTCPCompoundPacket(RTPRawPacket &rawpack, RTPMemoryManager *
 	compoundpacket = rawpack.GetData();
 	compoundpacketlength = rawpack.GetDataLength();
 	deletepacket = true;
+	bufferpool = rawpack.GetBufferPool();
+	headroom = rawpack.GetDataHeadroom();
 
 	rawpack.ZeroData();
 	
@@ -82,6 +87,8 @@ RTCPCompoundPacket::RTCPCompoundPacket(uint8_t *packet, size_t packetlen, bool d
 {
 	compoundpacket = 0;
 	compoundpacketlength = 0;
+	bufferpool = 0;
+	headroom = 0;
 	
 	error = ParseData(packet,packetlen);
 	if (error < 0)
@@ -100,6 +107,8 @@ RTCPCompoundPacket::RTCPCompoundPacket(RTPMemoryManager *mgr) : RTPMemoryObject(
 	compoundpacketlength = 0;
 	error = 0;
 	deletepacket = true;
+	bufferpool = 0;
+	headroom = 0;
 }
 
 int RTCPCompoundPacket::ParseData(uint8_t *data, size_t datalen)
@@ -201,7 +210,12 @@ RTCPCompoundPacket::~RTCPCompoundPacket()
 {
 	ClearPacketList();
 	if (compoundpacket && deletepacket)
-		RTPDeleteByteArray(compoundpacket,GetMemoryManager());
+	{
+		if (bufferpool)
+			bufferpool->ReleaseBuffer(compoundpacket-headroom);
+		else
+			RTPDeleteByteArray((compoundpacket-headroom),GetMemoryManager());
+	}
 }
 
 void RTCPCompoundPacket::ClearPacketList()
@@ -47,6 +47,7 @@ namespace jrtplib
 {
 
 class RTPRawPacket;
+class RTPReceiveBufferPool;
 class RTCPPacket;
 
 /** Represents an RTCP compound packet. */
@@ -101,6 +102,8 @@ protected:
 	uint8_t *compoundpacket;
 	size_t compoundpacketlength;
 	bool deletepacket;
+	RTPReceiveBufferPool *bufferpool;
+	size_t headroom;
 	
 	std::list<RTCPPacket *> rtcppacklist;
 	std::list<RTCPPacket *>::const_iterator rtcppackit;
@@ -101,7 +101,24 @@ void RTCPPacketBuilder::Destroy()
 	init = false;
 }
 
+void RTCPPacketBuilder::GetSenderInfo(SenderInfo &info) const
+{
+	info.ssrc = rtppacketbuilder.GetSSRC();
+	info.packettime = rtppacketbuilder.GetPacketTime();
+	info.packettimestamp = rtppacketbuilder.GetPacketTimestamp();
+	info.packetcount = rtppacketbuilder.GetPacketCount();
+	info.octetcount = rtppacketbuilder.GetPayloadOctetCount();
+}
+
 int RTCPPacketBuilder::BuildNextPacket(RTCPCompoundPacket **pack)
+{
+	SenderInfo info;
+
+	GetSenderInfo(info);
+	return BuildNextPacket(pack,info);
+}
+
+int RTCPPacketBuilder::BuildNextPacket(RTCPCompoundPacket **pack, const SenderInfo &info)
 {
 	if (!init)
 		return ERR_RTP_RTCPPACKETBUILDER_NOTINIT;
@@ -129,15 +146,15 @@ int RTCPPacketBuilder::BuildNextPacket(RTCPCompoundPacket **pack)
 			sender = true;
 	}
 	
-	uint32_t ssrc = rtppacketbuilder.GetSSRC();
+	uint32_t ssrc = info.ssrc;
 	RTPTime curtime = RTPTime::CurrentTime();
 
 	if (sender)
 	{
-		RTPTime rtppacktime = rtppacketbuilder.GetPacketTime();
-		uint32_t rtppacktimestamp = rtppacketbuilder.GetPacketTimestamp();
-		uint32_t packcount = rtppacketbuilder.GetPacketCount();
-		uint32_t octetcount = rtppacketbuilder.GetPayloadOctetCount();
+		RTPTime rtppacktime = info.packettime;
+		uint32_t rtppacktimestamp = info.packettimestamp;
+		uint32_t packcount = info.packetcount;
+		uint32_t octetcount = info.octetcount;
 		RTPTime diff = curtime;
 		diff -= rtppacktime;
 		diff += transmissiondelay; // the sample being sampled at this very instant will need a larger timestamp
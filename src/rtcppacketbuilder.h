@@ -100,9 +100,33 @@ public:
 	 */
 	int SetPreTransmissionDelay(const RTPTime &delay)				{ if (!init) return ERR_RTP_RTCPPACKETBUILDER_NOTINIT; transmissiondelay = delay; return 0; }
 	
+	/** The information about the RTP packets sent so far that's needed to start a sender report. */
+	class SenderInfo
+	{
+	public:
+		SenderInfo() : ssrc(0), packettime(0,0), packettimestamp(0), packetcount(0), octetcount(0)	{ }
+
+		uint32_t ssrc;
+		RTPTime packettime;
+		uint32_t packettimestamp;
+		uint32_t packetcount;
+		uint32_t octetcount;
+	};
+
+	/** Copies the current information from the RTP packet builder into \c info.
+	 *  Copies the current information from the RTP packet builder into \c info. Together with
+	 *  the BuildNextPacket version that accepts this information, this allows the RTP packet 
+	 *  builder to be used by another thread while the RTCP compound packet is being built.
+	 */
+	void GetSenderInfo(SenderInfo &info) const;
+
 	/** Builds the next RTCP compound packet which should be sent and stores it in \c pack. */
 	int BuildNextPacket(RTCPCompoundPacket **pack);
 
+	/** Builds the next RTCP compound packet which should be sent and stores it in \c pack, using
+	 *  \c info instead of the current state of the RTP packet builder (see RTCPPacketBuilder::GetSenderInfo). */
+	int BuildNextPacket(RTCPCompoundPacket **pack, const SenderInfo &info);
+
 	/** Builds a BYE packet with reason for leaving specified by \c reason and length \c reasonlength.
 	 *  Builds a BYE packet with reason for leaving specified by \c reason and length \c reasonlength. If 
 	 *  \c useSRifpossible is set to \c true, the RTCP compound packet will start with a sender report if
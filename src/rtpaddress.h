@@ -39,6 +39,7 @@
 #define RTPADDRESS_H
 
 #include "rtpconfig.h"
+#include "rtptypes.h"
 #include <string>
 
 namespace jrtplib
@@ -70,6 +71,14 @@ public:
 	 */
 	virtual RTPAddress *CreateCopy(RTPMemoryManager *mgr) const = 0;
 
+	/** Creates a copy of the RTPAddress instance in the memory block \c buffer of \c buffersize bytes.
+	 *  Creates a copy of the RTPAddress instance in the memory block \c buffer of \c buffersize bytes,
+	 *  which must be suitably aligned. This allows an address to be stored inside another object;
+	 *  such a copy must be destroyed by calling its destructor explicitly. Returns null if the copy
+	 *  doesn't fit or if the implementation doesn't support this (the default).
+	 */
+	virtual RTPAddress *CreateCopyAt(void *buffer, size_t buffersize) const	{ JRTPLIB_UNUSED(buffer); JRTPLIB_UNUSED(buffersize); return 0; }
+
 	/** Checks if the address \c addr is the same address as the one this instance represents. 
 	 *  Checks if the address \c addr is the same address as the one this instance represents.
 	 *  Implementations must be able to handle a NULL argument.
@@ -67,7 +67,12 @@ int RTPCollisionList::UpdateAddress(const RTPAddress *addr,const RTPTime &receiv
 	{
 		if (((*it).addr)->IsSameAddress(addr))
 		{
-			(*it).recvtime = receivetime;
+			std::list<AddressAndTime> entry;
+
+			// Take the entry out and insert it again at the position for its new time
+			entry.splice(entry.begin(),addresslist,it);
+			entry.front().recvtime = receivetime;
+			addresslist.splice(GetInsertPosition(receivetime),entry);
 			*created = false;
 			return 0;
 		}
@@ -77,11 +82,29 @@ int RTPCollisionList::UpdateAddress(const RTPAddress *addr,const RTPTime &receiv
 	if (newaddr == 0)
 		return ERR_RTP_OUTOFMEM;
 	
-	addresslist.push_back(AddressAndTime(newaddr,receivetime));
+	addresslist.insert(GetInsertPosition(receivetime),AddressAndTime(newaddr,receivetime));
 	*created = true;
 	return 0;
 }
 
+std::list<RTPCollisionList::AddressAndTime>::iterator RTPCollisionList::GetInsertPosition(const RTPTime &t)
+{
+	// The list is kept sorted by time; since updates normally use the current
+	// time, the position is searched for starting at the back
+	std::list<AddressAndTime>::iterator it = addresslist.end();
+
+	while (it != addresslist.begin())
+	{
+		std::list<AddressAndTime>::iterator prev = it;
+
+		prev--;
+		if (!(t < (*prev).recvtime))
+			break;
+		it = prev;
+	}
+	return it;
+}
+
 bool RTPCollisionList::HasAddress(const RTPAddress *addr) const
 {
 	std::list<AddressAndTime>::const_iterator it;
@@ -101,16 +124,12 @@ void RTPCollisionList::Timeout(const RTPTime &currenttime,const RTPTime &timeout
 	RTPTime checktime = currenttime;
 	checktime -= timeoutdelay;
 	
+	// The entries are sorted by time, so only the oldest ones need to be checked
 	it = addresslist.begin();
-	while(it != addresslist.end())
+	while(it != addresslist.end() && (*it).recvtime < checktime) // timeout
 	{
-		if ((*it).recvtime < checktime) // timeout
-		{
-			RTPDelete((*it).addr,GetMemoryManager());
-			it = addresslist.erase(it);	
-		}
-		else
-			it++;
+		RTPDelete((*it).addr,GetMemoryManager());
+		it = addresslist.erase(it);	
 	}
 }
 
@@ -86,6 +86,9 @@ private:
 		RTPTime recvtime;
 	};
 
+	std::list<AddressAndTime>::iterator GetInsertPosition(const RTPTime &t);
+
+	// Ordered by time, oldest entry first
 	std::list<AddressAndTime> addresslist;
 };
 
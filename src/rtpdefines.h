@@ -46,6 +46,7 @@
 #define RTP_COLLISIONTIMEOUTMULTIPLIER					10
 #define RTP_NOTETTIMEOUTMULTIPLIER					25
 #define RTP_DEFAULTSESSIONBANDWIDTH					10000.0
+#define RTP_DEFAULTPACKETWINDOWSIZE					4096
 
 #define RTP_RTCPTYPE_SR							200
 #define RTP_RTCPTYPE_RR							201
@@ -245,6 +245,73 @@ static RTPErrorInfo ErrorDescriptions[]=
 	{ ERR_RTP_TCPTRANS_SOCKETNOTFOUNDINDESTINATIONS, "The specified destination address (socket) was not found in the list of destinations of the TCP transmitter" },
 	{ ERR_RTP_TCPTRANS_ERRORINSEND, "An error occurred in the TCP transmitter while sending a packet" },
 	{ ERR_RTP_TCPTRANS_ERRORINRECV, "An error occurred in the TCP transmitter while receiving a packet" },
+	{ ERR_RTP_UDPV4TRANS_ILLEGALRECEIVEBATCHSIZE, "The receive batch size for the UDP over IPv4 transmitter must be at most RTPUDPV4TRANS_MAXRECEIVEBATCHSIZE" },
+	{ ERR_RTP_UDPV6TRANS_ILLEGALRECEIVEBATCHSIZE, "The receive batch size for the UDP over IPv6 transmitter must be at most RTPUDPV6TRANS_MAXRECEIVEBATCHSIZE" },
+	{ ERR_RTP_UDPRECEIVEBATCH_ILLEGALSIZE, "Both the batch size and the datagram size of a receive batch must be positive" },
+	{ ERR_RTP_UDPRECEIVEBATCH_NORECVMMSGSUPPORT, "Batched receiving of datagrams is not supported on this platform" },
+	{ ERR_RTP_UDPSENDBATCH_NOSENDMMSGSUPPORT, "Sending a packet to several destinations using a single call is not supported on this platform" },
+	{ ERR_RTP_IOURINGTRANS_NOTINIT, "The io_uring transmitter was not initialized" },
+	{ ERR_RTP_IOURINGTRANS_ALREADYINIT, "The io_uring transmitter was already initialized" },
+	{ ERR_RTP_IOURINGTRANS_ALREADYCREATED, "The io_uring transmitter was already created" },
+	{ ERR_RTP_IOURINGTRANS_NOTCREATED, "The io_uring transmitter was not created" },
+	{ ERR_RTP_IOURINGTRANS_ILLEGALPARAMETERS, "Illegal parameters type passed to the io_uring transmitter" },
+	{ ERR_RTP_IOURINGTRANS_CANTINITMUTEX, "Unable to initialize the io_uring transmitter's mutexes" },
+	{ ERR_RTP_IOURINGTRANS_CANTCREATESOCKET, "Unable to create a socket for the io_uring transmitter" },
+	{ ERR_RTP_IOURINGTRANS_CANTBINDRTPSOCKET, "Unable to bind the RTP socket of the io_uring transmitter" },
+	{ ERR_RTP_IOURINGTRANS_CANTBINDRTCPSOCKET, "Unable to bind the RTCP socket of the io_uring transmitter" },
+	{ ERR_RTP_IOURINGTRANS_CANTSETSOCKETBUFFER, "Unable to set the buffer size of one of the io_uring transmitter's sockets" },
+	{ ERR_RTP_IOURINGTRANS_PORTBASENOTEVEN, "The specified port base for the io_uring transmitter is not an even number" },
+	{ ERR_RTP_IOURINGTRANS_ILLEGALBUFFERCOUNT, "The number of receive buffers for the io_uring transmitter must be a power of two between 1 and 32768, and the other ring and buffer sizes must be positive" },
+	{ ERR_RTP_IOURINGTRANS_CANTSETUPRING, "Unable to set up an io_uring instance; the kernel may not support it" },
+	{ ERR_RTP_IOURINGTRANS_CANTREGISTERBUFFERS, "Unable to register the receive buffers with the io_uring instance; a kernel of at least version 5.19 is required" },
+	{ ERR_RTP_IOURINGTRANS_CANTCREATEWAKEUPDESCRIPTOR, "Unable to create the eventfd descriptor that's used to abort a wait in the io_uring transmitter" },
+	{ ERR_RTP_IOURINGTRANS_CANTSUBMIT, "Unable to submit requests to the io_uring instance" },
+	{ ERR_RTP_IOURINGTRANS_ERRORINWAIT, "An error occurred while waiting for completions of the io_uring instance" },
+	{ ERR_RTP_IOURINGTRANS_ALREADYWAITING, "The io_uring transmitter is already waiting for incoming data" },
+	{ ERR_RTP_IOURINGTRANS_NOTWAITING, "The io_uring transmitter is not waiting for incoming data" },
+	{ ERR_RTP_IOURINGTRANS_INVALIDADDRESSTYPE, "The io_uring transmitter only supports IPv4 addresses" },
+	{ ERR_RTP_IOURINGTRANS_NOSUCHENTRY, "The specified destination was not found in the io_uring transmitter's list" },
+	{ ERR_RTP_IOURINGTRANS_DESTINATIONALREADYINLIST, "The specified destination is already in the io_uring transmitter's list" },
+	{ ERR_RTP_IOURINGTRANS_NOMULTICASTSUPPORT, "The io_uring transmitter does not support multicasting" },
+	{ ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED, "The io_uring transmitter only supports the 'accept all' receive mode" },
+	{ ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG, "The maximum packet size is too big for the io_uring transmitter" },
+	{ ERR_RTP_RECEIVEBUFFERPOOL_ALREADYCREATED, "The receive buffer pool was already created" },
+	{ ERR_RTP_RECEIVEBUFFERPOOL_ILLEGALSIZE, "The number of buffers and the buffer size of the receive buffer pool must be positive" },
+	{ ERR_RTP_RECEIVEBUFFERPOOL_CANTINITMUTEX, "Unable to initialize the mutex of the receive buffer pool" },
+	{ ERR_RTP_SESSION_NORECEIVEBUFFERPOOL, "No receive buffer pool is used by this session" },
+	{ ERR_RTP_UDPSOCKETFILTER_TOOLARGE, "The accept or ignore list is too large to be converted into a socket filter" },
+	{ ERR_RTP_UDPSOCKETFILTER_CANTATTACH, "Unable to attach the socket filter" },
+	{ ERR_RTP_UDPSOCKETFILTER_NOTSUPPORTED, "Socket filters are not supported on this platform" },
+	{ ERR_RTP_UDPSOCKETFILTER_CANTGETDROPCOUNT, "Unable to obtain the number of packets the kernel dropped" },
+	{ ERR_RTP_UDPSOCKETFILTER_CANTATTACHSTEERING, "Unable to attach the program that distributes packets over the sockets based on their SSRC" },
+	{ ERR_RTP_UDPV4TRANS_CANTSETREUSEPORT, "Unable to let several sockets share the same port (this requires SO_REUSEPORT support and an explicit port base)" },
+	{ ERR_RTP_UDPV6TRANS_CANTSETREUSEPORT, "Unable to let several sockets share the same port (this requires SO_REUSEPORT support)" },
+	{ ERR_RTP_TRANSMITTER_NORECEIVESOCKETS, "The transmission component doesn't provide the sockets on which it receives data" },
+	{ ERR_RTP_TRANSMITTER_SOCKETARRAYTOOSMALL, "The array to store the receive sockets in is too small" },
+	{ ERR_RTP_REACTOR_ALREADYRUNNING, "The reactor is already running" },
+	{ ERR_RTP_REACTOR_NOTRUNNING, "The reactor is not running" },
+	{ ERR_RTP_REACTOR_ILLEGALTHREADCOUNT, "The number of reactor threads must be positive" },
+	{ ERR_RTP_REACTOR_CANTINITMUTEX, "Unable to initialize the mutex of the reactor" },
+	{ ERR_RTP_REACTOR_CANTCREATEEPOLL, "Unable to create the epoll instance of the reactor" },
+	{ ERR_RTP_REACTOR_CANTSTARTTHREAD, "Unable to start a reactor thread" },
+	{ ERR_RTP_REACTOR_INVALIDSESSION, "The session was not created yet, or it uses its own poll thread" },
+	{ ERR_RTP_REACTOR_SESSIONALREADYADDED, "The session was already added to the reactor" },
+	{ ERR_RTP_REACTOR_SESSIONNOTFOUND, "The session was not added to the reactor" },
+	{ ERR_RTP_REACTOR_CANTREGISTERSOCKET, "Unable to register a socket of the session with the reactor" },
+	{ ERR_RTP_SESSIONGROUP_ALREADYCREATED, "The session group was already created" },
+	{ ERR_RTP_SESSIONGROUP_NOTCREATED, "The session group was not created yet" },
+	{ ERR_RTP_SESSIONGROUP_CANTINITMUTEX, "Unable to initialize the mutex of the session group" },
+	{ ERR_RTP_UDPV4TRANS_NOABORTDESCRIPTORS, "The transmitter was created without abort descriptors, so waiting for data can't be aborted" },
+	{ ERR_RTP_UDPV6TRANS_NOABORTDESCRIPTORS, "The transmitter was created without abort descriptors, so waiting for data can't be aborted" },
+	{ ERR_RTP_EVENTNOTIFIER_ALREADYINIT, "The event notifier was already initialized" },
+	{ ERR_RTP_EVENTNOTIFIER_NOTINIT, "The event notifier was not initialized" },
+	{ ERR_RTP_EVENTNOTIFIER_CANTCREATE, "Unable to create the descriptor of the event notifier" },
+	{ ERR_RTP_SESSION_NODATAREADYNOTIFICATION, "Data ready notification was not enabled for this session" },
+	{ ERR_RTP_PACKETQUEUE_ALREADYCREATED, "The packet queue was already created" },
+	{ ERR_RTP_PACKETQUEUE_NOATOMICSUPPORT, "The packet queue needs std::atomic, which is not available" },
+	{ ERR_RTP_PACKETQUEUE_ILLEGALCAPACITY, "Illegal capacity for the packet queue" },
+	{ ERR_RTP_SESSION_NODELIVERYQUEUE, "No delivery queue was requested for this session" },
+	{ ERR_RTP_SESSION_NOLOCKHOLDTIMES, "The lock hold times of this session are not being collected" },
 	{ 0,0 }
 };
 
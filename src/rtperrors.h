@@ -246,6 +246,73 @@ std::string JRTPLIB_IMPORTEXPORT RTPGetErrorString(int errcode);
 #define ERR_RTP_TCPTRANS_SOCKETNOTFOUNDINDESTINATIONS             -195
 #define ERR_RTP_TCPTRANS_ERRORINSEND                              -196
 #define ERR_RTP_TCPTRANS_ERRORINRECV                              -197
+#define ERR_RTP_UDPV4TRANS_ILLEGALRECEIVEBATCHSIZE                -198
+#define ERR_RTP_UDPV6TRANS_ILLEGALRECEIVEBATCHSIZE                -199
+#define ERR_RTP_UDPRECEIVEBATCH_ILLEGALSIZE                       -200
+#define ERR_RTP_UDPRECEIVEBATCH_NORECVMMSGSUPPORT                 -201
+#define ERR_RTP_UDPSENDBATCH_NOSENDMMSGSUPPORT                    -202
+#define ERR_RTP_IOURINGTRANS_NOTINIT                              -203
+#define ERR_RTP_IOURINGTRANS_ALREADYINIT                          -204
+#define ERR_RTP_IOURINGTRANS_ALREADYCREATED                       -205
+#define ERR_RTP_IOURINGTRANS_NOTCREATED                           -206
+#define ERR_RTP_IOURINGTRANS_ILLEGALPARAMETERS                    -207
+#define ERR_RTP_IOURINGTRANS_CANTINITMUTEX                        -208
+#define ERR_RTP_IOURINGTRANS_CANTCREATESOCKET                     -209
+#define ERR_RTP_IOURINGTRANS_CANTBINDRTPSOCKET                    -210
+#define ERR_RTP_IOURINGTRANS_CANTBINDRTCPSOCKET                   -211
+#define ERR_RTP_IOURINGTRANS_CANTSETSOCKETBUFFER                  -212
+#define ERR_RTP_IOURINGTRANS_PORTBASENOTEVEN                      -213
+#define ERR_RTP_IOURINGTRANS_ILLEGALBUFFERCOUNT                   -214
+#define ERR_RTP_IOURINGTRANS_CANTSETUPRING                        -215
+#define ERR_RTP_IOURINGTRANS_CANTREGISTERBUFFERS                  -216
+#define ERR_RTP_IOURINGTRANS_CANTCREATEWAKEUPDESCRIPTOR           -217
+#define ERR_RTP_IOURINGTRANS_CANTSUBMIT                           -218
+#define ERR_RTP_IOURINGTRANS_ERRORINWAIT                          -219
+#define ERR_RTP_IOURINGTRANS_ALREADYWAITING                       -220
+#define ERR_RTP_IOURINGTRANS_NOTWAITING                           -221
+#define ERR_RTP_IOURINGTRANS_INVALIDADDRESSTYPE                   -222
+#define ERR_RTP_IOURINGTRANS_NOSUCHENTRY                          -223
+#define ERR_RTP_IOURINGTRANS_DESTINATIONALREADYINLIST             -224
+#define ERR_RTP_IOURINGTRANS_NOMULTICASTSUPPORT                   -225
+#define ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED              -226
+#define ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG                  -227
+#define ERR_RTP_RECEIVEBUFFERPOOL_ALREADYCREATED                  -228
+#define ERR_RTP_RECEIVEBUFFERPOOL_ILLEGALSIZE                     -229
+#define ERR_RTP_RECEIVEBUFFERPOOL_CANTINITMUTEX                   -230
+#define ERR_RTP_SESSION_NORECEIVEBUFFERPOOL                       -231
+#define ERR_RTP_UDPSOCKETFILTER_TOOLARGE                          -232
+#define ERR_RTP_UDPSOCKETFILTER_CANTATTACH                        -233
+#define ERR_RTP_UDPSOCKETFILTER_NOTSUPPORTED                      -234
+#define ERR_RTP_UDPSOCKETFILTER_CANTGETDROPCOUNT                  -235
+#define ERR_RTP_UDPSOCKETFILTER_CANTATTACHSTEERING                -236
+#define ERR_RTP_UDPV4TRANS_CANTSETREUSEPORT                       -237
+#define ERR_RTP_UDPV6TRANS_CANTSETREUSEPORT                       -238
+#define ERR_RTP_TRANSMITTER_NORECEIVESOCKETS                      -239
+#define ERR_RTP_TRANSMITTER_SOCKETARRAYTOOSMALL                   -240
+#define ERR_RTP_REACTOR_ALREADYRUNNING                            -241
+#define ERR_RTP_REACTOR_NOTRUNNING                                -242
+#define ERR_RTP_REACTOR_ILLEGALTHREADCOUNT                        -243
+#define ERR_RTP_REACTOR_CANTINITMUTEX                             -244
+#define ERR_RTP_REACTOR_CANTCREATEEPOLL                           -245
+#define ERR_RTP_REACTOR_CANTSTARTTHREAD                           -246
+#define ERR_RTP_REACTOR_INVALIDSESSION                            -247
+#define ERR_RTP_REACTOR_SESSIONALREADYADDED                       -248
+#define ERR_RTP_REACTOR_SESSIONNOTFOUND                           -249
+#define ERR_RTP_REACTOR_CANTREGISTERSOCKET                        -250
+#define ERR_RTP_SESSIONGROUP_ALREADYCREATED                       -251
+#define ERR_RTP_SESSIONGROUP_NOTCREATED                           -252
+#define ERR_RTP_SESSIONGROUP_CANTINITMUTEX                        -253
+#define ERR_RTP_UDPV4TRANS_NOABORTDESCRIPTORS                     -254
+#define ERR_RTP_UDPV6TRANS_NOABORTDESCRIPTORS                     -255
+#define ERR_RTP_EVENTNOTIFIER_ALREADYINIT                         -256
+#define ERR_RTP_EVENTNOTIFIER_NOTINIT                             -257
+#define ERR_RTP_EVENTNOTIFIER_CANTCREATE                          -258
+#define ERR_RTP_SESSION_NODATAREADYNOTIFICATION                   -259
+#define ERR_RTP_PACKETQUEUE_ALREADYCREATED                        -260
+#define ERR_RTP_PACKETQUEUE_NOATOMICSUPPORT                       -261
+#define ERR_RTP_PACKETQUEUE_ILLEGALCAPACITY                       -262
+#define ERR_RTP_SESSION_NODELIVERYQUEUE                           -263
+#define ERR_RTP_SESSION_NOLOCKHOLDTIMES                           -264
 
 #endif // RTPERRORS_H
 
@@ -0,0 +1,151 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpeventnotifier.h"
+#include "rtperrors.h"
+#ifdef RTP_HAVE_EVENTFD
+	#include <sys/eventfd.h>
+	#include <unistd.h>
+	#include <stdint.h>
+#endif // RTP_HAVE_EVENTFD
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+#ifdef RTP_HAVE_EVENTFD
+
+RTPEventNotifier::RTPEventNotifier()
+{
+	m_fd = -1;
+}
+
+RTPEventNotifier::~RTPEventNotifier()
+{
+	Destroy();
+}
+
+int RTPEventNotifier::Init()
+{
+	if (m_fd >= 0)
+		return ERR_RTP_EVENTNOTIFIER_ALREADYINIT;
+
+	// Non-blocking, so that clearing a notifier that wasn't signalled doesn't block
+	if ((m_fd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC)) < 0)
+		return ERR_RTP_EVENTNOTIFIER_CANTCREATE;
+	return 0;
+}
+
+void RTPEventNotifier::Destroy()
+{
+	if (m_fd < 0)
+		return;
+	close(m_fd);
+	m_fd = -1;
+}
+
+int RTPEventNotifier::Signal()
+{
+	if (m_fd < 0)
+		return ERR_RTP_EVENTNOTIFIER_NOTINIT;
+
+	uint64_t value = 1;
+
+	if (write(m_fd, &value, sizeof(uint64_t)))
+	{
+		// To get rid of __wur related compiler warnings
+	}
+	return 0;
+}
+
+int RTPEventNotifier::Clear()
+{
+	if (m_fd < 0)
+		return ERR_RTP_EVENTNOTIFIER_NOTINIT;
+
+	// Reading an eventfd resets its counter to zero
+	uint64_t value;
+
+	if (read(m_fd, &value, sizeof(uint64_t)))
+	{
+		// To get rid of __wur related compiler warnings
+	}
+	return 0;
+}
+
+#else
+
+RTPEventNotifier::RTPEventNotifier()
+{
+}
+
+RTPEventNotifier::~RTPEventNotifier()
+{
+	Destroy();
+}
+
+int RTPEventNotifier::Init()
+{
+	if (m_descriptors.IsInitialized())
+		return ERR_RTP_EVENTNOTIFIER_ALREADYINIT;
+
+	int status;
+
+	if ((status = m_descriptors.Init()) < 0)
+		return status;
+	return 0;
+}
+
+void RTPEventNotifier::Destroy()
+{
+	m_descriptors.Destroy();
+}
+
+int RTPEventNotifier::Signal()
+{
+	if (!m_descriptors.IsInitialized())
+		return ERR_RTP_EVENTNOTIFIER_NOTINIT;
+	return m_descriptors.SendAbortSignal();
+}
+
+int RTPEventNotifier::Clear()
+{
+	if (!m_descriptors.IsInitialized())
+		return ERR_RTP_EVENTNOTIFIER_NOTINIT;
+	return m_descriptors.ClearAbortSignal();
+}
+
+#endif // RTP_HAVE_EVENTFD
+
+} // end namespace
+
@@ -0,0 +1,107 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpeventnotifier.h
+ */
+
+#ifndef RTPEVENTNOTIFIER_H
+
+#define RTPEVENTNOTIFIER_H
+
+#include "rtpconfig.h"
+#include "rtpsocketutil.h"
+#ifndef RTP_HAVE_EVENTFD
+	#include "rtpabortdescriptors.h"
+#endif // !RTP_HAVE_EVENTFD
+
+namespace jrtplib
+{
+
+/**
+ * Provides a descriptor that becomes readable when an event is signalled.
+ *
+ * The descriptor can be included in a call to 'select', 'poll' or 'epoll_wait' in
+ * another thread, which will then wake up when RTPEventNotifier::Signal is called.
+ * It stays readable until RTPEventNotifier::Clear is called. On Linux an eventfd is 
+ * used for this; on other platforms the class falls back to an RTPAbortDescriptors
+ * instance.
+ */
+class JRTPLIB_IMPORTEXPORT RTPEventNotifier
+{
+	JRTPLIB_NO_COPY(RTPEventNotifier)
+public:
+	RTPEventNotifier();
+	~RTPEventNotifier();
+
+	/** Initializes this instance. */
+	int Init();
+
+	/** De-initializes this instance. */
+	void Destroy();
+
+	/** Returns a flag indicating if this instance was initialized. */
+	bool IsInitialized() const;
+
+	/** Returns the descriptor that becomes readable when an event is signalled. */
+	SocketType GetDescriptor() const;
+
+	/** Makes the descriptor readable. */
+	int Signal();
+
+	/** Makes the descriptor unreadable again, regardless of how many times 
+	 *  RTPEventNotifier::Signal was called. */
+	int Clear();
+private:
+#ifdef RTP_HAVE_EVENTFD
+	int m_fd;
+#else
+	RTPAbortDescriptors m_descriptors;
+#endif // RTP_HAVE_EVENTFD
+};
+
+#ifdef RTP_HAVE_EVENTFD
+
+inline bool RTPEventNotifier::IsInitialized() const						{ return m_fd >= 0; }
+inline SocketType RTPEventNotifier::GetDescriptor() const					{ return m_fd; }
+
+#else
+
+inline bool RTPEventNotifier::IsInitialized() const						{ return m_descriptors.IsInitialized(); }
+inline SocketType RTPEventNotifier::GetDescriptor() const					{ return m_descriptors.GetAbortSocket(); }
+
+#endif // RTP_HAVE_EVENTFD
+
+} // end namespace
+
+#endif // RTPEVENTNOTIFIER_H
+
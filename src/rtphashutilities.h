@@ -0,0 +1,79 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtphashutilities.h
+ */
+
+#ifndef RTPHASHUTILITIES_H
+
+#define RTPHASHUTILITIES_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+
+namespace jrtplib
+{
+
+/** Scrambles the bits of \c x, so that keys which only differ in a few bits (like consecutive
+ *  port numbers or IP addresses in the same subnet) end up far apart. This is the final mixing
+ *  step of the 32-bit MurmurHash3 function. */
+inline uint32_t RTPHashMix(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x85ebca6bU;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35U;
+	x ^= x >> 16;
+	return x;
+}
+
+/** Combines the hash value \c h with the value \c v, and mixes the result. */
+inline uint32_t RTPHashCombine(uint32_t h, uint32_t v)
+{
+	return RTPHashMix(h ^ (v + 0x9e3779b9U + (h << 6) + (h >> 2)));
+}
+
+/** Returns a hash value for the 16 byte IPv6 address \c addr, using all of its bytes. */
+inline uint32_t RTPHashIPv6Address(const uint8_t *addr)
+{
+	uint32_t h = 0;
+
+	for (int i = 0 ; i < 16 ; i += 4)
+		h = RTPHashCombine(h, (((uint32_t)addr[i])<<24)|(((uint32_t)addr[i+1])<<16)|(((uint32_t)addr[i+2])<<8)|((uint32_t)addr[i+3]));
+	return h;
+}
+
+} // end namespace
+
+#endif // RTPHASHUTILITIES_H
+
@@ -0,0 +1,126 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpholdtimehistogram.h
+ */
+
+#ifndef RTPHOLDTIMEHISTOGRAM_H
+
+#define RTPHOLDTIMEHISTOGRAM_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtptimeutilities.h"
+
+// Number of buckets; the last one counts everything from about four seconds on
+#define RTPHOLDTIMEHISTOGRAM_NUMBUCKETS							24
+
+namespace jrtplib
+{
+
+/** Keeps track of how long something, e.g. a lock, was held.
+ *  Each time RTPHoldTimeHistogram::Stop is called, the time that has passed since the previous
+ *  call to RTPHoldTimeHistogram::Start is counted in one of the buckets of a histogram. The
+ *  buckets have a logarithmic scale: the first one counts the durations shorter than one 
+ *  microsecond, and each following bucket covers durations up to twice as long as the previous one.
+ *  The class itself is not thread-safe; when it's used to measure how long a lock was held, the
+ *  calls to RTPHoldTimeHistogram::Start and RTPHoldTimeHistogram::Stop should be made while the
+ *  lock is held.
+ */
+class JRTPLIB_IMPORTEXPORT RTPHoldTimeHistogram
+{
+public:
+	RTPHoldTimeHistogram() : starttime(0,0)							{ Reset(); }
+
+	/** Clears all counts. */
+	void Reset();
+
+	/** Marks the start of a duration that should be measured. */
+	void Start()													{ starttime = RTPTime::CurrentTime(); }
+
+	/** Counts the time that has passed since the last call to RTPHoldTimeHistogram::Start. */
+	void Stop();
+
+	/** Returns the number of buckets in the histogram. */
+	size_t GetNumberOfBuckets() const								{ return RTPHOLDTIMEHISTOGRAM_NUMBUCKETS; }
+
+	/** Returns the number of durations that were counted in bucket \c idx. */
+	uint64_t GetCount(size_t idx) const								{ return (idx < RTPHOLDTIMEHISTOGRAM_NUMBUCKETS)?counts[idx]:0; }
+
+	/** Returns the limit in microseconds of bucket \c idx: the bucket counts the durations that are
+	 *  shorter than this limit, but not shorter than the limit of the previous bucket. The last bucket
+	 *  also counts all longer durations. */
+	static uint64_t GetBucketLimit(size_t idx)						{ return ((uint64_t)1) << idx; }
+
+	/** Returns the number of durations that were counted in total. */
+	uint64_t GetTotalCount() const									{ return totalcount; }
+
+	/** Returns the sum of all counted durations. */
+	RTPTime GetTotalTime() const									{ return RTPTime(totaltime); }
+
+	/** Returns the longest duration that was counted. */
+	RTPTime GetMaximumTime() const									{ return RTPTime(maxtime); }
+private:
+	RTPTime starttime;
+	uint64_t counts[RTPHOLDTIMEHISTOGRAM_NUMBUCKETS];
+	uint64_t totalcount;
+	double totaltime, maxtime;
+};
+
+inline void RTPHoldTimeHistogram::Stop()
+{
+	RTPTime t = RTPTime::CurrentTime();
+
+	t -= starttime;
+
+	double d = t.GetDouble();
+	uint64_t microseconds = (d > 0)?(uint64_t)(d*1000000.0):0;
+	size_t idx = 0;
+
+	while (microseconds != 0 && idx < RTPHOLDTIMEHISTOGRAM_NUMBUCKETS-1)
+	{
+		microseconds >>= 1;
+		idx++;
+	}
+
+	counts[idx]++;
+	totalcount++;
+	totaltime += d;
+	if (d > maxtime)
+		maxtime = d;
+}
+
+} // end namespace
+
+#endif // RTPHOLDTIMEHISTOGRAM_H
+
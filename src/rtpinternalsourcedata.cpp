@@ -37,6 +37,7 @@
 #include "rtpdebug.h"
 
 #define RTPINTERNALSOURCEDATA_MAXPROBATIONPACKETS		32
+#define RTPINTERNALSOURCEDATA_DELIVERYHISTORY			64
 
 namespace jrtplib
 {
@@ -44,6 +45,13 @@ namespace jrtplib
 RTPInternalSourceData::RTPInternalSourceData(uint32_t ssrc,RTPSources::ProbationType probtype,RTPMemoryManager *mgr):RTPSourceData(ssrc,mgr)
 {
 	JRTPLIB_UNUSED(probtype); // possibly unused
+	membertimeoutentry.SetOwner(this);
+	sendertimeoutentry.SetOwner(this);
+	byetimeoutentry.SetOwner(this);
+	notetimeoutentry.SetOwner(this);
+	hasdelivered = false;
+	lastdeliveredseqnr = 0;
+	deliveredhistory = 0;
 #ifdef RTP_SUPPORT_PROBATION
 	probationtype = probtype;
 #endif // RTP_SUPPORT_PROBATION
@@ -122,68 +130,67 @@ int RTPInternalSourceData::ProcessRTPPacket(RTPPacket *rtppack,const RTPTime &re
 
 	// Now, we can place the packet in the queue
 	
-	if (packetlist.empty())
-	{
-		*stored = true;
-		packetlist.push_back(rtppack);
-		return 0;
-	}
-	
 	if (!validated) // still on probation
 	{
 		// Make sure that we don't buffer too much packets to avoid wasting memory
 		// on a bad source. Delete the packet in the queue with the lowest sequence
 		// number.
-		if (packetlist.size() == RTPINTERNALSOURCEDATA_MAXPROBATIONPACKETS)
+		if (packetring.GetNumberOfPackets() == RTPINTERNALSOURCEDATA_MAXPROBATIONPACKETS)
 		{
-			RTPPacket *p = *(packetlist.begin());
-			packetlist.pop_front();
-			RTPDelete(p,GetMemoryManager());
+			RTPPacket *p = packetring.Pop();
+			RTPPacket::Delete(p,GetMemoryManager());
 		}
 	}
 
-	// find the right position to insert the packet
-	
-	std::list<RTPPacket*>::iterator it,start;
-	bool done = false;
-	uint32_t newseqnr = rtppack->GetExtendedSequenceNumber();
-	
-	it = packetlist.end();
-	--it;
-	start = packetlist.begin();
-	
-	while (!done)
+	// The ring drops the packet if it's a duplicate or if it's too old
+	int status = packetring.Insert(rtppack,sources->GetPacketWindowSize(),stored);
+
+	if (status < 0)
+		return status;
+	if (*stored && validated)
+		sources->OnStoredRTPPacket(this,rtppack);
+	return 0;
+}
+
+bool RTPInternalSourceData::MustRejectForDelivery(uint32_t seqnr, uint32_t windowsize) const
+{
+	if (!hasdelivered)
+		return false;
+
+	// As in RTPSequenceRing, the difference is interpreted as a signed value so that
+	// the extended sequence numbers may wrap around
+	if ((int32_t)(seqnr-lastdeliveredseqnr) > 0)
+		return false;
+
+	uint32_t behind = lastdeliveredseqnr-seqnr;
+
+	if (behind >= windowsize || behind >= RTPINTERNALSOURCEDATA_DELIVERYHISTORY)
+		return true;
+	return (deliveredhistory & (((uint64_t)1) << behind)) != 0;
+}
+
+void RTPInternalSourceData::MarkDelivered(uint32_t seqnr)
+{
+	if (!hasdelivered)
 	{
-		RTPPacket *p;
-		uint32_t seqnr;
-		
-		p = *it;
-		seqnr = p->GetExtendedSequenceNumber();
-		if (seqnr > newseqnr)
-		{
-			if (it != start)
-				--it;
-			else // we're at the start of the list
-			{
-				*stored = true;
-				done = true;
-				packetlist.push_front(rtppack);
-			}
-		}
-		else if (seqnr < newseqnr) // insert after this packet
-		{
-			++it;
-			packetlist.insert(it,rtppack);
-			done = true;
-			*stored = true;
-		}
-		else // they're equal !! Drop packet
-		{
-			done = true;
-		}
+		hasdelivered = true;
+		lastdeliveredseqnr = seqnr;
+		deliveredhistory = 1;
+		return;
 	}
 
-	return 0;
+	int32_t diff = (int32_t)(seqnr-lastdeliveredseqnr);
+
+	if (diff > 0)
+	{
+		if (diff >= RTPINTERNALSOURCEDATA_DELIVERYHISTORY)
+			deliveredhistory = 1;
+		else
+			deliveredhistory = (deliveredhistory << diff) | 1;
+		lastdeliveredseqnr = seqnr;
+	}
+	else
+		deliveredhistory |= ((uint64_t)1) << (lastdeliveredseqnr-seqnr);
 }
 
 int RTPInternalSourceData::ProcessSDESItem(uint8_t sdesid,const uint8_t *data,size_t itemlen,const RTPTime &receivetime,bool *cnamecollis)
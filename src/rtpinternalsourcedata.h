@@ -43,6 +43,7 @@
 #include "rtpaddress.h"
 #include "rtptimeutilities.h"
 #include "rtpsources.h"
+#include "rtptimerwheel.h"
 
 namespace jrtplib
 {
@@ -70,13 +71,32 @@ public:
 	int SetRTCPDataAddress(const RTPAddress *a);
 
 	void ClearSenderFlag()										{ issender = false; }
-	void SentRTPPacket()										{ if (!ownssrc) return; RTPTime t = RTPTime::CurrentTime(); issender = true; stats.SetLastRTPPacketTime(t); stats.SetLastMessageTime(t); }
+	void SentRTPPacket()										{ SentRTPPacket(RTPTime::CurrentTime()); }
+	void SentRTPPacket(const RTPTime &t)								{ if (!ownssrc) return; issender = true; stats.SetLastRTPPacketTime(t); stats.SetLastMessageTime(t); }
 	void SetOwnSSRC()										{ ownssrc = true; validated = true; }
 	void SetCSRC()											{ validated = true; iscsrc = true; }
 	void ClearNote()										{ SDESinf.SetNote(0,0); }
-	
-#ifdef RTP_SUPPORT_PROBATION
+
+	// Used when packets are handed to the session's delivery queue instead of being stored:
+	// a packet must be rejected if one with the same sequence number was delivered already,
+	// or if it lies too far before the last delivered one to tell
+	bool MustRejectForDelivery(uint32_t seqnr, uint32_t windowsize) const;
+	void MarkDelivered(uint32_t seqnr);
+
+	// Entries for the timer wheels of RTPSources, one for each kind of timeout
+	RTPTimerWheelEntry &GetMemberTimeoutEntry()							{ return membertimeoutentry; }
+	RTPTimerWheelEntry &GetSenderTimeoutEntry()							{ return sendertimeoutentry; }
+	RTPTimerWheelEntry &GetBYETimeoutEntry()							{ return byetimeoutentry; }
+	RTPTimerWheelEntry &GetNoteTimeoutEntry()							{ return notetimeoutentry; }
 private:
+	RTPTimerWheelEntry membertimeoutentry;
+	RTPTimerWheelEntry sendertimeoutentry;
+	RTPTimerWheelEntry byetimeoutentry;
+	RTPTimerWheelEntry notetimeoutentry;
+	bool hasdelivered;
+	uint32_t lastdeliveredseqnr;
+	uint64_t deliveredhistory; // bit i is set if lastdeliveredseqnr-i was delivered
+#ifdef RTP_SUPPORT_PROBATION
 	RTPSources::ProbationType probationtype;
 #endif // RTP_SUPPORT_PROBATION
 };
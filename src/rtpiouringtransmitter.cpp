@@ -0,0 +1,1696 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpiouringtransmitter.h"
+
+#ifdef RTP_SUPPORT_IOURING
+
+#include "rtprawpacket.h"
+#include "rtppacket.h"
+#include "rtpipv4address.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include "rtpdefines.h"
+#include "rtpstructs.h"
+#include "rtpsocketutilinternal.h"
+#include "rtpinternalutils.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef RTP_SUPPORT_IFADDRS
+	#include <ifaddrs.h>
+#endif // RTP_SUPPORT_IFADDRS
+#ifdef RTPDEBUG
+	#include <iostream>
+#endif // RTPDEBUG
+
+#include "rtpdebug.h"
+
+#define RTPIOURINGTRANS_MAXPACKSIZE							65535
+#define RTPIOURINGTRANS_MAXRECEIVEBUFFERS					32768
+#define RTPIOURINGTRANS_BUFFERGROUP							0
+#define RTPIOURINGTRANS_SQPOLLIDLE							1000 // milliseconds
+
+// The lowest bits of the user data of a request tell us what kind of request it was,
+// for a send request the remaining bits contain the index of the request
+#define RTPIOURINGTRANS_REQ_RTPRECV							1
+#define RTPIOURINGTRANS_REQ_RTCPRECV						2
+#define RTPIOURINGTRANS_REQ_WAKEUP							3
+#define RTPIOURINGTRANS_REQ_SEND							4
+#define RTPIOURINGTRANS_REQ_CANCEL							5
+#define RTPIOURINGTRANS_REQ_TYPEBITS						3
+#define RTPIOURINGTRANS_REQ_TYPEMASK						((1<<RTPIOURINGTRANS_REQ_TYPEBITS)-1)
+
+#ifdef RTP_SUPPORT_THREAD
+	#define MAINMUTEX_LOCK 		{ if (threadsafe) mainmutex.Lock(); }
+	#define MAINMUTEX_UNLOCK	{ if (threadsafe) mainmutex.Unlock(); }
+	#define WAITMUTEX_LOCK		{ if (threadsafe) waitmutex.Lock(); }
+	#define WAITMUTEX_UNLOCK	{ if (threadsafe) waitmutex.Unlock(); }
+#else
+	#define MAINMUTEX_LOCK
+	#define MAINMUTEX_UNLOCK
+	#define WAITMUTEX_LOCK
+	#define WAITMUTEX_UNLOCK
+#endif // RTP_SUPPORT_THREAD
+
+namespace jrtplib
+{
+
+// There's no wrapper for these system calls in the C library, and we don't
+// want to depend on liburing for this
+
+static inline int RTPIoUringSetup(unsigned int entries,struct io_uring_params *p)
+{
+	return (int)syscall(__NR_io_uring_setup,entries,p);
+}
+
+static inline int RTPIoUringEnter(int fd,unsigned int tosubmit,unsigned int mincomplete,unsigned int flags,const void *arg,size_t argsize)
+{
+	return (int)syscall(__NR_io_uring_enter,fd,tosubmit,mincomplete,flags,arg,argsize);
+}
+
+static inline int RTPIoUringRegister(int fd,unsigned int opcode,void *arg,unsigned int nrargs)
+{
+	return (int)syscall(__NR_io_uring_register,fd,opcode,arg,nrargs);
+}
+
+class RTPIoUringTransmitter::SendRequest
+{
+public:
+	struct msghdr msg;
+	struct iovec iov;
+	struct sockaddr_in addr;
+	size_t bufferindex;
+	bool rtp;
+};
+
+RTPIoUringTransmitter::RTPIoUringTransmitter(RTPMemoryManager *mgr) : RTPTransmitter(mgr)
+{
+	created = false;
+	init = false;
+	numsenderrors = 0;
+	bufferpool = 0;
+}
+
+RTPIoUringTransmitter::~RTPIoUringTransmitter()
+{
+	Destroy();
+}
+
+int RTPIoUringTransmitter::Init(bool tsafe)
+{
+	if (init)
+		return ERR_RTP_IOURINGTRANS_ALREADYINIT;
+	
+#ifdef RTP_SUPPORT_THREAD
+	threadsafe = tsafe;
+	if (threadsafe)
+	{
+		int status;
+		
+		status = mainmutex.Init();
+		if (status < 0)
+			return ERR_RTP_IOURINGTRANS_CANTINITMUTEX;
+		status = waitmutex.Init();
+		if (status < 0)
+			return ERR_RTP_IOURINGTRANS_CANTINITMUTEX;
+	}
+#else
+	if (tsafe)
+		return ERR_RTP_NOTHREADSUPPORT;
+#endif // RTP_SUPPORT_THREAD
+
+	init = true;
+	return 0;
+}
+
+int RTPIoUringTransmitter::Create(size_t maximumpacketsize,const RTPTransmissionParams *transparams)
+{
+	const RTPIoUringTransmissionParams *params,defaultparams;
+	int status;
+
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+
+	if (created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_ALREADYCREATED;
+	}
+	
+	// Obtain transmission parameters
+	
+	if (transparams == 0)
+		params = &defaultparams;
+	else
+	{
+		if (transparams->GetTransmissionProtocol() != RTPTransmitter::IoUringProto)
+		{
+			MAINMUTEX_UNLOCK
+			return ERR_RTP_IOURINGTRANS_ILLEGALPARAMETERS;
+		}
+		params = static_cast<const RTPIoUringTransmissionParams *>(transparams);
+	}
+
+	if (maximumpacketsize > RTPIOURINGTRANS_MAXPACKSIZE)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG;
+	}
+
+	size_t numrecv = params->GetNumberOfReceiveBuffers();
+
+	if (numrecv == 0 || numrecv > RTPIOURINGTRANS_MAXRECEIVEBUFFERS || (numrecv & (numrecv-1)) != 0 ||
+	    params->GetReceiveBufferSize() == 0 || params->GetReceiveBufferSize() > RTPIOURINGTRANS_MAXPACKSIZE ||
+	    params->GetQueueDepth() == 0 || params->GetNumberOfSendBuffers() == 0)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_ILLEGALBUFFERCOUNT;
+	}
+
+	// Make sure that everything can be cleaned up safely if something goes wrong
+
+	rtpsock = -1;
+	rtcpsock = -1;
+	ringfd = -1;
+	wakeupfd = -1;
+	sqring = MAP_FAILED;
+	cqring = MAP_FAILED;
+	sqes = (io_uring_sqe *)MAP_FAILED;
+	bufring = (io_uring_buf_ring *)MAP_FAILED;
+	recvbuffers = 0;
+	senddata = 0;
+	sendrequestblock = 0;
+	sendrequests = 0;
+	numsendbuffers = 0;
+	sendbuffersize = 0;
+	numsendrequests = 0;
+	rtprecvarmed = false;
+	rtcprecvarmed = false;
+	wakeuparmed = false;
+	wokenup = false;
+
+	if ((status = CreateSockets(params)) < 0)
+	{
+		MAINMUTEX_UNLOCK
+		return status;
+	}
+
+	if ((status = CreateRing(params)) < 0 ||
+	    (status = CreateReceiveBuffers(params)) < 0 ||
+	    (status = CreateSendBuffers(params->GetNumberOfSendBuffers(),maximumpacketsize)) < 0)
+	{
+		DestroyRing();
+		CloseSockets();
+		MAINMUTEX_UNLOCK
+		return status;
+	}
+
+	wakeupfd = eventfd(0,EFD_CLOEXEC);
+	if (wakeupfd < 0)
+	{
+		DestroyRing();
+		CloseSockets();
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_CANTCREATEWAKEUPDESCRIPTOR;
+	}
+
+	// Keep a multishot receive active on both sockets, and wait for the wakeup
+	// descriptor to be signalled
+
+	memset(&rtpmsghdr,0,sizeof(struct msghdr));
+	rtpmsghdr.msg_namelen = sizeof(struct sockaddr_in);
+	memset(&rtcpmsghdr,0,sizeof(struct msghdr));
+	rtcpmsghdr.msg_namelen = sizeof(struct sockaddr_in);
+
+	if ((status = ArmReceive(true)) < 0 || 
+	    (rtpsock != rtcpsock && (status = ArmReceive(false)) < 0) ||
+	    (status = ArmWakeup()) < 0 ||
+	    (status = SubmitEntries(false)) < 0)
+	{
+		DestroyRing();
+		CloseSockets();
+		MAINMUTEX_UNLOCK
+		return status;
+	}
+
+	// Try to obtain local IP addresses
+
+	localIPs = params->GetLocalIPList();
+	if (localIPs.empty()) // User did not provide list of local IP addresses, calculate them
+		CreateLocalIPList();
+
+	maxpacksize = maximumpacketsize;
+	localhostname = 0;
+	localhostnamelength = 0;
+	waitingfordata = false;
+	numsenderrors = 0;
+	created = true;
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+void RTPIoUringTransmitter::Destroy()
+{
+	if (!init)
+		return;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return;
+	}
+
+	created = false;
+	
+	if (waitingfordata)
+	{
+		uint64_t one = 1;
+
+		if (write(wakeupfd,&one,sizeof(uint64_t)) < 0) 
+		{
+			// Nothing we can do about this
+		}
+		MAINMUTEX_UNLOCK
+		WAITMUTEX_LOCK // to make sure that the WaitForIncomingData function ended
+		WAITMUTEX_UNLOCK
+		MAINMUTEX_LOCK
+	}
+
+	if (localhostname)
+	{
+		RTPDeleteByteArray(localhostname,GetMemoryManager());
+		localhostname = 0;
+		localhostnamelength = 0;
+	}
+
+	// The kernel may still be using our send buffers, make sure that all
+	// pending operations are finished before releasing them
+	WaitForAllSends();
+	DestroyRing();
+	CloseSockets();
+
+	destinations.clear();
+	FlushPackets();
+	senderrors.clear();
+	localIPs.clear();
+	if (bufferpool)
+	{
+		bufferpool->Release();
+		bufferpool = 0;
+	}
+
+	MAINMUTEX_UNLOCK
+}
+
+RTPTransmissionInfo *RTPIoUringTransmitter::GetTransmissionInfo()
+{
+	if (!init)
+		return 0;
+
+	MAINMUTEX_LOCK
+	RTPTransmissionInfo *tinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPTRANSMISSIONINFO) RTPIoUringTransmissionInfo(rtpsock,rtcpsock,m_rtpPort,m_rtcpPort);
+	MAINMUTEX_UNLOCK
+	return tinf;
+}
+
+void RTPIoUringTransmitter::DeleteTransmissionInfo(RTPTransmissionInfo *i)
+{
+	if (!init)
+		return;
+
+	RTPDelete(i, GetMemoryManager());
+}
+
+int RTPIoUringTransmitter::GetLocalHostName(uint8_t *buffer,size_t *bufferlength)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+
+	if (localhostname == 0)
+	{
+		char name[1024];
+
+		if (gethostname(name,1023) != 0 || name[0] == 0)
+		{
+			uint32_t ip = localIPs.empty()?((((uint32_t)127)<<24)|((uint32_t)1)):localIPs.front();
+
+			RTP_SNPRINTF(name,1024,"%d.%d.%d.%d",(int)((ip>>24)&0xFF),(int)((ip>>16)&0xFF),(int)((ip>>8)&0xFF),(int)(ip&0xFF));
+		}
+		name[1023] = 0;
+
+		localhostnamelength = strlen(name);
+		localhostname = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t [localhostnamelength+1];
+		if (localhostname == 0)
+		{
+			localhostnamelength = 0;
+			MAINMUTEX_UNLOCK
+			return ERR_RTP_OUTOFMEM;
+		}
+		memcpy(localhostname,name,localhostnamelength+1);
+	}
+	
+	if ((*bufferlength) < localhostnamelength)
+	{
+		*bufferlength = localhostnamelength; // tell the application the required size of the buffer
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_TRANS_BUFFERLENGTHTOOSMALL;
+	}
+
+	memcpy(buffer,localhostname,localhostnamelength);
+	*bufferlength = localhostnamelength;
+	
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+bool RTPIoUringTransmitter::ComesFromThisTransmitter(const RTPAddress *addr)
+{
+	if (!init)
+		return false;
+
+	if (addr == 0)
+		return false;
+	
+	MAINMUTEX_LOCK
+	
+	bool v = false;
+		
+	if (created && addr->GetAddressType() == RTPAddress::IPv4Address)
+	{	
+		const RTPIPv4Address *addr2 = (const RTPIPv4Address *)addr;
+
+		if (addr2->GetPort() == m_rtpPort || addr2->GetPort() == m_rtcpPort) // check for RTP port and RTCP port
+		{
+			std::list<uint32_t>::const_iterator it;
+
+			for (it = localIPs.begin() ; !v && it != localIPs.end() ; ++it)
+			{
+				if (addr2->GetIP() == *it)
+					v = true;
+			}
+		}
+	}
+
+	MAINMUTEX_UNLOCK
+	return v;
+}
+
+int RTPIoUringTransmitter::Poll()
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+
+	// The kernel has already received the packets, we only need to pick them up
+	int status = ProcessCompletions();
+	if (status >= 0)
+		status = SubmitEntries(false); // in case receive requests needed to be restarted
+	MAINMUTEX_UNLOCK
+	return status;
+}
+
+int RTPIoUringTransmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavailable)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+	
+	MAINMUTEX_LOCK
+	
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+	if (waitingfordata)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_ALREADYWAITING;
+	}
+
+	// First pick up everything that's already there, so that we'll only
+	// wake up for new events
+	int status = ProcessCompletions();
+	if (status >= 0)
+		status = SubmitEntries(false);
+	if (status < 0)
+	{
+		MAINMUTEX_UNLOCK
+		return status;
+	}
+	if (!rawpacketlist.empty())
+	{
+		if (dataavailable != 0)
+			*dataavailable = true;
+		MAINMUTEX_UNLOCK
+		return 0;
+	}
+	
+	RTPTime endtime = RTPTime::CurrentTime();
+	endtime += delay;
+	bool gotdata = false;
+	bool done = false;
+
+	waitingfordata = true;
+	wokenup = false;
+
+	WAITMUTEX_LOCK
+	MAINMUTEX_UNLOCK
+
+	while (!done)
+	{
+		RTPTime remaining = endtime;
+		remaining -= RTPTime::CurrentTime();
+
+		// Only completion events are waited for here, submitting requests or
+		// processing the completions is still done while holding the main mutex
+		status = (remaining.GetDouble() > 0)?WaitForCompletionEvent(remaining):0;
+
+		MAINMUTEX_LOCK
+		if (!created) // destroy called
+		{
+			waitingfordata = false;
+			MAINMUTEX_UNLOCK
+			WAITMUTEX_UNLOCK
+			return 0;
+		}
+
+		if (status >= 0)
+			status = ProcessCompletions();
+		if (status >= 0)
+			status = SubmitEntries(false);
+
+		if (status < 0)
+			done = true;
+		else if (!rawpacketlist.empty())
+		{
+			gotdata = true;
+			done = true;
+		}
+		else if (wokenup || remaining.GetDouble() <= 0)
+			done = true;
+
+		if (done)
+			waitingfordata = false;
+		MAINMUTEX_UNLOCK
+	}
+	
+	WAITMUTEX_UNLOCK
+
+	if (status < 0)
+		return status;
+	if (dataavailable != 0)
+		*dataavailable = gotdata;
+	return 0;
+}
+
+int RTPIoUringTransmitter::AbortWait()
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+	
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+	if (!waitingfordata)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTWAITING;
+	}
+
+	// This completes the read request on the eventfd, which causes the
+	// waiting thread to return from io_uring_enter
+	uint64_t one = 1;
+
+	if (write(wakeupfd,&one,sizeof(uint64_t)) < 0)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_CANTCREATEWAKEUPDESCRIPTOR;
+	}
+	
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+int RTPIoUringTransmitter::SendRTPData(const void *data,size_t len)	
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+	
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+	if (len > maxpacksize)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG;
+	}
+	
+	int status = QueueSend(true,data,len);
+	if (status >= 0)
+		status = SubmitEntries(false);
+	
+	MAINMUTEX_UNLOCK
+	return status;
+}
+
+int RTPIoUringTransmitter::SendRTCPData(const void *data,size_t len)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+	if (len > maxpacksize)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG;
+	}
+	
+	int status = QueueSend(false,data,len);
+	if (status >= 0)
+		status = SubmitEntries(false);
+
+	MAINMUTEX_UNLOCK
+	return status;
+}
+
+int RTPIoUringTransmitter::SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		if (lengths[i] > maxpacksize)
+		{
+			MAINMUTEX_UNLOCK
+			return ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG;
+		}
+	}
+
+	// All packets are queued first, and handed to the kernel at once (unless we
+	// run out of send buffers, in which case some need to be submitted earlier)
+	int status = 0;
+	for (size_t i = 0 ; status >= 0 && i < numpackets ; i++)
+		status = QueueSend(true,packets[i],lengths[i]);
+	if (status >= 0)
+		status = SubmitEntries(false);
+
+	MAINMUTEX_UNLOCK
+	return status;
+}
+
+int RTPIoUringTransmitter::AddDestination(const RTPAddress &addr)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+	
+	MAINMUTEX_LOCK
+
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+
+	RTPIPv4Destination dest;
+	if (!RTPIPv4Destination::AddressToDestination(addr, dest))
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_INVALIDADDRESSTYPE;
+	}
+
+	std::vector<RTPIPv4Destination>::const_iterator it;
+	for (it = destinations.begin() ; it != destinations.end() ; ++it)
+	{
+		if (*it == dest)
+		{
+			MAINMUTEX_UNLOCK
+			return ERR_RTP_IOURINGTRANS_DESTINATIONALREADYINLIST;
+		}
+	}
+	destinations.push_back(dest);
+
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+int RTPIoUringTransmitter::DeleteDestination(const RTPAddress &addr)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+	
+	MAINMUTEX_LOCK
+	
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+
+	RTPIPv4Destination dest;
+	if (!RTPIPv4Destination::AddressToDestination(addr, dest))
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_INVALIDADDRESSTYPE;
+	}
+
+	std::vector<RTPIPv4Destination>::iterator it;
+	for (it = destinations.begin() ; it != destinations.end() ; ++it)
+	{
+		if (*it == dest)
+		{
+			destinations.erase(it);
+			MAINMUTEX_UNLOCK
+			return 0;
+		}
+	}
+	
+	MAINMUTEX_UNLOCK
+	return ERR_RTP_IOURINGTRANS_NOSUCHENTRY;
+}
+
+void RTPIoUringTransmitter::ClearDestinations()
+{
+	if (!init)
+		return;
+	
+	MAINMUTEX_LOCK
+	if (created)
+		destinations.clear();
+	MAINMUTEX_UNLOCK
+}
+
+bool RTPIoUringTransmitter::SupportsMulticasting()
+{
+	return false;
+}
+
+int RTPIoUringTransmitter::JoinMulticastGroup(const RTPAddress &)
+{
+	return ERR_RTP_IOURINGTRANS_NOMULTICASTSUPPORT;
+}
+
+int RTPIoUringTransmitter::LeaveMulticastGroup(const RTPAddress &)
+{
+	return ERR_RTP_IOURINGTRANS_NOMULTICASTSUPPORT;
+}
+
+void RTPIoUringTransmitter::LeaveAllMulticastGroups()
+{
+}
+
+int RTPIoUringTransmitter::SetReceiveMode(RTPTransmitter::ReceiveMode m)
+{
+	if (m != RTPTransmitter::AcceptAll)
+		return ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED;
+	return 0;
+}
+
+int RTPIoUringTransmitter::AddToIgnoreList(const RTPAddress &)
+{
+	return ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED;
+}
+
+int RTPIoUringTransmitter::DeleteFromIgnoreList(const RTPAddress &)
+{
+	return ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED;
+}
+
+void RTPIoUringTransmitter::ClearIgnoreList()
+{
+}
+
+int RTPIoUringTransmitter::AddToAcceptList(const RTPAddress &)
+{
+	return ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED;
+}
+
+int RTPIoUringTransmitter::DeleteFromAcceptList(const RTPAddress &)
+{
+	return ERR_RTP_IOURINGTRANS_RECEIVEMODENOTSUPPORTED;
+}
+
+void RTPIoUringTransmitter::ClearAcceptList()
+{
+}
+
+int RTPIoUringTransmitter::SetMaximumPacketSize(size_t s)	
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+	
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+	if (s > RTPIOURINGTRANS_MAXPACKSIZE)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_SPECIFIEDSIZETOOBIG;
+	}
+
+	if (s > sendbuffersize)
+	{
+		// The send buffers are too small, they can only be replaced once
+		// the kernel doesn't need them anymore
+		WaitForAllSends();
+
+		int status = CreateSendBuffers(numsendbuffers,s);
+		if (status < 0)
+		{
+			MAINMUTEX_UNLOCK
+			return status;
+		}
+	}
+	maxpacksize = s;
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+bool RTPIoUringTransmitter::NewDataAvailable()
+{
+	if (!init)
+		return false;
+	
+	MAINMUTEX_LOCK
+	
+	bool v;
+		
+	if (!created)
+		v = false;
+	else
+	{
+		if (rawpacketlist.empty())
+			v = false;
+		else
+			v = true;
+	}
+	
+	MAINMUTEX_UNLOCK
+	return v;
+}
+
+RTPRawPacket *RTPIoUringTransmitter::GetNextPacket()
+{
+	if (!init)
+		return 0;
+	
+	MAINMUTEX_LOCK
+	
+	RTPRawPacket *p;
+	
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return 0;
+	}
+	if (rawpacketlist.empty())
+	{
+		MAINMUTEX_UNLOCK
+		return 0;
+	}
+
+	p = *(rawpacketlist.begin());
+	rawpacketlist.pop_front();
+
+	MAINMUTEX_UNLOCK
+	return p;
+}
+
+bool RTPIoUringTransmitter::GetNextSendError(RTPIPv4Address &addr,bool &rtp,int &errorcode)
+{
+	if (!init)
+		return false;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return false;
+	}
+
+	// Make sure the results of previous send operations are known
+	ProcessCompletions();
+	SubmitEntries(false);
+
+	if (senderrors.empty())
+	{
+		MAINMUTEX_UNLOCK
+		return false;
+	}
+
+	const SendErrorInfo &info = senderrors.front();
+	addr.SetIP(info.ip);
+	addr.SetPort(info.port);
+	rtp = info.rtp;
+	errorcode = info.errorcode;
+	senderrors.pop_front();
+
+	MAINMUTEX_UNLOCK
+	return true;
+}
+
+uint64_t RTPIoUringTransmitter::GetNumberOfSendErrors()
+{
+	if (!init)
+		return 0;
+
+	MAINMUTEX_LOCK
+	if (created)
+	{
+		ProcessCompletions();
+		SubmitEntries(false);
+	}
+	uint64_t num = numsenderrors;
+	MAINMUTEX_UNLOCK
+	return num;
+}
+
+int RTPIoUringTransmitter::SetReceiveBufferPool(RTPReceiveBufferPool *pool)
+{
+	if (!init)
+		return ERR_RTP_IOURINGTRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_IOURINGTRANS_NOTCREATED;
+	}
+	if (pool)
+		pool->AddReference();
+	if (bufferpool)
+		bufferpool->Release();
+	bufferpool = pool;
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+// Here the private functions start...
+
+int RTPIoUringTransmitter::CreateSockets(const RTPIoUringTransmissionParams *params)
+{
+	struct sockaddr_in addr;
+	int size;
+
+	if (!params->GetRTCPMultiplexing() && params->GetPortbase()%2 != 0)
+		return ERR_RTP_IOURINGTRANS_PORTBASENOTEVEN;
+
+	rtpsock = socket(PF_INET,SOCK_DGRAM|SOCK_CLOEXEC,0);
+	if (rtpsock == RTPSOCKERR)
+		return ERR_RTP_IOURINGTRANS_CANTCREATESOCKET;
+
+	// If we're multiplexing, we're just going to set the RTCP socket to equal the RTP socket
+	if (params->GetRTCPMultiplexing())
+		rtcpsock = rtpsock;
+	else
+	{
+		rtcpsock = socket(PF_INET,SOCK_DGRAM|SOCK_CLOEXEC,0);
+		if (rtcpsock == RTPSOCKERR)
+		{
+			CloseSockets();
+			return ERR_RTP_IOURINGTRANS_CANTCREATESOCKET;
+		}
+	}
+
+	m_rtpPort = params->GetPortbase();
+	m_rtcpPort = (rtpsock == rtcpsock)?m_rtpPort:(m_rtpPort+1);
+
+	memset(&addr,0,sizeof(struct sockaddr_in));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(m_rtpPort);
+	addr.sin_addr.s_addr = htonl(params->GetBindIP());
+	if (bind(rtpsock,(struct sockaddr *)&addr,sizeof(struct sockaddr_in)) != 0)
+	{
+		CloseSockets();
+		return ERR_RTP_IOURINGTRANS_CANTBINDRTPSOCKET;
+	}
+
+	if (rtpsock != rtcpsock) // no need to bind same socket twice when multiplexing
+	{
+		addr.sin_port = htons(m_rtcpPort);
+		if (bind(rtcpsock,(struct sockaddr *)&addr,sizeof(struct sockaddr_in)) != 0)
+		{
+			CloseSockets();
+			return ERR_RTP_IOURINGTRANS_CANTBINDRTCPSOCKET;
+		}
+	}
+
+	// set socket buffer sizes
+
+	size = params->GetRTPReceiveBuffer();
+	if (setsockopt(rtpsock,SOL_SOCKET,SO_RCVBUF,(const char *)&size,sizeof(int)) != 0)
+	{
+		CloseSockets();
+		return ERR_RTP_IOURINGTRANS_CANTSETSOCKETBUFFER;
+	}
+	size = params->GetRTPSendBuffer();
+	if (setsockopt(rtpsock,SOL_SOCKET,SO_SNDBUF,(const char *)&size,sizeof(int)) != 0)
+	{
+		CloseSockets();
+		return ERR_RTP_IOURINGTRANS_CANTSETSOCKETBUFFER;
+	}
+
+	if (rtpsock != rtcpsock) // no need to set RTCP flags when multiplexing
+	{
+		size = params->GetRTCPReceiveBuffer();
+		if (setsockopt(rtcpsock,SOL_SOCKET,SO_RCVBUF,(const char *)&size,sizeof(int)) != 0)
+		{
+			CloseSockets();
+			return ERR_RTP_IOURINGTRANS_CANTSETSOCKETBUFFER;
+		}
+		size = params->GetRTCPSendBuffer();
+		if (setsockopt(rtcpsock,SOL_SOCKET,SO_SNDBUF,(const char *)&size,sizeof(int)) != 0)
+		{
+			CloseSockets();
+			return ERR_RTP_IOURINGTRANS_CANTSETSOCKETBUFFER;
+		}
+	}
+	return 0;
+}
+
+void RTPIoUringTransmitter::CloseSockets()
+{
+	if (rtcpsock != rtpsock && rtcpsock != -1)
+		RTPCLOSE(rtcpsock);
+	if (rtpsock != -1)
+		RTPCLOSE(rtpsock);
+	rtpsock = -1;
+	rtcpsock = -1;
+}
+
+int RTPIoUringTransmitter::CreateRing(const RTPIoUringTransmissionParams *params)
+{
+	struct io_uring_params p;
+
+	// Each outstanding request produces at most one completion, except for the
+	// multishot receives which produce one for each receive buffer that's used;
+	// the completion queue is made large enough to hold all of these
+	size_t numcompletions = params->GetQueueDepth() + params->GetNumberOfReceiveBuffers() + 8;
+
+	memset(&p,0,sizeof(struct io_uring_params));
+	p.flags = IORING_SETUP_CQSIZE;
+	p.cq_entries = (unsigned int)numcompletions;
+	if (params->GetUseSubmissionPolling())
+	{
+		p.flags |= IORING_SETUP_SQPOLL;
+		p.sq_thread_idle = RTPIOURINGTRANS_SQPOLLIDLE;
+	}
+
+	ringfd = RTPIoUringSetup((unsigned int)params->GetQueueDepth(),&p);
+	if (ringfd < 0)
+		return ERR_RTP_IOURINGTRANS_CANTSETUPRING;
+
+	if (!(p.features & IORING_FEAT_EXT_ARG) || !(p.features & IORING_FEAT_NODROP))
+		return ERR_RTP_IOURINGTRANS_CANTSETUPRING;
+
+	sqringsize = p.sq_off.array + p.sq_entries*sizeof(unsigned int);
+	cqringsize = p.cq_off.cqes + p.cq_entries*sizeof(struct io_uring_cqe);
+	sqessize = p.sq_entries*sizeof(struct io_uring_sqe);
+
+	sqring = mmap(0,sqringsize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ringfd,IORING_OFF_SQ_RING);
+	if (sqring == MAP_FAILED)
+		return ERR_RTP_IOURINGTRANS_CANTSETUPRING;
+	cqring = mmap(0,cqringsize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ringfd,IORING_OFF_CQ_RING);
+	if (cqring == MAP_FAILED)
+		return ERR_RTP_IOURINGTRANS_CANTSETUPRING;
+	sqes = (io_uring_sqe *)mmap(0,sqessize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ringfd,IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+		return ERR_RTP_IOURINGTRANS_CANTSETUPRING;
+
+	uint8_t *sq = (uint8_t *)sqring;
+	uint8_t *cq = (uint8_t *)cqring;
+
+	sqhead = (unsigned int *)(sq + p.sq_off.head);
+	sqtail = (unsigned int *)(sq + p.sq_off.tail);
+	sqmask = (unsigned int *)(sq + p.sq_off.ring_mask);
+	sqflags = (unsigned int *)(sq + p.sq_off.flags);
+	sqarray = (unsigned int *)(sq + p.sq_off.array);
+	cqhead = (unsigned int *)(cq + p.cq_off.head);
+	cqtail = (unsigned int *)(cq + p.cq_off.tail);
+	cqmask = (unsigned int *)(cq + p.cq_off.ring_mask);
+	cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+	sqentries = p.sq_entries;
+	sqlocaltail = *sqtail;
+	sqpoll = params->GetUseSubmissionPolling();
+	return 0;
+}
+
+int RTPIoUringTransmitter::CreateReceiveBuffers(const RTPIoUringTransmissionParams *params)
+{
+	numrecvbuffers = params->GetNumberOfReceiveBuffers();
+
+	// The kernel stores the header which describes the message and the sender's
+	// address in front of the packet data itself
+	recvbufferstride = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in) + params->GetReceiveBufferSize();
+	recvbufferstride = (recvbufferstride+15)&~((size_t)15);
+
+	bufringsize = numrecvbuffers*sizeof(struct io_uring_buf);
+	bufring = (io_uring_buf_ring *)mmap(0,bufringsize,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+	if (bufring == MAP_FAILED)
+		return ERR_RTP_OUTOFMEM;
+
+	recvbuffers = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t[numrecvbuffers*recvbufferstride];
+	if (recvbuffers == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	struct io_uring_buf_reg reg;
+
+	memset(&reg,0,sizeof(struct io_uring_buf_reg));
+	reg.ring_addr = (uint64_t)(uintptr_t)bufring;
+	reg.ring_entries = (uint32_t)numrecvbuffers;
+	reg.bgid = RTPIOURINGTRANS_BUFFERGROUP;
+	if (RTPIoUringRegister(ringfd,IORING_REGISTER_PBUF_RING,&reg,1) < 0)
+		return ERR_RTP_IOURINGTRANS_CANTREGISTERBUFFERS;
+
+	bufringtail = 0;
+	for (size_t i = 0 ; i < numrecvbuffers ; i++)
+		RecycleReceiveBuffer((uint16_t)i);
+	__atomic_store_n(&bufring->tail,bufringtail,__ATOMIC_RELEASE);
+	return 0;
+}
+
+int RTPIoUringTransmitter::CreateSendBuffers(size_t num,size_t size)
+{
+	uint8_t *newdata = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t[num*size];
+	if (newdata == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	if (senddata)
+		RTPDeleteByteArray(senddata,GetMemoryManager());
+	senddata = newdata;
+	numsendbuffers = num;
+	sendbuffersize = size;
+	sendbufferrefs.assign(num,0);
+	freesendbuffers.clear();
+	for (size_t i = 0 ; i < num ; i++)
+		freesendbuffers.push_back(num-1-i);
+
+	if (sendrequestblock == 0)
+	{
+		// We'll never have more send requests outstanding than fit in the submission queue
+		numsendrequests = sqentries;
+		sendrequestblock = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t[numsendrequests*sizeof(SendRequest)];
+		if (sendrequestblock == 0)
+			return ERR_RTP_OUTOFMEM;
+		sendrequests = (SendRequest *)sendrequestblock;
+		freesendrequests.clear();
+		for (size_t i = 0 ; i < numsendrequests ; i++)
+			freesendrequests.push_back(numsendrequests-1-i);
+	}
+	return 0;
+}
+
+void RTPIoUringTransmitter::DestroyRing()
+{
+	// Closing the ring also cancels all pending requests
+	if (ringfd != -1)
+		close(ringfd);
+	if (wakeupfd != -1)
+		close(wakeupfd);
+	if (sqes != MAP_FAILED)
+		munmap(sqes,sqessize);
+	if (cqring != MAP_FAILED)
+		munmap(cqring,cqringsize);
+	if (sqring != MAP_FAILED)
+		munmap(sqring,sqringsize);
+	if (bufring != MAP_FAILED)
+		munmap(bufring,bufringsize);
+	if (recvbuffers)
+		RTPDeleteByteArray(recvbuffers,GetMemoryManager());
+	if (senddata)
+		RTPDeleteByteArray(senddata,GetMemoryManager());
+	if (sendrequestblock)
+		RTPDeleteByteArray(sendrequestblock,GetMemoryManager());
+
+	ringfd = -1;
+	wakeupfd = -1;
+	sqes = (io_uring_sqe *)MAP_FAILED;
+	cqring = MAP_FAILED;
+	sqring = MAP_FAILED;
+	bufring = (io_uring_buf_ring *)MAP_FAILED;
+	recvbuffers = 0;
+	senddata = 0;
+	sendrequestblock = 0;
+	sendrequests = 0;
+	sendbufferrefs.clear();
+	freesendbuffers.clear();
+	freesendrequests.clear();
+}
+
+void RTPIoUringTransmitter::FlushPackets()
+{
+	std::list<RTPRawPacket*>::const_iterator it;
+
+	for (it = rawpacketlist.begin() ; it != rawpacketlist.end() ; ++it)
+		RTPDelete(*it,GetMemoryManager());
+	rawpacketlist.clear();
+}
+
+void RTPIoUringTransmitter::CreateLocalIPList()
+{
+#ifdef RTP_SUPPORT_IFADDRS
+	struct ifaddrs *addrs,*tmp;
+	
+	if (getifaddrs(&addrs) == 0)
+	{
+		for (tmp = addrs ; tmp != 0 ; tmp = tmp->ifa_next)
+		{
+			if (tmp->ifa_addr != 0 && tmp->ifa_addr->sa_family == AF_INET)
+			{
+				struct sockaddr_in *inaddr = (struct sockaddr_in *)tmp->ifa_addr;
+				localIPs.push_back(ntohl(inaddr->sin_addr.s_addr));
+			}
+		}
+		freeifaddrs(addrs);
+	}
+#endif // RTP_SUPPORT_IFADDRS
+
+	uint32_t loopbackaddr = (((uint32_t)127)<<24)|((uint32_t)1);
+	std::list<uint32_t>::const_iterator it;
+	bool found = false;
+	
+	for (it = localIPs.begin() ; !found && it != localIPs.end() ; it++)
+	{
+		if (*it == loopbackaddr)
+			found = true;
+	}
+
+	if (!found)
+		localIPs.push_back(loopbackaddr);
+}
+
+io_uring_sqe *RTPIoUringTransmitter::GetSubmissionEntry()
+{
+	unsigned int head = __atomic_load_n(sqhead,__ATOMIC_ACQUIRE);
+
+	if (sqlocaltail - head >= sqentries)
+	{
+		// The queue is full, let the kernel pick up the entries first
+		if (SubmitEntries(false) < 0)
+			return 0;
+		if (sqpoll)
+		{
+			if (RTPIoUringEnter(ringfd,0,0,IORING_ENTER_SQ_WAIT,0,0) < 0)
+				return 0;
+		}
+		head = __atomic_load_n(sqhead,__ATOMIC_ACQUIRE);
+		if (sqlocaltail - head >= sqentries)
+			return 0;
+	}
+
+	unsigned int idx = sqlocaltail & (*sqmask);
+	io_uring_sqe *sqe = &sqes[idx];
+
+	memset(sqe,0,sizeof(struct io_uring_sqe));
+	sqarray[idx] = idx;
+	sqlocaltail++;
+	return sqe;
+}
+
+int RTPIoUringTransmitter::SubmitEntries(bool waitforcompletion)
+{
+	// Make the new entries visible to the kernel
+	__atomic_store_n(sqtail,sqlocaltail,__ATOMIC_RELEASE);
+
+	unsigned int flags = 0;
+	unsigned int tosubmit = 0;
+	unsigned int mincomplete = 0;
+
+	if (sqpoll)
+	{
+		// The kernel thread picks up the entries by itself, a system call is
+		// only needed if it went to sleep
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(sqflags,__ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)
+			flags |= IORING_ENTER_SQ_WAKEUP;
+	}
+	else
+		tosubmit = sqlocaltail - __atomic_load_n(sqhead,__ATOMIC_ACQUIRE);
+
+	if (waitforcompletion)
+	{
+		flags |= IORING_ENTER_GETEVENTS;
+		mincomplete = 1;
+	}
+
+	if (tosubmit == 0 && flags == 0)
+		return 0;
+
+	for (int attempt = 0 ; ; attempt++)
+	{
+		if (RTPIoUringEnter(ringfd,tosubmit,mincomplete,flags,0,0) >= 0)
+			return 0;
+
+		int errcode = errno;
+
+		if (errcode == EINTR)
+			continue;
+		if ((errcode == EBUSY || errcode == EAGAIN) && attempt < 2)
+		{
+			// Too many completions are waiting to be processed
+			ProcessCompletions();
+			if (!sqpoll)
+				tosubmit = sqlocaltail - __atomic_load_n(sqhead,__ATOMIC_ACQUIRE);
+			continue;
+		}
+		return ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+	}
+}
+
+int RTPIoUringTransmitter::WaitForCompletionEvent(const RTPTime &delay)
+{
+	struct __kernel_timespec ts;
+	struct io_uring_getevents_arg arg;
+
+	ts.tv_sec = delay.GetSeconds();
+	ts.tv_nsec = (long long)delay.GetMicroSeconds()*1000;
+	memset(&arg,0,sizeof(struct io_uring_getevents_arg));
+	arg.ts = (uint64_t)(uintptr_t)&ts;
+
+	if (RTPIoUringEnter(ringfd,0,1,IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG,&arg,sizeof(struct io_uring_getevents_arg)) < 0)
+	{
+		int errcode = errno;
+
+		if (errcode != ETIME && errcode != EINTR && errcode != EBUSY)
+			return ERR_RTP_IOURINGTRANS_ERRORINWAIT;
+	}
+	return 0;
+}
+
+int RTPIoUringTransmitter::ArmReceive(bool rtp)
+{
+	io_uring_sqe *sqe = GetSubmissionEntry();
+	if (sqe == 0)
+		return ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+
+	sqe->opcode = IORING_OP_RECVMSG;
+	sqe->fd = (rtp)?rtpsock:rtcpsock;
+	sqe->addr = (uint64_t)(uintptr_t)((rtp)?&rtpmsghdr:&rtcpmsghdr);
+	sqe->len = 1;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = RTPIOURINGTRANS_BUFFERGROUP;
+	sqe->user_data = (rtp)?RTPIOURINGTRANS_REQ_RTPRECV:RTPIOURINGTRANS_REQ_RTCPRECV;
+
+	if (rtp)
+		rtprecvarmed = true;
+	else
+		rtcprecvarmed = true;
+	return 0;
+}
+
+int RTPIoUringTransmitter::ArmWakeup()
+{
+	io_uring_sqe *sqe = GetSubmissionEntry();
+	if (sqe == 0)
+		return ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = wakeupfd;
+	sqe->addr = (uint64_t)(uintptr_t)&wakeupvalue;
+	sqe->len = sizeof(uint64_t);
+	sqe->user_data = RTPIOURINGTRANS_REQ_WAKEUP;
+	wakeuparmed = true;
+	return 0;
+}
+
+void RTPIoUringTransmitter::RecycleReceiveBuffer(uint16_t bufid)
+{
+	// Only the address, length and id may be set, the first entry shares
+	// its memory with the tail of the ring. The entries are not accessed using
+	// the 'bufs' member, since in C++ the way it's declared places it at the
+	// wrong offset.
+	struct io_uring_buf *buf = ((struct io_uring_buf *)bufring) + (bufringtail & (numrecvbuffers-1));
+
+	buf->addr = (uint64_t)(uintptr_t)(recvbuffers + (size_t)bufid*recvbufferstride);
+	buf->len = (uint32_t)recvbufferstride;
+	buf->bid = bufid;
+	bufringtail++;
+}
+
+int RTPIoUringTransmitter::ProcessCompletions()
+{
+	unsigned int head = *cqhead;
+	unsigned int tail = __atomic_load_n(cqtail,__ATOMIC_ACQUIRE);
+	unsigned int mask = *cqmask;
+	uint16_t prevbufringtail = bufringtail;
+	RTPTime receivetime(0,0);
+	bool gottime = false;
+	int status = 0;
+
+	while (head != tail)
+	{
+		const io_uring_cqe *cqe = &cqes[head & mask];
+		uint64_t type = cqe->user_data & RTPIOURINGTRANS_REQ_TYPEMASK;
+
+		switch (type)
+		{
+		case RTPIOURINGTRANS_REQ_RTPRECV:
+		case RTPIOURINGTRANS_REQ_RTCPRECV:
+			if (!gottime)
+			{
+				receivetime = RTPTime::CurrentTime();
+				gottime = true;
+			}
+			if (status >= 0)
+				status = ProcessReceiveCompletion(type == RTPIOURINGTRANS_REQ_RTPRECV,cqe,receivetime);
+			else
+				ProcessReceiveCompletion(type == RTPIOURINGTRANS_REQ_RTPRECV,cqe,receivetime);
+			break;
+		case RTPIOURINGTRANS_REQ_WAKEUP:
+			wokenup = true;
+			wakeuparmed = false;
+			break;
+		case RTPIOURINGTRANS_REQ_SEND:
+			ProcessSendCompletion((size_t)(cqe->user_data >> RTPIOURINGTRANS_REQ_TYPEBITS),cqe->res);
+			break;
+		default:
+			break;
+		}
+		head++;
+		tail = (head == tail)?__atomic_load_n(cqtail,__ATOMIC_ACQUIRE):tail;
+	}
+	__atomic_store_n(cqhead,head,__ATOMIC_RELEASE);
+
+	if (bufringtail != prevbufringtail)
+		__atomic_store_n(&bufring->tail,bufringtail,__ATOMIC_RELEASE);
+
+	// A multishot request ends when something goes wrong, for example when we
+	// ran out of receive buffers; restart the ones that are no longer active
+	if (!rtprecvarmed && ArmReceive(true) < 0)
+		return ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+	if (rtpsock != rtcpsock && !rtcprecvarmed && ArmReceive(false) < 0)
+		return ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+	if (!wakeuparmed && ArmWakeup() < 0)
+		return ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+	return status;
+}
+
+int RTPIoUringTransmitter::ProcessReceiveCompletion(bool rtp,const io_uring_cqe *cqe,RTPTime &receivetime)
+{
+	if (!(cqe->flags & IORING_CQE_F_MORE))
+	{
+		if (rtp)
+			rtprecvarmed = false;
+		else
+			rtcprecvarmed = false;
+	}
+
+	if (cqe->res < 0 || !(cqe->flags & IORING_CQE_F_BUFFER))
+		return 0;
+
+	uint16_t bufid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+	uint8_t *buf = recvbuffers + (size_t)bufid*recvbufferstride;
+	const struct io_uring_recvmsg_out *out = (const struct io_uring_recvmsg_out *)buf;
+	const struct sockaddr_in *srcaddr = (const struct sockaddr_in *)(buf + sizeof(struct io_uring_recvmsg_out));
+	const uint8_t *data = buf + sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in);
+	size_t datalen = out->payloadlen;
+	int status = 0;
+
+	// Packets that didn't fit in the buffer are discarded
+	if (!(out->flags & MSG_TRUNC) && out->namelen >= sizeof(struct sockaddr_in) && datalen > 0)
+	{
+		RTPRawPacket *pack;
+		RTPIPv4Address addr(ntohl(srcaddr->sin_addr.s_addr),ntohs(srcaddr->sin_port));
+		uint8_t *datacopy;
+
+		datacopy = AllocateDataCopy(rtp,datalen);
+		if (datacopy == 0)
+			status = ERR_RTP_OUTOFMEM;
+		else
+		{
+			memcpy(datacopy,data,datalen);
+
+			bool isrtp = rtp;
+			if (rtpsock == rtcpsock) // check payload type when multiplexing
+			{
+				isrtp = true;
+
+				if (datalen > sizeof(RTCPCommonHeader))
+				{
+					RTCPCommonHeader *rtcpheader = (RTCPCommonHeader *)datacopy;
+					uint8_t packettype = rtcpheader->packettype;
+
+					if (packettype >= 200 && packettype <= 204)
+						isrtp = false;
+				}
+			}
+
+			// The address is stored inside the raw packet instance
+			pack = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPRAWPACKET) RTPRawPacket(datacopy,datalen,addr,receivetime,isrtp,GetMemoryManager());
+			if (pack == 0)
+			{
+				ReleaseDataCopy(datacopy);
+				status = ERR_RTP_OUTOFMEM;
+			}
+			else
+			{
+				pack->SetBufferPool(bufferpool);
+				pack->SetDataHeadroom(RTPPacket::GetEmbeddedSize());
+				rawpacketlist.push_back(pack);
+			}
+		}
+	}
+
+	// The data has been copied, so the kernel can use the buffer again
+	RecycleReceiveBuffer(bufid);
+	return status;
+}
+
+uint8_t *RTPIoUringTransmitter::AllocateDataCopy(bool rtp,size_t len)
+{
+	// Room is reserved in front of the data, so that the RTPPacket instance
+	// can be stored in the same memory block
+	size_t headroom = RTPPacket::GetEmbeddedSize();
+	uint8_t *block;
+
+	if (bufferpool)
+		block = bufferpool->GetBuffer(headroom+len,rtp);
+	else
+		block = RTPNew(GetMemoryManager(),(rtp)?RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET:RTPMEM_TYPE_BUFFER_RECEIVEDRTCPPACKET) uint8_t[headroom+len];
+	if (block == 0)
+		return 0;
+	return block+headroom;
+}
+
+void RTPIoUringTransmitter::ReleaseDataCopy(uint8_t *data)
+{
+	uint8_t *block = data-RTPPacket::GetEmbeddedSize();
+
+	if (bufferpool)
+		bufferpool->ReleaseBuffer(block);
+	else
+		RTPDeleteByteArray(block,GetMemoryManager());
+}
+
+void RTPIoUringTransmitter::ProcessSendCompletion(size_t reqidx,int result)
+{
+	if (reqidx >= numsendrequests)
+		return;
+
+	SendRequest &req = sendrequests[reqidx];
+
+	if (result < 0)
+	{
+		numsenderrors++;
+		if (senderrors.size() < RTPIOURINGTRANS_MAXSENDERRORS)
+			senderrors.push_back(SendErrorInfo(ntohl(req.addr.sin_addr.s_addr),ntohs(req.addr.sin_port),req.rtp,-result));
+	}
+
+	if (--sendbufferrefs[req.bufferindex] == 0)
+		freesendbuffers.push_back(req.bufferindex);
+	freesendrequests.push_back(reqidx);
+}
+
+int RTPIoUringTransmitter::QueueSend(bool rtp,const void *data,size_t len)
+{
+	if (destinations.empty())
+		return 0;
+
+	int status;
+
+	while (freesendbuffers.empty())
+	{
+		if ((status = WaitForSendResources()) < 0)
+			return status;
+	}
+
+	size_t bufidx = freesendbuffers.back();
+	uint8_t *buf = senddata + bufidx*sendbuffersize;
+
+	freesendbuffers.pop_back();
+	memcpy(buf,data,len);
+
+	// We hold a reference ourselves while the requests are being queued, otherwise
+	// the buffer could be released if we have to wait for requests to finish
+	sendbufferrefs[bufidx] = 1;
+	status = 0;
+
+	std::vector<RTPIPv4Destination>::const_iterator it;
+	for (it = destinations.begin() ; status >= 0 && it != destinations.end() ; ++it)
+	{
+		while (status >= 0 && freesendrequests.empty())
+			status = WaitForSendResources();
+		if (status < 0)
+			break;
+
+		io_uring_sqe *sqe = GetSubmissionEntry();
+		if (sqe == 0)
+		{
+			status = ERR_RTP_IOURINGTRANS_CANTSUBMIT;
+			break;
+		}
+
+		size_t reqidx = freesendrequests.back();
+		SendRequest &req = sendrequests[reqidx];
+
+		freesendrequests.pop_back();
+		req.addr = *((rtp)?(*it).GetRTPSockAddr():(*it).GetRTCPSockAddr());
+		req.iov.iov_base = buf;
+		req.iov.iov_len = len;
+		memset(&req.msg,0,sizeof(struct msghdr));
+		req.msg.msg_name = &req.addr;
+		req.msg.msg_namelen = sizeof(struct sockaddr_in);
+		req.msg.msg_iov = &req.iov;
+		req.msg.msg_iovlen = 1;
+		req.bufferindex = bufidx;
+		req.rtp = rtp;
+		sendbufferrefs[bufidx]++;
+
+		sqe->opcode = IORING_OP_SENDMSG;
+		sqe->fd = (rtp)?rtpsock:rtcpsock;
+		sqe->addr = (uint64_t)(uintptr_t)&req.msg;
+		sqe->len = 1;
+		sqe->user_data = (((uint64_t)reqidx) << RTPIOURINGTRANS_REQ_TYPEBITS) | RTPIOURINGTRANS_REQ_SEND;
+	}
+
+	if (--sendbufferrefs[bufidx] == 0)
+		freesendbuffers.push_back(bufidx);
+	return status;
+}
+
+int RTPIoUringTransmitter::WaitForSendResources()
+{
+	// Hand what we have to the kernel and wait for something to finish
+	int status = SubmitEntries(true);
+	if (status < 0)
+		return status;
+	return ProcessCompletions();
+}
+
+void RTPIoUringTransmitter::WaitForAllSends()
+{
+	while (freesendrequests.size() < numsendrequests)
+	{
+		if (WaitForSendResources() < 0)
+			break;
+	}
+}
+
+#ifdef RTPDEBUG
+void RTPIoUringTransmitter::Dump()
+{
+	if (!init)
+		std::cout << "Not initialized" << std::endl;
+	else
+	{
+		MAINMUTEX_LOCK
+	
+		if (!created)
+			std::cout << "Not created" << std::endl;
+		else
+		{
+			std::cout << "Portbase:                       " << m_rtpPort << std::endl;
+			std::cout << "RTP socket descriptor:          " << rtpsock << std::endl;
+			std::cout << "RTCP socket descriptor:         " << rtcpsock << std::endl;
+			std::cout << "io_uring descriptor:            " << ringfd << std::endl;
+			std::cout << "Submission queue entries:       " << sqentries << std::endl;
+			std::cout << "Receive buffers:                " << numrecvbuffers << std::endl;
+			std::cout << "Send buffers:                   " << numsendbuffers << std::endl;
+			std::cout << "Number of destinations:         " << destinations.size() << std::endl;
+			std::cout << "Number of packets in queue:     " << rawpacketlist.size() << std::endl;
+			std::cout << "Number of send errors:          " << numsenderrors << std::endl;
+		}
+		MAINMUTEX_UNLOCK
+	}
+}
+#endif // RTPDEBUG
+
+} // end namespace
+
+#endif // RTP_SUPPORT_IOURING
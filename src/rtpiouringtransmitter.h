@@ -0,0 +1,404 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpiouringtransmitter.h
+ */
+
+#ifndef RTPIOURINGTRANSMITTER_H
+
+#define RTPIOURINGTRANSMITTER_H
+
+#include "rtpconfig.h"
+
+#ifdef RTP_SUPPORT_IOURING
+
+#include "rtptransmitter.h"
+#include "rtpipv4destination.h"
+#include "rtpsocketutil.h"
+#include "rtpreceivebufferpool.h"
+#include <list>
+#include <vector>
+
+#ifdef RTP_SUPPORT_THREAD
+	#include <jthread/jmutex.h>
+#endif // RTP_SUPPORT_THREAD
+
+#define RTPIOURINGTRANS_HEADERSIZE						(20+8)
+#define RTPIOURINGTRANS_DEFAULTPORTBASE					5000
+#define RTPIOURINGTRANS_RTPRECEIVEBUFFER				32768
+#define RTPIOURINGTRANS_RTCPRECEIVEBUFFER				32768
+#define RTPIOURINGTRANS_RTPTRANSMITBUFFER				32768
+#define RTPIOURINGTRANS_RTCPTRANSMITBUFFER				32768
+#define RTPIOURINGTRANS_DEFAULTQUEUEDEPTH				256
+#define RTPIOURINGTRANS_DEFAULTNUMRECEIVEBUFFERS		256
+#define RTPIOURINGTRANS_DEFAULTRECEIVEBUFFERSIZE		2048
+#define RTPIOURINGTRANS_DEFAULTNUMSENDBUFFERS			64
+#define RTPIOURINGTRANS_MAXSENDERRORS					256
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace jrtplib
+{
+
+class RTPIPv4Address;
+
+/** Parameters for the io_uring based UDP over IPv4 transmitter. */
+class JRTPLIB_IMPORTEXPORT RTPIoUringTransmissionParams : public RTPTransmissionParams
+{
+public:
+	RTPIoUringTransmissionParams();
+
+	/** Sets the IP address which is used to bind the sockets to \c ip. */
+	void SetBindIP(uint32_t ip)									{ bindIP = ip; }
+
+	/** Sets the RTP portbase to \c pbase, which has to be an even number. */
+	void SetPortbase(uint16_t pbase)							{ portbase = pbase; }
+
+	/** Enables or disables multiplexing RTCP traffic over the RTP channel, so that only a single port is used. */
+	void SetRTCPMultiplexing(bool f)							{ rtcpmux = f; }
+
+	/** Passes a list of IP addresses which will be used as the local IP addresses. */
+	void SetLocalIPList(std::list<uint32_t> &iplist)			{ localIPs = iplist; } 
+
+	/** Clears the list of local IP addresses. 
+	 *  Clears the list of local IP addresses. An empty list will make the transmission 
+	 *  component itself determine the local IP addresses.
+	 */
+	void ClearLocalIPList()										{ localIPs.clear(); }
+
+	/** Sets the RTP socket's send buffer size. */
+	void SetRTPSendBuffer(int s)								{ rtpsendbuf = s; }
+
+	/** Sets the RTP socket's receive buffer size. */
+	void SetRTPReceiveBuffer(int s)								{ rtprecvbuf = s; }
+
+	/** Sets the RTCP socket's send buffer size. */
+	void SetRTCPSendBuffer(int s)								{ rtcpsendbuf = s; }
+
+	/** Sets the RTCP socket's receive buffer size. */
+	void SetRTCPReceiveBuffer(int s)							{ rtcprecvbuf = s; }
+
+	/** Sets the number of entries in the submission queue of the io_uring instance. */
+	void SetQueueDepth(size_t n)								{ queuedepth = n; }
+
+	/** Sets the number of buffers the kernel can use to store incoming packets in; this
+	 *  must be a power of two. */
+	void SetNumberOfReceiveBuffers(size_t n)					{ numrecvbuffers = n; }
+
+	/** Sets the size of each receive buffer, i.e. the maximum size of an incoming packet;
+	 *  larger packets are discarded. */
+	void SetReceiveBufferSize(size_t s)							{ recvbuffersize = s; }
+
+	/** Sets the number of outgoing packets that can be in flight at the same time. */
+	void SetNumberOfSendBuffers(size_t n)						{ numsendbuffers = n; }
+
+	/** If set to \c true, a kernel thread polls the submission queue, so that sending a
+	 *  packet doesn't require a system call at all (IORING_SETUP_SQPOLL). */
+	void SetUseSubmissionPolling(bool f)						{ sqpoll = f; }
+
+	/** Returns the IP address which will be used to bind the sockets. */
+	uint32_t GetBindIP() const									{ return bindIP; }
+
+	/** Returns the RTP portbase which will be used (default is 5000). */
+	uint16_t GetPortbase() const								{ return portbase; }
+
+	/** Returns a flag indicating if RTCP traffic will be multiplexed over the RTP channel. */
+	bool GetRTCPMultiplexing() const							{ return rtcpmux; }
+
+	/** Returns the list of local IP addresses. */
+	const std::list<uint32_t> &GetLocalIPList() const			{ return localIPs; }
+
+	/** Returns the RTP socket's send buffer size. */
+	int GetRTPSendBuffer() const								{ return rtpsendbuf; }
+
+	/** Returns the RTP socket's receive buffer size. */
+	int GetRTPReceiveBuffer() const								{ return rtprecvbuf; }
+
+	/** Returns the RTCP socket's send buffer size. */
+	int GetRTCPSendBuffer() const								{ return rtcpsendbuf; }
+
+	/** Returns the RTCP socket's receive buffer size. */
+	int GetRTCPReceiveBuffer() const							{ return rtcprecvbuf; }
+
+	/** Returns the number of submission queue entries (default is 256). */
+	size_t GetQueueDepth() const								{ return queuedepth; }
+
+	/** Returns the number of receive buffers (default is 256). */
+	size_t GetNumberOfReceiveBuffers() const					{ return numrecvbuffers; }
+
+	/** Returns the size of each receive buffer (default is 2048). */
+	size_t GetReceiveBufferSize() const							{ return recvbuffersize; }
+
+	/** Returns the number of outgoing packets that can be in flight (default is 64). */
+	size_t GetNumberOfSendBuffers() const						{ return numsendbuffers; }
+
+	/** Returns \c true if the submission queue will be polled by a kernel thread (default is \c false). */
+	bool GetUseSubmissionPolling() const						{ return sqpoll; }
+private:
+	uint16_t portbase;
+	uint32_t bindIP;
+	int rtpsendbuf, rtprecvbuf;
+	int rtcpsendbuf, rtcprecvbuf;
+	bool rtcpmux;
+	std::list<uint32_t> localIPs;
+	size_t queuedepth;
+	size_t numrecvbuffers, recvbuffersize;
+	size_t numsendbuffers;
+	bool sqpoll;
+};
+
+inline RTPIoUringTransmissionParams::RTPIoUringTransmissionParams() : RTPTransmissionParams(RTPTransmitter::IoUringProto)
+{
+	portbase = RTPIOURINGTRANS_DEFAULTPORTBASE;
+	bindIP = 0;
+	rtpsendbuf = RTPIOURINGTRANS_RTPTRANSMITBUFFER;
+	rtprecvbuf = RTPIOURINGTRANS_RTPRECEIVEBUFFER;
+	rtcpsendbuf = RTPIOURINGTRANS_RTCPTRANSMITBUFFER;
+	rtcprecvbuf = RTPIOURINGTRANS_RTCPRECEIVEBUFFER;
+	rtcpmux = false;
+	queuedepth = RTPIOURINGTRANS_DEFAULTQUEUEDEPTH;
+	numrecvbuffers = RTPIOURINGTRANS_DEFAULTNUMRECEIVEBUFFERS;
+	recvbuffersize = RTPIOURINGTRANS_DEFAULTRECEIVEBUFFERSIZE;
+	numsendbuffers = RTPIOURINGTRANS_DEFAULTNUMSENDBUFFERS;
+	sqpoll = false;
+}
+
+/** Additional information about the io_uring based transmitter. */
+class JRTPLIB_IMPORTEXPORT RTPIoUringTransmissionInfo : public RTPTransmissionInfo
+{
+public:
+	RTPIoUringTransmissionInfo(SocketType rtpsock,SocketType rtcpsock,uint16_t rtpport,uint16_t rtcpport) 
+		: RTPTransmissionInfo(RTPTransmitter::IoUringProto)	{ rtpsocket = rtpsock; rtcpsocket = rtcpsock; m_rtpPort = rtpport; m_rtcpPort = rtcpport; }
+
+	~RTPIoUringTransmissionInfo()							{ }
+
+	/** Returns the socket descriptor used for receiving and transmitting RTP packets. */
+	SocketType GetRTPSocket() const							{ return rtpsocket; }
+
+	/** Returns the socket descriptor used for receiving and transmitting RTCP packets. */
+	SocketType GetRTCPSocket() const						{ return rtcpsocket; }
+
+	/** Returns the port number that the RTP socket receives packets on. */
+	uint16_t GetRTPPort() const								{ return m_rtpPort; }
+
+	/** Returns the port number that the RTCP socket receives packets on. */
+	uint16_t GetRTCPPort() const							{ return m_rtcpPort; }
+private:
+	SocketType rtpsocket,rtcpsocket;
+	uint16_t m_rtpPort, m_rtcpPort;
+};
+
+/** An UDP over IPv4 transmission component based on Linux' io_uring interface.
+ *  This class inherits the RTPTransmitter interface and implements a transmission component
+ *  which uses UDP over IPv4 to send and receive RTP and RTCP data, like RTPUDPv4Transmitter
+ *  does. Instead of reading each packet using a separate system call, a multishot \c recvmsg
+ *  operation is kept active on both sockets, and the kernel stores the incoming packets in
+ *  buffers that are registered up front. Outgoing packets are copied into a send buffer and
+ *  queued as submission entries, one for each destination; all of these are handed to the
+ *  kernel with a single system call, or without any system call if submission polling is
+ *  enabled. Waiting for incoming data is done by waiting for completions, and RTPTransmitter::AbortWait
+ *  wakes up the waiting thread through an \c eventfd that is monitored by the ring itself.
+ *
+ *  The component's parameters are described by the class RTPIoUringTransmissionParams. The
+ *  functions which have an RTPAddress argument require an argument of RTPIPv4Address.
+ *  The RTPTransmitter::GetTransmissionInfo member function returns an instance of type
+ *  RTPIoUringTransmissionInfo. Multicasting and the accept and ignore lists are not supported.
+ *  A kernel of at least version 6.0 is required.
+ */
+class JRTPLIB_IMPORTEXPORT RTPIoUringTransmitter : public RTPTransmitter
+{
+	JRTPLIB_NO_COPY(RTPIoUringTransmitter)
+public:
+	RTPIoUringTransmitter(RTPMemoryManager *mgr);
+	~RTPIoUringTransmitter();
+
+	int Init(bool treadsafe);
+	int Create(size_t maxpacksize,const RTPTransmissionParams *transparams);
+	void Destroy();
+	RTPTransmissionInfo *GetTransmissionInfo();
+	void DeleteTransmissionInfo(RTPTransmissionInfo *inf);
+
+	int GetLocalHostName(uint8_t *buffer,size_t *bufferlength);
+	bool ComesFromThisTransmitter(const RTPAddress *addr);
+	size_t GetHeaderOverhead()							{ return RTPIOURINGTRANS_HEADERSIZE; }
+	
+	int Poll();
+	int WaitForIncomingData(const RTPTime &delay,bool *dataavailable = 0);
+	int AbortWait();
+	
+	int SendRTPData(const void *data,size_t len);	
+	int SendRTCPData(const void *data,size_t len);
+	int SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets);
+
+	int AddDestination(const RTPAddress &addr);
+	int DeleteDestination(const RTPAddress &addr);
+	void ClearDestinations();
+
+	bool SupportsMulticasting();
+	int JoinMulticastGroup(const RTPAddress &addr);
+	int LeaveMulticastGroup(const RTPAddress &addr);
+	void LeaveAllMulticastGroups();
+
+	int SetReceiveMode(RTPTransmitter::ReceiveMode m);
+	int AddToIgnoreList(const RTPAddress &addr);
+	int DeleteFromIgnoreList(const RTPAddress &addr);
+	void ClearIgnoreList();
+	int AddToAcceptList(const RTPAddress &addr);
+	int DeleteFromAcceptList(const RTPAddress &addr);
+	void ClearAcceptList();
+	int SetMaximumPacketSize(size_t s);	
+	
+	bool NewDataAvailable();
+	RTPRawPacket *GetNextPacket();
+
+	/** When a packet could not be sent to one of the destinations, this is recorded
+	 *  (at most RTPIOURINGTRANS_MAXSENDERRORS entries are kept). This function retrieves and
+	 *  removes the oldest entry: \c addr is set to the destination, \c rtp indicates if it was
+	 *  an RTP or RTCP packet and \c errorcode is the error reported by the system.
+	 *  Returns \c false if no such entry is available. */
+	bool GetNextSendError(RTPIPv4Address &addr,bool &rtp,int &errorcode);
+
+	/** Returns the total number of times sending a packet to a destination failed. */
+	uint64_t GetNumberOfSendErrors();
+
+	/** The packets in the receive buffers of the ring are copied into buffers from \c pool
+	 *  instead of newly allocated memory. Specify null to stop using a pool. */
+	int SetReceiveBufferPool(RTPReceiveBufferPool *pool);
+#ifdef RTPDEBUG
+	void Dump();
+#endif // RTPDEBUG
+private:
+	class SendRequest;
+
+	int CreateSockets(const RTPIoUringTransmissionParams *params);
+	int CreateRing(const RTPIoUringTransmissionParams *params);
+	int CreateReceiveBuffers(const RTPIoUringTransmissionParams *params);
+	int CreateSendBuffers(size_t num,size_t size);
+	void DestroyRing();
+	void CloseSockets();
+	void FlushPackets();
+	void CreateLocalIPList();
+
+	io_uring_sqe *GetSubmissionEntry();
+	int SubmitEntries(bool waitforcompletion);
+	int WaitForCompletionEvent(const RTPTime &delay);
+	int ArmReceive(bool rtp);
+	int ArmWakeup();
+	void RecycleReceiveBuffer(uint16_t bufid);
+	int ProcessCompletions();
+	int ProcessReceiveCompletion(bool rtp,const io_uring_cqe *cqe,RTPTime &receivetime);
+	uint8_t *AllocateDataCopy(bool rtp,size_t len);
+	void ReleaseDataCopy(uint8_t *data);
+	void ProcessSendCompletion(size_t reqidx,int result);
+	int QueueSend(bool rtp,const void *data,size_t len);
+	int WaitForSendResources();
+	void WaitForAllSends();
+
+	bool init;
+	bool created;
+	bool waitingfordata;
+	SocketType rtpsock,rtcpsock;
+	uint16_t m_rtpPort, m_rtcpPort;
+	std::list<uint32_t> localIPs;
+	uint8_t *localhostname;
+	size_t localhostnamelength;
+	size_t maxpacksize;
+
+	std::vector<RTPIPv4Destination> destinations;
+	std::list<RTPRawPacket*> rawpacketlist;
+
+	// The io_uring instance and the parts of it that are shared with the kernel
+	int ringfd;
+	bool sqpoll;
+	void *sqring, *cqring;
+	size_t sqringsize, cqringsize;
+	io_uring_sqe *sqes;
+	size_t sqessize;
+	unsigned int *sqhead, *sqtail, *sqmask, *sqflags, *sqarray;
+	unsigned int *cqhead, *cqtail, *cqmask;
+	io_uring_cqe *cqes;
+	unsigned int sqentries;
+	unsigned int sqlocaltail;
+	struct msghdr rtpmsghdr, rtcpmsghdr;
+	bool rtprecvarmed, rtcprecvarmed;
+
+	// Waking up a thread that's waiting for completions
+	int wakeupfd;
+	uint64_t wakeupvalue;
+	bool wakeuparmed, wokenup;
+
+	// Buffers the kernel stores incoming packets in
+	io_uring_buf_ring *bufring;
+	size_t bufringsize;
+	uint8_t *recvbuffers;
+	size_t numrecvbuffers, recvbufferstride;
+	uint16_t bufringtail;
+
+	// Copies of outgoing packets, which need to stay valid until they've been sent
+	uint8_t *senddata;
+	size_t numsendbuffers, sendbuffersize;
+	std::vector<size_t> sendbufferrefs, freesendbuffers;
+	uint8_t *sendrequestblock;
+	SendRequest *sendrequests;
+	size_t numsendrequests;
+	std::vector<size_t> freesendrequests;
+
+	class SendErrorInfo
+	{
+	public:
+		SendErrorInfo(uint32_t ip,uint16_t port,bool rtp,int errorcode) : ip(ip), port(port), rtp(rtp), errorcode(errorcode) { }
+
+		uint32_t ip;
+		uint16_t port;
+		bool rtp;
+		int errorcode;
+	};
+
+	std::list<SendErrorInfo> senderrors;
+	uint64_t numsenderrors;
+
+	RTPReceiveBufferPool *bufferpool;
+
+#ifdef RTP_SUPPORT_THREAD
+	jthread::JMutex mainmutex,waitmutex;
+	bool threadsafe;
+#endif // RTP_SUPPORT_THREAD
+};
+
+} // end namespace
+
+#endif // RTP_SUPPORT_IOURING
+
+#endif // RTPIOURINGTRANSMITTER_H
@@ -41,6 +41,7 @@
 #include "rtpconfig.h"
 #include "rtpaddress.h"
 #include "rtptypes.h"
+#include <new>
 
 namespace jrtplib
 {
@@ -132,6 +133,7 @@ public:
 	uint16_t GetRTCPSendPort() const																{ return rtcpsendport; }
 
 	RTPAddress *CreateCopy(RTPMemoryManager *mgr) const;
+	RTPAddress *CreateCopyAt(void *buffer, size_t buffersize) const											{ if (buffersize < sizeof(RTPIPv4Address)) return 0; return new (buffer) RTPIPv4Address(ip,port); }
 
 	// Note that these functions are only used for received packets, and for those
 	// the rtcpsendport variable is not important and should be ignored.
@@ -44,6 +44,7 @@
 
 #include "rtpaddress.h"
 #include "rtptypes.h"
+#include <new>
 #ifdef RTP_SUPPORT_NETINET_IN
 	#include <netinet/in.h>
 #endif // RTP_SUPPORT_NETINET_IN
@@ -92,6 +93,7 @@ public:
 	uint16_t GetPort() const																				{ return port; }
 
 	RTPAddress *CreateCopy(RTPMemoryManager *mgr) const;
+	RTPAddress *CreateCopyAt(void *buffer, size_t buffersize) const											{ if (buffersize < sizeof(RTPIPv6Address)) return 0; return new (buffer) RTPIPv6Address(ip,port); }
 	bool IsSameAddress(const RTPAddress *addr) const;
 	bool IsFromSameHost(const RTPAddress *addr) const;
 #ifdef RTPDEBUG
@@ -143,6 +143,27 @@
 /** Buffer that's used when encrypting a packet. */
 #define RTPMEM_TYPE_BUFFER_SRTPDATA								33
 
+/** Buffer to store an RTPReceiveBufferPool instance. */
+#define RTPMEM_TYPE_CLASS_RECEIVEBUFFERPOOL						34
+
+/** Buffer to store an RTPUDPDestinationSnapshot instance. */
+#define RTPMEM_TYPE_CLASS_DESTINATIONSNAPSHOT						35
+
+/** Buffer to store the bitmap of an RTPPortSet instance. */
+#define RTPMEM_TYPE_BUFFER_PORTSETBITMAP							36
+
+/** Buffer to store the information about a session that's served by an RTPReactor. */
+#define RTPMEM_TYPE_CLASS_REACTORSESSION							37
+
+/** Buffer to store a worker thread of an RTPReactor. */
+#define RTPMEM_TYPE_CLASS_REACTORTHREAD							38
+
+/** Buffer to store the ring of an RTPPacketQueue instance. */
+#define RTPMEM_TYPE_BUFFER_PACKETQUEUE							39
+
+/** Buffer to store the slots of an RTPSequenceRing instance. */
+#define RTPMEM_TYPE_BUFFER_SEQUENCERING							40
+
 namespace jrtplib
 {
 
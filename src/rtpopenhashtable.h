@@ -0,0 +1,101 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpopenhashtable.h
+ */
+
+#ifndef RTPOPENHASHTABLE_H
+
+#define RTPOPENHASHTABLE_H
+
+#include "rtpconfig.h"
+#include "rtperrors.h"
+#include "rtpopenkeyhashtable.h"
+
+namespace jrtplib
+{
+
+/** A hash table which stores a set of elements of type \c Element.
+ *  This is the counterpart of RTPHashTable, using the same storage as RTPOpenKeyHashTable:
+ *  the elements themselves are used as keys. The class \c GetHash must have a static member 
+ *  function \c GetHash which returns a 32-bit hash value for an element.
+ */
+template<class Element,class GetHash>
+class RTPOpenHashTable
+{
+	JRTPLIB_NO_COPY(RTPOpenHashTable)
+public:
+	RTPOpenHashTable(RTPMemoryManager *mgr = 0, int memtype = RTPMEM_TYPE_OTHER) : table(mgr,memtype) { }
+	~RTPOpenHashTable()					{ }
+
+	void GotoFirstElement()					{ table.GotoFirstElement(); }
+	void GotoLastElement()					{ table.GotoLastElement(); }
+	bool HasCurrentElement()				{ return table.HasCurrentElement(); }
+	int DeleteCurrentElement()				{ return (table.DeleteCurrentElement() < 0)?ERR_RTP_HASHTABLE_NOCURRENTELEMENT:0; }
+	Element &GetCurrentElement()				{ return table.GetCurrentKey(); }
+	int GotoElement(const Element &e)			{ return (table.GotoElement(e) < 0)?ERR_RTP_HASHTABLE_ELEMENTNOTFOUND:0; }
+	bool HasElement(const Element &e)			{ return table.HasElement(e); }
+	void GotoNextElement()					{ table.GotoNextElement(); }
+	void GotoPreviousElement()				{ table.GotoPreviousElement(); }
+	void Clear()						{ table.Clear(); }
+
+	int AddElement(const Element &elem);
+	int DeleteElement(const Element &elem)			{ return (table.DeleteElement(elem) < 0)?ERR_RTP_HASHTABLE_ELEMENTNOTFOUND:0; }
+
+	/** Returns the number of elements in the table. */
+	size_t GetNumberOfElements() const			{ return table.GetNumberOfElements(); }
+
+	/** Returns the number of bytes that are currently allocated for the table. */
+	size_t GetAllocatedSize() const				{ return table.GetAllocatedSize(); }
+private:
+	class NoValue
+	{
+	};
+
+	RTPOpenKeyHashTable<Element,NoValue,GetHash> table;
+};
+
+template<class Element,class GetHash>
+inline int RTPOpenHashTable<Element,GetHash>::AddElement(const Element &elem)
+{
+	int status = table.AddElement(elem,NoValue());
+
+	if (status == ERR_RTP_KEYHASHTABLE_KEYALREADYEXISTS)
+		return ERR_RTP_HASHTABLE_ELEMENTALREADYEXISTS;
+	return status;
+}
+
+} // end namespace
+
+#endif // RTPOPENHASHTABLE_H
+
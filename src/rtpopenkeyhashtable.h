@@ -0,0 +1,464 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpopenkeyhashtable.h
+ */
+
+#ifndef RTPOPENKEYHASHTABLE_H
+
+#define RTPOPENKEYHASHTABLE_H
+
+#include "rtpconfig.h"
+#include "rtperrors.h"
+#include "rtpmemoryobject.h"
+#include "rtptypes.h"
+#include <new>
+
+#ifdef RTPDEBUG
+#include <iostream>
+#endif // RTPDEBUG
+
+// Number of index slots that's allocated when the first element is added
+#define RTPOPENKEYHASHTABLE_MINSLOTS							16
+#define RTPOPENKEYHASHTABLE_NONODE							0xFFFFFFFF
+
+namespace jrtplib
+{
+
+/** A hash table which maps keys of type \c Key to elements of type \c Element.
+ *  This table offers the same interface as RTPKeyHashTable, but instead of a fixed array of
+ *  buckets with a separately allocated entry for each element, it stores the elements in one 
+ *  contiguous array and uses an open addressing (linear probing) index into that array. Both 
+ *  arrays start out empty and are doubled in size when needed, so small tables only use little 
+ *  memory. The elements are kept in a doubly linked list in the order in which they were added,
+ *  which is used by the GotoFirstElement, GotoNextElement, ... functions; deleting the current
+ *  element moves to the next one, as before.
+ *
+ *  The class \c GetHash must have a static member function \c GetHash which returns a 32-bit 
+ *  hash value for a key. Note that references to keys and elements are only valid until the 
+ *  next call to AddElement or DeleteElement, since these may move the elements around.
+ */
+template<class Key,class Element,class GetHash>
+class RTPOpenKeyHashTable : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPOpenKeyHashTable)
+public:
+	RTPOpenKeyHashTable(RTPMemoryManager *mgr = 0,int memtype = RTPMEM_TYPE_OTHER);
+	~RTPOpenKeyHashTable()					{ Clear(); }
+
+	void GotoFirstElement()					{ curnode = firstnode; }
+	void GotoLastElement()					{ curnode = lastnode; }
+	bool HasCurrentElement()				{ return (curnode == RTPOPENKEYHASHTABLE_NONODE)?false:true; }
+	int DeleteCurrentElement();
+	Element &GetCurrentElement()				{ return nodes[curnode].element; }
+	Key &GetCurrentKey()					{ return nodes[curnode].key; }
+	int GotoElement(const Key &k);
+	bool HasElement(const Key &k);
+
+	/** Returns a pointer to the element stored for key \c k, or null if there is none; unlike
+	 *  GotoElement, this does not change the current element. */
+	Element *FindElement(const Key &k);
+	void GotoNextElement();
+	void GotoPreviousElement();
+	void Clear();
+
+	int AddElement(const Key &k,const Element &elem);
+	int DeleteElement(const Key &k);
+
+	/** Returns the number of elements in the table. */
+	size_t GetNumberOfElements() const			{ return (size_t)numnodes; }
+
+	/** Returns the number of bytes that are currently allocated for the table. */
+	size_t GetAllocatedSize() const				{ return (size_t)nodecapacity*sizeof(Node) + (size_t)numslots*sizeof(uint32_t); }
+
+#ifdef RTPDEBUG
+	void Dump();
+#endif // RTPDEBUG
+private:
+	class Node
+	{
+	public:
+		Node(const Key &k,const Element &e,uint32_t h):hash(h),listprev(RTPOPENKEYHASHTABLE_NONODE),listnext(RTPOPENKEYHASHTABLE_NONODE),key(k),element(e) { }
+		Node(const Node &n):hash(n.hash),listprev(n.listprev),listnext(n.listnext),key(n.key),element(n.element) { }
+
+		uint32_t hash;
+		uint32_t listprev,listnext;
+		Key key;
+		Element element;
+	private:
+		Node &operator=(const Node &);
+	};
+
+	uint32_t GetHomeSlot(uint32_t hash) const		{ return (hash*0x9E3779B1U) >> slotshift; } // Fibonacci hashing
+	uint32_t FindSlot(const Key &k,uint32_t hash) const;
+	uint32_t FindSlotOfNode(uint32_t n) const;
+	void InsertInIndex(uint32_t n);
+	void RemoveFromIndex(uint32_t slot);
+	int Grow();
+
+	Node *nodes;
+	uint32_t *slots; // index of the node plus one, zero for an empty slot
+	uint32_t numslots,slotmask,slotshift;
+	uint32_t nodecapacity,numnodes;
+	uint32_t firstnode,lastnode,curnode;
+#ifdef RTP_SUPPORT_MEMORYMANAGEMENT
+	int memorytype;
+#endif // RTP_SUPPORT_MEMORYMANAGEMENT
+};
+
+template<class Key,class Element,class GetHash>
+inline RTPOpenKeyHashTable<Key,Element,GetHash>::RTPOpenKeyHashTable(RTPMemoryManager *mgr,int memtype) : RTPMemoryObject(mgr)
+{
+	JRTPLIB_UNUSED(memtype); // possibly unused
+
+	nodes = 0;
+	slots = 0;
+	numslots = 0;
+	slotmask = 0;
+	slotshift = 32;
+	nodecapacity = 0;
+	numnodes = 0;
+	firstnode = RTPOPENKEYHASHTABLE_NONODE;
+	lastnode = RTPOPENKEYHASHTABLE_NONODE;
+	curnode = RTPOPENKEYHASHTABLE_NONODE;
+#ifdef RTP_SUPPORT_MEMORYMANAGEMENT
+	memorytype = memtype;
+#endif // RTP_SUPPORT_MEMORYMANAGEMENT
+}
+
+template<class Key,class Element,class GetHash>
+inline uint32_t RTPOpenKeyHashTable<Key,Element,GetHash>::FindSlot(const Key &k,uint32_t hash) const
+{
+	if (numnodes == 0)
+		return RTPOPENKEYHASHTABLE_NONODE;
+
+	// The index is never completely filled, so this ends at an empty slot
+	uint32_t i = GetHomeSlot(hash);
+	while (slots[i] != 0)
+	{
+		const Node &n = nodes[slots[i]-1];
+
+		if (n.hash == hash && n.key == k)
+			return i;
+		i = (i+1)&slotmask;
+	}
+	return RTPOPENKEYHASHTABLE_NONODE;
+}
+
+template<class Key,class Element,class GetHash>
+inline uint32_t RTPOpenKeyHashTable<Key,Element,GetHash>::FindSlotOfNode(uint32_t n) const
+{
+	uint32_t i = GetHomeSlot(nodes[n].hash);
+
+	while (slots[i] != n+1)
+		i = (i+1)&slotmask;
+	return i;
+}
+
+template<class Key,class Element,class GetHash>
+inline void RTPOpenKeyHashTable<Key,Element,GetHash>::InsertInIndex(uint32_t n)
+{
+	uint32_t i = GetHomeSlot(nodes[n].hash);
+
+	while (slots[i] != 0)
+		i = (i+1)&slotmask;
+	slots[i] = n+1;
+}
+
+template<class Key,class Element,class GetHash>
+inline void RTPOpenKeyHashTable<Key,Element,GetHash>::RemoveFromIndex(uint32_t slot)
+{
+	// Shift later entries of the same run back, so that no lookup passes an 
+	// empty slot before reaching its entry; no tombstones are needed this way
+	uint32_t i = slot;
+
+	for (;;)
+	{
+		uint32_t j = i;
+
+		slots[i] = 0;
+		for (;;)
+		{
+			j = (j+1)&slotmask;
+			if (slots[j] == 0)
+				return;
+
+			uint32_t home = GetHomeSlot(nodes[slots[j]-1].hash);
+
+			// The entry can be moved to 'i' unless its home slot lies cyclically in (i,j]
+			if (i <= j)
+			{
+				if (home <= i || home > j)
+					break;
+			}
+			else
+			{
+				if (home <= i && home > j)
+					break;
+			}
+		}
+		slots[i] = slots[j];
+		i = j;
+	}
+}
+
+template<class Key,class Element,class GetHash>
+inline int RTPOpenKeyHashTable<Key,Element,GetHash>::Grow()
+{
+	uint32_t newnumslots = (numslots == 0)?RTPOPENKEYHASHTABLE_MINSLOTS:numslots*2;
+	uint32_t newnodecapacity = newnumslots/2 + newnumslots/4; // load factor of at most 3/4
+	uint32_t newslotshift = 32;
+
+	for (uint32_t s = newnumslots ; s > 1 ; s >>= 1)
+		newslotshift--;
+
+	uint8_t *nodebuf = RTPNew(GetMemoryManager(),memorytype) uint8_t[(size_t)newnodecapacity*sizeof(Node)];
+	if (nodebuf == 0)
+		return ERR_RTP_OUTOFMEM;
+	uint8_t *slotbuf = RTPNew(GetMemoryManager(),memorytype) uint8_t[(size_t)newnumslots*sizeof(uint32_t)];
+	if (slotbuf == 0)
+	{
+		RTPDeleteByteArray(nodebuf,GetMemoryManager());
+		return ERR_RTP_OUTOFMEM;
+	}
+
+	// The nodes keep their positions, so the list links and the cursor stay valid
+	Node *newnodes = (Node *)nodebuf;
+	for (uint32_t n = 0 ; n < numnodes ; n++)
+	{
+		new (&newnodes[n]) Node(nodes[n]);
+		nodes[n].~Node();
+	}
+	if (nodes)
+		RTPDeleteByteArray((uint8_t *)nodes,GetMemoryManager());
+	if (slots)
+		RTPDeleteByteArray((uint8_t *)slots,GetMemoryManager());
+
+	nodes = newnodes;
+	nodecapacity = newnodecapacity;
+	slots = (uint32_t *)slotbuf;
+	numslots = newnumslots;
+	slotmask = newnumslots-1;
+	slotshift = newslotshift;
+
+	for (uint32_t i = 0 ; i < numslots ; i++)
+		slots[i] = 0;
+	for (uint32_t n = 0 ; n < numnodes ; n++)
+		InsertInIndex(n);
+	return 0;
+}
+
+template<class Key,class Element,class GetHash>
+inline int RTPOpenKeyHashTable<Key,Element,GetHash>::DeleteCurrentElement()
+{
+	if (curnode == RTPOPENKEYHASHTABLE_NONODE)
+		return ERR_RTP_KEYHASHTABLE_NOCURRENTELEMENT;
+
+	uint32_t n = curnode;
+	uint32_t prev = nodes[n].listprev;
+	uint32_t next = nodes[n].listnext;
+
+	// Relink the elements in the list
+
+	if (prev == RTPOPENKEYHASHTABLE_NONODE)
+		firstnode = next;
+	else
+		nodes[prev].listnext = next;
+	if (next == RTPOPENKEYHASHTABLE_NONODE)
+		lastnode = prev;
+	else
+		nodes[next].listprev = prev;
+
+	RemoveFromIndex(FindSlotOfNode(n));
+	nodes[n].~Node();
+	curnode = next; // Set to next element in list
+
+	// Keep the nodes contiguous by moving the last one into the hole
+
+	uint32_t last = numnodes-1;
+
+	if (n != last)
+	{
+		slots[FindSlotOfNode(last)] = n+1;
+		new (&nodes[n]) Node(nodes[last]);
+		nodes[last].~Node();
+
+		prev = nodes[n].listprev;
+		next = nodes[n].listnext;
+		if (prev == RTPOPENKEYHASHTABLE_NONODE)
+			firstnode = n;
+		else
+			nodes[prev].listnext = n;
+		if (next == RTPOPENKEYHASHTABLE_NONODE)
+			lastnode = n;
+		else
+			nodes[next].listprev = n;
+		if (curnode == last)
+			curnode = n;
+	}
+	numnodes--;
+	return 0;
+}
+	
+template<class Key,class Element,class GetHash>
+inline int RTPOpenKeyHashTable<Key,Element,GetHash>::GotoElement(const Key &k)
+{
+	uint32_t slot = FindSlot(k,GetHash::GetHash(k));
+
+	if (slot == RTPOPENKEYHASHTABLE_NONODE)
+	{
+		curnode = RTPOPENKEYHASHTABLE_NONODE;
+		return ERR_RTP_KEYHASHTABLE_KEYNOTFOUND;
+	}
+	curnode = slots[slot]-1;
+	return 0;
+}
+
+template<class Key,class Element,class GetHash>
+inline bool RTPOpenKeyHashTable<Key,Element,GetHash>::HasElement(const Key &k)
+{
+	return (FindSlot(k,GetHash::GetHash(k)) == RTPOPENKEYHASHTABLE_NONODE)?false:true;
+}
+
+template<class Key,class Element,class GetHash>
+inline Element *RTPOpenKeyHashTable<Key,Element,GetHash>::FindElement(const Key &k)
+{
+	uint32_t slot = FindSlot(k,GetHash::GetHash(k));
+
+	if (slot == RTPOPENKEYHASHTABLE_NONODE)
+		return 0;
+	return &nodes[slots[slot]-1].element;
+}
+
+template<class Key,class Element,class GetHash>
+inline void RTPOpenKeyHashTable<Key,Element,GetHash>::GotoNextElement()
+{
+	if (curnode != RTPOPENKEYHASHTABLE_NONODE)
+		curnode = nodes[curnode].listnext;
+}
+
+template<class Key,class Element,class GetHash>
+inline void RTPOpenKeyHashTable<Key,Element,GetHash>::GotoPreviousElement()
+{
+	if (curnode != RTPOPENKEYHASHTABLE_NONODE)
+		curnode = nodes[curnode].listprev;
+}
+
+template<class Key,class Element,class GetHash>
+inline void RTPOpenKeyHashTable<Key,Element,GetHash>::Clear()
+{
+	for (uint32_t n = 0 ; n < numnodes ; n++)
+		nodes[n].~Node();
+	if (nodes)
+		RTPDeleteByteArray((uint8_t *)nodes,GetMemoryManager());
+	if (slots)
+		RTPDeleteByteArray((uint8_t *)slots,GetMemoryManager());
+
+	nodes = 0;
+	slots = 0;
+	numslots = 0;
+	slotmask = 0;
+	slotshift = 32;
+	nodecapacity = 0;
+	numnodes = 0;
+	firstnode = RTPOPENKEYHASHTABLE_NONODE;
+	lastnode = RTPOPENKEYHASHTABLE_NONODE;
+	curnode = RTPOPENKEYHASHTABLE_NONODE;
+}
+
+template<class Key,class Element,class GetHash>
+inline int RTPOpenKeyHashTable<Key,Element,GetHash>::AddElement(const Key &k,const Element &elem)
+{
+	uint32_t hash = GetHash::GetHash(k);
+	int status;
+
+	if (FindSlot(k,hash) != RTPOPENKEYHASHTABLE_NONODE)
+		return ERR_RTP_KEYHASHTABLE_KEYALREADYEXISTS;
+	
+	if (numnodes == nodecapacity)
+	{
+		if ((status = Grow()) < 0)
+			return status;
+	}
+
+	// Okay, the key doesn't exist, so we can add the new element at the end
+	
+	uint32_t n = numnodes;
+
+	new (&nodes[n]) Node(k,elem,hash);
+	numnodes++;
+	InsertInIndex(n);
+
+	if (firstnode == RTPOPENKEYHASHTABLE_NONODE)
+		firstnode = n;
+	else
+	{
+		nodes[lastnode].listnext = n;
+		nodes[n].listprev = lastnode;
+	}
+	lastnode = n;
+	return 0;
+}
+
+template<class Key,class Element,class GetHash>
+inline int RTPOpenKeyHashTable<Key,Element,GetHash>::DeleteElement(const Key &k)
+{
+	int status;
+
+	status = GotoElement(k);
+	if (status < 0)
+		return status;
+	return DeleteCurrentElement();
+}
+
+#ifdef RTPDEBUG
+template<class Key,class Element,class GetHash>
+inline void RTPOpenKeyHashTable<Key,Element,GetHash>::Dump()
+{
+	std::cout << "DUMPING INDEX CONTENTS:" << std::endl;
+	for (uint32_t i = 0 ; i < numslots ; i++)
+	{
+		if (slots[i] != 0)
+			std::cout << "\tSlot " << i << " | Key " << nodes[slots[i]-1].key << " | Element " << nodes[slots[i]-1].element << std::endl;
+	}
+	
+	std::cout << "DUMPING LIST CONTENTS:" << std::endl;
+	for (uint32_t n = firstnode ; n != RTPOPENKEYHASHTABLE_NONODE ; n = nodes[n].listnext)
+		std::cout << "\tKey " << nodes[n].key << " | Element " << nodes[n].element << std::endl;
+}
+#endif // RTPDEBUG
+
+} // end namespace
+
+#endif // RTPOPENKEYHASHTABLE_H
+
@@ -35,6 +35,7 @@
 #include "rtpdefines.h"
 #include "rtperrors.h"
 #include "rtprawpacket.h"
+#include "rtpreceivebufferpool.h"
 #ifdef RTP_SUPPORT_NETINET_IN
 	#include <netinet/in.h>
 #endif // RTP_SUPPORT_NETINET_IN
@@ -67,6 +68,9 @@ void RTPPacket::Clear()
 	extensionlength = 0;
 	error = 0;
 	externalbuffer = false;
+	bufferpool = 0;
+	headroom = 0;
+	embedded = false;
 }
 
 RTPPacket::RTPPacket(RTPRawPacket &rawpack,RTPMemoryManager *mgr) : RTPMemoryObject(mgr),receivetime(rawpack.GetReceiveTime())
@@ -100,6 +104,55 @@ RTPPacket::RTPPacket(uint8_t payloadtype,const void *payloaddata,size_t payloadl
 		                    csrcs,gotextension,extensionid,extensionlen_numwords,extensiondata,buffer,buffersize);
 }
 
+RTPPacket::~RTPPacket()
+{
+	// If this instance is stored in the same memory block as the data,
+	// the block is released by RTPPacket::Delete
+	if (packet && !externalbuffer && !embedded)
+	{
+		if (bufferpool)
+			bufferpool->ReleaseBuffer(packet-headroom);
+		else
+			RTPDeleteByteArray((packet-headroom),GetMemoryManager());
+	}
+}
+
+RTPPacket *RTPPacket::Create(RTPRawPacket &rawpack,RTPMemoryManager *mgr)
+{
+	if (rawpack.GetData() == 0 || rawpack.GetDataHeadroom() < GetEmbeddedSize())
+		return RTPNew(mgr,RTPMEM_TYPE_CLASS_RTPPACKET) RTPPacket(rawpack,mgr);
+
+	// The instance is placed at the start of the memory block, so if the
+	// data is taken over, the block is released when the instance is deleted
+	RTPPacket *p = CreateAt(rawpack.GetData()-rawpack.GetDataHeadroom(),rawpack,mgr);
+	p->embedded = true;
+	return p;
+}
+
+void RTPPacket::Delete(RTPPacket *p,RTPMemoryManager *mgr)
+{
+	JRTPLIB_UNUSED(mgr); // possibly unused
+
+	if (!p->embedded)
+	{
+		RTPDelete(p,mgr);
+		return;
+	}
+
+	// If parsing failed, the memory still belongs to the raw packet
+	uint8_t *block = (p->packet)?(uint8_t *)p:0;
+	RTPReceiveBufferPool *pool = p->bufferpool;
+
+	p->~RTPPacket();
+	if (block)
+	{
+		if (pool)
+			pool->ReleaseBuffer(block);
+		else
+			RTPDeleteByteArray(block,mgr);
+	}
+}
+
 int RTPPacket::ParseRawPacket(RTPRawPacket &rawpack)
 {
 	uint8_t *packetbytes;
@@ -197,6 +250,8 @@ int RTPPacket::ParseRawPacket(RTPRawPacket &rawpack)
 	RTPPacket::payload = packetbytes+payloadoffset;
 	RTPPacket::packetlength = packetlen;
 	RTPPacket::payloadlength = payloadlength;
+	RTPPacket::bufferpool = rawpack.GetBufferPool();
+	RTPPacket::headroom = rawpack.GetDataHeadroom();
 
 	// We'll zero the data of the raw packet, since we're using it here now!
 	rawpack.ZeroData();
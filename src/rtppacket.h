@@ -42,11 +42,16 @@
 #include "rtptypes.h"
 #include "rtptimeutilities.h"
 #include "rtpmemoryobject.h"
+#include <new>
+
+/** Alignment of an RTPPacket instance that is stored in front of its data. */
+#define RTPPACKET_EMBEDDEDALIGNMENT										16
 
 namespace jrtplib
 {
 
 class RTPRawPacket;
+class RTPReceiveBufferPool;
 
 /** Represents an RTP Packet.
  *  The RTPPacket class can be used to parse a RTPRawPacket instance if it represents RTP data. 
@@ -81,7 +86,25 @@ public:
 		  bool gotextension,uint16_t extensionid,uint16_t extensionlen_numwords,const void *extensiondata,
 		  void *buffer,size_t buffersize,RTPMemoryManager *mgr = 0);
 
-	virtual ~RTPPacket()																{ if (packet && !externalbuffer) RTPDeleteByteArray(packet,GetMemoryManager());  }
+	virtual ~RTPPacket();
+
+	/** Creates an RTPPacket instance based upon the data in \c rawpack, like the first constructor.
+	 *  Creates an RTPPacket instance based upon the data in \c rawpack, like the first constructor.
+	 *  If the memory block of the raw packet has room for it in front of the data (see 
+	 *  RTPRawPacket::GetDataHeadroom and RTPPacket::GetEmbeddedSize), the instance is stored in that
+	 *  space so that the packet header information, the payload and the object itself occupy a
+	 *  single block of memory. Otherwise, memory is allocated using \c mgr. The result must always 
+	 *  be deleted using RTPPacket::Delete; returns null if no memory could be allocated.
+	 */
+	static RTPPacket *Create(RTPRawPacket &rawpack,RTPMemoryManager *mgr = 0);
+
+	/** Deletes \c p, which can be any RTPPacket instance that was allocated using \c mgr or that was
+	 *  created by RTPPacket::Create. */
+	static void Delete(RTPPacket *p,RTPMemoryManager *mgr);
+
+	/** Returns the number of bytes that must be available in front of the data of a raw packet to 
+	 *  store an RTPPacket instance there. */
+	static size_t GetEmbeddedSize()														{ return (sizeof(RTPPacket)+RTPPACKET_EMBEDDEDALIGNMENT-1)/RTPPACKET_EMBEDDEDALIGNMENT*RTPPACKET_EMBEDDEDALIGNMENT; }
 
 	/** If an error occurred in one of the constructors, this function returns the error code. */
 	int GetCreationError() const														{ return error; }
@@ -152,6 +175,7 @@ public:
 	 */
 	RTPTime GetReceiveTime() const														{ return receivetime; }
 private:
+	static RTPPacket *CreateAt(void *buffer,RTPRawPacket &rawpack,RTPMemoryManager *mgr)	{ return new (buffer) RTPPacket(rawpack,mgr); }
 	void Clear();
 	int ParseRawPacket(RTPRawPacket &rawpack);
 	int BuildPacket(uint8_t payloadtype,const void *payloaddata,size_t payloadlen,uint16_t seqnr,
@@ -174,6 +198,9 @@ private:
 	size_t extensionlength;
 
 	bool externalbuffer;
+	RTPReceiveBufferPool *bufferpool;
+	size_t headroom;
+	bool embedded;
 
 	RTPTime receivetime;
 };
@@ -0,0 +1,115 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtppacketqueue.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPPacketQueue::RTPPacketQueue(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	slots = 0;
+	capacity = 0;
+	mask = 0;
+#ifdef RTP_HAVE_STDATOMIC
+	tail = 0;
+	cachedhead = 0;
+	numpushed = 0;
+	numrejected = 0;
+	head = 0;
+	cachedtail = 0;
+#endif // RTP_HAVE_STDATOMIC
+}
+
+RTPPacketQueue::~RTPPacketQueue()
+{
+	Destroy();
+}
+
+int RTPPacketQueue::Create(size_t n)
+{
+	if (slots != 0)
+		return ERR_RTP_PACKETQUEUE_ALREADYCREATED;
+#ifndef RTP_HAVE_STDATOMIC
+	JRTPLIB_UNUSED(n);
+	return ERR_RTP_PACKETQUEUE_NOATOMICSUPPORT;
+#else
+	if (n == 0)
+		return ERR_RTP_PACKETQUEUE_ILLEGALCAPACITY;
+
+	size_t c = 1;
+
+	while (c < n)
+	{
+		c <<= 1;
+		if (c == 0) // overflow
+			return ERR_RTP_PACKETQUEUE_ILLEGALCAPACITY;
+	}
+
+	slots = (RTPPacket **)RTPNew(GetMemoryManager(),RTPMEM_TYPE_BUFFER_PACKETQUEUE) uint8_t[c*sizeof(RTPPacket *)];
+	if (slots == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	capacity = c;
+	mask = c-1;
+	tail = 0;
+	cachedhead = 0;
+	numpushed = 0;
+	numrejected = 0;
+	head = 0;
+	cachedtail = 0;
+	return 0;
+#endif // RTP_HAVE_STDATOMIC
+}
+
+void RTPPacketQueue::Destroy()
+{
+	if (slots == 0)
+		return;
+
+	RTPPacket *p;
+
+	while ((p = Pop()) != 0)
+		RTPPacket::Delete(p,GetMemoryManager());
+
+	RTPDeleteByteArray((uint8_t *)slots,GetMemoryManager());
+	slots = 0;
+	capacity = 0;
+	mask = 0;
+}
+
+} // end namespace
+
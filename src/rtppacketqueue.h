@@ -0,0 +1,182 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtppacketqueue.h
+ */
+
+#ifndef RTPPACKETQUEUE_H
+
+#define RTPPACKETQUEUE_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+#ifdef RTP_HAVE_STDATOMIC
+	#include <atomic>
+#endif // RTP_HAVE_STDATOMIC
+
+// Number of bytes between the members used by the producer and those used by the consumer
+#define RTPPACKETQUEUE_PADDING									64
+
+namespace jrtplib
+{
+
+class RTPPacket;
+
+/** A bounded queue that hands over RTP packets from one thread to another without locking.
+ *  This is a ring buffer for exactly one producer thread, which calls RTPPacketQueue::Push,
+ *  and one consumer thread, which calls RTPPacketQueue::Pop. Neither of them ever waits for
+ *  the other one: when the queue is full, RTPPacketQueue::Push simply fails. The class needs
+ *  \c std::atomic; if it's not available, RTPPacketQueue::Create returns an error.
+ */
+class JRTPLIB_IMPORTEXPORT RTPPacketQueue : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPPacketQueue)
+public:
+	RTPPacketQueue(RTPMemoryManager *mgr = 0);
+	~RTPPacketQueue();
+
+	/** Allocates room for at least \c capacity packets (the size is rounded up to a power of two). */
+	int Create(size_t capacity);
+
+	/** Releases the queue, deleting the packets that are still stored in it; neither the
+	 *  producer nor the consumer may use the queue at that time. */
+	void Destroy();
+
+	/** Returns \c true if RTPPacketQueue::Create was called successfully. */
+	bool IsCreated() const											{ return slots != 0; }
+
+	/** Returns the number of packets that can be stored in the queue. */
+	size_t GetCapacity() const										{ return capacity; }
+
+	/** Stores \c p at the end of the queue and returns \c true, or returns \c false
+	 *  if the queue is full (may only be called by the producer). */
+	bool Push(RTPPacket *p);
+
+	/** Returns \c true if there's no room for another packet; if this returns \c false, the
+	 *  next call to RTPPacketQueue::Push will succeed (may only be called by the producer). */
+	bool IsFull();
+
+	/** Removes the first packet from the queue and returns it, or returns null if the 
+	 *  queue is empty (may only be called by the consumer). The packet must be 
+	 *  deallocated using RTPPacket::Delete. */
+	RTPPacket *Pop();
+
+	/** Returns the number of packets that were stored by RTPPacketQueue::Push. */
+	uint64_t GetNumberOfPushedPackets() const;
+
+	/** Returns the number of times RTPPacketQueue::Push failed because the queue was full. */
+	uint64_t GetNumberOfRejectedPackets() const;
+private:
+	RTPPacket **slots;
+	size_t capacity, mask;
+
+	// The producer and consumer each get their own cache line, in which they also 
+	// keep the last index of the other side they've seen, so that they only need
+	// to read the other side's cache line when the queue seems full or empty.
+#ifdef RTP_HAVE_STDATOMIC
+	char pad0[RTPPACKETQUEUE_PADDING];
+	std::atomic<size_t> tail;
+	size_t cachedhead;
+	std::atomic<uint64_t> numpushed, numrejected;
+	char pad1[RTPPACKETQUEUE_PADDING];
+	std::atomic<size_t> head;
+	size_t cachedtail;
+	char pad2[RTPPACKETQUEUE_PADDING];
+#endif // RTP_HAVE_STDATOMIC
+};
+
+#ifdef RTP_HAVE_STDATOMIC
+
+inline bool RTPPacketQueue::Push(RTPPacket *p)
+{
+	size_t t = tail.load(std::memory_order_relaxed);
+
+	if (t - cachedhead == capacity)
+	{
+		cachedhead = head.load(std::memory_order_acquire);
+		if (t - cachedhead == capacity)
+		{
+			numrejected.store(numrejected.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+			return false;
+		}
+	}
+	slots[t&mask] = p;
+	tail.store(t+1,std::memory_order_release);
+	numpushed.store(numpushed.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+	return true;
+}
+
+inline bool RTPPacketQueue::IsFull()
+{
+	size_t t = tail.load(std::memory_order_relaxed);
+
+	if (t - cachedhead == capacity)
+		cachedhead = head.load(std::memory_order_acquire);
+	return (t - cachedhead == capacity);
+}
+
+inline RTPPacket *RTPPacketQueue::Pop()
+{
+	size_t h = head.load(std::memory_order_relaxed);
+
+	if (h == cachedtail)
+	{
+		cachedtail = tail.load(std::memory_order_acquire);
+		if (h == cachedtail)
+			return 0;
+	}
+
+	RTPPacket *p = slots[h&mask];
+
+	head.store(h+1,std::memory_order_release);
+	return p;
+}
+
+inline uint64_t RTPPacketQueue::GetNumberOfPushedPackets() const		{ return numpushed.load(std::memory_order_relaxed); }
+inline uint64_t RTPPacketQueue::GetNumberOfRejectedPackets() const		{ return numrejected.load(std::memory_order_relaxed); }
+
+#else
+
+inline bool RTPPacketQueue::Push(RTPPacket *)							{ return false; }
+inline bool RTPPacketQueue::IsFull()									{ return true; }
+inline RTPPacket *RTPPacketQueue::Pop()									{ return 0; }
+inline uint64_t RTPPacketQueue::GetNumberOfPushedPackets() const		{ return 0; }
+inline uint64_t RTPPacketQueue::GetNumberOfRejectedPackets() const		{ return 0; }
+
+#endif // RTP_HAVE_STDATOMIC
+
+} // end namespace
+
+#endif // RTPPACKETQUEUE_H
+
@@ -124,13 +124,7 @@ void *RTPPollThread::Thread()
 	{
 		int status;
 
-		rtpsession.schedmutex.Lock();
-		rtpsession.sourcesmutex.Lock();
-		
-		RTPTime rtcpdelay = rtcpsched.GetTransmissionDelay();
-		
-		rtpsession.sourcesmutex.Unlock();
-		rtpsession.schedmutex.Unlock();
+		RTPTime rtcpdelay = rtpsession.GetRTCPTransmissionDelay();
 
 		if ((status = transmitter->WaitForIncomingData(rtcpdelay)) < 0)
 		{
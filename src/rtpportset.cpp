@@ -0,0 +1,172 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpportset.h"
+#include "rtperrors.h"
+#include <string.h>
+
+#include "rtpdebug.h"
+
+#define RTPPORTSET_BITMAPSIZE									(65536/8)
+
+namespace jrtplib
+{
+
+RTPPortSet::RTPPortSet(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	bitmap = 0;
+	numports = 0;
+}
+
+RTPPortSet::~RTPPortSet()
+{
+	Clear();
+}
+
+int RTPPortSet::Add(uint16_t port)
+{
+	if (bitmap)
+	{
+		uint8_t mask = (uint8_t)(1 << (port & 7));
+
+		if (!(bitmap[port >> 3] & mask))
+		{
+			bitmap[port >> 3] |= mask;
+			numports++;
+		}
+		return 0;
+	}
+
+	// Keep the inline array sorted, which makes it easy to iterate over the
+	// ports in the same order as when a bitmap is used
+	uint32_t pos = 0;
+
+	while (pos < numports && inlineports[pos] < port)
+		pos++;
+	if (pos < numports && inlineports[pos] == port)
+		return 0;
+
+	if (numports < RTPPORTSET_INLINESIZE)
+	{
+		memmove(inlineports + pos + 1,inlineports + pos,(numports - pos)*sizeof(uint16_t));
+		inlineports[pos] = port;
+		numports++;
+		return 0;
+	}
+
+	// The inline array is full, switch to a bitmap
+	uint8_t *newbitmap = RTPNew(GetMemoryManager(),RTPMEM_TYPE_BUFFER_PORTSETBITMAP) uint8_t[RTPPORTSET_BITMAPSIZE];
+	if (newbitmap == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	memset(newbitmap,0,RTPPORTSET_BITMAPSIZE);
+	for (uint32_t i = 0 ; i < numports ; i++)
+		newbitmap[inlineports[i] >> 3] |= (uint8_t)(1 << (inlineports[i] & 7));
+	newbitmap[port >> 3] |= (uint8_t)(1 << (port & 7));
+	bitmap = newbitmap;
+	numports++;
+	return 0;
+}
+
+bool RTPPortSet::Remove(uint16_t port)
+{
+	if (bitmap)
+	{
+		uint8_t mask = (uint8_t)(1 << (port & 7));
+
+		if (!(bitmap[port >> 3] & mask))
+			return false;
+		bitmap[port >> 3] &= (uint8_t)~mask;
+		numports--;
+		return true;
+	}
+
+	for (uint32_t i = 0 ; i < numports ; i++)
+	{
+		if (inlineports[i] == port)
+		{
+			memmove(inlineports + i,inlineports + i + 1,(numports - i - 1)*sizeof(uint16_t));
+			numports--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void RTPPortSet::Clear()
+{
+	if (bitmap)
+	{
+		RTPDeleteByteArray(bitmap,GetMemoryManager());
+		bitmap = 0;
+	}
+	numports = 0;
+}
+
+int RTPPortSet::GetNextPort(int port) const
+{
+	int start = port + 1;
+
+	if (start < 0 || start > 65535)
+		return -1;
+
+	if (bitmap)
+	{
+		for (int p = start ; p < 65536 ; )
+		{
+			uint8_t bits = (uint8_t)(bitmap[p >> 3] >> (p & 7));
+
+			if (bits == 0) // skip the rest of this byte
+			{
+				p = (p | 7) + 1;
+				continue;
+			}
+			while (!(bits & 1))
+			{
+				bits >>= 1;
+				p++;
+			}
+			return p;
+		}
+		return -1;
+	}
+
+	for (uint32_t i = 0 ; i < numports ; i++)
+	{
+		if ((int)inlineports[i] >= start)
+			return (int)inlineports[i];
+	}
+	return -1;
+}
+
+} // end namespace
+
@@ -0,0 +1,108 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpportset.h
+ */
+
+#ifndef RTPPORTSET_H
+
+#define RTPPORTSET_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+
+/** The number of ports an RTPPortSet can store before it switches to a bitmap. */
+#define RTPPORTSET_INLINESIZE									16
+
+namespace jrtplib
+{
+
+/** A set of port numbers, used by the transmitters to store the ports of an accept or ignore list entry.
+ *  Up to RTPPORTSET_INLINESIZE ports are stored in a small sorted array inside the object
+ *  itself, so that checking if a port is present only needs to look at a single cache
+ *  line for the common case of a few ports per address. When more ports are added, a
+ *  bitmap with one bit for each possible port number is allocated instead, which
+ *  keeps the check constant time for sets containing thousands of ports.
+ */
+class JRTPLIB_IMPORTEXPORT RTPPortSet : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPPortSet)
+public:
+	RTPPortSet(RTPMemoryManager *mgr = 0);
+	~RTPPortSet();
+
+	/** Adds \c port to the set; nothing happens if it's already present. */
+	int Add(uint16_t port);
+
+	/** Removes \c port from the set, and returns \c false if it wasn't present. */
+	bool Remove(uint16_t port);
+
+	/** Removes all ports from the set. */
+	void Clear();
+
+	/** Returns \c true if \c port is present in the set. */
+	inline bool Contains(uint16_t port) const;
+
+	/** Returns \c true if the set doesn't contain any ports. */
+	bool IsEmpty() const												{ return (numports == 0); }
+
+	/** Returns the number of ports in the set. */
+	size_t GetNumberOfPorts() const										{ return numports; }
+
+	/** Returns the lowest port in the set which is larger than \c port, or -1 if there
+	 *  is no such port; specify -1 to obtain the lowest port in the set. */
+	int GetNextPort(int port) const;
+private:
+	uint8_t *bitmap;
+	uint32_t numports;
+	uint16_t inlineports[RTPPORTSET_INLINESIZE];
+};
+
+inline bool RTPPortSet::Contains(uint16_t port) const
+{
+	if (bitmap)
+		return ((bitmap[port >> 3] & (1 << (port & 7))) != 0);
+
+	for (uint32_t i = 0 ; i < numports ; i++)
+	{
+		if (inlineports[i] == port)
+			return true;
+	}
+	return false;
+}
+
+} // end namespace
+
+#endif // RTPPORTSET_H
+
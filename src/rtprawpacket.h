@@ -44,6 +44,10 @@
 #include "rtptypes.h"
 #include "rtpmemoryobject.h"
 #include "rtpstructs.h"
+#include "rtpreceivebufferpool.h"
+
+/** The number of bytes that are reserved inside an RTPRawPacket to store a copy of the sender address. */
+#define RTPRAWPACKET_ADDRESSSTORAGESIZE									128
 
 namespace jrtplib
 {
@@ -72,6 +76,13 @@ public:
 	 *  based on the header information the packet type will be determined.
 	 */
 	RTPRawPacket(uint8_t *data,size_t datalen,RTPAddress *address,RTPTime &recvtime,RTPMemoryManager *mgr = 0);
+
+	/** Creates an instance which stores data from \c data with length \c datalen, and a copy of \c address.
+	 *  This is similar to the first constructor, but instead of taking ownership of an allocated address,
+	 *  a copy of \c address is stored inside the instance itself if the address type supports this (see
+	 *  RTPAddress::CreateCopyAt), which avoids a separate allocation for each incoming packet.
+	 */
+	RTPRawPacket(uint8_t *data,size_t datalen,const RTPAddress &address,RTPTime &recvtime,bool rtp,RTPMemoryManager *mgr = 0);
 	~RTPRawPacket();
 	
 	/** Returns the pointer to the data which is contained in this packet. */
@@ -83,6 +94,13 @@ public:
 	/** Returns the time at which this packet was received. */
 	RTPTime GetReceiveTime() const											{ return receivetime; }
 
+	/** Returns \c true if the receive time was recorded by the kernel when the datagram arrived, 
+	 *  and \c false if it's the time at which the transmitter read the datagram. */
+	bool HasKernelReceiveTime() const										{ return kernelreceivetime; }
+
+	/** Indicates whether the receive time was recorded by the kernel (used by the transmission components). */
+	void SetKernelReceiveTime(bool f)										{ kernelreceivetime = f; }
+
 	/** Returns the address stored in this packet. */
 	const RTPAddress *GetSenderAddress() const								{ return senderaddress; }
 
@@ -96,7 +114,7 @@ public:
 	 *  the packet data (without having to copy it)	and to make sure the data isn't deleted 
 	 *  when the destructor of RTPRawPacket is called.
 	 */
-	void ZeroData()															{ packetdata = 0; packetdatalength = 0; }
+	void ZeroData()															{ packetdata = 0; packetdatalength = 0; bufferpool = 0; headroom = 0; }
 
 	/** Allocates a number of bytes for RTP or RTCP data using the memory manager that
 	 *  was used for this raw packet instance, can be useful if the RTPRawPacket::SetData
@@ -110,14 +128,40 @@ public:
 	/** Deallocates the currently stored RTPAddress instance and replaces it
 	 *  with the one that's specified (you probably don't need this function). */
 	void SetSenderAddress(RTPAddress *address);
+
+	/** Indicates that the data stored in this packet was obtained from \c pool using
+	 *  RTPReceiveBufferPool::GetBuffer, so that it's returned to that pool instead of
+	 *  being deleted (used by the transmission components). */
+	void SetBufferPool(RTPReceiveBufferPool *pool)							{ bufferpool = pool; }
+
+	/** Returns the pool the data of this packet was obtained from, or null if the
+	 *  data was allocated using the memory manager. Classes that take over the data
+	 *  using RTPRawPacket::ZeroData must return it to this pool as well. */
+	RTPReceiveBufferPool *GetBufferPool() const								{ return bufferpool; }
+
+	/** Indicates that the memory block containing the data starts \c numbytes bytes before the
+	 *  pointer that was passed to the constructor (used by the transmission components). This
+	 *  space can be used by RTPPacket to store itself in the same memory block as the data. */
+	void SetDataHeadroom(size_t numbytes)									{ headroom = numbytes; }
+
+	/** Returns the number of bytes that are available in front of the data, in the same memory block. 
+	 *  Classes that take over the data using RTPRawPacket::ZeroData must release the memory block
+	 *  starting at this offset before the data. */
+	size_t GetDataHeadroom() const											{ return headroom; }
 private:
 	void DeleteData();
+	void DeleteSenderAddress();
 
 	uint8_t *packetdata;
 	size_t packetdatalength;
 	RTPTime receivetime;
 	RTPAddress *senderaddress;
+	RTPReceiveBufferPool *bufferpool;
+	size_t headroom;
 	bool isrtp;
+	bool inlineaddress;
+	bool kernelreceivetime;
+	uint64_t addressstorage[RTPRAWPACKET_ADDRESSSTORAGESIZE/sizeof(uint64_t)];
 };
 
 inline RTPRawPacket::RTPRawPacket(uint8_t *data,size_t datalen,RTPAddress *address,RTPTime &recvtime,bool rtp,RTPMemoryManager *mgr):RTPMemoryObject(mgr),receivetime(recvtime)
@@ -125,7 +169,11 @@ inline RTPRawPacket::RTPRawPacket(uint8_t *data,size_t datalen,RTPAddress *addre
 	packetdata = data;
 	packetdatalength = datalen;
 	senderaddress = address;
+	bufferpool = 0;
+	headroom = 0;
 	isrtp = rtp;
+	inlineaddress = false;
+	kernelreceivetime = false;
 }
 
 inline RTPRawPacket::RTPRawPacket(uint8_t *data,size_t datalen,RTPAddress *address,RTPTime &recvtime,RTPMemoryManager *mgr):RTPMemoryObject(mgr),receivetime(recvtime)
@@ -133,6 +181,10 @@ inline RTPRawPacket::RTPRawPacket(uint8_t *data,size_t datalen,RTPAddress *addre
 	packetdata = data;
 	packetdatalength = datalen;
 	senderaddress = address;
+	bufferpool = 0;
+	headroom = 0;
+	inlineaddress = false;
+	kernelreceivetime = false;
 
 	isrtp = true;
 	if (datalen >= sizeof(RTCPCommonHeader))
@@ -145,6 +197,21 @@ inline RTPRawPacket::RTPRawPacket(uint8_t *data,size_t datalen,RTPAddress *addre
 	}
 }
 
+inline RTPRawPacket::RTPRawPacket(uint8_t *data,size_t datalen,const RTPAddress &address,RTPTime &recvtime,bool rtp,RTPMemoryManager *mgr):RTPMemoryObject(mgr),receivetime(recvtime)
+{
+	packetdata = data;
+	packetdatalength = datalen;
+	bufferpool = 0;
+	headroom = 0;
+	isrtp = rtp;
+	kernelreceivetime = false;
+
+	senderaddress = address.CreateCopyAt(addressstorage,sizeof(addressstorage));
+	inlineaddress = (senderaddress != 0);
+	if (!inlineaddress)
+		senderaddress = address.CreateCopy(GetMemoryManager());
+}
+
 inline RTPRawPacket::~RTPRawPacket()
 {
 	DeleteData();
@@ -153,12 +220,30 @@ inline RTPRawPacket::~RTPRawPacket()
 inline void RTPRawPacket::DeleteData()
 {
 	if (packetdata)
-		RTPDeleteByteArray(packetdata,GetMemoryManager());
-	if (senderaddress)
-		RTPDelete(senderaddress,GetMemoryManager());
+	{
+		if (bufferpool)
+			bufferpool->ReleaseBuffer(packetdata-headroom);
+		else
+			RTPDeleteByteArray((packetdata-headroom),GetMemoryManager());
+	}
+	DeleteSenderAddress();
 
 	packetdata = 0;
+	bufferpool = 0;
+	headroom = 0;
+}
+
+inline void RTPRawPacket::DeleteSenderAddress()
+{
+	if (senderaddress)
+	{
+		if (inlineaddress)
+			senderaddress->~RTPAddress();
+		else
+			RTPDelete(senderaddress,GetMemoryManager());
+	}
 	senderaddress = 0;
+	inlineaddress = false;
 }
 
 inline uint8_t *RTPRawPacket::AllocateBytes(bool isrtp, int recvlen) const
@@ -170,17 +255,22 @@ inline uint8_t *RTPRawPacket::AllocateBytes(bool isrtp, int recvlen) const
 inline void RTPRawPacket::SetData(uint8_t *data, size_t datalen)
 {
 	if (packetdata)
-		RTPDeleteByteArray(packetdata,GetMemoryManager());
+	{
+		if (bufferpool)
+			bufferpool->ReleaseBuffer(packetdata-headroom);
+		else
+			RTPDeleteByteArray((packetdata-headroom),GetMemoryManager());
+	}
 
 	packetdata = data;
 	packetdatalength = datalen;
+	bufferpool = 0;
+	headroom = 0;
 }
 
 inline void RTPRawPacket::SetSenderAddress(RTPAddress *address)
 {
-	if (senderaddress)
-		RTPDelete(senderaddress, GetMemoryManager());
-
+	DeleteSenderAddress();
 	senderaddress = address;
 }
 
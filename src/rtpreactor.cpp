@@ -0,0 +1,618 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpreactor.h"
+
+#if defined(RTP_SUPPORT_THREAD) && defined(RTP_HAVE_EPOLL)
+
+#include "rtpsession.h"
+#include "rtptransmitter.h"
+#include "rtcpscheduler.h"
+#include "rtperrors.h"
+#include <jthread/jthread.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <iostream>
+
+#include "rtpdebug.h"
+
+#define RTPREACTOR_MAXEVENTS					64
+#define RTPREACTOR_KICKID						0
+
+namespace jrtplib
+{
+
+class RTPReactor::ReactorThread : public jthread::JThread
+{
+	JRTPLIB_NO_COPY(ReactorThread)
+public:
+	ReactorThread(RTPReactor &r, size_t idx) : index(idx), reactor(r)		{ }
+	~ReactorThread()												{ }
+
+	// The ids of the sessions that are ready to be processed, protected by queuemutex
+	std::deque<uint64_t> queue;
+	jthread::JMutex queuemutex;
+	const size_t index;
+private:
+	void *Thread()
+	{
+		JThread::ThreadStarted();
+		reactor.WorkerLoop(*this);
+		return 0;
+	}
+
+	RTPReactor &reactor;
+};
+
+RTPReactor::RTPReactor(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	running = false;
+	stopthreads = false;
+	epollfd = -1;
+	nextid = RTPREACTOR_KICKID+1;
+}
+
+RTPReactor::~RTPReactor()
+{
+	Stop();
+}
+
+int RTPReactor::Start(int numthreads)
+{
+	if (running)
+		return ERR_RTP_REACTOR_ALREADYRUNNING;
+	if (numthreads < 1)
+		return ERR_RTP_REACTOR_ILLEGALTHREADCOUNT;
+
+	if (!mutex.IsInitialized())
+	{
+		if (mutex.Init() < 0)
+			return ERR_RTP_REACTOR_CANTINITMUTEX;
+	}
+
+	if ((epollfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+		return ERR_RTP_REACTOR_CANTCREATEEPOLL;
+
+	int status;
+
+	if ((status = kickdescriptors.Init()) < 0)
+	{
+		close(epollfd);
+		epollfd = -1;
+		return status;
+	}
+
+	// The kick descriptor is armed one-shot as well, so that a kick wakes up a single worker
+	struct epoll_event ev;
+
+	ev.events = EPOLLIN|EPOLLONESHOT;
+	ev.data.u64 = RTPREACTOR_KICKID;
+	if (epoll_ctl(epollfd, EPOLL_CTL_ADD, kickdescriptors.GetAbortSocket(), &ev) < 0)
+	{
+		kickdescriptors.Destroy();
+		close(epollfd);
+		epollfd = -1;
+		return ERR_RTP_REACTOR_CANTREGISTERSOCKET;
+	}
+
+	stopthreads = false;
+	running = true;
+
+	// All workers must exist before the first one starts, since they look at
+	// each other's queues
+	for (int i = 0 ; i < numthreads ; i++)
+	{
+		ReactorThread *t = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_REACTORTHREAD) ReactorThread(*this, (size_t)i);
+		if (t == 0)
+		{
+			Stop();
+			return ERR_RTP_OUTOFMEM;
+		}
+		threads.push_back(t);
+		if (t->queuemutex.Init() < 0)
+		{
+			Stop();
+			return ERR_RTP_REACTOR_CANTINITMUTEX;
+		}
+	}
+	for (size_t i = 0 ; i < threads.size() ; i++)
+	{
+		if (threads[i]->Start() < 0)
+		{
+			Stop();
+			return ERR_RTP_REACTOR_CANTSTARTTHREAD;
+		}
+	}
+	return 0;
+}
+
+void RTPReactor::Stop()
+{
+	if (!running)
+		return;
+
+	mutex.Lock();
+	stopthreads = true;
+	mutex.Unlock();
+
+	// A worker that sees the stop flag rearms the kick descriptor without clearing it,
+	// so the signal is passed on until every worker has noticed it
+	kickdescriptors.SendAbortSignal();
+
+	RTPTime thetime = RTPTime::CurrentTime();
+	bool done = false;
+
+	while (!done)
+	{
+		bool allstopped = true;
+
+		for (size_t i = 0 ; i < threads.size() ; i++)
+		{
+			if (threads[i]->IsRunning())
+				allstopped = false;
+		}
+		if (allstopped)
+			break;
+
+		// wait max 5 sec
+		RTPTime curtime = RTPTime::CurrentTime();
+		if ((curtime.GetDouble()-thetime.GetDouble()) > 5.0)
+			done = true;
+		RTPTime::Wait(RTPTime(0,10000));
+	}
+
+	for (size_t i = 0 ; i < threads.size() ; i++)
+	{
+		if (threads[i]->IsRunning())
+		{
+			std::cerr << "RTPReactor: Warning! Having to kill thread!" << std::endl;
+			threads[i]->Kill();
+		}
+		RTPDelete(threads[i],GetMemoryManager());
+	}
+	threads.clear();
+
+	ClearSessions();
+	timers.clear();
+	close(epollfd);
+	epollfd = -1;
+	kickdescriptors.Destroy();
+	stopthreads = false;
+	running = false;
+}
+
+int RTPReactor::AddSession(RTPSession &session)
+{
+	if (!running)
+		return ERR_RTP_REACTOR_NOTRUNNING;
+	if (!session.created || session.usingpollthread || !session.needthreadsafety)
+		return ERR_RTP_REACTOR_INVALIDSESSION;
+
+	SessionEntry *entry = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_REACTORSESSION) SessionEntry(session);
+	if (entry == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	int status;
+
+	entry->numsockets = MaxSocketsPerSession;
+	if ((status = session.rtptrans->GetReceiveSockets(entry->sockets, &entry->numsockets)) < 0)
+	{
+		RTPDelete(entry,GetMemoryManager());
+		return status;
+	}
+
+	mutex.Lock();
+	if (sessionids.find(&session) != sessionids.end())
+	{
+		mutex.Unlock();
+		RTPDelete(entry,GetMemoryManager());
+		return ERR_RTP_REACTOR_SESSIONALREADYADDED;
+	}
+
+	uint64_t id = nextid++;
+
+	if ((status = Register(id, entry, EPOLL_CTL_ADD)) < 0)
+	{
+		Deregister(entry);
+		mutex.Unlock();
+		RTPDelete(entry,GetMemoryManager());
+		return status;
+	}
+	sessions[id] = entry;
+	sessionids[&session] = id;
+
+	// Process the session right away, which also determines its first RTCP deadline
+	ScheduleTimer(id, entry, RTPTime::CurrentTime());
+	mutex.Unlock();
+
+	Kick();
+	return 0;
+}
+
+int RTPReactor::RemoveSession(RTPSession &session)
+{
+	if (!running)
+		return ERR_RTP_REACTOR_NOTRUNNING;
+
+	mutex.Lock();
+
+	std::map<RTPSession *, uint64_t>::iterator it = sessionids.find(&session);
+	if (it == sessionids.end())
+	{
+		mutex.Unlock();
+		return ERR_RTP_REACTOR_SESSIONNOTFOUND;
+	}
+
+	std::map<uint64_t, SessionEntry *>::iterator it2 = sessions.find(it->second);
+	SessionEntry *entry = it2->second;
+
+	Deregister(entry);
+	sessions.erase(it2);
+	sessionids.erase(it);
+	entry->removed = true;
+
+	// Pending timers of the session will no longer be found, but a worker may
+	// still be processing it
+	while (entry->busy)
+	{
+		mutex.Unlock();
+		RTPTime::Wait(RTPTime(0,1000));
+		mutex.Lock();
+	}
+	mutex.Unlock();
+
+	RTPDelete(entry,GetMemoryManager());
+	return 0;
+}
+
+size_t RTPReactor::GetNumberOfSessions()
+{
+	if (!running)
+		return 0;
+
+	mutex.Lock();
+	size_t num = sessions.size();
+	mutex.Unlock();
+	return num;
+}
+
+void RTPReactor::WorkerLoop(ReactorThread &self)
+{
+	struct epoll_event events[RTPREACTOR_MAXEVENTS];
+	std::vector<uint64_t> work;
+
+	while (true)
+	{
+		uint64_t id;
+		int timeout = -1;
+
+		mutex.Lock();
+		bool stop = stopthreads;
+		mutex.Unlock();
+
+		if (stop)
+			break;
+
+		if (GetWork(self, id))
+		{
+			ProcessSession(id);
+			continue;
+		}
+
+		mutex.Lock();
+		if (!timers.empty())
+		{
+			RTPTime curtime = RTPTime::CurrentTime();
+			double diff = timers[0].time.GetDouble() - curtime.GetDouble();
+
+			if (diff <= 0)
+				timeout = 0;
+			else if (diff > 3600.0)
+				timeout = 3600000;
+			else // round up, otherwise we'd wake up just before the deadline
+				timeout = (int)ceil(diff*1000.0);
+		}
+		mutex.Unlock();
+
+		int num = epoll_wait(epollfd, events, RTPREACTOR_MAXEVENTS, timeout);
+		if (num < 0)
+		{
+			if (errno != EINTR)
+				RTPTime::Wait(RTPTime(0,1000)); // avoid spinning if something is seriously wrong
+			num = 0;
+		}
+
+		bool kicked = false;
+
+		work.clear();
+		for (int i = 0 ; i < num ; i++)
+		{
+			if (events[i].data.u64 == RTPREACTOR_KICKID)
+				kicked = true;
+			else
+				work.push_back(events[i].data.u64);
+		}
+
+		mutex.Lock();
+		if (kicked)
+		{
+			struct epoll_event ev;
+
+			if (!stopthreads)
+				kickdescriptors.ClearAbortSignal();
+			ev.events = EPOLLIN|EPOLLONESHOT;
+			ev.data.u64 = RTPREACTOR_KICKID;
+			epoll_ctl(epollfd, EPOLL_CTL_MOD, kickdescriptors.GetAbortSocket(), &ev);
+		}
+
+		RTPTime curtime = RTPTime::CurrentTime();
+
+		while (!timers.empty() && timers[0].time <= curtime)
+		{
+			std::pop_heap(timers.begin(), timers.end());
+
+			const TimerEntry &t = timers.back();
+			std::map<uint64_t, SessionEntry *>::iterator it = sessions.find(t.id);
+
+			if (it != sessions.end() && it->second->hastimer && it->second->generation == t.generation)
+			{
+				it->second->hastimer = false;
+				work.push_back(t.id);
+			}
+			timers.pop_back();
+		}
+		mutex.Unlock();
+
+		if (work.empty())
+			continue;
+
+		// A session that has both incoming data and an expired timer only needs to be processed once
+		std::sort(work.begin(), work.end());
+		work.erase(std::unique(work.begin(), work.end()), work.end());
+
+		self.queuemutex.Lock();
+		self.queue.insert(self.queue.end(), work.begin(), work.end());
+		size_t queuesize = self.queue.size();
+		self.queuemutex.Unlock();
+
+		// We can only process one session at a time, wake up an idle worker to steal the rest
+		if (queuesize > 1 && threads.size() > 1)
+			Kick();
+	}
+}
+
+bool RTPReactor::GetWork(ReactorThread &self, uint64_t &id)
+{
+	self.queuemutex.Lock();
+	if (!self.queue.empty())
+	{
+		id = self.queue.front();
+		self.queue.pop_front();
+		self.queuemutex.Unlock();
+		return true;
+	}
+	self.queuemutex.Unlock();
+
+	for (size_t i = 1 ; i < threads.size() ; i++)
+	{
+		ReactorThread *victim = threads[(self.index+i)%threads.size()];
+
+		victim->queuemutex.Lock();
+		if (!victim->queue.empty())
+		{
+			id = victim->queue.back();
+			victim->queue.pop_back();
+
+			bool more = !victim->queue.empty();
+
+			victim->queuemutex.Unlock();
+
+			// Pass on the wake-up, so that other idle workers can help as well
+			if (more)
+				Kick();
+			return true;
+		}
+		victim->queuemutex.Unlock();
+	}
+	return false;
+}
+
+void RTPReactor::ProcessSession(uint64_t id)
+{
+	mutex.Lock();
+
+	std::map<uint64_t, SessionEntry *>::iterator it = sessions.find(id);
+	if (it == sessions.end())
+	{
+		mutex.Unlock();
+		return;
+	}
+
+	SessionEntry *entry = it->second;
+
+	if (entry->busy)
+	{
+		// Another worker is processing the session, let it run one more round
+		entry->again = true;
+		mutex.Unlock();
+		return;
+	}
+	entry->busy = true;
+	mutex.Unlock();
+
+	RTPSession &session = entry->session;
+	RTPTime delay(0,0);
+	int status = 0;
+	bool done = false;
+
+	while (!done)
+	{
+		if ((status = session.rtptrans->Poll()) < 0)
+			break;
+		if ((status = session.ProcessPolledData()) < 0)
+			break;
+
+		session.OnPollThreadStep();
+
+		delay = session.GetRTCPTransmissionDelay();
+
+		mutex.Lock();
+		if (entry->again && !entry->removed)
+		{
+			entry->again = false;
+			mutex.Unlock();
+		}
+		else
+			done = true; // keep the lock
+	}
+
+	bool kick = false;
+
+	if (done)
+	{
+		// Rearming the sockets and clearing the busy flag happen while holding the
+		// lock, so an event for this session cannot slip in between and get lost
+		entry->again = false;
+		if (!entry->removed)
+		{
+			RTPTime deadline = RTPTime::CurrentTime();
+
+			deadline += delay;
+			kick = ScheduleTimer(id, entry, deadline);
+			status = Register(id, entry, EPOLL_CTL_MOD);
+		}
+		if (status >= 0)
+		{
+			entry->busy = false;
+			mutex.Unlock();
+
+			if (kick)
+				Kick();
+			return;
+		}
+		mutex.Unlock();
+	}
+
+	// The session stays marked as busy while its error handler runs
+	session.OnPollThreadError(status);
+
+	mutex.Lock();
+
+	bool owner = !entry->removed;
+
+	if (owner)
+	{
+		Deregister(entry);
+		sessions.erase(id);
+		sessionids.erase(&session);
+		entry->removed = true;
+	}
+	entry->busy = false;
+	mutex.Unlock();
+
+	// If RemoveSession was called in the meantime, it's waiting to delete the entry itself
+	if (owner)
+		RTPDelete(entry,GetMemoryManager());
+}
+
+int RTPReactor::Register(uint64_t id, SessionEntry *entry, int op)
+{
+	for (size_t i = 0 ; i < entry->numsockets ; i++)
+	{
+		struct epoll_event ev;
+
+		ev.events = EPOLLIN|EPOLLONESHOT;
+		ev.data.u64 = id;
+		if (epoll_ctl(epollfd, op, entry->sockets[i], &ev) < 0)
+			return ERR_RTP_REACTOR_CANTREGISTERSOCKET;
+	}
+	return 0;
+}
+
+void RTPReactor::Deregister(SessionEntry *entry)
+{
+	for (size_t i = 0 ; i < entry->numsockets ; i++)
+	{
+		struct epoll_event ev; // only needed for kernels before 2.6.9
+
+		memset(&ev, 0, sizeof(struct epoll_event));
+
+		epoll_ctl(epollfd, EPOLL_CTL_DEL, entry->sockets[i], &ev);
+	}
+}
+
+bool RTPReactor::ScheduleTimer(uint64_t id, SessionEntry *entry, const RTPTime &deadline)
+{
+	// If the pending timer expires earlier, processing the session then will
+	// schedule the later deadline; this keeps stale heap entries to a minimum
+	if (entry->hastimer && entry->deadline <= deadline)
+		return false;
+
+	bool earliest = (timers.empty() || deadline < timers[0].time);
+
+	entry->generation++;
+	entry->hastimer = true;
+	entry->deadline = deadline;
+	timers.push_back(TimerEntry(deadline, id, entry->generation));
+	std::push_heap(timers.begin(), timers.end());
+
+	// Only if the deadline is earlier than all others can a waiting worker be sleeping too long
+	return earliest;
+}
+
+void RTPReactor::Kick()
+{
+	kickdescriptors.SendAbortSignal();
+}
+
+void RTPReactor::ClearSessions()
+{
+	std::map<uint64_t, SessionEntry *>::iterator it;
+
+	for (it = sessions.begin() ; it != sessions.end() ; ++it)
+	{
+		Deregister(it->second);
+		RTPDelete(it->second,GetMemoryManager());
+	}
+	sessions.clear();
+	sessionids.clear();
+}
+
+} // end namespace
+
+#endif // RTP_SUPPORT_THREAD && RTP_HAVE_EPOLL
+
@@ -0,0 +1,163 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpreactor.h
+ */
+
+#ifndef RTPREACTOR_H
+
+#define RTPREACTOR_H
+
+#include "rtpconfig.h"
+
+#if defined(RTP_SUPPORT_THREAD) && defined(RTP_HAVE_EPOLL)
+
+#include "rtpmemoryobject.h"
+#include "rtpabortdescriptors.h"
+#include "rtptimeutilities.h"
+#include "rtpsocketutil.h"
+#include <jthread/jmutex.h>
+#include <vector>
+#include <map>
+
+namespace jrtplib
+{
+
+class RTPSession;
+
+/** Serves the incoming data and the RTCP timers of many sessions using a small number of threads.
+ *  Instead of giving each session its own poll thread, which needs a thread and a blocking wait 
+ *  per session, the receive sockets of all sessions that are added to an RTPReactor are 
+ *  registered with a single epoll instance, and the RTCP deadlines of these sessions are kept 
+ *  in one timer heap. A fixed number of worker threads wait on the epoll instance and process
+ *  a session when data arrives on one of its sockets or when its RTCP deadline has passed. A
+ *  session is never processed by two workers at the same time, and a step of a session (polling
+ *  the transmitter and calling RTPSession::ProcessPolledData) always runs to completion in 
+ *  the worker that started it.
+ *
+ *  The sessions that a worker finds ready are placed in its own work queue. Workers take work
+ *  from the front of their own queue, and a worker without work steals from the back of the
+ *  queue of another worker before waiting for new events, so that a few busy sessions don't 
+ *  delay the processing of the others.
+ *
+ *  A session can only be added to a reactor if it was created with thread safety enabled and
+ *  without its own poll thread (see RTPSessionParams::SetUsePollThread and 
+ *  RTPSessionParams::SetNeedThreadSafety), and if its transmitter provides its receive sockets
+ *  (see RTPTransmitter::GetReceiveSockets). Each time a session was processed, its 
+ *  RTPSession::OnPollThreadStep member function is called; if an error occurs, 
+ *  RTPSession::OnPollThreadError is called and the session is no longer served by the reactor.
+ *  These callbacks run in a worker thread and must not call RTPReactor::RemoveSession. A
+ *  session must be removed from the reactor before it is destroyed.
+ */
+class JRTPLIB_IMPORTEXPORT RTPReactor : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPReactor)
+public:
+	RTPReactor(RTPMemoryManager *mgr = 0);
+	~RTPReactor();
+
+	/** Starts \c numthreads worker threads. */
+	int Start(int numthreads);
+
+	/** Stops the worker threads and removes all sessions from the reactor. */
+	void Stop();
+
+	/** Returns \c true if the worker threads are running. */
+	bool IsRunning() const											{ return running; }
+
+	/** Lets the reactor serve \c session. */
+	int AddSession(RTPSession &session);
+
+	/** Stops serving \c session, waiting until a worker that's currently processing it is done. */
+	int RemoveSession(RTPSession &session);
+
+	/** Returns the number of sessions that are currently being served. */
+	size_t GetNumberOfSessions();
+private:
+	class ReactorThread;
+	friend class ReactorThread;
+
+	enum { MaxSocketsPerSession = 2 };
+
+	class SessionEntry
+	{
+	public:
+		SessionEntry(RTPSession &s) : session(s), deadline(0, 0)			{ numsockets = 0; busy = false; again = false; removed = false; hastimer = false; generation = 0; }
+
+		RTPSession &session;
+		SocketType sockets[MaxSocketsPerSession];
+		size_t numsockets;
+		bool busy, again, removed, hastimer;
+		RTPTime deadline;
+		uint64_t generation;
+	};
+
+	class TimerEntry
+	{
+	public:
+		TimerEntry(const RTPTime &t, uint64_t i, uint64_t g) : time(t), id(i), generation(g)	{ }
+
+		// The heap functions build a max-heap, so the earliest deadline compares as largest
+		bool operator<(const TimerEntry &e) const						{ return time > e.time; }
+
+		RTPTime time;
+		uint64_t id;
+		uint64_t generation;
+	};
+
+	void WorkerLoop(ReactorThread &self);
+	bool GetWork(ReactorThread &self, uint64_t &id);
+	void ProcessSession(uint64_t id);
+	int Register(uint64_t id, SessionEntry *entry, int op);
+	void Deregister(SessionEntry *entry);
+	bool ScheduleTimer(uint64_t id, SessionEntry *entry, const RTPTime &deadline);
+	void Kick();
+	void ClearSessions();
+
+	bool running, stopthreads;
+	int epollfd;
+	RTPAbortDescriptors kickdescriptors;
+	jthread::JMutex mutex;
+	std::vector<ReactorThread *> threads;
+	std::map<uint64_t, SessionEntry *> sessions;
+	std::map<RTPSession *, uint64_t> sessionids;
+	std::vector<TimerEntry> timers;
+	uint64_t nextid;
+};
+
+} // end namespace
+
+#endif // RTP_SUPPORT_THREAD && RTP_HAVE_EPOLL
+
+#endif // RTPREACTOR_H
+
@@ -0,0 +1,198 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpreceivebufferpool.h"
+#include "rtperrors.h"
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPReceiveBufferPool::RTPReceiveBufferPool(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	memblock = 0;
+	numbuffers = 0;
+	buffersize = 0;
+	bufferstride = 0;
+	numoutstanding = 0;
+	refcount = 1;
+	numhits = 0;
+	nummisses = 0;
+#ifdef RTP_SUPPORT_THREAD
+	threadsafe = false;
+#endif // RTP_SUPPORT_THREAD
+}
+
+RTPReceiveBufferPool::~RTPReceiveBufferPool()
+{
+	if (memblock)
+		RTPDeleteByteArray(memblock,GetMemoryManager());
+}
+
+int RTPReceiveBufferPool::Create(size_t nbuf, size_t bufsize, bool tsafe)
+{
+	if (memblock)
+		return ERR_RTP_RECEIVEBUFFERPOOL_ALREADYCREATED;
+	if (nbuf == 0 || bufsize == 0)
+		return ERR_RTP_RECEIVEBUFFERPOOL_ILLEGALSIZE;
+
+#ifdef RTP_SUPPORT_THREAD
+	threadsafe = tsafe;
+	if (threadsafe && !mutex.IsInitialized())
+	{
+		if (mutex.Init() < 0)
+			return ERR_RTP_RECEIVEBUFFERPOOL_CANTINITMUTEX;
+	}
+#else
+	if (tsafe)
+		return ERR_RTP_NOTHREADSUPPORT;
+#endif // RTP_SUPPORT_THREAD
+
+	// Keep the buffers aligned, so that objects can be stored in them as well
+	size_t stride = (bufsize+RTPRECEIVEBUFFERPOOL_ALIGNMENT-1)/RTPRECEIVEBUFFERPOOL_ALIGNMENT*RTPRECEIVEBUFFERPOOL_ALIGNMENT;
+
+	memblock = RTPNew(GetMemoryManager(),RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET) uint8_t[nbuf*stride];
+	if (memblock == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	numbuffers = nbuf;
+	buffersize = bufsize;
+	bufferstride = stride;
+	freebuffers.resize(numbuffers);
+	for (size_t i = 0 ; i < numbuffers ; i++)
+		freebuffers[i] = memblock + (numbuffers-1-i)*bufferstride;
+	return 0;
+}
+
+uint8_t *RTPReceiveBufferPool::GetBuffer(size_t len, bool rtp)
+{
+	uint8_t *buf = 0;
+
+	Lock();
+	if (len <= buffersize && !freebuffers.empty())
+	{
+		buf = freebuffers.back();
+		freebuffers.pop_back();
+		numhits++;
+	}
+	else
+		nummisses++;
+	numoutstanding++;
+	Unlock();
+
+	if (buf == 0)
+	{
+		JRTPLIB_UNUSED(rtp); // possibly unused
+		buf = RTPNew(GetMemoryManager(),(rtp)?RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET:RTPMEM_TYPE_BUFFER_RECEIVEDRTCPPACKET) uint8_t[len];
+		if (buf == 0)
+		{
+			Lock();
+			numoutstanding--;
+			Unlock();
+		}
+	}
+	return buf;
+}
+
+void RTPReceiveBufferPool::ReleaseBuffer(uint8_t *buf)
+{
+	bool frompool = IsPoolBuffer(buf);
+	
+	if (!frompool)
+		RTPDeleteByteArray(buf,GetMemoryManager());
+
+	Lock();
+	if (frompool)
+		freebuffers.push_back(buf);
+	numoutstanding--;
+	bool unused = (numoutstanding == 0 && refcount == 0);
+	Unlock();
+
+	if (unused)
+		RTPDelete(this,GetMemoryManager());
+}
+
+void RTPReceiveBufferPool::AddReference()
+{
+	Lock();
+	refcount++;
+	Unlock();
+}
+
+void RTPReceiveBufferPool::Release()
+{
+	Lock();
+	refcount--;
+	bool unused = (numoutstanding == 0 && refcount == 0);
+	Unlock();
+
+	if (unused)
+		RTPDelete(this,GetMemoryManager());
+}
+
+void RTPReceiveBufferPool::GetStatistics(RTPReceiveBufferPoolStatistics &stats)
+{
+	Lock();
+	stats.numbuffers = numbuffers;
+	stats.buffersize = buffersize;
+	stats.numinuse = numbuffers - freebuffers.size();
+	stats.numhits = numhits;
+	stats.nummisses = nummisses;
+	Unlock();
+}
+
+void RTPReceiveBufferPool::ClearStatistics()
+{
+	Lock();
+	numhits = 0;
+	nummisses = 0;
+	Unlock();
+}
+
+void RTPReceiveBufferPool::Lock()
+{
+#ifdef RTP_SUPPORT_THREAD
+	if (threadsafe)
+		mutex.Lock();
+#endif // RTP_SUPPORT_THREAD
+}
+
+void RTPReceiveBufferPool::Unlock()
+{
+#ifdef RTP_SUPPORT_THREAD
+	if (threadsafe)
+		mutex.Unlock();
+#endif // RTP_SUPPORT_THREAD
+}
+
+} // end namespace
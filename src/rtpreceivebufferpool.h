@@ -0,0 +1,156 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpreceivebufferpool.h
+ */
+
+#ifndef RTPRECEIVEBUFFERPOOL_H
+
+#define RTPRECEIVEBUFFERPOOL_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+#include <vector>
+
+#ifdef RTP_SUPPORT_THREAD
+	#include <jthread/jmutex.h>
+#endif // RTP_SUPPORT_THREAD
+
+namespace jrtplib
+{
+
+/** Describes how often incoming packets could be stored in a buffer of an RTPReceiveBufferPool. */
+class JRTPLIB_IMPORTEXPORT RTPReceiveBufferPoolStatistics
+{
+public:
+	RTPReceiveBufferPoolStatistics()								{ numbuffers = 0; buffersize = 0; numinuse = 0; numhits = 0; nummisses = 0; }
+
+	/** Returns the number of buffers in the pool. */
+	size_t GetNumberOfBuffers() const								{ return numbuffers; }
+
+	/** Returns the size of each buffer in the pool. */
+	size_t GetBufferSize() const									{ return buffersize; }
+
+	/** Returns the number of buffers of the pool that are currently used by packets. */
+	size_t GetNumberOfBuffersInUse() const							{ return numinuse; }
+
+	/** Returns the number of times a packet could be stored in a buffer of the pool. */
+	uint64_t GetNumberOfHits() const								{ return numhits; }
+
+	/** Returns the number of times memory had to be allocated for a packet instead,
+	 *  either because all buffers were in use or because the packet was too large. */
+	uint64_t GetNumberOfMisses() const								{ return nummisses; }
+
+	/** Returns the fraction of requests that could be served from the pool. */
+	double GetHitRatio() const										{ return (numhits+nummisses == 0)?0:((double)numhits/(double)(numhits+nummisses)); }
+private:
+	size_t numbuffers, buffersize, numinuse;
+	uint64_t numhits, nummisses;
+
+	friend class RTPReceiveBufferPool;
+};
+
+/** Each buffer in an RTPReceiveBufferPool starts at a multiple of this number of bytes. */
+#define RTPRECEIVEBUFFERPOOL_ALIGNMENT									16
+
+/** A pool of fixed size buffers to store incoming packets in.
+ *  Instead of allocating memory for each packet that's received, a transmission
+ *  component can take a buffer from this pool and, if the size of the packet is known
+ *  in advance, read the packet into it directly. The RTPRawPacket which stores the data
+ *  remembers the pool, and the buffer is returned to it when the packet (or the RTPPacket
+ *  or RTCPCompoundPacket it was turned into) is deleted. If no buffer is available, or if
+ *  the packet is too large, memory is allocated using the memory manager instead; this
+ *  is recorded as a miss in the statistics.
+ *
+ *  Since packets can still exist after the transmitter and session that received them
+ *  are gone, the pool uses reference counting: it is created with one reference, each
+ *  component that keeps a pointer to it calls RTPReceiveBufferPool::AddReference and
+ *  RTPReceiveBufferPool::Release, and the pool deletes itself when the last reference is
+ *  released and no more buffers are in use. For this reason an instance must always be
+ *  allocated using RTPNew (or \c new if no memory manager is used) and must never be
+ *  deleted directly.
+ */
+class JRTPLIB_IMPORTEXPORT RTPReceiveBufferPool : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPReceiveBufferPool)
+public:
+	RTPReceiveBufferPool(RTPMemoryManager *mgr = 0);
+	~RTPReceiveBufferPool();
+
+	/** Allocates \c numbuffers buffers of \c buffersize bytes each; if \c threadsafe is
+	 *  \c true, buffers can be obtained and released from different threads. */
+	int Create(size_t numbuffers, size_t buffersize, bool threadsafe);
+
+	/** Returns the size of each buffer in the pool. */
+	size_t GetBufferSize() const									{ return buffersize; }
+
+	/** Returns a buffer that can store at least \c len bytes, taken from the pool if possible.
+	 *  The \c rtp flag is only used to select the memory type when memory needs to be
+	 *  allocated. The buffer must be passed to RTPReceiveBufferPool::ReleaseBuffer when
+	 *  it's no longer needed. Returns null if no memory could be allocated. */
+	uint8_t *GetBuffer(size_t len, bool rtp);
+
+	/** Returns a buffer that was obtained using RTPReceiveBufferPool::GetBuffer. */
+	void ReleaseBuffer(uint8_t *buf);
+
+	/** Registers an additional user of the pool. */
+	void AddReference();
+
+	/** Unregisters a user of the pool; the instance may be deleted by this call. */
+	void Release();
+
+	/** Stores the current statistics in \c stats. */
+	void GetStatistics(RTPReceiveBufferPoolStatistics &stats);
+
+	/** Resets the hit and miss counters. */
+	void ClearStatistics();
+private:
+	bool IsPoolBuffer(const uint8_t *buf) const						{ return (buf >= memblock && buf < memblock + numbuffers*bufferstride); }
+	void Lock();
+	void Unlock();
+
+	uint8_t *memblock;
+	size_t numbuffers, buffersize, bufferstride;
+	std::vector<uint8_t *> freebuffers;
+	size_t numoutstanding, refcount;
+	uint64_t numhits, nummisses;
+#ifdef RTP_SUPPORT_THREAD
+	jthread::JMutex mutex;
+	bool threadsafe;
+#endif // RTP_SUPPORT_THREAD
+};
+
+} // end namespace
+
+#endif // RTPRECEIVEBUFFERPOOL_H
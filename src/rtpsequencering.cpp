@@ -0,0 +1,191 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpsequencering.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+#include <string.h>
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPSequenceRing::RTPSequenceRing(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	slots = 0;
+	capacity = 0;
+	mask = 0;
+	firstseqnr = 0;
+	lastseqnr = 0;
+	numpackets = 0;
+}
+
+RTPSequenceRing::~RTPSequenceRing()
+{
+	Clear();
+}
+
+uint32_t RTPSequenceRing::GetWindowSize(size_t size)
+{
+	uint32_t w = 1;
+
+	while (w < size && w < (((uint32_t)1) << RTPSEQUENCERING_MAXWINDOWBITS))
+		w <<= 1;
+	return w;
+}
+
+int RTPSequenceRing::Insert(RTPPacket *p, uint32_t windowsize, bool *stored)
+{
+	uint32_t seqnr = p->GetExtendedSequenceNumber();
+	int status;
+
+	*stored = false;
+
+	// Differences are interpreted as signed values, so that the extended
+	// sequence numbers may wrap around
+	if (numpackets != 0)
+	{
+		if ((int32_t)(seqnr-firstseqnr) < 0)
+		{
+			uint32_t span = lastseqnr-seqnr+1;
+
+			if (span > windowsize)
+				return 0;
+			if (span > capacity)
+			{
+				if ((status = Resize(span)) < 0)
+					return status;
+			}
+			firstseqnr = seqnr;
+		}
+		else if ((int32_t)(seqnr-lastseqnr) > 0)
+		{
+			if (seqnr-firstseqnr+1 > windowsize)
+				DeleteBefore(seqnr-windowsize+1);
+		
+			if (numpackets != 0)
+			{
+				uint32_t span = seqnr-firstseqnr+1;
+
+				if (span > capacity)
+				{
+					if ((status = Resize(span)) < 0)
+						return status;
+				}
+				lastseqnr = seqnr;
+			}
+		}
+		else if (slots[seqnr&mask] != 0) // duplicate
+			return 0;
+	}
+
+	if (numpackets == 0)
+	{
+		if (capacity == 0)
+		{
+			if ((status = Resize((windowsize < RTPSEQUENCERING_INITIALSIZE)?windowsize:RTPSEQUENCERING_INITIALSIZE)) < 0)
+				return status;
+		}
+		firstseqnr = seqnr;
+		lastseqnr = seqnr;
+	}
+
+	slots[seqnr&mask] = p;
+	numpackets++;
+	*stored = true;
+	return 0;
+}
+
+void RTPSequenceRing::Clear()
+{
+	if (slots == 0)
+		return;
+
+	RTPPacket *p;
+
+	while ((p = Pop()) != 0)
+		RTPPacket::Delete(p,GetMemoryManager());
+
+	RTPDeleteByteArray((uint8_t *)slots,GetMemoryManager());
+	slots = 0;
+	capacity = 0;
+	mask = 0;
+}
+
+int RTPSequenceRing::Resize(uint32_t span)
+{
+	uint32_t newcapacity = (capacity == 0)?1:capacity;
+
+	while (newcapacity < span)
+		newcapacity <<= 1;
+
+	RTPPacket **newslots = (RTPPacket **)RTPNew(GetMemoryManager(),RTPMEM_TYPE_BUFFER_SEQUENCERING) uint8_t[(size_t)newcapacity*sizeof(RTPPacket *)];
+	if (newslots == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	uint32_t newmask = newcapacity-1;
+
+	memset(newslots,0,(size_t)newcapacity*sizeof(RTPPacket *));
+	if (numpackets != 0)
+	{
+		for (uint32_t s = firstseqnr ; s != lastseqnr+1 ; s++)
+			newslots[s&newmask] = slots[s&mask];
+	}
+	if (slots)
+		RTPDeleteByteArray((uint8_t *)slots,GetMemoryManager());
+
+	slots = newslots;
+	capacity = newcapacity;
+	mask = newmask;
+	return 0;
+}
+
+void RTPSequenceRing::DeleteBefore(uint32_t seqnr)
+{
+	while (numpackets != 0 && (int32_t)(seqnr-firstseqnr) > 0)
+	{
+		RTPPacket **s = &slots[firstseqnr&mask];
+
+		if (*s)
+		{
+			RTPPacket::Delete(*s,GetMemoryManager());
+			*s = 0;
+			numpackets--;
+		}
+		firstseqnr++;
+	}
+	SkipEmptySlots();
+}
+
+} // end namespace
+
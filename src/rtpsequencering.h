@@ -0,0 +1,133 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpsequencering.h
+ */
+
+#ifndef RTPSEQUENCERING_H
+
+#define RTPSEQUENCERING_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+
+// Number of slots that are allocated when the first packet is stored
+#define RTPSEQUENCERING_INITIALSIZE								16
+
+// The window size is limited to 2^RTPSEQUENCERING_MAXWINDOWBITS packets
+#define RTPSEQUENCERING_MAXWINDOWBITS							24
+
+namespace jrtplib
+{
+
+class RTPPacket;
+
+/** Stores RTP packets ordered by their extended sequence number.
+ *  The packets are kept in a ring of which the size is a power of two; a packet is stored in the
+ *  slot given by the low bits of its extended sequence number, so that storing it doesn't depend
+ *  on how far it arrived out of order, and a duplicate is noticed because its slot is already 
+ *  taken. The ring grows when needed, but the range of sequence numbers it spans is limited by
+ *  a window size: a packet that lies too far before the stored ones is refused, a packet that
+ *  lies too far after them causes the oldest packets to be deleted.
+ */
+class JRTPLIB_IMPORTEXPORT RTPSequenceRing : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPSequenceRing)
+public:
+	RTPSequenceRing(RTPMemoryManager *mgr = 0);
+	~RTPSequenceRing();
+
+	/** Rounds \c size up to a window size that can be passed to RTPSequenceRing::Insert. */
+	static uint32_t GetWindowSize(size_t size);
+
+	/** Stores \c p using its extended sequence number, so that the stored packets span at most 
+	 *  \c windowsize sequence numbers; \c windowsize must be a value returned by
+	 *  RTPSequenceRing::GetWindowSize. The flag \c stored is set to \c false if the packet is a
+	 *  duplicate or lies before the window, in which case the caller remains responsible for it.
+	 */
+	int Insert(RTPPacket *p, uint32_t windowsize, bool *stored);
+
+	/** Removes the packet with the lowest sequence number from the ring and returns it, or 
+	 *  returns null if the ring is empty. The packet must be deallocated using RTPPacket::Delete. */
+	RTPPacket *Pop();
+
+	/** Deletes all stored packets and releases the ring. */
+	void Clear();
+
+	/** Returns \c true if no packets are stored. */
+	bool IsEmpty() const											{ return numpackets == 0; }
+
+	/** Returns the number of stored packets. */
+	size_t GetNumberOfPackets() const								{ return numpackets; }
+
+	/** Returns the number of slots that are currently allocated. */
+	uint32_t GetCapacity() const									{ return capacity; }
+private:
+	int Resize(uint32_t span);
+	void DeleteBefore(uint32_t seqnr);
+	void SkipEmptySlots();
+
+	RTPPacket **slots;
+	uint32_t capacity, mask;
+	uint32_t firstseqnr, lastseqnr; // the slot of firstseqnr is always taken if the ring isn't empty
+	size_t numpackets;
+};
+
+inline RTPPacket *RTPSequenceRing::Pop()
+{
+	if (numpackets == 0)
+		return 0;
+
+	RTPPacket **s = &slots[firstseqnr&mask];
+	RTPPacket *p = *s;
+
+	*s = 0;
+	numpackets--;
+	firstseqnr++;
+	SkipEmptySlots();
+	return p;
+}
+
+inline void RTPSequenceRing::SkipEmptySlots()
+{
+	if (numpackets == 0)
+		return;
+	while (slots[firstseqnr&mask] == 0)
+		firstseqnr++;
+}
+
+} // end namespace
+
+#endif // RTPSEQUENCERING_H
+
@@ -36,10 +36,12 @@
 #include "rtpudpv4transmitter.h"
 #include "rtpudpv6transmitter.h"
 #include "rtptcptransmitter.h"
+#include "rtpiouringtransmitter.h"
 #include "rtpexternaltransmitter.h"
 #include "rtpsessionparams.h"
 #include "rtpdefines.h"
 #include "rtprawpacket.h"
+#include "rtpreceivebufferpool.h"
 #include "rtppacket.h"
 #include "rtptimeutilities.h"
 #include "rtpmemorymanager.h"
@@ -64,19 +66,25 @@
 #include "rtpdebug.h"
 
 #ifdef RTP_SUPPORT_THREAD
-	#define SOURCES_LOCK					{ if (needthreadsafety) sourcesmutex.Lock(); }
-	#define SOURCES_UNLOCK					{ if (needthreadsafety) sourcesmutex.Unlock(); }
-	#define BUILDER_LOCK					{ if (needthreadsafety) buildermutex.Lock(); }
-	#define BUILDER_UNLOCK					{ if (needthreadsafety) buildermutex.Unlock(); }
-	#define SCHED_LOCK						{ if (needthreadsafety) schedmutex.Lock(); }
-	#define SCHED_UNLOCK					{ if (needthreadsafety) schedmutex.Unlock(); }
-	#define PACKSENT_LOCK					{ if (needthreadsafety) packsentmutex.Lock(); }
-	#define PACKSENT_UNLOCK					{ if (needthreadsafety) packsentmutex.Unlock(); } 
+	#define SESSION_LOCK(m,h)				{ if (needthreadsafety) { m.Lock(); if (collectlockholdtimes) h.Start(); } }
+	#define SESSION_UNLOCK(m,h)				{ if (needthreadsafety) { if (collectlockholdtimes) h.Stop(); m.Unlock(); } }
+	#define SOURCES_LOCK					SESSION_LOCK(sourcesmutex,sourcesholdtimes)
+	#define SOURCES_UNLOCK					SESSION_UNLOCK(sourcesmutex,sourcesholdtimes)
+	#define BUILDER_LOCK					SESSION_LOCK(buildermutex,builderholdtimes)
+	#define BUILDER_UNLOCK					SESSION_UNLOCK(buildermutex,builderholdtimes)
+	#define RTCPBUILDER_LOCK				SESSION_LOCK(rtcpbuildermutex,rtcpbuilderholdtimes)
+	#define RTCPBUILDER_UNLOCK				SESSION_UNLOCK(rtcpbuildermutex,rtcpbuilderholdtimes)
+	#define SCHED_LOCK						SESSION_LOCK(schedmutex,schedholdtimes)
+	#define SCHED_UNLOCK					SESSION_UNLOCK(schedmutex,schedholdtimes)
+	#define PACKSENT_LOCK					SESSION_LOCK(packsentmutex,packsentholdtimes)
+	#define PACKSENT_UNLOCK					SESSION_UNLOCK(packsentmutex,packsentholdtimes)
 #else
 	#define SOURCES_LOCK
 	#define SOURCES_UNLOCK
 	#define BUILDER_LOCK
 	#define BUILDER_UNLOCK
+	#define RTCPBUILDER_LOCK
+	#define RTCPBUILDER_UNLOCK
 	#define SCHED_LOCK
 	#define SCHED_UNLOCK
 	#define PACKSENT_LOCK
@@ -87,8 +95,8 @@ namespace jrtplib
 {
 
 RTPSession::RTPSession(RTPRandom *r,RTPMemoryManager *mgr) 
-	: RTPMemoryObject(mgr),rtprnd(GetRandomNumberGenerator(r)),sources(*this,mgr),packetbuilder(*rtprnd,mgr),rtcpsched(sources,*rtprnd),
-	  rtcpbuilder(sources,packetbuilder,mgr),collisionlist(mgr)
+	: RTPMemoryObject(mgr),rtprnd(GetRandomNumberGenerator(r)),lastrtpsendtime(0,0),sources(*this,mgr),packetbuilder(*rtprnd,mgr),rtcpsched(sources,*rtprnd),
+	  rtcpbuilder(sources,packetbuilder,mgr),collisionlist(mgr),deliveryqueue(mgr)
 {
 	// We're not going to set these flags in Create, so that the constructor of a derived class
 	// can already change them
@@ -96,6 +104,12 @@ RTPSession::RTPSession(RTPRandom *r,RTPMemoryManager *mgr)
 	m_changeOutgoingData = false;
 
 	created = false;
+	bufferpool = 0;
+	datareadypending = false;
+	dropondeliveryoverflow = true;
+#ifdef RTP_SUPPORT_THREAD
+	collectlockholdtimes = false;
+#endif // RTP_SUPPORT_THREAD
 	timeinit.Dummy();
 
 	//std::cout << (void *)(rtprnd) << std::endl;
@@ -124,6 +138,7 @@ int RTPSession::Create(const RTPSessionParams &sessparams,const RTPTransmissionP
 
 	useSR_BYEifpossible = sessparams.GetSenderReportForBYE();
 	sentpackets = false;
+	sentrtppackets = false;
 	
 	// Check max packet size
 	
@@ -154,6 +169,11 @@ int RTPSession::Create(const RTPSessionParams &sessparams,const RTPTransmissionP
 	case RTPTransmitter::TCPProto:
 		rtptrans = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPTRANSMITTER) RTPTCPTransmitter(GetMemoryManager());
 		break;
+#ifdef RTP_SUPPORT_IOURING
+	case RTPTransmitter::IoUringProto:
+		rtptrans = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPTRANSMITTER) RTPIoUringTransmitter(GetMemoryManager());
+		break;
+#endif // RTP_SUPPORT_IOURING
 	default:
 		return ERR_RTP_SESSION_UNSUPPORTEDTRANSMISSIONPROTOCOL;
 	}
@@ -189,6 +209,7 @@ int RTPSession::Create(const RTPSessionParams &sessparams,RTPTransmitter *transm
 
 	useSR_BYEifpossible = sessparams.GetSenderReportForBYE();
 	sentpackets = false;
+	sentrtppackets = false;
 	
 	// Check max packet size
 	
@@ -227,6 +248,8 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 
 #endif // RTP_SUPPORT_PROBATION
 
+	sources.SetPacketWindowSize(sessparams.GetPacketWindowSize());
+
 	// Add our own ssrc to the source table
 	
 	if ((status = sources.CreateOwnSSRC(packetbuilder.GetSSRC())) < 0)
@@ -333,16 +356,75 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 	collisionmultiplier = sessparams.GetCollisionTimeoutMultiplier();
 	notemultiplier = sessparams.GetNoteTimeoutMultiplier();
 
+	// Create the descriptor for data ready notifications if requested
+
+	datareadypending = false;
+	if (sessparams.GetUseDataReadyNotification())
+	{
+		if ((status = datareadynotifier.Init()) < 0)
+		{
+			if (deletetransmitter)
+				RTPDelete(rtptrans,GetMemoryManager());
+			packetbuilder.Destroy();
+			sources.Clear();
+			rtcpbuilder.Destroy();
+			return status;
+		}
+	}
+
+	// Create the queue in which packets are delivered to the application if requested
+
+	dropondeliveryoverflow = (sessparams.GetDeliveryQueueOverflowPolicy() == RTPSessionParams::DropNewPacket);
+	if (sessparams.GetDeliveryQueueSize() > 0)
+	{
+		if ((status = deliveryqueue.Create(sessparams.GetDeliveryQueueSize())) < 0)
+		{
+			datareadynotifier.Destroy();
+			if (deletetransmitter)
+				RTPDelete(rtptrans,GetMemoryManager());
+			packetbuilder.Destroy();
+			sources.Clear();
+			rtcpbuilder.Destroy();
+			return status;
+		}
+	}
+
+	// Create the pool for incoming packets if requested
+	
+	if ((status = CreateReceiveBufferPool(sessparams)) < 0)
+	{
+		deliveryqueue.Destroy();
+		datareadynotifier.Destroy();
+		if (deletetransmitter)
+			RTPDelete(rtptrans,GetMemoryManager());
+		packetbuilder.Destroy();
+		sources.Clear();
+		rtcpbuilder.Destroy();
+		return status;
+	}
+
 	// Do thread stuff if necessary
 	
 #ifdef RTP_SUPPORT_THREAD
 	pollthread = 0;
-	if (usingpollthread)
+	collectlockholdtimes = (needthreadsafety && sessparams.GetCollectLockHoldTimes());
+	sourcesholdtimes.Reset();
+	builderholdtimes.Reset();
+	rtcpbuilderholdtimes.Reset();
+	schedholdtimes.Reset();
+	packsentholdtimes.Reset();
+
+	// The mutexes are also needed when the session is driven by another thread
+	// than its own poll thread, e.g. by an RTPReactor
+	if (needthreadsafety)
 	{
 		if (!sourcesmutex.IsInitialized())	
 		{
 			if (sourcesmutex.Init() < 0)
 			{
+				DestroyReceiveBufferPool();
+				deliveryqueue.Destroy();
+				datareadynotifier.Destroy();
 				if (deletetransmitter)
 					RTPDelete(rtptrans,GetMemoryManager());
 				packetbuilder.Destroy();
@@ -355,6 +437,24 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 		{
 			if (buildermutex.Init() < 0)
 			{
+				DestroyReceiveBufferPool();
+				deliveryqueue.Destroy();
+				datareadynotifier.Destroy();
+				if (deletetransmitter)
+					RTPDelete(rtptrans,GetMemoryManager());
+				packetbuilder.Destroy();
+				sources.Clear();
+				rtcpbuilder.Destroy();
+				return ERR_RTP_SESSION_CANTINITMUTEX;
+			}
+		}
+		if (!rtcpbuildermutex.IsInitialized())
+		{
+			if (rtcpbuildermutex.Init() < 0)
+			{
+				DestroyReceiveBufferPool();
+				deliveryqueue.Destroy();
+				datareadynotifier.Destroy();
 				if (deletetransmitter)
 					RTPDelete(rtptrans,GetMemoryManager());
 				packetbuilder.Destroy();
@@ -367,6 +467,9 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 		{
 			if (schedmutex.Init() < 0)
 			{
+				DestroyReceiveBufferPool();
+				deliveryqueue.Destroy();
+				datareadynotifier.Destroy();
 				if (deletetransmitter)
 					RTPDelete(rtptrans,GetMemoryManager());
 				packetbuilder.Destroy();
@@ -379,6 +482,9 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 		{
 			if (packsentmutex.Init() < 0)
 			{
+				DestroyReceiveBufferPool();
+				deliveryqueue.Destroy();
+				datareadynotifier.Destroy();
 				if (deletetransmitter)
 					RTPDelete(rtptrans,GetMemoryManager());
 				packetbuilder.Destroy();
@@ -387,10 +493,15 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 				return ERR_RTP_SESSION_CANTINITMUTEX;
 			}
 		}
-		
+	}
+	if (usingpollthread)
+	{
 		pollthread = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPPOLLTHREAD) RTPPollThread(*this,rtcpsched);
 		if (pollthread == 0)
 		{
+			DestroyReceiveBufferPool();
+			deliveryqueue.Destroy();
+			datareadynotifier.Destroy();
 			if (deletetransmitter)
 				RTPDelete(rtptrans,GetMemoryManager());
 			packetbuilder.Destroy();
@@ -400,6 +511,9 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 		}
 		if ((status = pollthread->Start(rtptrans)) < 0)
 		{
+			DestroyReceiveBufferPool();
+			deliveryqueue.Destroy();
+			datareadynotifier.Destroy();
 			if (deletetransmitter)
 				RTPDelete(rtptrans,GetMemoryManager());
 			RTPDelete(pollthread,GetMemoryManager());
@@ -415,6 +529,48 @@ int RTPSession::InternalCreate(const RTPSessionParams &sessparams)
 	return 0;
 }
 
+int RTPSession::CreateReceiveBufferPool(const RTPSessionParams &sessparams)
+{
+	bufferpool = 0;
+	if (sessparams.GetReceiveBufferPoolSize() == 0)
+		return 0;
+
+	size_t buffersize = sessparams.GetReceiveBufferPoolBufferSize();
+	int status;
+
+	if (buffersize == 0)
+		buffersize = maxpacksize;
+	buffersize += RTPPacket::GetEmbeddedSize(); // the RTPPacket instance is stored in front of the data
+
+	bufferpool = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RECEIVEBUFFERPOOL) RTPReceiveBufferPool(GetMemoryManager());
+	if (bufferpool == 0)
+		return ERR_RTP_OUTOFMEM;
+	if ((status = bufferpool->Create(sessparams.GetReceiveBufferPoolSize(),buffersize,needthreadsafety)) < 0)
+	{
+		bufferpool->Release();
+		bufferpool = 0;
+		return status;
+	}
+	if ((status = rtptrans->SetReceiveBufferPool(bufferpool)) < 0)
+	{
+		bufferpool->Release();
+		bufferpool = 0;
+		return status;
+	}
+	return 0;
+}
+
+void RTPSession::DestroyReceiveBufferPool()
+{
+	if (bufferpool == 0)
+		return;
+
+	// Packets that are still stored somewhere keep the pool alive
+	rtptrans->SetReceiveBufferPool(0);
+	bufferpool->Release();
+	bufferpool = 0;
+}
+
 
 void RTPSession::Destroy()
 {
@@ -426,6 +582,9 @@ void RTPSession::Destroy()
 		RTPDelete(pollthread,GetMemoryManager());
 #endif // RTP_SUPPORT_THREAD
 	
+	DestroyReceiveBufferPool();
+	deliveryqueue.Destroy();
+	datareadynotifier.Destroy();
 	if (deletetransmitter)
 		RTPDelete(rtptrans,GetMemoryManager());
 	packetbuilder.Destroy();
@@ -462,6 +621,7 @@ void RTPSession::BYEDestroy(const RTPTime &maxwaittime,const void *reason,size_t
 
 	RTCPCompoundPacket *pack;
 
+	UpdateOwnSenderInfo();
 	if (sentpackets)
 	{
 		int status;
@@ -508,6 +668,9 @@ void RTPSession::BYEDestroy(const RTPTime &maxwaittime,const void *reason,size_t
 		}
 	}
 	
+	DestroyReceiveBufferPool();
+	deliveryqueue.Destroy();
+	datareadynotifier.Destroy();
 	if (deletetransmitter)
 		RTPDelete(rtptrans,GetMemoryManager());
 	packetbuilder.Destroy();
@@ -565,6 +728,20 @@ void RTPSession::ClearDestinations()
 	rtptrans->ClearDestinations();
 }
 
+int RTPSession::AddDestinations(const RTPAddress * const *addresses,size_t numaddresses)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	return rtptrans->AddDestinations(addresses,numaddresses);
+}
+
+int RTPSession::DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	return rtptrans->DeleteDestinations(addresses,numaddresses);
+}
+
 bool RTPSession::SupportsMulticasting()
 {
 	if (!created)
@@ -613,12 +790,7 @@ int RTPSession::SendPacket(const void *data,size_t len)
 	}
 	BUILDER_UNLOCK
 
-	SOURCES_LOCK
-	sources.SentRTPPacket();
-	SOURCES_UNLOCK
-	PACKSENT_LOCK
-	sentpackets = true;
-	PACKSENT_UNLOCK
+	MarkRTPPacketSent();
 	return 0;
 }
 
@@ -643,12 +815,7 @@ int RTPSession::SendPacket(const void *data,size_t len,
 	}
 	BUILDER_UNLOCK
 	
-	SOURCES_LOCK
-	sources.SentRTPPacket();
-	SOURCES_UNLOCK
-	PACKSENT_LOCK
-	sentpackets = true;
-	PACKSENT_UNLOCK
+	MarkRTPPacketSent();
 	return 0;
 }
 
@@ -673,12 +840,7 @@ int RTPSession::SendPacketEx(const void *data,size_t len,
 	}
 	BUILDER_UNLOCK
 
-	SOURCES_LOCK
-	sources.SentRTPPacket();
-	SOURCES_UNLOCK
-	PACKSENT_LOCK
-	sentpackets = true;
-	PACKSENT_UNLOCK
+	MarkRTPPacketSent();
 	return 0;
 }
 
@@ -704,12 +866,7 @@ int RTPSession::SendPacketEx(const void *data,size_t len,
 	}
 	BUILDER_UNLOCK
 
-	SOURCES_LOCK
-	sources.SentRTPPacket();
-	SOURCES_UNLOCK
-	PACKSENT_LOCK
-	sentpackets = true;
-	PACKSENT_UNLOCK
+	MarkRTPPacketSent();
 	return 0;
 }
 
@@ -741,16 +898,16 @@ int RTPSession::SendRTCPAPPPacket(uint8_t subtype, const uint8_t name[4], const
 	if ((status = pb.AddSDESSource(ssrc)) < 0)
 		return status;
 	
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	size_t owncnamelen = 0;
 	uint8_t *owncname = rtcpbuilder.GetLocalCNAME(&owncnamelen);
 
 	if ((status = pb.AddSDESNormalItem(RTCPSDESPacket::CNAME,owncname,owncnamelen)) < 0)
 	{
-		BUILDER_UNLOCK
+		RTCPBUILDER_UNLOCK
 		return status;
 	}
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	
 	//add our application specific packet
 	if((status = pb.AddAPPPacket(subtype, ssrc, name, appdata, appdatalen)) < 0)
@@ -843,17 +1000,17 @@ int RTPSession::SendUnknownPacket(bool sr, uint8_t payload_type, uint8_t subtype
 		return status;
 	}
 	
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	size_t owncnamelen = 0;
 	uint8_t *owncname = rtcpbuilder.GetLocalCNAME(&owncnamelen);
 
 	if ((status = rtcpcomppack->AddSDESNormalItem(RTCPSDESPacket::CNAME,owncname,owncnamelen)) < 0)
 	{
-		BUILDER_UNLOCK
+		RTCPBUILDER_UNLOCK
 		RTPDelete(rtcpcomppack,GetMemoryManager());
 		return status;
 	}
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	
 	//add our packet
 	if((status = rtcpcomppack->AddUnknownPacket(payload_type, subtype, ssrc, data, len)) < 0)
@@ -976,9 +1133,9 @@ int RTPSession::SetPreTransmissionDelay(const RTPTime &delay)
 
 	int status;
 
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetPreTransmissionDelay(delay);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -996,6 +1153,16 @@ void RTPSession::DeleteTransmissionInfo(RTPTransmissionInfo *inf)
 	rtptrans->DeleteTransmissionInfo(inf);
 }
 
+int RTPSession::GetReceiveBufferPoolStatistics(RTPReceiveBufferPoolStatistics &stats)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	if (bufferpool == 0)
+		return ERR_RTP_SESSION_NORECEIVEBUFFERPOOL;
+	bufferpool->GetStatistics(stats);
+	return 0;
+}
+
 int RTPSession::Poll()
 {
 	int status;
@@ -1027,6 +1194,135 @@ int RTPSession::AbortWait()
 	return rtptrans->AbortWait();
 }
 
+int RTPSession::GetReceiveSockets(SocketType *sockets,size_t *numsockets)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	if (usingpollthread)
+		return ERR_RTP_SESSION_USINGPOLLTHREAD;
+	return rtptrans->GetReceiveSockets(sockets,numsockets);
+}
+
+RTPTime RTPSession::GetNextDeadline()
+{
+	if (!created)
+		return RTPTime(0,0);
+	if (usingpollthread)
+		return RTPTime(0,0);
+
+	RTPTime t = RTPTime::CurrentTime();
+
+	t += GetRTCPTransmissionDelay();
+	return t;
+}
+
+int RTPSession::Step(const RTPTime &now)
+{
+	int status;
+	
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	if (usingpollthread)
+		return ERR_RTP_SESSION_USINGPOLLTHREAD;
+	if ((status = rtptrans->Poll()) < 0)
+		return status;
+	return ProcessPolledData(now);
+}
+
+int RTPSession::GetDataReadyDescriptor(SocketType *desc)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	if (!datareadynotifier.IsInitialized())
+		return ERR_RTP_SESSION_NODATAREADYNOTIFICATION;
+	*desc = datareadynotifier.GetDescriptor();
+	return 0;
+}
+
+int RTPSession::ClearDataReadyNotification()
+{
+	int status;
+
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	if (!datareadynotifier.IsInitialized())
+		return ERR_RTP_SESSION_NODATAREADYNOTIFICATION;
+
+	SOURCES_LOCK
+	datareadypending = false;
+	status = datareadynotifier.Clear();
+	SOURCES_UNLOCK
+	return status;
+}
+
+RTPPacket *RTPSession::GetDeliveredPacket()
+{
+	if (!created)
+		return 0;
+	if (!deliveryqueue.IsCreated())
+		return 0;
+	return deliveryqueue.Pop();
+}
+
+int RTPSession::GetDeliveryQueueCounters(uint64_t *numdelivered, uint64_t *numoverflows)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+	if (!deliveryqueue.IsCreated())
+		return ERR_RTP_SESSION_NODELIVERYQUEUE;
+	*numdelivered = deliveryqueue.GetNumberOfPushedPackets();
+	*numoverflows = deliveryqueue.GetNumberOfRejectedPackets();
+	return 0;
+}
+
+int RTPSession::GetLockHoldTimes(SessionLock l, RTPHoldTimeHistogram &hist)
+{
+	if (!created)
+		return ERR_RTP_SESSION_NOTCREATED;
+#ifndef RTP_SUPPORT_THREAD
+	JRTPLIB_UNUSED(l);
+	JRTPLIB_UNUSED(hist);
+	return ERR_RTP_SESSION_NOLOCKHOLDTIMES;
+#else
+	if (!collectlockholdtimes)
+		return ERR_RTP_SESSION_NOLOCKHOLDTIMES;
+
+	// The histogram is only changed while the lock it describes is held; the lock is
+	// taken directly to avoid measuring this call as well
+	switch (l)
+	{
+	case SourcesLock:
+		sourcesmutex.Lock();
+		hist = sourcesholdtimes;
+		sourcesmutex.Unlock();
+		break;
+	case PacketBuilderLock:
+		buildermutex.Lock();
+		hist = builderholdtimes;
+		buildermutex.Unlock();
+		break;
+	case RTCPBuilderLock:
+		rtcpbuildermutex.Lock();
+		hist = rtcpbuilderholdtimes;
+		rtcpbuildermutex.Unlock();
+		break;
+	case SchedulerLock:
+		schedmutex.Lock();
+		hist = schedholdtimes;
+		schedmutex.Unlock();
+		break;
+	case PacketSentLock:
+		packsentmutex.Lock();
+		hist = packsentholdtimes;
+		packsentmutex.Unlock();
+		break;
+	default:
+		return ERR_RTP_SESSION_NOLOCKHOLDTIMES;
+	}
+	return 0;
+#endif // RTP_SUPPORT_THREAD
+}
+
 RTPTime RTPSession::GetRTCPDelay()
 {
 	if (!created)
@@ -1034,7 +1330,13 @@ RTPTime RTPSession::GetRTCPDelay()
 	if (usingpollthread)
 		return RTPTime(0,0);
 
+	return GetRTCPTransmissionDelay();
+}
+
+RTPTime RTPSession::GetRTCPTransmissionDelay()
+{
 	SOURCES_LOCK
+	UpdateOwnSenderInfo();
 	SCHED_LOCK
 	RTPTime t = rtcpsched.GetTransmissionDelay();
 	SCHED_UNLOCK
@@ -1042,11 +1344,41 @@ RTPTime RTPSession::GetRTCPDelay()
 	return t;
 }
 
+void RTPSession::MarkRTPPacketSent()
+{
+	// Only record the send here; the own entry in the source table is brought up to date
+	// by UpdateOwnSenderInfo before it is used, so a sender never has to wait for the
+	// sources lock while a poll step is building an RTCP packet
+
+	RTPTime sendtime = RTPTime::CurrentTime();
+
+	PACKSENT_LOCK
+	sentpackets = true;
+	sentrtppackets = true;
+	lastrtpsendtime = sendtime;
+	PACKSENT_UNLOCK
+}
+
+void RTPSession::UpdateOwnSenderInfo()
+{
+	// Must be called with the sources lock held
+
+	PACKSENT_LOCK
+	bool hassent = sentrtppackets;
+	RTPTime sendtime = lastrtpsendtime;
+	sentrtppackets = false;
+	PACKSENT_UNLOCK
+
+	if (hassent)
+		sources.SentRTPPacket(sendtime);
+}
+
 int RTPSession::BeginDataAccess()
 {
 	if (!created)
 		return ERR_RTP_SESSION_NOTCREATED;
 	SOURCES_LOCK
+	UpdateOwnSenderInfo();
 	return 0;
 }
 
@@ -1120,7 +1452,7 @@ uint16_t RTPSession::GetNextSequenceNumber() const
 
 void RTPSession::DeletePacket(RTPPacket *p)
 {
-	RTPDelete(p,GetMemoryManager());
+	RTPPacket::Delete(p,GetMemoryManager());
 }
 
 int RTPSession::EndDataAccess()
@@ -1193,10 +1525,12 @@ int RTPSession::SetMaximumPacketSize(size_t s)
 	if ((status = rtptrans->SetMaximumPacketSize(s)) < 0)
 		return status;
 
+	RTCPBUILDER_LOCK
 	BUILDER_LOCK
 	if ((status = packetbuilder.SetMaximumPacketSize(s)) < 0)
 	{
 		BUILDER_UNLOCK
+		RTCPBUILDER_UNLOCK
 		// restore previous max packet size
 		rtptrans->SetMaximumPacketSize(maxpacksize);
 		return status;
@@ -1206,10 +1540,12 @@ int RTPSession::SetMaximumPacketSize(size_t s)
 		// restore previous max packet size
 		packetbuilder.SetMaximumPacketSize(maxpacksize);
 		BUILDER_UNLOCK
+		RTCPBUILDER_UNLOCK
 		rtptrans->SetMaximumPacketSize(maxpacksize);
 		return status;
 	}
 	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	maxpacksize = s;
 	return 0;
 }
@@ -1239,9 +1575,9 @@ int RTPSession::SetTimestampUnit(double u)
 
 	int status;
 
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetTimestampUnit(u);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -1249,54 +1585,54 @@ void RTPSession::SetNameInterval(int count)
 {
 	if (!created)
 		return;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	rtcpbuilder.SetNameInterval(count);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 }
 
 void RTPSession::SetEMailInterval(int count)
 {
 	if (!created)
 		return;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	rtcpbuilder.SetEMailInterval(count);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 }
 
 void RTPSession::SetLocationInterval(int count)
 {
 	if (!created)
 		return;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	rtcpbuilder.SetLocationInterval(count);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 }
 
 void RTPSession::SetPhoneInterval(int count)
 {
 	if (!created)
 		return;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	rtcpbuilder.SetPhoneInterval(count);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 }
 
 void RTPSession::SetToolInterval(int count)
 {
 	if (!created)
 		return;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	rtcpbuilder.SetToolInterval(count);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 }
 
 void RTPSession::SetNoteInterval(int count)
 {
 	if (!created)
 		return;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	rtcpbuilder.SetNoteInterval(count);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 }
 
 int RTPSession::SetLocalName(const void *s,size_t len)
@@ -1305,9 +1641,9 @@ int RTPSession::SetLocalName(const void *s,size_t len)
 		return ERR_RTP_SESSION_NOTCREATED;
 
 	int status;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetLocalName(s,len);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -1317,9 +1653,9 @@ int RTPSession::SetLocalEMail(const void *s,size_t len)
 		return ERR_RTP_SESSION_NOTCREATED;
 
 	int status;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetLocalEMail(s,len);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -1329,9 +1665,9 @@ int RTPSession::SetLocalLocation(const void *s,size_t len)
 		return ERR_RTP_SESSION_NOTCREATED;
 
 	int status;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetLocalLocation(s,len);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -1341,9 +1677,9 @@ int RTPSession::SetLocalPhone(const void *s,size_t len)
 		return ERR_RTP_SESSION_NOTCREATED;
 
 	int status;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetLocalPhone(s,len);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -1353,9 +1689,9 @@ int RTPSession::SetLocalTool(const void *s,size_t len)
 		return ERR_RTP_SESSION_NOTCREATED;
 
 	int status;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetLocalTool(s,len);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
@@ -1365,18 +1701,23 @@ int RTPSession::SetLocalNote(const void *s,size_t len)
 		return ERR_RTP_SESSION_NOTCREATED;
 
 	int status;
-	BUILDER_LOCK
+	RTCPBUILDER_LOCK
 	status = rtcpbuilder.SetLocalNote(s,len);
-	BUILDER_UNLOCK
+	RTCPBUILDER_UNLOCK
 	return status;
 }
 
-int RTPSession::ProcessPolledData()
+int RTPSession::ProcessPolledData(const RTPTime &now)
 {
 	RTPRawPacket *rawpack;
 	int status;
 	
+	// First phase: process the packets that were received, which only needs the source table;
+	// the other locks are only taken briefly when a collision must be handled
+
 	SOURCES_LOCK
+	UpdateOwnSenderInfo();
+	sources.ClearNewPacketCount();
 	while ((rawpack = rtptrans->GetNextPacket()) != 0)
 	{
 		if (m_changeIncomingData)
@@ -1427,15 +1768,18 @@ int RTPSession::ProcessPolledData()
 					
 					RTCPCompoundPacket *rtcpcomppack;
 
+					RTCPBUILDER_LOCK
 					BUILDER_LOCK
 					if ((status = rtcpbuilder.BuildBYEPacket(&rtcpcomppack,0,0,useSR_BYEifpossible)) < 0)
 					{
 						BUILDER_UNLOCK
+						RTCPBUILDER_UNLOCK
 						SOURCES_UNLOCK
 						RTPDelete(rawpack,GetMemoryManager());
 						return status;
 					}
 					BUILDER_UNLOCK
+					RTCPBUILDER_UNLOCK
 
 					byepackets.push_back(rtcpcomppack);
 					if (byepackets.size() == 1) // was the first packet, schedule a BYE packet (otherwise there's already one scheduled)
@@ -1454,6 +1798,7 @@ int RTPSession::ProcessPolledData()
 					
 				PACKSENT_LOCK
 				sentpackets = false;
+				sentrtppackets = false;
 				PACKSENT_UNLOCK
 	
 				// remove old entry in source table and add new one
@@ -1475,11 +1820,25 @@ int RTPSession::ProcessPolledData()
 		RTPDelete(rawpack,GetMemoryManager());
 	}
 
+	// Signal the descriptor only once until the application clears it again
+	size_t numnewpackets = sources.GetNewPacketCount();
+
+	if (numnewpackets > 0 && datareadynotifier.IsInitialized() && !datareadypending)
+	{
+		datareadypending = true;
+		datareadynotifier.Signal();
+	}
+	SOURCES_UNLOCK
+
+	// Second phase: check for timeouts, which only needs the source table (and the scheduler
+	// to calculate the interval on which the timeouts are based)
+
+	SOURCES_LOCK
+	UpdateOwnSenderInfo();
 	SCHED_LOCK
 	RTPTime d = rtcpsched.CalculateDeterministicInterval(false);
 	SCHED_UNLOCK
 	
-	RTPTime t = RTPTime::CurrentTime();
 	double Td = d.GetDouble();
 	RTPTime sendertimeout = RTPTime(Td*sendermultiplier);
 	RTPTime generaltimeout = RTPTime(Td*membermultiplier);
@@ -1487,69 +1846,79 @@ int RTPSession::ProcessPolledData()
 	RTPTime colltimeout = RTPTime(Td*collisionmultiplier);
 	RTPTime notetimeout = RTPTime(Td*notemultiplier);
 	
-	sources.MultipleTimeouts(t,sendertimeout,byetimeout,generaltimeout,notetimeout);
-	collisionlist.Timeout(t,colltimeout);
+	sources.MultipleTimeouts(now,sendertimeout,byetimeout,generaltimeout,notetimeout);
+	collisionlist.Timeout(now,colltimeout);
+	SOURCES_UNLOCK
 	
-	// We'll check if it's time for RTCP stuff
+	// Third phase: check if it's time for RTCP stuff. Building the compound packet needs
+	// the source table and the RTCP packet builder; of the RTP packet builder only a copy of
+	// the sender information is used, so that sending RTP packets isn't blocked meanwhile.
+	// The packet is sent after all locks have been released; the source table is locked
+	// again for RTPSession::OnSendRTCPCompoundPacket.
 
+	RTCPCompoundPacket *pack = 0;
+	bool isbye = false;
+
+	SOURCES_LOCK
+	UpdateOwnSenderInfo();
 	SCHED_LOCK
 	bool istime = rtcpsched.IsTime();
 	SCHED_UNLOCK
 	
 	if (istime)
 	{
-		RTCPCompoundPacket *pack;
-	
 		// we'll check if there's a bye packet to send, or just a normal packet
 
 		if (byepackets.empty())
 		{
+			RTCPPacketBuilder::SenderInfo senderinfo;
+
 			BUILDER_LOCK
-			if ((status = rtcpbuilder.BuildNextPacket(&pack)) < 0)
-			{
-				BUILDER_UNLOCK
-				SOURCES_UNLOCK
-				return status;
-			}
+			rtcpbuilder.GetSenderInfo(senderinfo);
 			BUILDER_UNLOCK
-			if ((status = SendRTCPData(pack->GetCompoundPacketData(),pack->GetCompoundPacketLength())) < 0)
+
+			RTCPBUILDER_LOCK
+			if ((status = rtcpbuilder.BuildNextPacket(&pack,senderinfo)) < 0)
 			{
+				RTCPBUILDER_UNLOCK
 				SOURCES_UNLOCK
-				RTPDelete(pack,GetMemoryManager());
 				return status;
 			}
-		
-			PACKSENT_LOCK
-			sentpackets = true;
-			PACKSENT_UNLOCK
-
-			OnSendRTCPCompoundPacket(pack); // we'll place this after the actual send to avoid tampering
+			RTCPBUILDER_UNLOCK
 		}
 		else
 		{
 			pack = *(byepackets.begin());
 			byepackets.pop_front();
-			
-			if ((status = SendRTCPData(pack->GetCompoundPacketData(),pack->GetCompoundPacketLength())) < 0)
-			{
-				SOURCES_UNLOCK
-				RTPDelete(pack,GetMemoryManager());
-				return status;
-			}
-			
-			PACKSENT_LOCK
-			sentpackets = true;
-			PACKSENT_UNLOCK
+			isbye = true;
+		}
+	}
+	SOURCES_UNLOCK
 
-			OnSendRTCPCompoundPacket(pack); // we'll place this after the actual send to avoid tampering
-			
-			if (!byepackets.empty()) // more bye packets to send, schedule them
-			{
-				SCHED_LOCK
-				rtcpsched.ScheduleBYEPacket((*(byepackets.begin()))->GetCompoundPacketLength());
-				SCHED_UNLOCK
-			}
+	if (istime)
+	{
+		if ((status = SendRTCPData(pack->GetCompoundPacketData(),pack->GetCompoundPacketLength())) < 0)
+		{
+			RTPDelete(pack,GetMemoryManager());
+			return status;
+		}
+	
+		PACKSENT_LOCK
+		sentpackets = true;
+		PACKSENT_UNLOCK
+
+		// The callback runs with the source table locked, as it always has, so that an
+		// implementation can still inspect the sources; the send itself didn't need the lock
+		SOURCES_LOCK
+		OnSendRTCPCompoundPacket(pack); // we'll place this after the actual send to avoid tampering
+		
+		if (isbye && !byepackets.empty()) // more bye packets to send, schedule them
+		{
+			SCHED_LOCK
+			rtcpsched.ScheduleBYEPacket((*(byepackets.begin()))->GetCompoundPacketLength());
+			SCHED_UNLOCK
 		}
+		SOURCES_UNLOCK
 		
 		SCHED_LOCK
 		rtcpsched.AnalyseOutgoing(*pack);
@@ -1557,7 +1926,9 @@ int RTPSession::ProcessPolledData()
 
 		RTPDelete(pack,GetMemoryManager());
 	}
-	SOURCES_UNLOCK
+
+	if (numnewpackets > 0)
+		OnDataReady(numnewpackets);
 	return 0;
 }
 
@@ -49,6 +49,9 @@
 #include "rtptimeutilities.h"
 #include "rtcpcompoundpacketbuilder.h"
 #include "rtpmemoryobject.h"
+#include "rtpeventnotifier.h"
+#include "rtppacketqueue.h"
+#include "rtpholdtimehistogram.h"
 #include <list>
 
 #ifdef RTP_SUPPORT_THREAD
@@ -65,6 +68,9 @@ class RTPAddress;
 class RTPSourceData;
 class RTPPacket;
 class RTPPollThread;
+class RTPReactor;
+class RTPReceiveBufferPool;
+class RTPReceiveBufferPoolStatistics;
 class RTPTransmissionInfo;
 class RTCPCompoundPacket;
 class RTCPPacket;
@@ -135,6 +141,14 @@ public:
 	/** Clears the list of destinations. */
 	void ClearDestinations();
 
+	/** Adds the \c numaddresses addresses in \c addresses to the list of destinations; if one of
+	 *  them can't be added, none of them are. */
+	int AddDestinations(const RTPAddress * const *addresses,size_t numaddresses);
+
+	/** Deletes the \c numaddresses addresses in \c addresses from the list of destinations; if one
+	 *  of them can't be deleted, none of them are. */
+	int DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses);
+
 	/** Returns \c true if multicasting is supported. */
 	bool SupportsMulticasting();
 
@@ -250,6 +264,11 @@ public:
 	/** Frees the memory used by the transmission information \c inf. */
 	void DeleteTransmissionInfo(RTPTransmissionInfo *inf);
 
+	/** If a pool for incoming packets was requested using RTPSessionParams::SetReceiveBufferPoolSize,
+	 *  this stores the number of times a packet could or could not be stored in one of its buffers
+	 *  in \c stats. */
+	int GetReceiveBufferPoolStatistics(RTPReceiveBufferPoolStatistics &stats);
+
 	/** If you're not using the poll thread, this function must be called regularly to process incoming data
 	 *  and to send RTCP data when necessary.
 	 */
@@ -272,6 +291,69 @@ public:
 	 */
 	RTPTime GetRTCPDelay();
 
+	/** Stores the sockets on which the session receives data in \c sockets, which has room for 
+	 *  \c *numsockets entries, and sets \c *numsockets to the number of sockets that were stored.
+	 *  Together with RTPSession::GetNextDeadline and RTPSession::Step, this allows an external event
+	 *  loop to drive the session: wait until one of these sockets becomes readable or until the 
+	 *  deadline has passed, then call RTPSession::Step. Only works when you're not using the poll 
+	 *  thread, and the transmitter must support RTPTransmitter::GetReceiveSockets.
+	 */
+	int GetReceiveSockets(SocketType *sockets,size_t *numsockets);
+
+	/** Returns the time at which RTPSession::Step must be called at the latest, even if no data
+	 *  arrived in the meantime (only works when you're not using the poll thread). */
+	RTPTime GetNextDeadline();
+
+	/** Processes the data that has arrived, checks for timeouts and sends RTCP data when necessary,
+	 *  without blocking; \c now is the current time (only works when you're not using the poll thread). */
+	int Step(const RTPTime &now);
+
+	/** If data ready notification was enabled using RTPSessionParams::SetUseDataReadyNotification,
+	 *  this stores a descriptor in \c desc that becomes readable when new packets have been stored.
+	 *  The descriptor can be used in the 'select', 'poll' or 'epoll_wait' call of a thread that 
+	 *  consumes the packets. Once it's readable, call RTPSession::ClearDataReadyNotification first
+	 *  and then retrieve the packets between RTPSession::BeginDataAccess and RTPSession::EndDataAccess;
+	 *  that way, packets that arrive in the meantime will make the descriptor readable again.
+	 */
+	int GetDataReadyDescriptor(SocketType *desc);
+
+	/** Makes the descriptor returned by RTPSession::GetDataReadyDescriptor unreadable again. */
+	int ClearDataReadyNotification();
+
+	/** If a delivery queue was requested using RTPSessionParams::SetDeliveryQueueSize, this
+	 *  returns the next packet from it, or null if the queue is empty.
+	 *  If a delivery queue was requested using RTPSessionParams::SetDeliveryQueueSize, this
+	 *  returns the next packet from it, or null if the queue is empty. The packets of all 
+	 *  validated sources are stored in this queue in the order in which they were processed,
+	 *  and the queue is read without locking the session, so that fetching packets never has to 
+	 *  wait until the poll thread has processed incoming data or sent RTCP packets. Only one 
+	 *  thread may call this function, and there's no need to call BeginDataAccess first. The
+	 *  packet must be deallocated using RTPSession::DeletePacket. Packets of sources that are
+	 *  still on probation are stored in the source table as usual. Together with data ready 
+	 *  notification (see RTPSession::GetDataReadyDescriptor), the thread can wait until
+	 *  packets are available.
+	 */
+	RTPPacket *GetDeliveredPacket();
+
+	/** Stores the number of packets that were placed in the delivery queue in \c numdelivered
+	 *  and the number of packets that didn't fit in it in \c numoverflows; what happened to the
+	 *  latter depends on RTPSessionParams::SetDeliveryQueueOverflowPolicy. */
+	int GetDeliveryQueueCounters(uint64_t *numdelivered, uint64_t *numoverflows);
+
+	/** Identifies one of the locks that protect the internal state of a session. */
+	enum SessionLock 
+	{ 
+		SourcesLock,			/**< Protects the source table. */
+		PacketBuilderLock,		/**< Protects the RTP packet builder, used when sending RTP packets. */
+		RTCPBuilderLock,		/**< Protects the RTCP packet builder, used when building RTCP compound packets. */
+		SchedulerLock,			/**< Protects the RTCP scheduler. */
+		PacketSentLock			/**< Protects the flag that indicates if packets were sent. */
+	};
+
+	/** If RTPSessionParams::SetCollectLockHoldTimes was used, this stores a copy of the histogram 
+	 *  of the durations that lock \c l was held in \c hist. */
+	int GetLockHoldTimes(SessionLock l, RTPHoldTimeHistogram &hist);
+
 	/** The following member functions (till EndDataAccess}) need to be accessed between a call 
 	 *  to BeginDataAccess and EndDataAccess. 
 	 *  The BeginDataAccess function makes sure that the poll thread won't access the source table
@@ -334,7 +416,8 @@ public:
 	 *  or NULL if no more packets are available.
 	 *  Extracts the next packet from the received packets queue of the current participant,
 	 *  or NULL if no more packets are available. When the packet is no longer needed, its
-	 *  memory should be freed using the DeletePacket member function.
+	 *  memory should be freed using the DeletePacket member function. Since the packet may
+	 *  be stored in the same memory block as its data, it must not be deleted directly.
 	 */
 	RTPPacket *GetNextPacket();
 
@@ -535,7 +618,12 @@ protected:
 	/** Is called when a BYE packet has been processed for source \c srcdat. */
 	virtual void OnBYEPacket(RTPSourceData *srcdat);
 
-	/** Is called when an RTCP compound packet has just been sent (useful to inspect outgoing RTCP data). */
+	/** Is called when an RTCP compound packet has just been sent (useful to inspect outgoing RTCP data).
+	 *  Is called when an RTCP compound packet has just been sent (useful to inspect outgoing RTCP data).
+	 *  When the packet was sent by the poll thread, an RTPReactor, RTPSession::Poll or RTPSession::Step, the
+	 *  source table is locked during this call, so the sources may be inspected but
+	 *  RTPSession::BeginDataAccess must not be called.
+	 */
 	virtual void OnSendRTCPCompoundPacket(RTCPCompoundPacket *pack);
 #ifdef RTP_SUPPORT_THREAD
 	/** Is called when error \c errcode was detected in the poll thread. */
@@ -603,14 +691,29 @@ protected:
 	 *  really suited to actually do something with the data.
 	 */
 	virtual void OnValidatedRTPPacket(RTPSourceData *srcdat, RTPPacket *rtppack, bool isonprobation, bool *ispackethandled);
+
+	/** Is called when a batch of incoming data has been processed and \c numpackets new packets of
+	 *  validated sources were stored.
+	 *  Is called when a batch of incoming data has been processed and \c numpackets new packets of 
+	 *  validated sources were stored. This happens at most once for each call to RTPSession::Poll, 
+	 *  RTPSession::Step or step of the poll thread, after the lock on the source table has been 
+	 *  released again, so the packets can be retrieved using RTPSession::BeginDataAccess. 
+	 */
+	virtual void OnDataReady(size_t numpackets);
 private:
 	int InternalCreate(const RTPSessionParams &sessparams);
+	int CreateReceiveBufferPool(const RTPSessionParams &sessparams);
+	void DestroyReceiveBufferPool();
 	int CreateCNAME(uint8_t *buffer,size_t *bufferlength,bool resolve);
-	int ProcessPolledData();
+	int ProcessPolledData()										{ return ProcessPolledData(RTPTime::CurrentTime()); }
+	int ProcessPolledData(const RTPTime &now);
 	int ProcessRTCPCompoundPacket(RTCPCompoundPacket &rtcpcomppack,RTPRawPacket *pack);
 	RTPRandom *GetRandomNumberGenerator(RTPRandom *r);
 	int SendRTPData(const void *data, size_t len);
 	int SendRTCPData(const void *data, size_t len);
+	RTPTime GetRTCPTransmissionDelay();
+	void MarkRTPPacketSent();
+	void UpdateOwnSenderInfo();
 
 	RTPRandom *rtprnd;
 	bool deletertprnd;
@@ -630,6 +733,8 @@ private:
 	double collisionmultiplier;
 	double notemultiplier;
 	bool sentpackets;
+	bool sentrtppackets; // protected by the packsent lock, like lastrtpsendtime
+	RTPTime lastrtpsendtime;
 
 	bool m_changeIncomingData, m_changeOutgoingData;
 
@@ -640,12 +745,20 @@ private:
 	RTPCollisionList collisionlist;
 
 	std::list<RTCPCompoundPacket *> byepackets;
+	RTPReceiveBufferPool *bufferpool;
+	RTPEventNotifier datareadynotifier;
+	bool datareadypending; // protected by the sources lock
+	RTPPacketQueue deliveryqueue;
+	bool dropondeliveryoverflow;
 	
 #ifdef RTP_SUPPORT_THREAD
 	RTPPollThread *pollthread;
-	jthread::JMutex sourcesmutex,buildermutex,schedmutex,packsentmutex;
+	jthread::JMutex sourcesmutex,buildermutex,rtcpbuildermutex,schedmutex,packsentmutex;
+	bool collectlockholdtimes;
+	RTPHoldTimeHistogram sourcesholdtimes,builderholdtimes,rtcpbuilderholdtimes,schedholdtimes,packsentholdtimes;
 
 	friend class RTPPollThread;
+	friend class RTPReactor;
 #endif // RTP_SUPPORT_THREAD
 	friend class RTPSessionSources;
 	friend class RTCPSessionPacketBuilder;
@@ -688,6 +801,7 @@ inline int RTPSession::OnChangeRTPOrRTCPData(const void *, size_t, bool, void **
 inline void RTPSession::OnSentRTPOrRTCPData(void *, size_t, bool)                                       { }
 inline bool RTPSession::OnChangeIncomingData(RTPRawPacket *)                                            { return true; }
 inline void RTPSession::OnValidatedRTPPacket(RTPSourceData *, RTPPacket *, bool, bool *)                { }
+inline void RTPSession::OnDataReady(size_t)                                                             { }
 
 } // end namespace
 
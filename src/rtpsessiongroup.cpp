@@ -0,0 +1,167 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpsessiongroup.h"
+
+#if defined(RTP_SUPPORT_THREAD) && defined(RTP_HAVE_EPOLL)
+
+#include "rtpsession.h"
+#include "rtperrors.h"
+#include <unistd.h>
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPSessionGroup::RTPSessionGroup(RTPMemoryManager *mgr) : RTPMemoryObject(mgr), reactor(mgr)
+{
+	created = false;
+	numthreads = 0;
+}
+
+RTPSessionGroup::~RTPSessionGroup()
+{
+	Destroy();
+}
+
+int RTPSessionGroup::Create(int numworkers)
+{
+	if (created)
+		return ERR_RTP_SESSIONGROUP_ALREADYCREATED;
+	if (numworkers < 0)
+		return ERR_RTP_REACTOR_ILLEGALTHREADCOUNT;
+
+	if (numworkers == 0)
+	{
+		long numcores = sysconf(_SC_NPROCESSORS_ONLN);
+		numworkers = (numcores > 0)?(int)numcores:1;
+	}
+
+	if (!sessionsmutex.IsInitialized())
+	{
+		if (sessionsmutex.Init() < 0)
+			return ERR_RTP_SESSIONGROUP_CANTINITMUTEX;
+	}
+
+	int status;
+
+	if ((status = reactor.Start(numworkers)) < 0)
+		return status;
+
+	numthreads = numworkers;
+	created = true;
+	return 0;
+}
+
+void RTPSessionGroup::Destroy(const RTPTime &maxwaittime, const void *reason, size_t reasonlength)
+{
+	DeleteSessions(true, maxwaittime, reason, reasonlength);
+}
+
+void RTPSessionGroup::Destroy()
+{
+	DeleteSessions(false, RTPTime(0,0), 0, 0);
+}
+
+int RTPSessionGroup::AddSession(RTPSession *session)
+{
+	if (!created)
+		return ERR_RTP_SESSIONGROUP_NOTCREATED;
+
+	int status;
+
+	sessionsmutex.Lock();
+	if ((status = reactor.AddSession(*session)) < 0)
+	{
+		sessionsmutex.Unlock();
+		return status;
+	}
+	sessions.push_back(session);
+	sessionsmutex.Unlock();
+	return 0;
+}
+
+int RTPSessionGroup::RemoveSession(RTPSession *session)
+{
+	if (!created)
+		return ERR_RTP_SESSIONGROUP_NOTCREATED;
+
+	int status;
+
+	sessionsmutex.Lock();
+	if ((status = reactor.RemoveSession(*session)) < 0)
+	{
+		sessionsmutex.Unlock();
+		return status;
+	}
+	sessions.remove(session);
+	sessionsmutex.Unlock();
+	return 0;
+}
+
+size_t RTPSessionGroup::GetNumberOfSessions()
+{
+	if (!created)
+		return 0;
+
+	sessionsmutex.Lock();
+	size_t num = sessions.size();
+	sessionsmutex.Unlock();
+	return num;
+}
+
+void RTPSessionGroup::DeleteSessions(bool sendbye, const RTPTime &maxwaittime, const void *reason, size_t reasonlength)
+{
+	if (!created)
+		return;
+
+	// Once the workers are stopped, no other thread touches the sessions anymore
+	reactor.Stop();
+
+	std::list<RTPSession *>::iterator it;
+
+	for (it = sessions.begin() ; it != sessions.end() ; ++it)
+	{
+		if (sendbye)
+			(*it)->BYEDestroy(maxwaittime, reason, reasonlength);
+		RTPDelete(*it,GetMemoryManager());
+	}
+	sessions.clear();
+	numthreads = 0;
+	created = false;
+}
+
+} // end namespace
+
+#endif // RTP_SUPPORT_THREAD && RTP_HAVE_EPOLL
+
@@ -0,0 +1,116 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpsessiongroup.h
+ */
+
+#ifndef RTPSESSIONGROUP_H
+
+#define RTPSESSIONGROUP_H
+
+#include "rtpconfig.h"
+
+#if defined(RTP_SUPPORT_THREAD) && defined(RTP_HAVE_EPOLL)
+
+#include "rtpmemoryobject.h"
+#include "rtpreactor.h"
+#include <jthread/jmutex.h>
+#include <list>
+
+namespace jrtplib
+{
+
+class RTPSession;
+
+/** Owns a number of sessions and processes them on a shared pool of worker threads.
+ *  Normally each session that uses a poll thread gets an OS thread of its own. A session
+ *  group instead processes the incoming data, the RTCP packets, the timeouts and the collision
+ *  handling of all its sessions on a pool of worker threads that's sized to the number of 
+ *  processor cores by default. The sessions are scheduled by an RTPReactor, so idle workers 
+ *  steal ready sessions from busy ones and a session never migrates to another worker in 
+ *  the middle of a step.
+ *
+ *  The sessions need to be created with thread safety enabled and without a poll thread of 
+ *  their own (see RTPSessionParams::SetUsePollThread), before they are added to the group.
+ */
+class JRTPLIB_IMPORTEXPORT RTPSessionGroup : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPSessionGroup)
+public:
+	RTPSessionGroup(RTPMemoryManager *mgr = 0);
+	~RTPSessionGroup();
+
+	/** Starts the worker pool with \c numworkers threads, or with one thread per processor 
+	 *  core if \c numworkers is zero. */
+	int Create(int numworkers = 0);
+
+	/** Stops the worker pool and destroys all sessions that are still part of the group,
+	 *  calling RTPSession::BYEDestroy with the specified arguments for each of them. */
+	void Destroy(const RTPTime &maxwaittime, const void *reason, size_t reasonlength);
+
+	/** Same as RTPSessionGroup::Destroy, but doesn't send BYE packets. */
+	void Destroy();
+
+	/** Returns \c true if the group was created. */
+	bool IsCreated() const											{ return created; }
+
+	/** Returns the number of worker threads. */
+	int GetNumberOfThreads() const									{ return numthreads; }
+
+	/** Adds \c session to the group, which takes ownership of it: when the group is destroyed, 
+	 *  the session is deleted using RTPDelete with the memory manager of the group. The session 
+	 *  must therefore have been allocated using RTPNew with that same memory manager.
+	 */
+	int AddSession(RTPSession *session);
+
+	/** Removes \c session from the group; the caller becomes responsible for deleting it again. */
+	int RemoveSession(RTPSession *session);
+
+	/** Returns the number of sessions in the group. */
+	size_t GetNumberOfSessions();
+private:
+	void DeleteSessions(bool sendbye, const RTPTime &maxwaittime, const void *reason, size_t reasonlength);
+
+	bool created;
+	int numthreads;
+	RTPReactor reactor;
+	jthread::JMutex sessionsmutex;
+	std::list<RTPSession *> sessions;
+};
+
+} // end namespace
+
+#endif // RTP_SUPPORT_THREAD && RTP_HAVE_EPOLL
+
+#endif // RTPSESSIONGROUP_H
+
@@ -57,6 +57,7 @@ RTPSessionParams::RTPSessionParams() : mininterval(0,0)
 #ifdef RTP_SUPPORT_PROBATION
 	probationtype = RTPSources::ProbationStore;
 #endif // RTP_SUPPORT_PROBATION
+	packetwindowsize = RTP_DEFAULTPACKETWINDOWSIZE;
 
 	mininterval = RTPTime(RTCP_DEFAULTMININTERVAL);
 	sessionbandwidth = RTP_DEFAULTSESSIONBANDWIDTH;
@@ -74,6 +75,13 @@ RTPSessionParams::RTPSessionParams() : mininterval(0,0)
 	
 	usepredefinedssrc = false;
 	predefinedssrc = 0;
+
+	recvpoolsize = 0;
+	recvpoolbuffersize = 0;
+	datareadynotification = false;
+	deliveryqueuesize = 0;
+	deliveryqueuepolicy = DropNewPacket;
+	collectlockholdtimes = false;
 }
 
 int RTPSessionParams::SetUsePollThread(bool usethread)
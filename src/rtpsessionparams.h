@@ -118,6 +118,14 @@ public:
 	RTPSources::ProbationType GetProbationType() const			{ return probationtype; }
 #endif // RTP_SUPPORT_PROBATION
 
+	/** Sets the number of consecutive sequence numbers the RTP packet queue of a participant 
+	 *  can span (see RTPSources::SetPacketWindowSize). */
+	void SetPacketWindowSize(size_t s)							{ packetwindowsize = s; }
+
+	/** Returns the window size of the participants' RTP packet queues (default is 
+	 *  RTP_DEFAULTPACKETWINDOWSIZE). */
+	size_t GetPacketWindowSize() const							{ return packetwindowsize; }
+
 	/** Sets the session bandwidth in bytes per second. */
 	void SetSessionBandwidth(double sessbw)						{ sessionbandwidth = sessbw; }
 
@@ -218,6 +226,59 @@ public:
 
 	/** Returns `true` if thread safety was requested using RTPSessionParams::SetNeedThreadSafety. */
 	bool NeedThreadSafety() const								{ return m_needThreadSafety; }
+
+	/** Sets the number of buffers in the pool that's used to store incoming packets in; the
+	 *  default of zero means that no such pool is used and memory is allocated for each packet. */
+	void SetReceiveBufferPoolSize(size_t numbuffers)			{ recvpoolsize = numbuffers; }
+
+	/** Returns the number of buffers in the pool for incoming packets (default is 0, no pool). */
+	size_t GetReceiveBufferPoolSize() const						{ return recvpoolsize; }
+
+	/** Sets the size of the largest packet that can be stored in a buffer of the pool for incoming
+	 *  packets; packets that are larger are stored in separately allocated memory. Zero means that
+	 *  the maximum packet size is used. Each buffer is enlarged to store the RTPPacket instance as well. */
+	void SetReceiveBufferPoolBufferSize(size_t s)				{ recvpoolbuffersize = s; }
+
+	/** Returns the size of each buffer in the pool for incoming packets (default is 0, meaning
+	 *  that the maximum packet size will be used). */
+	size_t GetReceiveBufferPoolBufferSize() const				{ return recvpoolbuffersize; }
+
+	/** If set to \c true, the session provides a descriptor that becomes readable when new
+	 *  packets have been stored (see RTPSession::GetDataReadyDescriptor), so that a thread
+	 *  that consumes the packets can wait for it instead of checking the sources regularly. */
+	void SetUseDataReadyNotification(bool f)					{ datareadynotification = f; }
+
+	/** Returns \c true if data ready notification was requested (default is \c false). */
+	bool GetUseDataReadyNotification() const					{ return datareadynotification; }
+
+	/** Determines what happens to a packet that doesn't fit in the delivery queue anymore. */
+	enum DeliveryQueueOverflowPolicy 
+	{ 
+		DropNewPacket,		/**< The packet is deleted. */
+		StoreInSourceTable	/**< The packet is stored in the source table, as if there were no delivery queue. */
+	};
+
+	/** If \c n is larger than zero, the packets of validated sources are not stored in the source
+	 *  table, but in a queue that can hold \c n packets, from which one other thread can fetch them
+	 *  using RTPSession::GetDeliveredPacket without locking the session (default is 0, no such queue). */
+	void SetDeliveryQueueSize(size_t n)							{ deliveryqueuesize = n; }
+
+	/** Returns the size of the delivery queue (default is 0, meaning that no delivery queue is used). */
+	size_t GetDeliveryQueueSize() const							{ return deliveryqueuesize; }
+
+	/** Sets what happens to packets that arrive when the delivery queue is full. */
+	void SetDeliveryQueueOverflowPolicy(DeliveryQueueOverflowPolicy p)	{ deliveryqueuepolicy = p; }
+
+	/** Returns what happens to packets that arrive when the delivery queue is full (default is
+	 *  RTPSessionParams::DropNewPacket). */
+	DeliveryQueueOverflowPolicy GetDeliveryQueueOverflowPolicy() const	{ return deliveryqueuepolicy; }
+
+	/** If set to \c true, the session keeps track of how long each of its internal locks is held
+	 *  (see RTPSession::GetLockHoldTimes); this is only possible when thread safety is needed. */
+	void SetCollectLockHoldTimes(bool f)						{ collectlockholdtimes = f; }
+
+	/** Returns \c true if the session should keep track of how long its locks are held (default is \c false). */
+	bool GetCollectLockHoldTimes() const						{ return collectlockholdtimes; }
 private:
 	bool acceptown;
 	bool usepollthread;
@@ -228,6 +289,7 @@ private:
 #ifdef RTP_SUPPORT_PROBATION
 	RTPSources::ProbationType probationtype;
 #endif // RTP_SUPPORT_PROBATION
+	size_t packetwindowsize;
 	
 	double sessionbandwidth;
 	double controlfrac;
@@ -248,6 +310,13 @@ private:
 
 	std::string cname;
 	bool m_needThreadSafety;
+
+	size_t recvpoolsize;
+	size_t recvpoolbuffersize;
+	bool datareadynotification;
+	size_t deliveryqueuesize;
+	DeliveryQueueOverflowPolicy deliveryqueuepolicy;
+	bool collectlockholdtimes;
 };
 
 } // end namespace
@@ -32,7 +32,8 @@
 
 #include "rtpsessionsources.h"
 #include "rtpsession.h"
-#include "rtpsourcedata.h"
+#include "rtpinternalsourcedata.h"
+#include "rtppacket.h"
 
 #include "rtpdebug.h"
 
@@ -113,6 +114,77 @@ void RTPSessionSources::OnNoteTimeout(RTPSourceData *srcdat)
 void RTPSessionSources::OnValidatedRTPPacket(RTPSourceData *srcdat, RTPPacket *rtppack, bool isonprobation, bool *ispackethandled)
 {
 	rtpsession.OnValidatedRTPPacket(srcdat, rtppack, isonprobation, ispackethandled);
+	if (isonprobation || *ispackethandled)
+		return;
+
+	// Only the thread that holds the sources lock gets here, so there's a single producer
+	RTPPacketQueue &deliveryqueue = rtpsession.deliveryqueue;
+
+	if (!deliveryqueue.IsCreated())
+		return;
+
+	// The packets that are still stored for this source must go first: if the
+	// queue can't take them all, this packet is stored after them
+	if (DeliverStoredPackets(srcdat))
+	{
+		RTPInternalSourceData *internalsrcdat = (RTPInternalSourceData *)srcdat;
+		uint32_t seqnr = rtppack->GetExtendedSequenceNumber();
+
+		// The source's packet ring never sees this packet, so duplicates and packets
+		// that are too old must be rejected here
+		if (internalsrcdat->MustRejectForDelivery(seqnr,GetPacketWindowSize()))
+		{
+			RTPPacket::Delete(rtppack,GetMemoryManager());
+			*ispackethandled = true;
+			return;
+		}
+		if (deliveryqueue.Push(rtppack))
+		{
+			internalsrcdat->MarkDelivered(seqnr);
+			*ispackethandled = true;
+			numnewpackets++;
+			return;
+		}
+	}
+	if (rtpsession.dropondeliveryoverflow)
+	{
+		RTPPacket::Delete(rtppack,GetMemoryManager());
+		*ispackethandled = true;
+	}
+}
+
+void RTPSessionSources::OnStoredRTPPacket(RTPSourceData *, RTPPacket *)
+{
+	// When the delivery queue is used, packets are counted when they're pushed into it
+	if (!rtpsession.deliveryqueue.IsCreated())
+		numnewpackets++;
+}
+
+bool RTPSessionSources::DeliverStoredPackets(RTPSourceData *srcdat)
+{
+	// Packets are left in the source's queue while it's on probation, or when the
+	// delivery queue was full and the overflow policy says to keep them
+	RTPPacketQueue &deliveryqueue = rtpsession.deliveryqueue;
+
+	while (srcdat->HasData())
+	{
+		if (deliveryqueue.IsFull())
+			return false;
+
+		RTPInternalSourceData *internalsrcdat = (RTPInternalSourceData *)srcdat;
+		RTPPacket *p = srcdat->GetNextPacket();
+		uint32_t seqnr = p->GetExtendedSequenceNumber();
+
+		if (internalsrcdat->MustRejectForDelivery(seqnr,GetPacketWindowSize()))
+		{
+			RTPPacket::Delete(p,GetMemoryManager());
+			continue;
+		}
+		deliveryqueue.Push(p);
+		internalsrcdat->MarkDelivered(seqnr);
+		numnewpackets++;
+	}
+	return true;
 }
 
 void RTPSessionSources::OnRTCPSenderReport(RTPSourceData *srcdat)
@@ -129,6 +201,11 @@ void RTPSessionSources::OnRTCPSDESItem(RTPSourceData *srcdat, RTCPSDESPacket::It
 							const void *itemdata, size_t itemlength)
 {
 	rtpsession.OnRTCPSDESItem(srcdat, t, itemdata, itemlength);
+
+	// A CNAME validates a source, after which the packets it sent while on probation
+	// can be delivered
+	if (t == RTCPSDESPacket::CNAME && rtpsession.deliveryqueue.IsCreated())
+		DeliverStoredPackets(srcdat);
 }
 
 #ifdef RTP_SUPPORT_SDESPRIV
@@ -50,10 +50,14 @@ class JRTPLIB_IMPORTEXPORT RTPSessionSources : public RTPSources
 {
 public:
 	RTPSessionSources(RTPSession &sess,RTPMemoryManager *mgr) : RTPSources(RTPSources::ProbationStore,mgr),rtpsession(sess)
-													{ owncollision = false; }
+													{ owncollision = false; numnewpackets = 0; }
 	~RTPSessionSources()										{ }
 	void ClearOwnCollisionFlag()									{ owncollision = false; }
 	bool DetectedOwnCollision() const								{ return owncollision; }
+
+	// Counts the packets of validated sources that were stored for the application
+	void ClearNewPacketCount()									{ numnewpackets = 0; }
+	size_t GetNewPacketCount() const								{ return numnewpackets; }
 private:
 	void OnRTPPacket(RTPPacket *pack,const RTPTime &receivetime,
 	                 const RTPAddress *senderaddress);
@@ -75,6 +79,7 @@ private:
 	                           const RTPAddress *senderaddress);
 	void OnNoteTimeout(RTPSourceData *srcdat);
 	void OnValidatedRTPPacket(RTPSourceData *srcdat, RTPPacket *rtppack, bool isonprobation, bool *ispackethandled);
+	void OnStoredRTPPacket(RTPSourceData *srcdat, RTPPacket *rtppack);
 	void OnRTCPSenderReport(RTPSourceData *srcdat);
 	void OnRTCPReceiverReport(RTPSourceData *srcdat);
 	void OnRTCPSDESItem(RTPSourceData *srcdat, RTCPSDESPacket::ItemType t,
@@ -84,8 +89,11 @@ private:
 	                                   const void *valuedata, size_t valuelen);
 #endif // RTP_SUPPORT_SDESPRIV
 	
+	bool DeliverStoredPackets(RTPSourceData *srcdat);
+
 	RTPSession &rtpsession;
 	bool owncollision;
+	size_t numnewpackets;
 };
 
 } // end namespace
@@ -43,6 +43,7 @@
 	#define RTPCLOSE(x)								closesocket(x)
 	#define RTPSOCKLENTYPE							int
 	#define RTPIOCTL								ioctlsocket
+	#define RTPSOCKERRNO							WSAGetLastError()
 #else // not Win32
 	#include <sys/socket.h>
 	#include <netinet/in.h>
@@ -52,6 +53,7 @@
 	#include <string.h>
 	#include <netdb.h>
 	#include <unistd.h>
+	#include <errno.h>
 
 	#ifdef RTP_HAVE_SYS_FILIO
 		#include <sys/filio.h>
@@ -73,6 +75,7 @@
 	#endif // RTP_SOCKLENTYPE_UINT
 
 	#define RTPIOCTL								ioctl
+	#define RTPSOCKERRNO							errno
 #endif // RTP_SOCKETTYPE_WINSOCK
 
 #endif // RTPSOCKETUTILINTERNAL_H
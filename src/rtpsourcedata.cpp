@@ -260,7 +260,7 @@ jitter = (uint32_t)djitter;
 	}
 }
 
-RTPSourceData::RTPSourceData(uint32_t s, RTPMemoryManager *mgr) : RTPMemoryObject(mgr),SDESinf(mgr),byetime(0,0)
+RTPSourceData::RTPSourceData(uint32_t s, RTPMemoryManager *mgr) : RTPMemoryObject(mgr),packetring(mgr),SDESinf(mgr),byetime(0,0)
 {
 	ssrc = s;
 	issender = false;
@@ -45,7 +45,7 @@
 #include "rtptypes.h"
 #include "rtpsources.h"
 #include "rtpmemoryobject.h"
-#include <list>
+#include "rtpsequencering.h"
 
 namespace jrtplib
 {
@@ -177,7 +177,7 @@ public:
 	void FlushPackets();
 
 	/** Returns \c true if there are RTP packets which can be extracted. */
-	bool HasData() const							{ if (!validated) return false; return packetlist.empty()?false:true; }
+	bool HasData() const							{ if (!validated) return false; return !packetring.IsEmpty(); }
 
 	/** Returns the SSRC identifier for this member. */
 	uint32_t GetSSRC() const						{ return ssrc; }
@@ -427,7 +427,7 @@ public:
 	virtual void Dump();
 #endif // RTPDEBUG
 protected:
-	std::list<RTPPacket *> packetlist;
+	RTPSequenceRing packetring;
 
 	uint32_t ssrc;
 	bool ownssrc;
@@ -455,23 +455,12 @@ inline RTPPacket *RTPSourceData::GetNextPacket()
 {
 	if (!validated)
 		return 0;
-
-	RTPPacket *p;
-
-	if (packetlist.empty())
-		return 0;
-	p = *(packetlist.begin());
-	packetlist.pop_front();
-	return p;
+	return packetring.Pop();
 }
 
 inline void RTPSourceData::FlushPackets()
 {
-	std::list<RTPPacket *>::const_iterator it;
-
-	for (it = packetlist.begin() ; it != packetlist.end() ; ++it)
-		RTPDelete(*it,GetMemoryManager());
-	packetlist.clear();
+	packetring.Clear();
 }
 
 } // end namespace
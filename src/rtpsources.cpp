@@ -62,6 +62,8 @@ RTPSources::RTPSources(ProbationType probtype,RTPMemoryManager *mgr) : RTPMemory
 	sendercount = 0;
 	activecount = 0;
 	owndata = 0;
+	packetwindowsize = RTPSequenceRing::GetWindowSize(RTP_DEFAULTPACKETWINDOWSIZE);
+	ClearLookupCache();
 #ifdef RTP_SUPPORT_PROBATION
 	probationtype = probtype;
 #endif // RTP_SUPPORT_PROBATION
@@ -89,6 +91,11 @@ void RTPSources::ClearSourceList()
 		sourcelist.GotoNextElement();
 	}
 	sourcelist.Clear();
+	ClearLookupCache();
+	membertimeouts.Clear();
+	sendertimeouts.Clear();
+	byetimeouts.Clear();
+	notetimeouts.Clear();
 	owndata = 0;
 	totalcount = 0;
 	sendercount = 0;
@@ -131,6 +138,7 @@ int RTPSources::DeleteOwnSSRC()
 
 	sourcelist.GotoElement(ssrc);
 	sourcelist.DeleteCurrentElement();
+	ForgetCachedSource(ssrc);
 
 	totalcount--;
 	if (owndata->IsSender())
@@ -146,15 +154,21 @@ int RTPSources::DeleteOwnSSRC()
 }
 
 void RTPSources::SentRTPPacket()
+{
+	SentRTPPacket(RTPTime::CurrentTime());
+}
+
+void RTPSources::SentRTPPacket(const RTPTime &sendtime)
 {
 	if (owndata == 0)
 		return;
 
 	bool prevsender = owndata->IsSender();
 	
-	owndata->SentRTPPacket();
+	owndata->SentRTPPacket(sendtime);
 	if (!prevsender && owndata->IsSender())
 		sendercount++;
+	ScheduleTimeouts(owndata);
 }
 
 int RTPSources::ProcessRawPacket(RTPRawPacket *rawpack,RTPTransmitter *rtptrans,bool acceptownpackets)
@@ -179,19 +193,19 @@ int RTPSources::ProcessRawPacket(RTPRawPacket *rawpack,RTPTransmitter *rtptrans[
 		RTPPacket *rtppack;
 		
 		// First, we'll see if the packet can be parsed
-		rtppack = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPPACKET) RTPPacket(*rawpack,GetMemoryManager());
+		rtppack = RTPPacket::Create(*rawpack,GetMemoryManager());
 		if (rtppack == 0)
 			return ERR_RTP_OUTOFMEM;
 		if ((status = rtppack->GetCreationError()) < 0)
 		{
 			if (status == ERR_RTP_PACKET_INVALIDPACKET)
 			{
-				RTPDelete(rtppack,GetMemoryManager());
+				RTPPacket::Delete(rtppack,GetMemoryManager());
 				rtppack = 0;
 			}
 			else
 			{
-				RTPDelete(rtppack,GetMemoryManager());
+				RTPPacket::Delete(rtppack,GetMemoryManager());
 				return status;
 			}
 		}
@@ -221,7 +235,7 @@ int RTPSources::ProcessRawPacket(RTPRawPacket *rawpack,RTPTransmitter *rtptrans[
 					if ((status = ProcessRTPPacket(rtppack,rawpack->GetReceiveTime(),0,&stored)) < 0)
 					{
 						if (!stored)
-							RTPDelete(rtppack,GetMemoryManager());
+							RTPPacket::Delete(rtppack,GetMemoryManager());
 						return status;
 					}
 				}
@@ -231,12 +245,12 @@ int RTPSources::ProcessRawPacket(RTPRawPacket *rawpack,RTPTransmitter *rtptrans[
 				if ((status = ProcessRTPPacket(rtppack,rawpack->GetReceiveTime(),senderaddress,&stored)) < 0)
 				{
 					if (!stored)
-						RTPDelete(rtppack,GetMemoryManager());
+						RTPPacket::Delete(rtppack,GetMemoryManager());
 					return status;
 				}
 			}
 			if (!stored)
-				RTPDelete(rtppack,GetMemoryManager());
+				RTPPacket::Delete(rtppack,GetMemoryManager());
 		}
 	}
 	else // RTCP packet
@@ -338,6 +352,7 @@ int RTPSources::ProcessRTPPacket(RTPPacket *rtppack,const RTPTime &receivetime,c
 		sendercount++;
 	if (!prevactive && srcdat->IsActive())
 		activecount++;
+	ScheduleTimeouts(srcdat);
 
 	if (created)
 		OnNewSource(srcdat);
@@ -364,7 +379,13 @@ int RTPSources::ProcessRTPPacket(RTPPacket *rtppack,const RTPTime &receivetime,c
 			else // already found an entry, possibly because of RTCP data
 			{
 				if (!CheckCollision(csrcdat,senderaddress,true))
+				{
+					bool prevactivecsrc = csrcdat->IsActive();
+
 					csrcdat->SetCSRC();
+					if (!prevactivecsrc && csrcdat->IsActive())
+						activecount++;
+				}
 			}
 		}
 	}
@@ -640,7 +661,7 @@ RTPSourceData *RTPSources::GetSourceInfo(uint32_t ssrc)
 
 bool RTPSources::GotEntry(uint32_t ssrc)
 {
-	return sourcelist.HasElement(ssrc);
+	return (LookupSource(ssrc) == 0)?false:true;
 }
 
 RTPPacket *RTPSources::GetNextPacket()
@@ -749,6 +770,7 @@ int RTPSources::ProcessSDESNormalItem(uint32_t ssrc,RTCPSDESPacket::ItemType t,s
 	status = srcdat->ProcessSDESItem(sdesid,(const uint8_t *)itemdata,itemlength,receivetime,&cnamecollis);
 	if (!prevactive && srcdat->IsActive())
 		activecount++;
+	ScheduleTimeouts(srcdat);
 	
 	// Call the callback
 	if (created)
@@ -811,6 +833,7 @@ int RTPSources::ProcessBYE(uint32_t ssrc,size_t reasonlength,const void *reasond
 	srcdat->ProcessBYEPacket((const uint8_t *)reasondata,reasonlength,receivetime);
 	if (prevactive && !srcdat->IsActive())
 		activecount--;
+	ScheduleTimeouts(srcdat);
 	
 	// Call the callback
 	if (created)
@@ -824,7 +847,7 @@ int RTPSources::ObtainSourceDataInstance(uint32_t ssrc,RTPInternalSourceData **s
 	RTPInternalSourceData *srcdat2;
 	int status;
 	
-	if (sourcelist.GotoElement(ssrc) < 0) // No entry for this source
+	if ((srcdat2 = LookupSource(ssrc)) == 0) // No entry for this source
 	{
 #ifdef RTP_SUPPORT_PROBATION
 		srcdat2 = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPINTERNALSOURCEDATA) RTPInternalSourceData(ssrc,probationtype,GetMemoryManager());
@@ -841,15 +864,51 @@ int RTPSources::ObtainSourceDataInstance(uint32_t ssrc,RTPInternalSourceData **s
 		*srcdat = srcdat2;
 		*created = true;
 		totalcount++;
+		ScheduleTimeouts(srcdat2);
 	}
 	else
 	{
-		*srcdat = sourcelist.GetCurrentElement();
+		*srcdat = srcdat2;
 		*created = false;
 	}
 	return 0;
 }
 
+RTPInternalSourceData *RTPSources::LookupSource(uint32_t ssrc)
+{
+	LookupCacheEntry &entry = lookupcache[GetLookupCacheIndex(ssrc)];
+
+	if (entry.srcdat != 0 && entry.ssrc == ssrc)
+		return entry.srcdat;
+
+	// Only existing sources are cached, so that deleting a source is the
+	// only thing that can make an entry invalid
+	RTPInternalSourceData **srcdat = sourcelist.FindElement(ssrc);
+
+	if (srcdat == 0)
+		return 0;
+	entry.ssrc = ssrc;
+	entry.srcdat = *srcdat;
+	return *srcdat;
+}
+
+void RTPSources::ForgetCachedSource(uint32_t ssrc)
+{
+	LookupCacheEntry &entry = lookupcache[GetLookupCacheIndex(ssrc)];
+
+	if (entry.ssrc == ssrc)
+		entry.srcdat = 0;
+}
+
+void RTPSources::ClearLookupCache()
+{
+	for (int i = 0 ; i < RTPSOURCES_LOOKUPCACHESIZE ; i++)
+	{
+		lookupcache[i].ssrc = 0;
+		lookupcache[i].srcdat = 0;
+	}
+}
+
 	
 int RTPSources::GetRTCPSourceData(uint32_t ssrc,const RTPAddress *senderaddress,
 		                  RTPInternalSourceData **srcdat2,bool *newsource)
@@ -904,9 +963,6 @@ int RTPSources::UpdateReceiveTime(uint32_t ssrc,const RTPTime &receivetime,const
 
 void RTPSources::Timeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 {
-	int newtotalcount = 0;
-	int newsendercount = 0;
-	int newactivecount = 0;
 	RTPTime checktime = curtime;
 	checktime -= timeoutdelay;
 	
@@ -927,50 +983,23 @@ void RTPSources::Timeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 				activecount--;
 			
 			sourcelist.DeleteCurrentElement();
+			ForgetCachedSource(srcdat->GetSSRC());
 
 			OnTimeout(srcdat);
 			OnRemoveSource(srcdat);
 			RTPDelete(srcdat,GetMemoryManager());
 		}
 		else
-		{
-			newtotalcount++;
-			if (srcdat->IsSender())
-				newsendercount++;
-			if (srcdat->IsActive())
-				newactivecount++;
 			sourcelist.GotoNextElement();
-		}
 	}
-	
+
 #ifdef RTPDEBUG
-	if (newtotalcount != totalcount)
-	{
-		std::cout << "New total count " << newtotalcount << " doesnt match old total count " << totalcount << std::endl;
-		SafeCountTotal();
-	}
-	if (newsendercount != sendercount)
-	{
-		std::cout << "New sender count " << newsendercount << " doesnt match old sender count " << sendercount << std::endl;
-		SafeCountSenders();
-	}
-	if (newactivecount != activecount)
-	{
-		std::cout << "New active count " << newactivecount << " doesnt match old active count " << activecount << std::endl;
-		SafeCountActive();
-	}
+	CheckCounts();
 #endif // RTPDEBUG
-	
-	totalcount = newtotalcount; // just to play it safe
-	sendercount = newsendercount;
-	activecount = newactivecount;
 }
 
 void RTPSources::SenderTimeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 {
-	int newtotalcount = 0;
-	int newsendercount = 0;
-	int newactivecount = 0;
 	RTPTime checktime = curtime;
 	checktime -= timeoutdelay;
 	
@@ -979,10 +1008,6 @@ void RTPSources::SenderTimeout(const RTPTime &curtime,const RTPTime &timeoutdela
 	{
 		RTPInternalSourceData *srcdat = sourcelist.GetCurrentElement();
 
-		newtotalcount++;
-		if (srcdat->IsActive())
-			newactivecount++;
-
 		if (srcdat->IsSender())
 		{
 			RTPTime lastrtppacktime = srcdat->INF_GetLastRTPPacketTime();
@@ -992,40 +1017,17 @@ void RTPSources::SenderTimeout(const RTPTime &curtime,const RTPTime &timeoutdela
 				srcdat->ClearSenderFlag();
 				sendercount--;
 			}
-			else
-				newsendercount++;
 		}
 		sourcelist.GotoNextElement();
 	}
-	
+
 #ifdef RTPDEBUG
-	if (newtotalcount != totalcount)
-	{
-		std::cout << "New total count " << newtotalcount << " doesnt match old total count " << totalcount << std::endl;
-		SafeCountTotal();
-	}
-	if (newsendercount != sendercount)
-	{
-		std::cout << "New sender count " << newsendercount << " doesnt match old sender count " << sendercount << std::endl;
-		SafeCountSenders();
-	}
-	if (newactivecount != activecount)
-	{
-		std::cout << "New active count " << newactivecount << " doesnt match old active count " << activecount << std::endl;
-		SafeCountActive();
-	}
+	CheckCounts();
 #endif // RTPDEBUG
-	
-	totalcount = newtotalcount; // just to play it safe
-	sendercount = newsendercount;
-	activecount = newactivecount;
 }
 
 void RTPSources::BYETimeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 {
-	int newtotalcount = 0;
-	int newsendercount = 0;
-	int newactivecount = 0;
 	RTPTime checktime = curtime;
 	checktime -= timeoutdelay;
 	
@@ -1046,59 +1048,25 @@ void RTPSources::BYETimeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 				if (srcdat->IsActive())
 					activecount--;
 				sourcelist.DeleteCurrentElement();
+				ForgetCachedSource(srcdat->GetSSRC());
 				OnBYETimeout(srcdat);
 				OnRemoveSource(srcdat);
 				RTPDelete(srcdat,GetMemoryManager());
 			}
 			else
-			{
-				newtotalcount++;
-				if (srcdat->IsSender())
-					newsendercount++;
-				if (srcdat->IsActive())
-					newactivecount++;
 				sourcelist.GotoNextElement();
-			}
 		}
 		else
-		{
-			newtotalcount++;
-			if (srcdat->IsSender())
-				newsendercount++;
-			if (srcdat->IsActive())
-				newactivecount++;
 			sourcelist.GotoNextElement();
-		}
 	}
-	
+
 #ifdef RTPDEBUG
-	if (newtotalcount != totalcount)
-	{
-		std::cout << "New total count " << newtotalcount << " doesnt match old total count " << totalcount << std::endl;
-		SafeCountTotal();
-	}
-	if (newsendercount != sendercount)
-	{
-		std::cout << "New sender count " << newsendercount << " doesnt match old sender count " << sendercount << std::endl;
-		SafeCountSenders();
-	}
-	if (newactivecount != activecount)
-	{
-		std::cout << "New active count " << newactivecount << " doesnt match old active count " << activecount << std::endl;
-		SafeCountActive();
-	}
+	CheckCounts();
 #endif // RTPDEBUG
-	
-	totalcount = newtotalcount; // just to play it safe
-	sendercount = newsendercount;
-	activecount = newactivecount;
 }
 
 void RTPSources::NoteTimeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 {
-	int newtotalcount = 0;
-	int newsendercount = 0;
-	int newactivecount = 0;
 	RTPTime checktime = curtime;
 	checktime -= timeoutdelay;
 	
@@ -1119,44 +1087,12 @@ void RTPSources::NoteTimeout(const RTPTime &curtime,const RTPTime &timeoutdelay)
 				OnNoteTimeout(srcdat);
 			}
 		}
-		
-		newtotalcount++;
-		if (srcdat->IsSender())
-			newsendercount++;
-		if (srcdat->IsActive())
-			newactivecount++;
 		sourcelist.GotoNextElement();
 	}
-	
-#ifdef RTPDEBUG
-	if (newtotalcount != totalcount)
-	{
-		std::cout << "New total count " << newtotalcount << " doesnt match old total count " << totalcount << std::endl;
-		SafeCountTotal();
-	}
-	if (newsendercount != sendercount)
-	{
-		std::cout << "New sender count " << newsendercount << " doesnt match old sender count " << sendercount << std::endl;
-		SafeCountSenders();
-	}
-	if (newactivecount != activecount)
-	{
-		std::cout << "New active count " << newactivecount << " doesnt match old active count " << activecount << std::endl;
-		SafeCountActive();
-	}
-#endif // RTPDEBUG
-	
-	totalcount = newtotalcount; // just to play it safe
-	sendercount = newsendercount;
-	activecount = newactivecount;
-
 }
 	
 void RTPSources::MultipleTimeouts(const RTPTime &curtime,const RTPTime &sendertimeout,const RTPTime &byetimeout,const RTPTime &generaltimeout,const RTPTime &notetimeout)
 {
-	int newtotalcount = 0;
-	int newsendercount = 0;
-	int newactivecount = 0;
 	RTPTime senderchecktime = curtime;
 	RTPTime byechecktime = curtime;
 	RTPTime generaltchecktime = curtime;
@@ -1165,122 +1101,124 @@ void RTPSources::MultipleTimeouts(const RTPTime &curtime,const RTPTime &senderti
 	byechecktime -= byetimeout;
 	generaltchecktime -= generaltimeout;
 	notechecktime -= notetimeout;
-	
-	sourcelist.GotoFirstElement();
-	while (sourcelist.HasCurrentElement())
+
+	// The wheels only return entries of which the key lies before the check time, the
+	// actual times are examined below since they may have changed after an entry was 
+	// scheduled. Participants that are removed take their other entries with them.
+	RTPTimerWheelEntry *entry;
+
+	byetimeouts.Advance(RTPTimerWheel::GetTick(byechecktime));
+	while ((entry = byetimeouts.PopExpired()) != 0)
 	{
-		RTPInternalSourceData *srcdat = sourcelist.GetCurrentElement();
-		bool deleted,issender,isactive;
-		bool byetimeout,normaltimeout,notetimeout;
-		
-		size_t notelen;
-		
-		issender = srcdat->IsSender();
-		isactive = srcdat->IsActive();
-		deleted = false;
-		byetimeout = false;
-		normaltimeout = false;
-		notetimeout = false;
+		RTPInternalSourceData *srcdat = (RTPInternalSourceData *)entry->GetOwner();
 
-        	srcdat->SDES_GetNote(&notelen);
-		if (notelen != 0) // Note has been set
-		{
-			RTPTime notetime = srcdat->INF_GetLastSDESNoteTime();
-			
-			if (notechecktime > notetime)
-			{
-				notetimeout = true;
-				srcdat->ClearNote();
-			}
-		}
+		if (srcdat == owndata || !srcdat->ReceivedBYE())
+			continue;
 
-		if (srcdat->ReceivedBYE())
-		{
-			RTPTime byetime = srcdat->GetBYETime();
+		RTPTime byetime = srcdat->GetBYETime();
 
-			if ((srcdat != owndata) && (byechecktime > byetime))
-			{
-				sourcelist.DeleteCurrentElement();
-				deleted = true;
-				byetimeout = true;
-			}
-		}
+		if (byechecktime > byetime)
+			RemoveTimedOutSource(srcdat,true);
+		else
+			byetimeouts.Schedule(*entry,RTPTimerWheel::GetTick(byetime));
+	}
 
-		if (!deleted)
-		{
-			RTPTime lastmsgtime = srcdat->INF_GetLastMessageTime();
+	membertimeouts.Advance(RTPTimerWheel::GetTick(generaltchecktime));
+	while ((entry = membertimeouts.PopExpired()) != 0)
+	{
+		RTPInternalSourceData *srcdat = (RTPInternalSourceData *)entry->GetOwner();
 
-			if ((srcdat != owndata) && (lastmsgtime < generaltchecktime))
-			{
-				sourcelist.DeleteCurrentElement();
-				deleted = true;
-				normaltimeout = true;
-			}
-		}
-		
-		if (!deleted)
-		{
-			newtotalcount++;
-			
-			if (issender)
-			{
-				RTPTime lastrtppacktime = srcdat->INF_GetLastRTPPacketTime();
+		if (srcdat == owndata)
+			continue;
 
-				if (lastrtppacktime < senderchecktime)
-				{
-					srcdat->ClearSenderFlag();
-					sendercount--;
-				}
-				else
-					newsendercount++;
-			}
+		RTPTime lastmsgtime = srcdat->INF_GetLastMessageTime();
 
-			if (isactive)
-				newactivecount++;
+		if (lastmsgtime < generaltchecktime)
+			RemoveTimedOutSource(srcdat,false);
+		else
+			membertimeouts.Schedule(*entry,RTPTimerWheel::GetTick(lastmsgtime));
+	}
 
-			if (notetimeout)
-				OnNoteTimeout(srcdat);
+	notetimeouts.Advance(RTPTimerWheel::GetTick(notechecktime));
+	while ((entry = notetimeouts.PopExpired()) != 0)
+	{
+		RTPInternalSourceData *srcdat = (RTPInternalSourceData *)entry->GetOwner();
+		size_t notelen;
 
-			sourcelist.GotoNextElement();
-		}
-		else // deleted entry
-		{
-			if (issender)
-				sendercount--;
-			if (isactive)
-				activecount--;
-			totalcount--;
+		srcdat->SDES_GetNote(&notelen);
+		if (notelen == 0)
+			continue;
 
-			if (byetimeout)
-				OnBYETimeout(srcdat);
-			if (normaltimeout)
-				OnTimeout(srcdat);
-			OnRemoveSource(srcdat);
-			RTPDelete(srcdat,GetMemoryManager());
+		RTPTime notetime = srcdat->INF_GetLastSDESNoteTime();
+			
+		if (notechecktime > notetime)
+		{
+			srcdat->ClearNote();
+			OnNoteTimeout(srcdat);
 		}
-	}	
-	
-#ifdef RTPDEBUG
-	if (newtotalcount != totalcount)
-	{
-		SafeCountTotal();
-		std::cout << "New total count " << newtotalcount << " doesnt match old total count " << totalcount << std::endl;
-	}
-	if (newsendercount != sendercount)
-	{
-		SafeCountSenders();
-		std::cout << "New sender count " << newsendercount << " doesnt match old sender count " << sendercount << std::endl;
+		else
+			notetimeouts.Schedule(*entry,RTPTimerWheel::GetTick(notetime));
 	}
-	if (newactivecount != activecount)
+
+	sendertimeouts.Advance(RTPTimerWheel::GetTick(senderchecktime));
+	while ((entry = sendertimeouts.PopExpired()) != 0)
 	{
-		std::cout << "New active count " << newactivecount << " doesnt match old active count " << activecount << std::endl;
-		SafeCountActive();
+		RTPInternalSourceData *srcdat = (RTPInternalSourceData *)entry->GetOwner();
+
+		if (!srcdat->IsSender())
+			continue;
+
+		RTPTime lastrtppacktime = srcdat->INF_GetLastRTPPacketTime();
+
+		if (lastrtppacktime < senderchecktime)
+		{
+			srcdat->ClearSenderFlag();
+			sendercount--;
+		}
+		else
+			sendertimeouts.Schedule(*entry,RTPTimerWheel::GetTick(lastrtppacktime));
 	}
+
+#ifdef RTPDEBUG
+	CheckCounts();
 #endif // RTPDEBUG
-	
-	totalcount = newtotalcount; // just to play it safe
-	sendercount = newsendercount;
-	activecount = newactivecount;
+}
+
+void RTPSources::ScheduleTimeouts(RTPInternalSourceData *srcdat)
+{
+	// An entry that's already scheduled is left alone, its key is corrected when it comes up
+	if (srcdat != owndata && !srcdat->GetMemberTimeoutEntry().IsScheduled())
+		membertimeouts.Schedule(srcdat->GetMemberTimeoutEntry(),RTPTimerWheel::GetTick(srcdat->INF_GetLastMessageTime()));
+	if (srcdat->IsSender() && !srcdat->GetSenderTimeoutEntry().IsScheduled())
+		sendertimeouts.Schedule(srcdat->GetSenderTimeoutEntry(),RTPTimerWheel::GetTick(srcdat->INF_GetLastRTPPacketTime()));
+	if (srcdat->ReceivedBYE() && !srcdat->GetBYETimeoutEntry().IsScheduled())
+		byetimeouts.Schedule(srcdat->GetBYETimeoutEntry(),RTPTimerWheel::GetTick(srcdat->GetBYETime()));
+
+	size_t notelen;
+
+	srcdat->SDES_GetNote(&notelen);
+	if (notelen != 0 && !srcdat->GetNoteTimeoutEntry().IsScheduled())
+		notetimeouts.Schedule(srcdat->GetNoteTimeoutEntry(),RTPTimerWheel::GetTick(srcdat->INF_GetLastSDESNoteTime()));
+}
+
+void RTPSources::RemoveTimedOutSource(RTPInternalSourceData *srcdat,bool byetimeout)
+{
+	sourcelist.GotoElement(srcdat->GetSSRC());
+	sourcelist.DeleteCurrentElement();
+	ForgetCachedSource(srcdat->GetSSRC());
+
+	totalcount--;
+	if (srcdat->IsSender())
+		sendercount--;
+	if (srcdat->IsActive())
+		activecount--;
+
+	if (byetimeout)
+		OnBYETimeout(srcdat);
+	else
+		OnTimeout(srcdat);
+	OnRemoveSource(srcdat);
+	RTPDelete(srcdat,GetMemoryManager()); // also removes its timer wheel entries
 }
 
 #ifdef RTPDEBUG
@@ -1349,6 +1287,31 @@ void RTPSources::SafeCountActive()
 	std::cout << "Actual active count: " << count << std::endl;
 }
 
+void RTPSources::CheckCounts()
+{
+	int total = 0, senders = 0, active = 0;
+
+	if (GotoFirstSource())
+	{
+		do
+		{
+			RTPSourceData *s = GetCurrentSourceInfo();
+
+			total++;
+			if (s->IsSender())
+				senders++;
+			if (s->IsActive())
+				active++;
+		} while (GotoNextSource());
+	}
+	if (total != totalcount)
+		std::cout << "Total count " << totalcount << " doesnt match actual total count " << total << std::endl;
+	if (senders != sendercount)
+		std::cout << "Sender count " << sendercount << " doesnt match actual sender count " << senders << std::endl;
+	if (active != activecount)
+		std::cout << "Active count " << activecount << " doesnt match actual active count " << active << std::endl;
+}
+
 #endif // RTPDEBUG
 
 bool RTPSources::CheckCollision(RTPInternalSourceData *srcdat,const RTPAddress *senderaddress,bool isrtp)
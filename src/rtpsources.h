@@ -40,11 +40,17 @@
 
 #include "rtpconfig.h"
 #include "rtpkeyhashtable.h"
+#include "rtpopenkeyhashtable.h"
 #include "rtcpsdespacket.h"
 #include "rtptypes.h"
 #include "rtpmemoryobject.h"
+#include "rtptimerwheel.h"
+#include "rtpsequencering.h"
 
 #define RTPSOURCES_HASHSIZE							8317
+// The cache of recently looked up participants has 2^RTPSOURCES_LOOKUPCACHEBITS entries
+#define RTPSOURCES_LOOKUPCACHEBITS						5
+#define RTPSOURCES_LOOKUPCACHESIZE						(1<<RTPSOURCES_LOOKUPCACHEBITS)
 
 namespace jrtplib
 {
@@ -52,6 +58,7 @@ namespace jrtplib
 class JRTPLIB_IMPORTEXPORT RTPSources_GetHashIndex
 {
 public:
+	static uint32_t GetHash(const uint32_t &ssrc)				{ return ssrc; }
 	static int GetIndex(const uint32_t &ssrc)				{ return ssrc%RTPSOURCES_HASHSIZE; }
 };
 	
@@ -94,6 +101,15 @@ public:
 	void SetProbationType(ProbationType probtype)							{ probationtype = probtype; }
 #endif // RTP_SUPPORT_PROBATION
 
+	/** Sets the number of consecutive sequence numbers the RTP packet queue of a participant can
+	 *  span; the value is rounded up to a power of two. When a packet arrives that lies beyond
+	 *  this window, the oldest packets in the queue are deleted. */
+	void SetPacketWindowSize(size_t s)								{ packetwindowsize = RTPSequenceRing::GetWindowSize(s); }
+
+	/** Returns the size of the window of the participants' RTP packet queues (default is
+	 *  RTP_DEFAULTPACKETWINDOWSIZE). */
+	uint32_t GetPacketWindowSize() const								{ return packetwindowsize; }
+
 	/** Creates an entry for our own SSRC identifier. */
 	int CreateOwnSSRC(uint32_t ssrc);
 
@@ -106,6 +122,11 @@ public:
 	 */
 	void SentRTPPacket();
 
+	/** Like RTPSources::SentRTPPacket(), but uses \c sendtime as the time at which the packet was sent
+	 *  instead of the current time; this allows the update to be postponed.
+	 */
+	void SentRTPPacket(const RTPTime &sendtime);
+
 	/** Processes a raw packet \c rawpack.
 	 *  Processes a raw packet \c rawpack. The instance \c trans will be used to check if this
 	 *  packet is one of our own packets. The flag \c acceptownpackets indicates whether own packets should be 
@@ -271,7 +292,8 @@ public:
 
 	/** Combines the functions SenderTimeout, BYETimeout, Timeout and NoteTimeout.
 	 *  Combines the functions SenderTimeout, BYETimeout, Timeout and NoteTimeout. This is more efficient
-	 *  than calling all four functions since only one iteration is needed in this function.
+	 *  than calling all four functions: instead of iterating over the source table, the timeouts are 
+	 *  tracked in timer wheels, so only the participants of which a deadline may have passed are examined.
 	 */
 	void MultipleTimeouts(const RTPTime &curtime,const RTPTime &sendertimeout,
 			      const RTPTime &byetimeout,const RTPTime &generaltimeout,
@@ -290,6 +312,7 @@ public:
 	void SafeCountTotal();
 	void SafeCountSenders();
 	void SafeCountActive();
+	void CheckCounts();
 #endif // RTPDEBUG
 protected:
 	/** Is called when an RTP packet is about to be processed. */
@@ -363,13 +386,33 @@ protected:
 	 *  `ispackethandled` is set to `true`, the packet will no longer be stored in this
 	 *  source's packet list. */
 	virtual void OnValidatedRTPPacket(RTPSourceData *srcdat, RTPPacket *rtppack, bool isonprobation, bool *ispackethandled);
+
+	/** Is called when \c rtppack was stored in the packet queue of the validated source \c srcdat, 
+	 *  so that it can be retrieved using RTPSourceData::GetNextPacket. */
+	virtual void OnStoredRTPPacket(RTPSourceData *srcdat, RTPPacket *rtppack);
 private:
 	void ClearSourceList();
 	int ObtainSourceDataInstance(uint32_t ssrc,RTPInternalSourceData **srcdat,bool *created);
 	int GetRTCPSourceData(uint32_t ssrc,const RTPAddress *senderaddress,RTPInternalSourceData **srcdat,bool *newsource);
 	bool CheckCollision(RTPInternalSourceData *srcdat,const RTPAddress *senderaddress,bool isrtp);
+	RTPInternalSourceData *LookupSource(uint32_t ssrc);
+	void ForgetCachedSource(uint32_t ssrc);
+	void ClearLookupCache();
+	static int GetLookupCacheIndex(uint32_t ssrc)						{ return (int)((ssrc*0x9E3779B1U) >> (32-RTPSOURCES_LOOKUPCACHEBITS)); }
+	void ScheduleTimeouts(RTPInternalSourceData *srcdat);
+	void RemoveTimedOutSource(RTPInternalSourceData *srcdat,bool byetimeout);
 	
-	RTPKeyHashTable<const uint32_t,RTPInternalSourceData*,RTPSources_GetHashIndex,RTPSOURCES_HASHSIZE> sourcelist;
+	RTPOpenKeyHashTable<const uint32_t,RTPInternalSourceData*,RTPSources_GetHashIndex> sourcelist;
+
+	// Direct-mapped cache in front of the source table; most sessions only receive from a few
+	// participants, which can then be found without a table lookup
+	class LookupCacheEntry
+	{
+	public:
+		uint32_t ssrc;
+		RTPInternalSourceData *srcdat;
+	};
+	LookupCacheEntry lookupcache[RTPSOURCES_LOOKUPCACHESIZE];
 	
 	int sendercount;
 	int totalcount;
@@ -378,9 +421,17 @@ private:
 #ifdef RTP_SUPPORT_PROBATION
 	ProbationType probationtype;
 #endif // RTP_SUPPORT_PROBATION
+	uint32_t packetwindowsize;
 
 	RTPInternalSourceData *owndata;
 
+	// Keyed by the time of the last activity of the corresponding kind; entries are only
+	// rescheduled when they come up and the participant turns out to be still active
+	RTPTimerWheel membertimeouts;
+	RTPTimerWheel sendertimeouts;
+	RTPTimerWheel byetimeouts;
+	RTPTimerWheel notetimeouts;
+
 	friend class RTPInternalSourceData;
 };
 
@@ -405,6 +456,7 @@ inline void RTPSources::OnUnknownPacketType(RTCPPacket *, const RTPTime &, const
 inline void RTPSources::OnUnknownPacketFormat(RTCPPacket *, const RTPTime &, const RTPAddress *)                    { }
 inline void RTPSources::OnNoteTimeout(RTPSourceData *)                                                              { }
 inline void RTPSources::OnValidatedRTPPacket(RTPSourceData *, RTPPacket *, bool, bool *)                            { }
+inline void RTPSources::OnStoredRTPPacket(RTPSourceData *, RTPPacket *)                                            { }
 
 } // end namespace
 
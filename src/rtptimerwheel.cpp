@@ -0,0 +1,344 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtptimerwheel.h"
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+#define RTPTIMERWHEEL_SLOTMASK									((uint64_t)(RTPTIMERWHEEL_NUMSLOTS-1))
+
+static inline int RTPTimerWheel_LowestBit(uint64_t bits)
+{
+	int n = 0;
+
+	while ((bits&1) == 0)
+	{
+		bits >>= 1;
+		n++;
+	}
+	return n;
+}
+
+RTPTimerWheel::RTPTimerWheel()
+{
+	for (int l = 0 ; l < RTPTIMERWHEEL_NUMLEVELS ; l++)
+	{
+		for (int s = 0 ; s < RTPTIMERWHEEL_NUMSLOTS ; s++)
+			slots[l][s] = 0;
+		occupied[l] = 0;
+	}
+	farlist = 0;
+	duelist = 0;
+	expiredlist = 0;
+	now = 0;
+	started = false;
+	numentries = 0;
+	numinslots = 0;
+}
+
+RTPTimerWheel::~RTPTimerWheel()
+{
+	Clear();
+}
+
+uint64_t RTPTimerWheel::GetTick(const RTPTime &t)
+{
+	double d = t.GetDouble();
+
+	if (d <= 0)
+		return 0;
+	return (uint64_t)(d*1000.0);
+}
+
+void RTPTimerWheel::Clear()
+{
+	for (int l = 0 ; l < RTPTIMERWHEEL_NUMLEVELS ; l++)
+	{
+		for (int s = 0 ; s < RTPTIMERWHEEL_NUMSLOTS ; s++)
+		{
+			while (slots[l][s])
+				Unlink(*slots[l][s]);
+		}
+	}
+	while (farlist)
+		Unlink(*farlist);
+	while (duelist)
+		Unlink(*duelist);
+	while (expiredlist)
+		Unlink(*expiredlist);
+	now = 0;
+	started = false;
+}
+
+void RTPTimerWheel::Schedule(RTPTimerWheelEntry &entry, uint64_t tick)
+{
+	entry.Unschedule();
+	entry.key = tick;
+	if (!started || tick < now)
+		Link(entry, DueList, 0);
+	else
+		Place(entry);
+}
+
+void RTPTimerWheel::Advance(uint64_t tick)
+{
+	if (!started)
+	{
+		// Everything that was scheduled so far is in the due list
+		started = true;
+		now = tick;
+	}
+
+	while (duelist)
+	{
+		RTPTimerWheelEntry *e = duelist;
+
+		Unlink(*e);
+		Link(*e, ExpiredList, 0);
+	}
+
+	while (now < tick)
+	{
+		if (numinslots == 0)
+		{
+			now = tick;
+			break;
+		}
+
+		uint64_t t = GetNextEventTime();
+
+		if (t >= tick)
+		{
+			SetTime(tick);
+			break;
+		}
+
+		// Moves the entries of higher levels that start at 't' down
+		SetTime(t);
+
+		// After this, the entries in the current slot of the lowest level have key 't'
+		RTPTimerWheelEntry *&head = slots[0][t&RTPTIMERWHEEL_SLOTMASK];
+
+		while (head)
+		{
+			RTPTimerWheelEntry *e = head;
+
+			Unlink(*e);
+			Link(*e, ExpiredList, 0);
+		}
+		SetTime(t+1);
+	}
+}
+
+RTPTimerWheelEntry *RTPTimerWheel::PopExpired()
+{
+	RTPTimerWheelEntry *e = expiredlist;
+
+	if (e)
+		Unlink(*e);
+	return e;
+}
+
+void RTPTimerWheel::Link(RTPTimerWheelEntry &entry, int level, int slot)
+{
+	RTPTimerWheelEntry **head;
+
+	if (level < RTPTIMERWHEEL_NUMLEVELS)
+	{
+		head = &slots[level][slot];
+		occupied[level] |= ((uint64_t)1) << slot;
+	}
+	else if (level == FarList)
+		head = &farlist;
+	else if (level == DueList)
+		head = &duelist;
+	else
+		head = &expiredlist;
+
+	entry.wheel = this;
+	entry.level = level;
+	entry.slot = slot;
+	entry.prev = 0;
+	entry.next = *head;
+	if (*head)
+		(*head)->prev = &entry;
+	*head = &entry;
+
+	numentries++;
+	if (level <= FarList)
+		numinslots++;
+}
+
+void RTPTimerWheel::Unlink(RTPTimerWheelEntry &entry)
+{
+	RTPTimerWheelEntry **head;
+	int level = entry.level;
+	int slot = entry.slot;
+
+	if (level < RTPTIMERWHEEL_NUMLEVELS)
+		head = &slots[level][slot];
+	else if (level == FarList)
+		head = &farlist;
+	else if (level == DueList)
+		head = &duelist;
+	else
+		head = &expiredlist;
+
+	if (entry.prev)
+		entry.prev->next = entry.next;
+	else
+		*head = entry.next;
+	if (entry.next)
+		entry.next->prev = entry.prev;
+
+	if (level < RTPTIMERWHEEL_NUMLEVELS && *head == 0)
+		occupied[level] &= ~(((uint64_t)1) << slot);
+
+	entry.wheel = 0;
+	entry.prev = 0;
+	entry.next = 0;
+
+	numentries--;
+	if (level <= FarList)
+		numinslots--;
+}
+
+void RTPTimerWheel::Place(RTPTimerWheelEntry &entry)
+{
+	// Use the lowest level of which the current range contains the key
+	for (int l = 0 ; l < RTPTIMERWHEEL_NUMLEVELS ; l++)
+	{
+		int shift = RTPTIMERWHEEL_LEVELBITS*(l+1);
+
+		if ((entry.key >> shift) == (now >> shift))
+		{
+			Link(entry, l, (int)((entry.key >> (RTPTIMERWHEEL_LEVELBITS*l))&RTPTIMERWHEEL_SLOTMASK));
+			return;
+		}
+	}
+	Link(entry, FarList, 0);
+}
+
+void RTPTimerWheel::MoveList(RTPTimerWheelEntry *&head, int level, int slot)
+{
+	// Detach the list first, since entries may be placed in the same list again
+	RTPTimerWheelEntry *e = head;
+
+	head = 0;
+	if (level < RTPTIMERWHEEL_NUMLEVELS)
+		occupied[level] &= ~(((uint64_t)1) << slot);
+
+	while (e)
+	{
+		RTPTimerWheelEntry *next = e->next;
+
+		e->wheel = 0;
+		e->prev = 0;
+		e->next = 0;
+		numentries--;
+		numinslots--;
+
+		Place(*e);
+		e = next;
+	}
+}
+
+void RTPTimerWheel::SetTime(uint64_t t)
+{
+	// There are no entries with a key between 'now' and 't', but entries of the
+	// higher levels and the far list may need to be moved down when 't' starts
+	// a new slot of those levels
+	now = t;
+
+	uint64_t farmask = (((uint64_t)1) << (RTPTIMERWHEEL_LEVELBITS*RTPTIMERWHEEL_NUMLEVELS))-1;
+
+	if ((t&farmask) == 0 && farlist)
+		MoveList(farlist, FarList, 0);
+
+	for (int l = RTPTIMERWHEEL_NUMLEVELS-1 ; l > 0 ; l--)
+	{
+		int shift = RTPTIMERWHEEL_LEVELBITS*l;
+
+		if ((t&((((uint64_t)1) << shift)-1)) != 0)
+			continue;
+
+		int s = (int)((t >> shift)&RTPTIMERWHEEL_SLOTMASK);
+
+		if (slots[l][s])
+			MoveList(slots[l][s], l, s);
+	}
+}
+
+uint64_t RTPTimerWheel::GetNextEventTime() const
+{
+	uint64_t best = ~((uint64_t)0);
+
+	// On the lowest level, the slots from the current one on can hold entries
+	uint64_t c = now&RTPTIMERWHEEL_SLOTMASK;
+	uint64_t bits = occupied[0] >> c;
+
+	if (bits)
+		best = now + (uint64_t)RTPTimerWheel_LowestBit(bits);
+
+	// On the higher levels, only the slots after the current one can hold entries
+	for (int l = 1 ; l < RTPTIMERWHEEL_NUMLEVELS ; l++)
+	{
+		int shift = RTPTIMERWHEEL_LEVELBITS*l;
+
+		c = (now >> shift)&RTPTIMERWHEEL_SLOTMASK;
+		bits = occupied[l] & ~((((uint64_t)2) << c)-1);
+		if (bits)
+		{
+			uint64_t roundstart = (now >> (shift+RTPTIMERWHEEL_LEVELBITS)) << (shift+RTPTIMERWHEEL_LEVELBITS);
+			uint64_t t = roundstart + (((uint64_t)RTPTimerWheel_LowestBit(bits)) << shift);
+
+			if (t < best)
+				best = t;
+		}
+	}
+
+	if (farlist)
+	{
+		int shift = RTPTIMERWHEEL_LEVELBITS*RTPTIMERWHEEL_NUMLEVELS;
+		uint64_t t = ((now >> shift)+1) << shift;
+
+		if (t < best)
+			best = t;
+	}
+	return best;
+}
+
+} // end namespace
+
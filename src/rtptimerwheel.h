@@ -0,0 +1,160 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtptimerwheel.h
+ */
+
+#ifndef RTPTIMERWHEEL_H
+
+#define RTPTIMERWHEEL_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtptimeutilities.h"
+
+// Each level of the wheel has 2^RTPTIMERWHEEL_LEVELBITS slots; with one millisecond ticks, 
+// five levels cover about twelve days, later entries are kept in a separate list
+#define RTPTIMERWHEEL_LEVELBITS									6
+#define RTPTIMERWHEEL_NUMSLOTS									(1<<RTPTIMERWHEEL_LEVELBITS)
+#define RTPTIMERWHEEL_NUMLEVELS									5
+
+namespace jrtplib
+{
+
+class RTPTimerWheel;
+
+/** An entry that can be scheduled in an RTPTimerWheel.
+ *  An entry is typically a member of the object it refers to, which can be retrieved using
+ *  RTPTimerWheelEntry::GetOwner. It removes itself from the wheel when it's destroyed, so the
+ *  object can be deleted at any time.
+ */
+class JRTPLIB_IMPORTEXPORT RTPTimerWheelEntry
+{
+	JRTPLIB_NO_COPY(RTPTimerWheelEntry)
+public:
+	RTPTimerWheelEntry() : owner(0), wheel(0), prev(0), next(0), key(0), level(0), slot(0)	{ }
+	~RTPTimerWheelEntry()											{ Unschedule(); }
+
+	/** Stores the object this entry refers to. */
+	void SetOwner(void *o)											{ owner = o; }
+
+	/** Returns the object this entry refers to. */
+	void *GetOwner() const											{ return owner; }
+
+	/** Returns \c true if the entry is currently stored in a timer wheel. */
+	bool IsScheduled() const										{ return wheel != 0; }
+
+	/** Returns the tick with which the entry was last scheduled. */
+	uint64_t GetKey() const											{ return key; }
+
+	/** Removes the entry from the timer wheel it's stored in, if any. */
+	void Unschedule();
+private:
+	void *owner;
+	RTPTimerWheel *wheel;
+	RTPTimerWheelEntry *prev, *next;
+	uint64_t key;
+	int level, slot;
+
+	friend class RTPTimerWheel;
+};
+
+/** A hierarchical timer wheel.
+ *  Entries are stored using a key, a time expressed in ticks of one millisecond. A call to
+ *  RTPTimerWheel::Advance collects all entries of which the key lies before the specified tick,
+ *  after which they can be retrieved one by one using RTPTimerWheel::PopExpired. Each level of 
+ *  the wheel covers a range that's RTPTIMERWHEEL_NUMSLOTS times larger than the one below it;
+ *  entries are moved to a lower level when their slot is reached, so that advancing the wheel
+ *  only touches the entries that actually expire, and the slots in which entries are stored.
+ *  The wheel's time never goes back: an entry that's scheduled with a key before the time that
+ *  has already been reached, is returned by the next call to RTPTimerWheel::Advance.
+ */
+class JRTPLIB_IMPORTEXPORT RTPTimerWheel
+{
+	JRTPLIB_NO_COPY(RTPTimerWheel)
+public:
+	RTPTimerWheel();
+	~RTPTimerWheel();
+
+	/** Converts the time \c t to a key for the timer wheel. */
+	static uint64_t GetTick(const RTPTime &t);
+
+	/** Removes all entries from the wheel. */
+	void Clear();
+
+	/** Stores \c entry using key \c tick, removing it from the wheel it was previously stored in. */
+	void Schedule(RTPTimerWheelEntry &entry, uint64_t tick);
+
+	/** Advances the wheel to \c tick, collecting all entries with a key before \c tick and
+	 *  all entries that were scheduled with a key before the previously reached time. */
+	void Advance(uint64_t tick);
+
+	/** Returns one of the entries that were collected by RTPTimerWheel::Advance and removes it
+	 *  from the wheel, or returns null if there are none left. */
+	RTPTimerWheelEntry *PopExpired();
+
+	/** Returns the number of entries stored in the wheel, including the collected ones. */
+	size_t GetNumberOfEntries() const								{ return numentries; }
+private:
+	// Besides the levels of the wheel, there are three lists: one for entries that lie beyond
+	// the range of the highest level, one for entries that were scheduled in the past and one
+	// for the entries that were collected by Advance
+	enum { FarList = RTPTIMERWHEEL_NUMLEVELS, DueList, ExpiredList };
+
+	void Link(RTPTimerWheelEntry &entry, int level, int slot);
+	void Unlink(RTPTimerWheelEntry &entry);
+	void Place(RTPTimerWheelEntry &entry);
+	void MoveList(RTPTimerWheelEntry *&head, int level, int slot);
+	void SetTime(uint64_t t);
+	uint64_t GetNextEventTime() const;
+
+	RTPTimerWheelEntry *slots[RTPTIMERWHEEL_NUMLEVELS][RTPTIMERWHEEL_NUMSLOTS];
+	uint64_t occupied[RTPTIMERWHEEL_NUMLEVELS];
+	RTPTimerWheelEntry *farlist, *duelist, *expiredlist;
+	uint64_t now;
+	bool started;
+	size_t numentries, numinslots;
+
+	friend class RTPTimerWheelEntry;
+};
+
+inline void RTPTimerWheelEntry::Unschedule()
+{
+	if (wheel)
+		wheel->Unlink(*this);
+}
+
+} // end namespace
+
+#endif // RTPTIMERWHEEL_H
+
@@ -42,6 +42,8 @@
 #include "rtptypes.h"
 #include "rtpmemoryobject.h"
 #include "rtptimeutilities.h"
+#include "rtpsocketutil.h"
+#include "rtperrors.h"
 
 namespace jrtplib
 {
@@ -51,6 +53,7 @@ class RTPAddress;
 class RTPTransmissionParams;
 class RTPTime;
 class RTPTransmissionInfo;
+class RTPReceiveBufferPool;
 
 /** Abstract class from which actual transmission components should be derived.
  *  Abstract class from which actual transmission components should be derived.
@@ -73,7 +76,8 @@ public:
 		IPv6UDPProto, /**< Specifies the internal UDP over IPv6 transmitter. */
 		TCPProto, /**< Specifies the internal TCP transmitter. */
 		ExternalProto, /**< Specifies the transmitter which can send packets using an external mechanism, and which can have received packets injected into it - see RTPExternalTransmitter for additional information. */
-		UserDefinedProto  /**< Specifies a user defined, external transmitter. */
+		UserDefinedProto, /**< Specifies a user defined, external transmitter. */
+		IoUringProto /**< Specifies the internal UDP over IPv4 transmitter based on Linux' io_uring interface. */
 	};
 
 	/** Three kind of receive modes can be specified. */
@@ -160,6 +164,13 @@ public:
 	/** Send a packet with length \c len containing \c data to all RTCP addresses of the current destination list. */
 	virtual int SendRTCPData(const void *data,size_t len) = 0;
 
+	/** Sends the \c numpackets packets in \c packets, with lengths \c lengths, to all RTP addresses
+	 *  of the current destination list. Transmission components that can hand such a burst of packets
+	 *  to the operating system at once can override this; the default implementation simply calls
+	 *  RTPTransmitter::SendRTPData for each packet.
+	 */
+	virtual int SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets);
+
 	/** Adds the address specified by \c addr to the list of destinations. */
 	virtual int AddDestination(const RTPAddress &addr) = 0;
 
@@ -169,6 +180,19 @@ public:
 	/** Clears the list of destinations. */
 	virtual void ClearDestinations() = 0;
 
+	/** Adds the \c numaddresses addresses in \c addresses to the list of destinations. Either all
+	 *  of them are added, or, if one of them can't be added, none of them are. Transmission components
+	 *  that can apply such a change at once can override this; the default implementation calls
+	 *  RTPTransmitter::AddDestination for each address.
+	 */
+	virtual int AddDestinations(const RTPAddress * const *addresses,size_t numaddresses);
+
+	/** Deletes the \c numaddresses addresses in \c addresses from the list of destinations. Either
+	 *  all of them are deleted, or, if one of them can't be deleted, none of them are. The default
+	 *  implementation calls RTPTransmitter::DeleteDestination for each address.
+	 */
+	virtual int DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses);
+
 	/** Returns \c true if the transmission component supports multicasting. */
 	virtual bool SupportsMulticasting() = 0;
 
@@ -215,6 +239,21 @@ public:
 	/** Returns the raw data of a received RTP packet (received during the Poll function) 
 	 *  in an RTPRawPacket instance. */
 	virtual RTPRawPacket *GetNextPacket() = 0;
+
+	/** Instructs the transmitter to store incoming packets in buffers obtained from \c pool, or
+	 *  to stop using a pool if \c pool is null. A transmitter that supports this keeps a reference
+	 *  to the pool until it is replaced or the transmitter is destroyed; the default implementation
+	 *  ignores the pool.
+	 */
+	virtual int SetReceiveBufferPool(RTPReceiveBufferPool *pool);
+
+	/** Stores the sockets on which the transmitter receives data in \c sockets, which has room for
+	 *  \c *numsockets entries, and sets \c *numsockets to the number of sockets that were stored.
+	 *  By waiting for incoming data on these sockets and calling RTPTransmitter::Poll when some
+	 *  arrives, a single thread can serve many transmitters (see RTPReactor). The default
+	 *  implementation returns ERR_RTP_TRANSMITTER_NORECEIVESOCKETS.
+	 */
+	virtual int GetReceiveSockets(SocketType *sockets,size_t *numsockets);
 #ifdef RTPDEBUG
 	virtual void Dump() = 0;
 #endif // RTPDEBUG
@@ -257,6 +296,60 @@ private:
 	RTPTransmitter::TransmissionProtocol protocol;
 };
 
+inline int RTPTransmitter::SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets)
+{
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		int status = SendRTPData(packets[i],lengths[i]);
+		if (status < 0)
+			return status;
+	}
+	return 0;
+}
+
+inline int RTPTransmitter::AddDestinations(const RTPAddress * const *addresses,size_t numaddresses)
+{
+	for (size_t i = 0 ; i < numaddresses ; i++)
+	{
+		int status = AddDestination(*addresses[i]);
+		if (status < 0)
+		{
+			while (i > 0)
+				DeleteDestination(*addresses[--i]);
+			return status;
+		}
+	}
+	return 0;
+}
+
+inline int RTPTransmitter::DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses)
+{
+	for (size_t i = 0 ; i < numaddresses ; i++)
+	{
+		int status = DeleteDestination(*addresses[i]);
+		if (status < 0)
+		{
+			while (i > 0)
+				AddDestination(*addresses[--i]);
+			return status;
+		}
+	}
+	return 0;
+}
+
+inline int RTPTransmitter::SetReceiveBufferPool(RTPReceiveBufferPool *pool)
+{
+	JRTPLIB_UNUSED(pool);
+	return 0;
+}
+
+inline int RTPTransmitter::GetReceiveSockets(SocketType *sockets,size_t *numsockets)
+{
+	JRTPLIB_UNUSED(sockets);
+	JRTPLIB_UNUSED(numsockets);
+	return ERR_RTP_TRANSMITTER_NORECEIVESOCKETS;
+}
+
 } // end namespace
 
 #endif // RTPTRANSMITTER_H
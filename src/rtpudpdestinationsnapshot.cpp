@@ -0,0 +1,83 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpudpdestinationsnapshot.h"
+#include "rtpsocketutilinternal.h"
+#include "rtperrors.h"
+#include <string.h>
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPUDPDestinationSnapshot::RTPUDPDestinationSnapshot(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	numdest = 0;
+	addrlen = 0;
+	addresses = 0;
+}
+
+RTPUDPDestinationSnapshot::~RTPUDPDestinationSnapshot()
+{
+	if (addresses)
+		RTPDeleteByteArray(addresses,GetMemoryManager());
+}
+
+int RTPUDPDestinationSnapshot::Create(size_t n, size_t len)
+{
+	if (addresses)
+	{
+		RTPDeleteByteArray(addresses,GetMemoryManager());
+		addresses = 0;
+	}
+	numdest = 0;
+	addrlen = len;
+
+	if (n == 0)
+		return 0;
+
+	addresses = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t[2*n*len];
+	if (addresses == 0)
+		return ERR_RTP_OUTOFMEM;
+	numdest = n;
+	return 0;
+}
+
+void RTPUDPDestinationSnapshot::SetDestination(size_t idx, const struct sockaddr *rtpaddr, const struct sockaddr *rtcpaddr)
+{
+	memcpy(addresses + (2*idx)*addrlen, rtpaddr, addrlen);
+	memcpy(addresses + (2*idx+1)*addrlen, rtcpaddr, addrlen);
+}
+
+} // end namespace
+
@@ -0,0 +1,129 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpudpdestinationsnapshot.h
+ */
+
+#ifndef RTPUDPDESTINATIONSNAPSHOT_H
+
+#define RTPUDPDESTINATIONSNAPSHOT_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+#ifdef RTP_HAVE_STDATOMIC
+	#include <atomic>
+#endif // RTP_HAVE_STDATOMIC
+
+struct sockaddr;
+
+namespace jrtplib
+{
+
+/** An immutable copy of the destination list of a UDP transmitter.
+ *  Instead of iterating over the hash table that holds the destinations each
+ *  time a packet is sent, the RTPUDPv4Transmitter and RTPUDPv6Transmitter classes
+ *  store the RTP and RTCP addresses of all destinations in such a snapshot
+ *  whenever the destination list changes. The send path only uses the snapshot,
+ *  so that changing the destinations doesn't need to wait until a packet has been
+ *  sent to all of them, and vice versa.
+ */
+class JRTPLIB_IMPORTEXPORT RTPUDPDestinationSnapshot : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPUDPDestinationSnapshot)
+public:
+	RTPUDPDestinationSnapshot(RTPMemoryManager *mgr = 0);
+	~RTPUDPDestinationSnapshot();
+
+	/** Allocates room for \c numdest destinations, for which the RTP and RTCP socket
+	 *  addresses each take \c addrlen bytes; these must then be set using
+	 *  RTPUDPDestinationSnapshot::SetDestination. */
+	int Create(size_t numdest, size_t addrlen);
+
+	/** Stores the RTP and RTCP addresses of the destination at position \c idx. */
+	void SetDestination(size_t idx, const struct sockaddr *rtpaddr, const struct sockaddr *rtcpaddr);
+
+	/** Returns the number of destinations in the snapshot. */
+	size_t GetNumberOfDestinations() const							{ return numdest; }
+
+	/** Returns the length of each of the stored socket addresses. */
+	size_t GetAddressLength() const									{ return addrlen; }
+
+	/** Returns the RTP address of the destination at position \c idx. */
+	const struct sockaddr *GetRTPAddress(size_t idx) const			{ return (const struct sockaddr *)(addresses + (2*idx)*addrlen); }
+
+	/** Returns the RTCP address of the destination at position \c idx. */
+	const struct sockaddr *GetRTCPAddress(size_t idx) const			{ return (const struct sockaddr *)(addresses + (2*idx+1)*addrlen); }
+private:
+	size_t numdest, addrlen;
+	uint8_t *addresses;
+};
+
+/** Hands over destination snapshots from the functions that change the destination list to the send path.
+ *  Each snapshot has exactly one owner at a time: a new snapshot is published by swapping it
+ *  into this slot, and the send path takes it by swapping in a null pointer. Whoever obtains a
+ *  snapshot from RTPUDPDestinationSnapshotSlot::Exchange is responsible for deleting it, so no
+ *  reference counting or waiting for readers is needed. When \c std::atomic is not available,
+ *  the calls to RTPUDPDestinationSnapshotSlot::Exchange must be protected by a mutex.
+ */
+class JRTPLIB_IMPORTEXPORT RTPUDPDestinationSnapshotSlot
+{
+	JRTPLIB_NO_COPY(RTPUDPDestinationSnapshotSlot)
+public:
+	RTPUDPDestinationSnapshotSlot() : snapshot(0)					{ }
+
+	/** Stores \c s in the slot and returns the snapshot that was stored previously. */
+	RTPUDPDestinationSnapshot *Exchange(RTPUDPDestinationSnapshot *s);
+private:
+#ifdef RTP_HAVE_STDATOMIC
+	std::atomic<RTPUDPDestinationSnapshot *> snapshot;
+#else
+	RTPUDPDestinationSnapshot *snapshot;
+#endif // RTP_HAVE_STDATOMIC
+};
+
+inline RTPUDPDestinationSnapshot *RTPUDPDestinationSnapshotSlot::Exchange(RTPUDPDestinationSnapshot *s)
+{
+#ifdef RTP_HAVE_STDATOMIC
+	return snapshot.exchange(s);
+#else
+	RTPUDPDestinationSnapshot *prev = snapshot;
+	snapshot = s;
+	return prev;
+#endif // RTP_HAVE_STDATOMIC
+}
+
+} // end namespace
+
+#endif // RTPUDPDESTINATIONSNAPSHOT_H
+
@@ -0,0 +1,309 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpudpreceivebatch.h"
+#include "rtpsocketutilinternal.h"
+#include "rtperrors.h"
+#include <errno.h>
+#include <string.h>
+#ifdef RTP_HAVE_UDP_GRO
+	#include <netinet/udp.h>
+#endif // RTP_HAVE_UDP_GRO
+#ifdef RTP_HAVE_SO_TIMESTAMPNS
+	#include <time.h>
+#endif // RTP_HAVE_SO_TIMESTAMPNS
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPUDPReceiveBatch::RTPUDPReceiveBatch(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	batchsize = 0;
+	datagramsize = 0;
+	controlsize = 0;
+	memblock = 0;
+	buffers = 0;
+	controlbuffers = 0;
+	msgs = 0;
+	iovecs = 0;
+	addresses = 0;
+	timestamps = false;
+	clockoffset = 0;
+}
+
+RTPUDPReceiveBatch::~RTPUDPReceiveBatch()
+{
+	Destroy();
+}
+
+void RTPUDPReceiveBatch::Destroy()
+{
+	if (memblock)
+		RTPDeleteByteArray(memblock,GetMemoryManager());
+
+	batchsize = 0;
+	datagramsize = 0;
+	controlsize = 0;
+	memblock = 0;
+	buffers = 0;
+	controlbuffers = 0;
+	msgs = 0;
+	iovecs = 0;
+	addresses = 0;
+	timestamps = false;
+	clockoffset = 0;
+}
+
+#ifdef RTP_HAVE_RECVMMSG
+
+int RTPUDPReceiveBatch::Create(size_t bsize, size_t dsize, bool getsegmentsize, bool gettimestamps)
+{
+	if (bsize == 0 || dsize == 0)
+		return ERR_RTP_UDPRECEIVEBATCH_ILLEGALSIZE;
+
+	Destroy();
+
+	size_t csize = 0;
+#ifdef RTP_HAVE_UDP_GRO
+	if (getsegmentsize)
+		csize = CMSG_SPACE(sizeof(int));
+#else
+	JRTPLIB_UNUSED(getsegmentsize);
+#endif // RTP_HAVE_UDP_GRO
+#ifdef RTP_HAVE_SO_TIMESTAMPNS
+	if (gettimestamps)
+		csize += CMSG_SPACE(sizeof(struct timespec));
+#else
+	gettimestamps = false;
+#endif // RTP_HAVE_SO_TIMESTAMPNS
+
+	// Everything is stored in a single block: first the structures that need
+	// to be aligned, then the actual datagram buffers
+	size_t msgslen = bsize*sizeof(struct mmsghdr);
+	size_t iovecslen = bsize*sizeof(struct iovec);
+	size_t addresseslen = bsize*sizeof(struct sockaddr_storage);
+	size_t controllen = bsize*csize;
+	size_t totallen = msgslen + iovecslen + addresseslen + controllen + bsize*dsize;
+
+	memblock = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t[totallen];
+	if (memblock == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	msgs = (struct mmsghdr *)memblock;
+	iovecs = (struct iovec *)(memblock + msgslen);
+	addresses = (struct sockaddr_storage *)(memblock + msgslen + iovecslen);
+	controlbuffers = (csize > 0)?(memblock + msgslen + iovecslen + addresseslen):0;
+	buffers = memblock + msgslen + iovecslen + addresseslen + controllen;
+	batchsize = bsize;
+	datagramsize = dsize;
+	controlsize = csize;
+	timestamps = gettimestamps;
+	clockoffset = 0;
+
+	memset(msgs, 0, msgslen);
+	for (size_t i = 0 ; i < batchsize ; i++)
+	{
+		iovecs[i].iov_base = buffers + i*datagramsize;
+		iovecs[i].iov_len = datagramsize;
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &addresses[i];
+		if (controlsize > 0)
+			msgs[i].msg_hdr.msg_control = controlbuffers + i*controlsize;
+	}
+
+	stats.SetBatchSize(batchsize);
+	return 0;
+}
+
+int RTPUDPReceiveBatch::Receive(SocketType sock)
+{
+	if (batchsize == 0)
+		return 0;
+
+	// The name and control lengths and the flags are modified by the call, so
+	// they need to be reset each time
+	for (size_t i = 0 ; i < batchsize ; i++)
+	{
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+		msgs[i].msg_hdr.msg_controllen = controlsize;
+		msgs[i].msg_hdr.msg_flags = 0;
+		msgs[i].msg_len = 0;
+	}
+
+	int num;
+	do
+	{
+		num = recvmmsg(sock, msgs, (unsigned int)batchsize, MSG_DONTWAIT, 0);
+	} while (num < 0 && errno == EINTR);
+
+	// Like the single datagram version in the transmitters, we're not going
+	// to treat errors here as fatal (e.g. an ICMP error could be reported on
+	// an UDP socket): it just means that no data was read
+	if (num < 0)
+		num = 0;
+
+#ifdef RTP_HAVE_SO_TIMESTAMPNS
+	// The kernel timestamps are wallclock times, while RTPTime::CurrentTime may
+	// be based on a monotonic clock. Measuring the difference once per batch
+	// keeps the receive times consistent with the rest of the library, even
+	// if the system clock was changed in the meantime
+	if (timestamps && num > 0)
+	{
+		struct timespec ts;
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		clockoffset = RTPTime::CurrentTime().GetDouble() - ((double)ts.tv_sec + (double)ts.tv_nsec*1e-9);
+	}
+#endif // RTP_HAVE_SO_TIMESTAMPNS
+
+	stats.RegisterBatch((size_t)num);
+	return num;
+}
+
+size_t RTPUDPReceiveBatch::GetDatagramLength(size_t idx) const
+{
+	return msgs[idx].msg_len;
+}
+
+bool RTPUDPReceiveBatch::IsDatagramTruncated(size_t idx) const
+{
+	return (msgs[idx].msg_hdr.msg_flags & MSG_TRUNC)?true:false;
+}
+
+size_t RTPUDPReceiveBatch::GetDatagramSegmentSize(size_t idx) const
+{
+#ifdef RTP_HAVE_UDP_GRO
+	if (controlsize == 0)
+		return 0;
+
+	struct msghdr *hdr = &msgs[idx].msg_hdr;
+	for (struct cmsghdr *cm = CMSG_FIRSTHDR(hdr) ; cm != 0 ; cm = CMSG_NXTHDR(hdr, cm))
+	{
+		if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO)
+		{
+			int segsize;
+
+			memcpy(&segsize, CMSG_DATA(cm), sizeof(int));
+			return (segsize > 0)?(size_t)segsize:0;
+		}
+	}
+#else
+	JRTPLIB_UNUSED(idx);
+#endif // RTP_HAVE_UDP_GRO
+	return 0;
+}
+
+bool RTPUDPReceiveBatch::GetDatagramReceiveTime(size_t idx, RTPTime &t) const
+{
+#ifdef RTP_HAVE_SO_TIMESTAMPNS
+	if (!timestamps)
+		return false;
+
+	struct msghdr *hdr = &msgs[idx].msg_hdr;
+	for (struct cmsghdr *cm = CMSG_FIRSTHDR(hdr) ; cm != 0 ; cm = CMSG_NXTHDR(hdr, cm))
+	{
+		if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS)
+		{
+			struct timespec ts;
+
+			memcpy(&ts, CMSG_DATA(cm), sizeof(struct timespec));
+			t = RTPTime((double)ts.tv_sec + (double)ts.tv_nsec*1e-9 + clockoffset);
+			return true;
+		}
+	}
+#else
+	JRTPLIB_UNUSED(idx);
+	JRTPLIB_UNUSED(t);
+#endif // RTP_HAVE_SO_TIMESTAMPNS
+	return false;
+}
+
+const struct sockaddr *RTPUDPReceiveBatch::GetSourceAddress(size_t idx) const
+{
+	return (const struct sockaddr *)&addresses[idx];
+}
+
+#else
+
+int RTPUDPReceiveBatch::Create(size_t bsize, size_t dsize, bool getsegmentsize, bool gettimestamps)
+{
+	JRTPLIB_UNUSED(bsize);
+	JRTPLIB_UNUSED(dsize);
+	JRTPLIB_UNUSED(getsegmentsize);
+	JRTPLIB_UNUSED(gettimestamps);
+	return ERR_RTP_UDPRECEIVEBATCH_NORECVMMSGSUPPORT;
+}
+
+int RTPUDPReceiveBatch::Receive(SocketType sock)
+{
+	JRTPLIB_UNUSED(sock);
+	return 0;
+}
+
+size_t RTPUDPReceiveBatch::GetDatagramLength(size_t idx) const
+{
+	JRTPLIB_UNUSED(idx);
+	return 0;
+}
+
+bool RTPUDPReceiveBatch::IsDatagramTruncated(size_t idx) const
+{
+	JRTPLIB_UNUSED(idx);
+	return true;
+}
+
+size_t RTPUDPReceiveBatch::GetDatagramSegmentSize(size_t idx) const
+{
+	JRTPLIB_UNUSED(idx);
+	return 0;
+}
+
+bool RTPUDPReceiveBatch::GetDatagramReceiveTime(size_t idx, RTPTime &t) const
+{
+	JRTPLIB_UNUSED(idx);
+	JRTPLIB_UNUSED(t);
+	return false;
+}
+
+const struct sockaddr *RTPUDPReceiveBatch::GetSourceAddress(size_t idx) const
+{
+	JRTPLIB_UNUSED(idx);
+	return 0;
+}
+
+#endif // RTP_HAVE_RECVMMSG
+
+} // end namespace
+
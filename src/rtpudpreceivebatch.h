@@ -0,0 +1,179 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpudpreceivebatch.h
+ */
+
+#ifndef RTPUDPRECEIVEBATCH_H
+
+#define RTPUDPRECEIVEBATCH_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+#include "rtpsocketutil.h"
+#include "rtptimeutilities.h"
+#include <vector>
+
+struct sockaddr;
+struct mmsghdr;
+struct iovec;
+struct sockaddr_storage;
+
+namespace jrtplib
+{
+
+/** Describes how well the batched receive calls of a transmitter were filled.
+ *  Each time a transmitter reads a batch of datagrams using a single system call,
+ *  the number of datagrams that were returned is recorded. These statistics can
+ *  be used to tune the batch size that's set in the transmission parameters: if
+ *  most batches are full, a larger batch size may help, if most batches only
+ *  contain one or two datagrams, the batch size can be reduced.
+ */
+class JRTPLIB_IMPORTEXPORT RTPReceiveBatchStatistics
+{
+public:
+	RTPReceiveBatchStatistics()										{ Clear(); }
+
+	/** Returns the maximum number of datagrams that can be returned by one call. */
+	size_t GetBatchSize() const										{ return fillcounts.size(); }
+
+	/** Returns the number of receive calls that returned at least one datagram. */
+	uint64_t GetNumberOfBatches() const								{ return numbatches; }
+
+	/** Returns the number of receive calls that did not return any datagram. */
+	uint64_t GetNumberOfEmptyCalls() const							{ return numemptycalls; }
+
+	/** Returns the total number of datagrams that were received. */
+	uint64_t GetNumberOfDatagrams() const							{ return numdatagrams; }
+
+	/** Returns the number of batches that were filled completely. */
+	uint64_t GetNumberOfFullBatches() const							{ return (fillcounts.empty())?0:fillcounts.back(); }
+
+	/** Returns the number of batches that contained exactly \c n datagrams,
+	 *  where \c n ranges from one to the batch size. */
+	uint64_t GetNumberOfBatchesWithFill(size_t n) const				{ return (n == 0 || n > fillcounts.size())?0:fillcounts[n-1]; }
+
+	/** Returns the average number of datagrams per non-empty batch. */
+	double GetAverageFill() const									{ return (numbatches == 0)?0:((double)numdatagrams/(double)numbatches); }
+
+	/** Resets all counters to zero. */
+	void Clear()													{ numbatches = 0; numemptycalls = 0; numdatagrams = 0; for (size_t i = 0 ; i < fillcounts.size() ; i++) fillcounts[i] = 0; }
+private:
+	void SetBatchSize(size_t n)										{ fillcounts.resize(n); Clear(); }
+	void RegisterBatch(size_t n)									{ if (n == 0) numemptycalls++; else { numbatches++; numdatagrams += n; fillcounts[n-1]++; } }
+
+	uint64_t numbatches, numemptycalls, numdatagrams;
+	std::vector<uint64_t> fillcounts;
+
+	friend class RTPUDPReceiveBatch;
+};
+
+/** Helper class for the UDP transmitters to read several datagrams from a socket at once.
+ *  This class holds the buffers, source addresses and message headers that are needed
+ *  to read up to a specific number of datagrams from a socket using a single \c recvmmsg
+ *  call. It is used internally by the RTPUDPv4Transmitter and RTPUDPv6Transmitter
+ *  classes when a receive batch size larger than one was requested and the platform
+ *  supports this system call.
+ */
+class JRTPLIB_IMPORTEXPORT RTPUDPReceiveBatch : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPUDPReceiveBatch)
+public:
+	RTPUDPReceiveBatch(RTPMemoryManager *mgr = 0);
+	~RTPUDPReceiveBatch();
+
+	/** Allocates room for \c batchsize datagrams of at most \c datagramsize bytes each. If
+	 *  \c getsegmentsize is \c true, room is also reserved to receive the segment size of
+	 *  datagrams that were coalesced by the kernel (UDP generic receive offload). If
+	 *  \c gettimestamps is \c true, room is reserved for the time at which the kernel
+	 *  received each datagram, which requires the \c SO_TIMESTAMPNS socket option. */
+	int Create(size_t batchsize, size_t datagramsize, bool getsegmentsize = false, bool gettimestamps = false);
+
+	/** Releases the allocated memory. */
+	void Destroy();
+
+	/** Returns \c true if RTPUDPReceiveBatch::Create was called successfully. */
+	bool IsCreated() const											{ return (batchsize != 0); }
+
+	/** Returns the maximum number of datagrams that can be read in one call. */
+	size_t GetBatchSize() const										{ return batchsize; }
+
+	/** Reads as many datagrams as are available (up to the batch size) from \c sock
+	 *  without blocking, and returns the number of datagrams that were read. */
+	int Receive(SocketType sock);
+
+	/** Returns the data of the datagram at position \c idx of the last batch. */
+	uint8_t *GetDatagramData(size_t idx) const						{ return buffers + idx*datagramsize; }
+
+	/** Returns the length of the datagram at position \c idx of the last batch. */
+	size_t GetDatagramLength(size_t idx) const;
+
+	/** Returns \c true if the datagram at position \c idx did not fit into its buffer. */
+	bool IsDatagramTruncated(size_t idx) const;
+
+	/** If the datagram at position \c idx actually contains several datagrams that were
+	 *  coalesced by the kernel, this returns the size of each of them (only the last one
+	 *  can be shorter); otherwise zero is returned. */
+	size_t GetDatagramSegmentSize(size_t idx) const;
+
+	/** If the kernel recorded when the datagram at position \c idx was received, this
+	 *  time is stored in \c t, converted to the clock that's used by RTPTime::CurrentTime,
+	 *  and \c true is returned; otherwise \c t is left untouched and \c false is returned. */
+	bool GetDatagramReceiveTime(size_t idx, RTPTime &t) const;
+
+	/** Returns the address the datagram at position \c idx was sent from. */
+	const struct sockaddr *GetSourceAddress(size_t idx) const;
+
+	/** Returns the fill statistics of the calls to RTPUDPReceiveBatch::Receive. */
+	const RTPReceiveBatchStatistics &GetStatistics() const			{ return stats; }
+
+	/** Resets the fill statistics. */
+	void ClearStatistics()											{ stats.Clear(); }
+private:
+	size_t batchsize, datagramsize, controlsize;
+	uint8_t *memblock;
+	uint8_t *buffers;
+	uint8_t *controlbuffers;
+	struct mmsghdr *msgs;
+	struct iovec *iovecs;
+	struct sockaddr_storage *addresses;
+	bool timestamps;
+	double clockoffset;
+	RTPReceiveBatchStatistics stats;
+};
+
+} // end namespace
+
+#endif // RTPUDPRECEIVEBATCH_H
+
@@ -0,0 +1,192 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpudpsendbatch.h"
+#include "rtpsocketutilinternal.h"
+#include "rtperrors.h"
+#include <errno.h>
+#include <string.h>
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPUDPSendBatch::RTPUDPSendBatch(RTPMemoryManager *mgr) : RTPMemoryObject(mgr)
+{
+	numdest = 0;
+	capacity = 0;
+	numfailures = 0;
+	memblock = 0;
+	msgs = 0;
+	iov = 0;
+	failedindices = 0;
+	failederrors = 0;
+}
+
+RTPUDPSendBatch::~RTPUDPSendBatch()
+{
+	Destroy();
+}
+
+void RTPUDPSendBatch::Destroy()
+{
+	if (memblock)
+		RTPDeleteByteArray(memblock,GetMemoryManager());
+
+	numdest = 0;
+	capacity = 0;
+	numfailures = 0;
+	memblock = 0;
+	msgs = 0;
+	iov = 0;
+	failedindices = 0;
+	failederrors = 0;
+}
+
+#ifdef RTP_HAVE_SENDMMSG
+
+int RTPUDPSendBatch::Create(size_t n)
+{
+	numfailures = 0;
+
+	if (n > capacity || memblock == 0)
+	{
+		Destroy();
+
+		// Allocate some extra room so that adding a few destinations doesn't
+		// cause a reallocation each time
+		size_t newcapacity = n + n/4 + 4;
+		size_t msgslen = newcapacity*sizeof(struct mmsghdr);
+		size_t iovlen = sizeof(struct iovec);
+		size_t indiceslen = newcapacity*sizeof(size_t);
+		size_t errorslen = newcapacity*sizeof(int);
+
+		memblock = RTPNew(GetMemoryManager(),RTPMEM_TYPE_OTHER) uint8_t[msgslen+iovlen+indiceslen+errorslen];
+		if (memblock == 0)
+			return ERR_RTP_OUTOFMEM;
+
+		msgs = (struct mmsghdr *)memblock;
+		iov = (struct iovec *)(memblock + msgslen);
+		failedindices = (size_t *)(memblock + msgslen + iovlen);
+		failederrors = (int *)(memblock + msgslen + iovlen + indiceslen);
+		capacity = newcapacity;
+	}
+
+	// All messages refer to the same data, only the destination differs
+	memset(msgs, 0, n*sizeof(struct mmsghdr));
+	memset(iov, 0, sizeof(struct iovec));
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		msgs[i].msg_hdr.msg_iov = iov;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	numdest = n;
+	return 0;
+}
+
+void RTPUDPSendBatch::SetDestination(size_t idx, const struct sockaddr *addr, size_t addrlen)
+{
+	msgs[idx].msg_hdr.msg_name = (void *)addr;
+	msgs[idx].msg_hdr.msg_namelen = (socklen_t)addrlen;
+}
+
+size_t RTPUDPSendBatch::Send(SocketType sock, const void *data, size_t len)
+{
+	size_t pos = 0;
+
+	numfailures = 0;
+	iov->iov_base = (void *)data;
+	iov->iov_len = len;
+
+	// The call stops at the first message that can't be sent; if that's the
+	// first one, an error is returned, otherwise the number of messages that
+	// were sent. In the latter case, the next call will report the error for
+	// the message that failed.
+	while (pos < numdest)
+	{
+		int status = sendmmsg(sock, msgs + pos, (unsigned int)(numdest - pos), 0);
+		if (status > 0)
+			pos += (size_t)status;
+		else
+		{
+			int errcode = (status < 0)?errno:EIO;
+
+			if (errcode == EINTR)
+				continue;
+
+			failedindices[numfailures] = pos;
+			failederrors[numfailures] = errcode;
+			numfailures++;
+			pos++;
+		}
+	}
+	return numfailures;
+}
+
+const struct sockaddr *RTPUDPSendBatch::GetFailedDestination(size_t i) const
+{
+	return (const struct sockaddr *)msgs[failedindices[i]].msg_hdr.msg_name;
+}
+
+#else
+
+int RTPUDPSendBatch::Create(size_t n)
+{
+	JRTPLIB_UNUSED(n);
+	return ERR_RTP_UDPSENDBATCH_NOSENDMMSGSUPPORT;
+}
+
+void RTPUDPSendBatch::SetDestination(size_t idx, const struct sockaddr *addr, size_t addrlen)
+{
+	JRTPLIB_UNUSED(idx);
+	JRTPLIB_UNUSED(addr);
+	JRTPLIB_UNUSED(addrlen);
+}
+
+size_t RTPUDPSendBatch::Send(SocketType sock, const void *data, size_t len)
+{
+	JRTPLIB_UNUSED(sock);
+	JRTPLIB_UNUSED(data);
+	JRTPLIB_UNUSED(len);
+	return 0;
+}
+
+const struct sockaddr *RTPUDPSendBatch::GetFailedDestination(size_t i) const
+{
+	JRTPLIB_UNUSED(i);
+	return 0;
+}
+
+#endif // RTP_HAVE_SENDMMSG
+
+} // end namespace
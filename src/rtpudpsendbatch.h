@@ -0,0 +1,105 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpudpsendbatch.h
+ */
+
+#ifndef RTPUDPSENDBATCH_H
+
+#define RTPUDPSENDBATCH_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpmemoryobject.h"
+#include "rtpsocketutil.h"
+
+struct sockaddr;
+struct mmsghdr;
+struct iovec;
+
+namespace jrtplib
+{
+
+/** Helper class for the UDP transmitters to send one packet to many destinations at once.
+ *  This class holds a message header for each destination of a transmitter, so that a
+ *  packet can be sent to all of them using a single \c sendmmsg call instead of calling
+ *  \c sendto for each destination separately. The destination addresses themselves are
+ *  not copied: the pointers that are passed to RTPUDPSendBatch::SetDestination must remain
+ *  valid until the batch is filled in again. The RTPUDPv4Transmitter and RTPUDPv6Transmitter
+ *  classes rebuild their batches each time the destination list changes.
+ */
+class JRTPLIB_IMPORTEXPORT RTPUDPSendBatch : public RTPMemoryObject
+{
+	JRTPLIB_NO_COPY(RTPUDPSendBatch)
+public:
+	RTPUDPSendBatch(RTPMemoryManager *mgr = 0);
+	~RTPUDPSendBatch();
+
+	/** Prepares the batch for \c numdest destinations, which must then be set using
+	 *  RTPUDPSendBatch::SetDestination; previously allocated memory is reused if possible. */
+	int Create(size_t numdest);
+
+	/** Releases the allocated memory. */
+	void Destroy();
+
+	/** Returns the number of destinations in the batch. */
+	size_t GetNumberOfDestinations() const							{ return numdest; }
+
+	/** Sets the address of the destination at position \c idx. */
+	void SetDestination(size_t idx, const struct sockaddr *addr, size_t addrlen);
+
+	/** Sends the \c len bytes in \c data to every destination in the batch and returns the
+	 *  number of destinations for which this failed. */
+	size_t Send(SocketType sock, const void *data, size_t len);
+
+	/** Returns the number of destinations the last call to RTPUDPSendBatch::Send failed for. */
+	size_t GetNumberOfFailures() const								{ return numfailures; }
+
+	/** Returns the address of the \c i-th destination the last send operation failed for. */
+	const struct sockaddr *GetFailedDestination(size_t i) const;
+
+	/** Returns the system error code for the \c i-th failed destination. */
+	int GetFailureErrorCode(size_t i) const							{ return failederrors[i]; }
+private:
+	size_t numdest, capacity;
+	size_t numfailures;
+	uint8_t *memblock;
+	struct mmsghdr *msgs;
+	struct iovec *iov;
+	size_t *failedindices;
+	int *failederrors;
+};
+
+} // end namespace
+
+#endif // RTPUDPSENDBATCH_H
@@ -0,0 +1,290 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+#include "rtpudpsocketfilter.h"
+#include "rtpsocketutilinternal.h"
+#include "rtperrors.h"
+
+#if defined(RTP_SUPPORT_SOCKETFILTER) || defined(RTP_SUPPORT_REUSEPORTSTEERING)
+	#include <linux/filter.h>
+#endif // RTP_SUPPORT_SOCKETFILTER || RTP_SUPPORT_REUSEPORTSTEERING
+#ifdef RTP_SUPPORT_SOCKETFILTER
+	#include <linux/sock_diag.h>
+#endif // RTP_SUPPORT_SOCKETFILTER
+
+#include "rtpdebug.h"
+
+namespace jrtplib
+{
+
+RTPUDPSocketFilter::RTPUDPSocketFilter()
+{
+	receivemode = RTPTransmitter::AcceptAll;
+	numaddrwords = 0;
+}
+
+RTPUDPSocketFilter::~RTPUDPSocketFilter()
+{
+}
+
+#ifdef RTP_SUPPORT_SOCKETFILTER
+
+#define RTPUDPSOCKETFILTER_ACCEPT			0xffffffff
+#define RTPUDPSOCKETFILTER_REJECT			0
+
+// Offsets of the source address in the IPv4 and IPv6 headers
+#define RTPUDPSOCKETFILTER_IPV4SRCOFFSET	12
+#define RTPUDPSOCKETFILTER_IPV6SRCOFFSET	8
+
+void RTPUDPSocketFilter::Start(RTPTransmitter::ReceiveMode mode, int addrwords, bool onlyipv6)
+{
+	program.clear();
+	receivemode = mode;
+	numaddrwords = addrwords;
+
+	if (onlyipv6)
+	{
+		// Check the version field of the IP header
+		AddStatement(BPF_LD|BPF_B|BPF_ABS,(uint32_t)SKF_NET_OFF);
+		AddStatement(BPF_ALU|BPF_RSH|BPF_K,4);
+		AddJump(BPF_JMP|BPF_JEQ|BPF_K,6,1,0);
+		AddStatement(BPF_RET|BPF_K,RTPUDPSOCKETFILTER_ACCEPT);
+	}
+}
+
+void RTPUDPSocketFilter::AddEntry(const uint32_t *addr, bool all, const RTPPortSet &ports)
+{
+	int32_t srcoffset = (numaddrwords == 1)?RTPUDPSOCKETFILTER_IPV4SRCOFFSET:RTPUDPSOCKETFILTER_IPV6SRCOFFSET;
+
+	// Compare the source address word by word; on a mismatch, we jump to the
+	// instruction which skips the rest of this entry
+	for (int i = 0 ; i < numaddrwords ; i++)
+	{
+		bool last = (i == numaddrwords-1);
+
+		AddStatement(BPF_LD|BPF_W|BPF_ABS,(uint32_t)(SKF_NET_OFF+srcoffset+i*4));
+		AddJump(BPF_JMP|BPF_JEQ|BPF_K,addr[i],(last)?1:0,(uint8_t)(2*(numaddrwords-1-i)));
+	}
+
+	size_t skipinstruction = program.size();
+
+	AddStatement(BPF_JMP|BPF_JA,0); // filled in below
+
+	// The packets from this address for which the port is in the list are
+	// accepted in the AcceptSome mode, unless the list specifies the ports to
+	// exclude. In the IgnoreSome mode it's the other way around.
+	bool acceptlisted = ((receivemode == RTPTransmitter::AcceptSome) != all);
+	uint32_t listedresult = (acceptlisted)?RTPUDPSOCKETFILTER_ACCEPT:RTPUDPSOCKETFILTER_REJECT;
+	uint32_t otherresult = (acceptlisted)?RTPUDPSOCKETFILTER_REJECT:RTPUDPSOCKETFILTER_ACCEPT;
+
+	// The UDP header is at the start of the data that's passed to the filter,
+	// and it starts with the source port. The ports are obtained in ascending
+	// order, so a run of consecutive ports can be checked as a range.
+	AddStatement(BPF_LD|BPF_H|BPF_ABS,0);
+
+	int port = ports.GetNextPort(-1);
+
+	while (port >= 0)
+	{
+		int first = port;
+		int last = port;
+
+		while ((port = ports.GetNextPort(last)) == last+1)
+			last = port;
+
+		if (first == last)
+			AddJump(BPF_JMP|BPF_JEQ|BPF_K,(uint32_t)first,0,1);
+		else
+		{
+			AddJump(BPF_JMP|BPF_JGE|BPF_K,(uint32_t)first,0,2);
+			AddJump(BPF_JMP|BPF_JGT|BPF_K,(uint32_t)last,1,0);
+		}
+		AddStatement(BPF_RET|BPF_K,listedresult);
+	}
+	AddStatement(BPF_RET|BPF_K,otherresult);
+
+	program[skipinstruction].k = (uint32_t)(program.size()-skipinstruction-1);
+}
+
+int RTPUDPSocketFilter::Attach(SocketType sock) const
+{
+	if (GetProgramLength() > BPF_MAXINSNS)
+		return ERR_RTP_UDPSOCKETFILTER_TOOLARGE;
+
+	std::vector<struct sock_filter> code(program.size()+1);
+
+	for (size_t i = 0 ; i < program.size() ; i++)
+	{
+		code[i].code = program[i].code;
+		code[i].jt = program[i].jt;
+		code[i].jf = program[i].jf;
+		code[i].k = program[i].k;
+	}
+
+	// Packets from addresses that aren't listed
+	code[program.size()].code = BPF_RET|BPF_K;
+	code[program.size()].jt = 0;
+	code[program.size()].jf = 0;
+	code[program.size()].k = (receivemode == RTPTransmitter::AcceptSome)?RTPUDPSOCKETFILTER_REJECT:RTPUDPSOCKETFILTER_ACCEPT;
+
+	struct sock_fprog prog;
+
+	prog.len = (unsigned short)code.size();
+	prog.filter = &code[0];
+	if (setsockopt(sock,SOL_SOCKET,SO_ATTACH_FILTER,&prog,sizeof(struct sock_fprog)) != 0)
+		return ERR_RTP_UDPSOCKETFILTER_CANTATTACH;
+	return 0;
+}
+
+void RTPUDPSocketFilter::Detach(SocketType sock)
+{
+	// The value isn't used, but the kernel requires an integer to be passed.
+	// This fails if no filter was attached, which doesn't matter.
+	int dummy = 0;
+	setsockopt(sock,SOL_SOCKET,SO_DETACH_FILTER,(const char *)&dummy,sizeof(int));
+}
+
+int RTPUDPSocketFilter::GetNumberOfDroppedPackets(SocketType sock, uint32_t &numdrops)
+{
+#ifdef SO_MEMINFO
+	uint32_t meminfo[SK_MEMINFO_VARS];
+	socklen_t len = sizeof(meminfo);
+
+	if (getsockopt(sock,SOL_SOCKET,SO_MEMINFO,meminfo,&len) != 0 || len <= SK_MEMINFO_DROPS*sizeof(uint32_t))
+		return ERR_RTP_UDPSOCKETFILTER_CANTGETDROPCOUNT;
+	numdrops = meminfo[SK_MEMINFO_DROPS];
+	return 0;
+#else
+	JRTPLIB_UNUSED(sock);
+	JRTPLIB_UNUSED(numdrops);
+	return ERR_RTP_UDPSOCKETFILTER_CANTGETDROPCOUNT;
+#endif // SO_MEMINFO
+}
+
+#else
+
+void RTPUDPSocketFilter::Start(RTPTransmitter::ReceiveMode mode, int addrwords, bool onlyipv6)
+{
+	JRTPLIB_UNUSED(onlyipv6);
+	receivemode = mode;
+	numaddrwords = addrwords;
+}
+
+void RTPUDPSocketFilter::AddEntry(const uint32_t *addr, bool all, const RTPPortSet &ports)
+{
+	JRTPLIB_UNUSED(addr);
+	JRTPLIB_UNUSED(all);
+	JRTPLIB_UNUSED(ports);
+}
+
+int RTPUDPSocketFilter::Attach(SocketType sock) const
+{
+	JRTPLIB_UNUSED(sock);
+	return ERR_RTP_UDPSOCKETFILTER_NOTSUPPORTED;
+}
+
+void RTPUDPSocketFilter::Detach(SocketType sock)
+{
+	JRTPLIB_UNUSED(sock);
+}
+
+int RTPUDPSocketFilter::GetNumberOfDroppedPackets(SocketType sock, uint32_t &numdrops)
+{
+	JRTPLIB_UNUSED(sock);
+	JRTPLIB_UNUSED(numdrops);
+	return ERR_RTP_UDPSOCKETFILTER_NOTSUPPORTED;
+}
+
+#endif // RTP_SUPPORT_SOCKETFILTER
+
+#ifdef RTP_SUPPORT_REUSEPORTSTEERING
+
+int RTPUDPSocketFilter::AttachSSRCSteering(SocketType sock, uint32_t numsockets, bool rtpdata, bool rtcpdata)
+{
+	if (numsockets == 0 || !(rtpdata || rtcpdata))
+		return ERR_RTP_UDPSOCKETFILTER_CANTATTACHSTEERING;
+
+	// The program sees the UDP payload, in which the SSRC is stored at offset 8
+	// for RTP packets and at offset 4 for RTCP packets. When both are received on
+	// the socket, RTCP packets are recognized by their packet type (RFC 5761).
+	// The value that's returned is the index of the socket in the group; when
+	// the packet is too short the program returns zero.
+	struct sock_filter both[] =
+	{
+		BPF_STMT(BPF_LD|BPF_B|BPF_ABS,1),
+		BPF_JUMP(BPF_JMP|BPF_JGE|BPF_K,192,0,3),
+		BPF_JUMP(BPF_JMP|BPF_JGT|BPF_K,223,2,0),
+		BPF_STMT(BPF_LD|BPF_W|BPF_ABS,4),
+		BPF_STMT(BPF_JMP|BPF_JA,1),
+		BPF_STMT(BPF_LD|BPF_W|BPF_ABS,8),
+		BPF_STMT(BPF_ALU|BPF_MOD|BPF_K,numsockets),
+		BPF_STMT(BPF_RET|BPF_A,0)
+	};
+	struct sock_filter single[] =
+	{
+		BPF_STMT(BPF_LD|BPF_W|BPF_ABS,(uint32_t)((rtpdata)?8:4)),
+		BPF_STMT(BPF_ALU|BPF_MOD|BPF_K,numsockets),
+		BPF_STMT(BPF_RET|BPF_A,0)
+	};
+	struct sock_fprog prog;
+
+	if (rtpdata && rtcpdata)
+	{
+		prog.len = sizeof(both)/sizeof(struct sock_filter);
+		prog.filter = both;
+	}
+	else
+	{
+		prog.len = sizeof(single)/sizeof(struct sock_filter);
+		prog.filter = single;
+	}
+
+	if (setsockopt(sock,SOL_SOCKET,SO_ATTACH_REUSEPORT_CBPF,&prog,sizeof(struct sock_fprog)) != 0)
+		return ERR_RTP_UDPSOCKETFILTER_CANTATTACHSTEERING;
+	return 0;
+}
+
+#else
+
+int RTPUDPSocketFilter::AttachSSRCSteering(SocketType sock, uint32_t numsockets, bool rtpdata, bool rtcpdata)
+{
+	JRTPLIB_UNUSED(sock);
+	JRTPLIB_UNUSED(numsockets);
+	JRTPLIB_UNUSED(rtpdata);
+	JRTPLIB_UNUSED(rtcpdata);
+	return ERR_RTP_UDPSOCKETFILTER_NOTSUPPORTED;
+}
+
+#endif // RTP_SUPPORT_REUSEPORTSTEERING
+
+} // end namespace
+
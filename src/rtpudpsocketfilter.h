@@ -0,0 +1,130 @@
+/*
+
+  This file is a part of JRTPLIB
+  Copyright (c) 1999-2017 Jori Liesenborgs
+
+  Contact: jori.liesenborgs@gmail.com
+
+  This library was developed at the Expertise Centre for Digital Media
+  (http://www.edm.uhasselt.be), a research center of the Hasselt University
+  (http://www.uhasselt.be). The library is based upon work done for 
+  my thesis at the School for Knowledge Technology (Belgium/The Netherlands).
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+
+*/
+
+/**
+ * \file rtpudpsocketfilter.h
+ */
+
+#ifndef RTPUDPSOCKETFILTER_H
+
+#define RTPUDPSOCKETFILTER_H
+
+#include "rtpconfig.h"
+#include "rtptypes.h"
+#include "rtpsocketutil.h"
+#include "rtptransmitter.h"
+#include "rtpportset.h"
+#include <vector>
+
+namespace jrtplib
+{
+
+/** Helper class for the UDP transmitters to let the kernel drop packets from ignored sources.
+ *  When a transmitter only accepts packets from some sources, or ignores the packets
+ *  from some sources, this class can be used to translate these lists into a classic
+ *  BPF program which is attached to a socket using the \c SO_ATTACH_FILTER option.
+ *  The kernel then drops the unwanted packets before they are queued on the socket,
+ *  so they never need to be copied to userspace. Only the socket filter interface
+ *  of Linux is supported; on other platforms, or when the lists are too large to be
+ *  converted, the transmitters keep performing the check themselves for every
+ *  packet that's read. They always do so anyway, for packets that were already
+ *  queued before the filter was attached.
+ */
+class JRTPLIB_IMPORTEXPORT RTPUDPSocketFilter
+{
+public:
+	RTPUDPSocketFilter();
+	~RTPUDPSocketFilter();
+
+	/** Starts a new program for the receive mode \c mode, for source addresses which
+	 *  consist of \c addrwords 32-bit words (one for IPv4, four for IPv6). Packets from
+	 *  sources for which no entry is added, are accepted in the RTPTransmitter::IgnoreSome
+	 *  mode and rejected in the RTPTransmitter::AcceptSome mode. If \c onlyipv6 is set,
+	 *  packets which don't have an IPv6 header (IPv4 packets received on a dual stack
+	 *  socket) are always accepted, and are left for the transmitter to check. */
+	void Start(RTPTransmitter::ReceiveMode mode, int addrwords, bool onlyipv6 = false);
+
+	/** Adds the ports in \c ports for the source address \c addr, which must contain
+	 *  the number of 32-bit words that was specified in RTPUDPSocketFilter::Start, in
+	 *  host byte order. If \c all is \c false, the entry applies to the ports in the set,
+	 *  otherwise it applies to all ports except the ones in the set. */
+	void AddEntry(const uint32_t *addr, bool all, const RTPPortSet &ports);
+
+	/** Attaches the program to \c sock, replacing a previously attached filter. If the
+	 *  program is too large to be loaded by the kernel, ERR_RTP_UDPSOCKETFILTER_TOOLARGE
+	 *  is returned and the socket is left unchanged. */
+	int Attach(SocketType sock) const;
+
+	/** Returns the number of instructions of the current program. */
+	size_t GetProgramLength() const										{ return program.size()+1; }
+
+	/** Removes the filter from \c sock, if one was attached. */
+	static void Detach(SocketType sock);
+
+	/** Stores the number of packets the kernel dropped for \c sock in \c numdrops. Note that
+	 *  besides the packets that were rejected by the socket filter, this also includes the
+	 *  packets that were dropped because the receive buffer of the socket was full. */
+	static int GetNumberOfDroppedPackets(SocketType sock, uint32_t &numdrops);
+
+	/** When several sockets are bound to the same port using \c SO_REUSEPORT, this attaches
+	 *  a program to their group which selects the socket for an incoming packet based
+	 *  on the SSRC it contains: the packet is delivered to the socket at position
+	 *  SSRC modulo \c numsockets in the group (the sockets are numbered in the order in
+	 *  which they were bound). This way, all packets of a specific source end up at the
+	 *  same socket. Set \c rtpdata and \c rtcpdata to indicate which kind of packets are
+	 *  received on \c sock; if both are set, the RTCP packets are recognized by their
+	 *  packet type. Only supported on Linux (\c SO_ATTACH_REUSEPORT_CBPF). */
+	static int AttachSSRCSteering(SocketType sock, uint32_t numsockets, bool rtpdata, bool rtcpdata);
+private:
+	// Same layout as the kernel's struct sock_filter
+	class Instruction
+	{
+	public:
+		Instruction(uint16_t code, uint8_t jt, uint8_t jf, uint32_t k) : code(code), jt(jt), jf(jf), k(k) { }
+
+		uint16_t code;
+		uint8_t jt, jf;
+		uint32_t k;
+	};
+
+	void AddStatement(uint16_t code, uint32_t k)						{ program.push_back(Instruction(code,0,0,k)); }
+	void AddJump(uint16_t code, uint32_t k, uint8_t jt, uint8_t jf)	{ program.push_back(Instruction(code,jt,jf,k)); }
+
+	std::vector<Instruction> program;
+	RTPTransmitter::ReceiveMode receivemode;
+	int numaddrwords;
+};
+
+} // end namespace
+
+#endif // RTPUDPSOCKETFILTER_H
+
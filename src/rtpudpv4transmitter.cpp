@@ -32,6 +32,7 @@
 
 #include "rtpudpv4transmitter.h"
 #include "rtprawpacket.h"
+#include "rtppacket.h"
 #include "rtpipv4address.h"
 #include "rtptimeutilities.h"
 #include "rtpdefines.h"
@@ -40,8 +41,12 @@
 #include "rtpinternalutils.h"
 #include "rtpselect.h"
 #include <stdio.h>
+#if defined(RTP_HAVE_UDP_SEGMENT) || defined(RTP_HAVE_UDP_GRO)
+	#include <netinet/udp.h>
+#endif // RTP_HAVE_UDP_SEGMENT || RTP_HAVE_UDP_GRO
 #include <assert.h>
 #include <vector>
+#include <algorithm>
 #ifdef RTPDEBUG
 	#include <iostream>
 #endif // RTPDEBUG
@@ -65,11 +70,19 @@
 #ifdef RTP_SUPPORT_THREAD
 	#define MAINMUTEX_LOCK 		{ if (threadsafe) mainmutex.Lock(); }
 	#define MAINMUTEX_UNLOCK	{ if (threadsafe) mainmutex.Unlock(); }
+	#define SENDMUTEX_LOCK		{ if (threadsafe) sendmutex.Lock(); }
+	#define SENDMUTEX_UNLOCK	{ if (threadsafe) sendmutex.Unlock(); }
+	#define RECEIVEMUTEX_LOCK	{ if (threadsafe) receivemutex.Lock(); }
+	#define RECEIVEMUTEX_UNLOCK	{ if (threadsafe) receivemutex.Unlock(); }
 	#define WAITMUTEX_LOCK		{ if (threadsafe) waitmutex.Lock(); }
 	#define WAITMUTEX_UNLOCK	{ if (threadsafe) waitmutex.Unlock(); }
 #else
 	#define MAINMUTEX_LOCK
 	#define MAINMUTEX_UNLOCK
+	#define SENDMUTEX_LOCK
+	#define SENDMUTEX_UNLOCK
+	#define RECEIVEMUTEX_LOCK
+	#define RECEIVEMUTEX_UNLOCK
 	#define WAITMUTEX_LOCK
 	#define WAITMUTEX_UNLOCK
 #endif // RTP_SUPPORT_THREAD
@@ -91,10 +104,21 @@ RTPUDPv4Transmitter::RTPUDPv4Transmitter(RTPMemoryManager *mgr) : RTPTransmitter
 #ifdef RTP_SUPPORT_IPV4MULTICAST
 								  multicastgroups(mgr,RTPMEM_TYPE_CLASS_MULTICASTHASHELEMENT),
 #endif // RTP_SUPPORT_IPV4MULTICAST
-								  acceptignoreinfo(mgr,RTPMEM_TYPE_CLASS_ACCEPTIGNOREHASHELEMENT)
+								  acceptignoreinfo(mgr,RTPMEM_TYPE_CLASS_ACCEPTIGNOREHASHELEMENT),
+								  recvbatch(mgr),
+								  rtpsendbatch(mgr),
+								  rtcpsendbatch(mgr)
 {
 	created = false;
 	init = false;
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+	usesegmentation = false;
+	numsenderrors = 0;
+	bufferpool = 0;
+	senddestinations = 0;
+	usesocketfilter = false;
+	socketfilteractive = false;
 }
 
 RTPUDPv4Transmitter::~RTPUDPv4Transmitter()
@@ -114,6 +138,12 @@ int RTPUDPv4Transmitter::Init(bool tsafe)
 		int status;
 		
 		status = mainmutex.Init();
+		if (status < 0)
+			return ERR_RTP_UDPV4TRANS_CANTINITMUTEX;
+		status = sendmutex.Init();
+		if (status < 0)
+			return ERR_RTP_UDPV4TRANS_CANTINITMUTEX;
+		status = receivemutex.Init();
 		if (status < 0)
 			return ERR_RTP_UDPV4TRANS_CANTINITMUTEX;
 		status = waitmutex.Init();
@@ -291,6 +321,18 @@ int GetAutoSockets(uint32_t bindIP, bool allowOdd, bool rtcpMux,
 	return ERR_RTP_UDPV4TRANS_TOOMANYATTEMPTSCHOOSINGSOCKET;
 }
 
+static bool EnableReusePort(SocketType s)
+{
+#ifdef RTP_HAVE_SO_REUSEPORT
+	int enable = 1;
+
+	return (setsockopt(s,SOL_SOCKET,SO_REUSEPORT,(const char *)&enable,sizeof(int)) == 0);
+#else
+	JRTPLIB_UNUSED(s);
+	return false;
+#endif // RTP_HAVE_SO_REUSEPORT
+}
+
 int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionParams *transparams)
 {
 	const RTPUDPv4TransmissionParams *params,defaultparams;
@@ -323,6 +365,13 @@ int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		params = (const RTPUDPv4TransmissionParams *)transparams;
 	}
 
+	// Only sockets that we create ourselves on a specific port can be shared
+	if (params->GetReusePortShards() > 0 && (params->GetPortbase() == 0 || params->GetUseExistingSockets(rtpsock, rtcpsock)))
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_CANTSETREUSEPORT;
+	}
+
 	if (params->GetUseExistingSockets(rtpsock, rtcpsock))
 	{
 		closesocketswhendone = false;
@@ -387,6 +436,17 @@ int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 				}
 			}
 
+			// This needs to be set before binding the sockets
+			if (params->GetReusePortShards() > 0)
+			{
+				if (!EnableReusePort(rtpsock) || (rtcpsock != rtpsock && !EnableReusePort(rtcpsock)))
+				{
+					CLOSESOCKETS;
+					MAINMUTEX_UNLOCK
+					return ERR_RTP_UDPV4TRANS_CANTSETREUSEPORT;
+				}
+			}
+
 			// bind sockets
 
 			uint32_t bindIP = params->GetBindIP();
@@ -431,6 +491,19 @@ int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 			}
 			else
 				m_rtcpPort = m_rtpPort;
+
+			// The program is shared by all sockets bound to the same port, each
+			// transmitter sets the same one
+			if (params->GetReusePortShards() > 0 && params->GetUseSSRCSteering())
+			{
+				if ((status = RTPUDPSocketFilter::AttachSSRCSteering(rtpsock,params->GetReusePortShards(),true,(rtcpsock == rtpsock))) < 0 ||
+				    (rtcpsock != rtpsock && (status = RTPUDPSocketFilter::AttachSSRCSteering(rtcpsock,params->GetReusePortShards(),false,true)) < 0))
+				{
+					CLOSESOCKETS;
+					MAINMUTEX_UNLOCK
+					return status;
+				}
+			}
 		}
 
 		// set socket buffer sizes
@@ -511,11 +584,66 @@ int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		MAINMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_SPECIFIEDSIZETOOBIG;
 	}
+
+	// A batch size of zero reads each datagram separately, just like a batch size of one
+	if (params->GetReceiveBatchSize() > RTPUDPV4TRANS_MAXRECEIVEBATCHSIZE)
+	{
+		CLOSESOCKETS;
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_ILLEGALRECEIVEBATCHSIZE;
+	}
+
+#ifdef RTP_HAVE_RECVMMSG
+	// When generic receive offload is enabled, the segment size needs to be
+	// obtained for each datagram, for which the batch receive code is used
+	// (even if the batch size is one)
+	bool receiveoffload = false;
+#ifdef RTP_HAVE_UDP_GRO
+	if (params->GetUseReceiveOffload())
+	{
+		int enable = 1;
+
+		if (setsockopt(rtpsock,SOL_UDP,UDP_GRO,(const char *)&enable,sizeof(int)) == 0)
+			receiveoffload = true;
+	}
+#endif // RTP_HAVE_UDP_GRO
+
+	// The same goes for the kernel's receive timestamps, which are delivered
+	// as control messages as well
+	bool kerneltimestamps = false;
+#ifdef RTP_HAVE_SO_TIMESTAMPNS
+	if (params->GetUseKernelTimestamps())
+	{
+		int enable = 1;
+
+		if (setsockopt(rtpsock,SOL_SOCKET,SO_TIMESTAMPNS,(const char *)&enable,sizeof(int)) == 0)
+		{
+			kerneltimestamps = true;
+			if (rtcpsock != rtpsock && setsockopt(rtcpsock,SOL_SOCKET,SO_TIMESTAMPNS,(const char *)&enable,sizeof(int)) != 0)
+				kerneltimestamps = false;
+		}
+	}
+#endif // RTP_HAVE_SO_TIMESTAMPNS
+
+	// Without recvmmsg support, the datagrams are simply read one by one
+	if (params->GetReceiveBatchSize() > 1 || receiveoffload || kerneltimestamps)
+	{
+		if ((status = recvbatch.Create(std::max((size_t)1,params->GetReceiveBatchSize()),RTPUDPV4TRANS_MAXPACKSIZE,receiveoffload,kerneltimestamps)) < 0)
+		{
+			CLOSESOCKETS;
+			MAINMUTEX_UNLOCK
+			return status;
+		}
+	}
+#endif // RTP_HAVE_RECVMMSG
 	
-	if (!params->GetCreatedAbortDescriptors())
+	if (!params->GetUseAbortDescriptors())
+		m_pAbortDesc = 0;
+	else if (!params->GetCreatedAbortDescriptors())
 	{
 		if ((status = m_abortDesc.Init()) < 0)
 		{
+			recvbatch.Destroy();
 			CLOSESOCKETS;
 			MAINMUTEX_UNLOCK
 			return status;
@@ -527,6 +655,7 @@ int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		m_pAbortDesc = params->GetCreatedAbortDescriptors();
 		if (!m_pAbortDesc->IsInitialized())
 		{
+			recvbatch.Destroy();
 			CLOSESOCKETS;
 			MAINMUTEX_UNLOCK
 			return ERR_RTP_ABORTDESC_NOTINIT;
@@ -541,9 +670,23 @@ int RTPUDPv4Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 	localhostname = 0;
 	localhostnamelength = 0;
 
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+	senderrors.clear();
+	numsenderrors = 0;
+	usesegmentation = params->GetUseSegmentationOffload();
+	usesocketfilter = params->GetUseSocketFilter();
+	socketfilteractive = false;
+
+	// The send and receive paths only check the 'created' flag while holding
+	// their own mutex, so all of them need to be locked to change it
+	RECEIVEMUTEX_LOCK
+	SENDMUTEX_LOCK
 	waitingfordata = false;
 	created = true;
-	MAINMUTEX_UNLOCK 
+	SENDMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
+	MAINMUTEX_UNLOCK
 	return 0;
 }
 
@@ -558,6 +701,8 @@ void RTPUDPv4Transmitter::Destroy()
 		MAINMUTEX_UNLOCK;
 		return;
 	}
+	RECEIVEMUTEX_LOCK
+	SENDMUTEX_LOCK
 
 	if (localhostname)
 	{
@@ -566,26 +711,58 @@ void RTPUDPv4Transmitter::Destroy()
 		localhostnamelength = 0;
 	}
 	
+	// Existing sockets aren't closed, so make sure they no longer filter packets
+	if (socketfilteractive)
+	{
+		RTPUDPSocketFilter::Detach(rtpsock);
+		if (rtcpsock != rtpsock)
+			RTPUDPSocketFilter::Detach(rtcpsock);
+		socketfilteractive = false;
+	}
 	CLOSESOCKETS;
 	destinations.Clear();
 #ifdef RTP_SUPPORT_IPV4MULTICAST
 	multicastgroups.Clear();
 #endif // RTP_SUPPORT_IPV4MULTICAST
 	FlushPackets();
+	recvbatch.Destroy();
+	rtpsendbatch.Destroy();
+	rtcpsendbatch.Destroy();
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+	if (senddestinations)
+	{
+		RTPDelete(senddestinations,GetMemoryManager());
+		senddestinations = 0;
+	}
+	RTPUDPDestinationSnapshot *published = publisheddestinations.Exchange(0);
+	if (published)
+		RTPDelete(published,GetMemoryManager());
+	senderrors.clear();
+	if (bufferpool)
+	{
+		bufferpool->Release();
+		bufferpool = 0;
+	}
 	ClearAcceptIgnoreInfo();
 	localIPs.clear();
 	created = false;
+	SENDMUTEX_UNLOCK
 	
 	if (waitingfordata)
 	{
-		m_pAbortDesc->SendAbortSignal();
+		if (m_pAbortDesc) // otherwise the wait ends when its timeout expires
+			m_pAbortDesc->SendAbortSignal();
 		m_abortDesc.Destroy(); // Doesn't do anything if not initialized
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		WAITMUTEX_LOCK // to make sure that the WaitForIncomingData function ended
 		WAITMUTEX_UNLOCK
 	}
 	else
+	{
 		m_abortDesc.Destroy(); // Doesn't do anything if not initialized
+		RECEIVEMUTEX_UNLOCK
+	}
 
 	MAINMUTEX_UNLOCK
 }
@@ -795,10 +972,10 @@ int RTPUDPv4Transmitter::Poll()
 
 	int status;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	status = PollSocket(true); // poll RTP socket
@@ -807,7 +984,7 @@ int RTPUDPv4Transmitter::Poll()
 		if (status >= 0)
 			status = PollSocket(false); // poll RTCP socket
 	}
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -816,22 +993,22 @@ int RTPUDPv4Transmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavai
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (waitingfordata)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_ALREADYWAITING;
 	}
 	
-	SocketType abortSocket = m_pAbortDesc->GetAbortSocket();
-
+	SocketType abortSocket = (m_pAbortDesc)?m_pAbortDesc->GetAbortSocket():RTPSOCKERR;
 	SocketType socks[3] = { rtpsock, rtcpsock, abortSocket };
+	size_t numsocks = (m_pAbortDesc)?3:2;
 	int8_t readflags[3] = { 0, 0, 0 };
 	const int idxRTP = 0;
 	const int idxRTCP = 1;
@@ -840,23 +1017,23 @@ int RTPUDPv4Transmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavai
 	waitingfordata = true;
 	
 	WAITMUTEX_LOCK
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 
-	int status = RTPSelect(socks, readflags, 3, delay);
+	int status = RTPSelect(socks, readflags, numsocks, delay);
 	if (status < 0)
 	{
-		MAINMUTEX_LOCK
+		RECEIVEMUTEX_LOCK
 		waitingfordata = false;
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		WAITMUTEX_UNLOCK
 		return status;
 	}
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	waitingfordata = false;
 	if (!created) // destroy called
 	{
-		MAINMUTEX_UNLOCK;
+		RECEIVEMUTEX_UNLOCK;
 		WAITMUTEX_UNLOCK
 		return 0;
 	}
@@ -873,7 +1050,7 @@ int RTPUDPv4Transmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavai
 			*dataavailable = false;
 	}	
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	WAITMUTEX_UNLOCK
 	return 0;
 }
@@ -883,21 +1060,26 @@ int RTPUDPv4Transmitter::AbortWait()
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (!waitingfordata)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTWAITING;
 	}
+	if (!m_pAbortDesc)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_NOABORTDESCRIPTORS;
+	}
 
 	m_pAbortDesc->SendAbortSignal();
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return 0;
 }
 
@@ -906,28 +1088,23 @@ int RTPUDPv4Transmitter::SendRTPData(const void *data,size_t len)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 
-	MAINMUTEX_LOCK
+	SENDMUTEX_LOCK
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (len > maxpacksize)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_SPECIFIEDSIZETOOBIG;
 	}
 	
-	destinations.GotoFirstElement();
-	while (destinations.HasCurrentElement())
-	{
-		sendto(rtpsock,(const char *)data,len,0,(const struct sockaddr *)destinations.GetCurrentElement().GetRTPSockAddr(),sizeof(struct sockaddr_in));
-		destinations.GotoNextElement();
-	}
+	int status = SendToDestinations(true,data,len);
 	
-	MAINMUTEX_UNLOCK
-	return 0;
+	SENDMUTEX_UNLOCK
+	return status;
 }
 
 int RTPUDPv4Transmitter::SendRTCPData(const void *data,size_t len)
@@ -935,31 +1112,132 @@ int RTPUDPv4Transmitter::SendRTCPData(const void *data,size_t len)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 
-	MAINMUTEX_LOCK
+	SENDMUTEX_LOCK
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (len > maxpacksize)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_SPECIFIEDSIZETOOBIG;
 	}
 	
-	destinations.GotoFirstElement();
-	while (destinations.HasCurrentElement())
+	int status = SendToDestinations(false,data,len);
+	
+	SENDMUTEX_UNLOCK
+	return status;
+}
+
+int RTPUDPv4Transmitter::SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets)
+{
+	if (!init)
+		return ERR_RTP_UDPV4TRANS_NOTINIT;
+
+	SENDMUTEX_LOCK
+	
+	if (!created)
 	{
-		sendto(rtcpsock,(const char *)data,len,0,(const struct sockaddr *)destinations.GetCurrentElement().GetRTCPSockAddr(),sizeof(struct sockaddr_in));
-		destinations.GotoNextElement();
+		SENDMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_NOTCREATED;
+	}
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		if (lengths[i] > maxpacksize)
+		{
+			SENDMUTEX_UNLOCK
+			return ERR_RTP_UDPV4TRANS_SPECIFIEDSIZETOOBIG;
+		}
+	}
+
+	size_t pos = 0;
+	while (pos < numpackets)
+	{
+		size_t num = 1;
+		int status;
+
+#ifdef RTP_HAVE_UDP_SEGMENT
+		if (usesegmentation)
+		{
+			// The kernel splits the data into segments of the size of the first
+			// packet, so only the last packet in a group may be shorter
+			size_t segsize = lengths[pos];
+			size_t totalsize = segsize;
+
+			while (pos+num < numpackets && num < RTPUDPV4TRANS_MAXSEGMENTS && lengths[pos+num] > 0 && lengths[pos+num] <= segsize &&
+			       totalsize+lengths[pos+num] <= RTPUDPV4TRANS_MAXSEGMENTEDSIZE)
+			{
+				totalsize += lengths[pos+num];
+				num++;
+				if (lengths[pos+num-1] < segsize)
+					break;
+			}
+		}
+#endif // RTP_HAVE_UDP_SEGMENT
+
+		if (num > 1)
+			status = SendSegmented(packets+pos,lengths+pos,num);
+		else
+			status = SendToDestinations(true,packets[pos],lengths[pos]);
+		if (status < 0)
+		{
+			SENDMUTEX_UNLOCK
+			return status;
+		}
+		pos += num;
 	}
 	
-	MAINMUTEX_UNLOCK
+	SENDMUTEX_UNLOCK
 	return 0;
 }
 
 int RTPUDPv4Transmitter::AddDestination(const RTPAddress &addr)
+{
+	const RTPAddress *addresses[1] = { &addr };
+
+	return AddDestinations(addresses,1);
+}
+
+int RTPUDPv4Transmitter::DeleteDestination(const RTPAddress &addr)
+{
+	const RTPAddress *addresses[1] = { &addr };
+
+	return DeleteDestinations(addresses,1);
+}
+
+void RTPUDPv4Transmitter::ClearDestinations()
+{
+	if (!init)
+		return;
+	
+	MAINMUTEX_LOCK
+	if (created)
+	{
+		destinations.Clear();
+		if (PublishDestinations() < 0)
+		{
+			// Not even an empty snapshot could be allocated, but we must make
+			// sure that nothing is sent to the old destinations anymore
+			SENDMUTEX_LOCK
+			RTPUDPDestinationSnapshot *published = publisheddestinations.Exchange(0);
+			if (published)
+				RTPDelete(published,GetMemoryManager());
+			if (senddestinations)
+			{
+				RTPDelete(senddestinations,GetMemoryManager());
+				senddestinations = 0;
+			}
+			rtpsendbatchvalid = false;
+			rtcpsendbatchvalid = false;
+			SENDMUTEX_UNLOCK
+		}
+	}
+	MAINMUTEX_UNLOCK
+}
+
+int RTPUDPv4Transmitter::AddDestinations(const RTPAddress * const *addresses,size_t numaddresses)
 {
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
@@ -972,53 +1250,133 @@ int RTPUDPv4Transmitter::AddDestination(const RTPAddress &addr)
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 
-	RTPIPv4Destination dest;
-	if (!RTPIPv4Destination::AddressToDestination(addr, dest))
+	int status = 0;
+	size_t num = 0;
+
+	while (num < numaddresses)
 	{
-		MAINMUTEX_UNLOCK
-		return ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
+		RTPIPv4Destination dest;
+		if (!RTPIPv4Destination::AddressToDestination(*addresses[num], dest))
+		{
+			status = ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
+			break;
+		}
+		if ((status = destinations.AddElement(dest)) < 0)
+			break;
+		num++;
+	}
+
+	if (status >= 0 && num > 0)
+		status = PublishDestinations();
+
+	// Either all of the addresses are processed, or none of them
+	if (status < 0)
+	{
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			RTPIPv4Destination dest;
+
+			RTPIPv4Destination::AddressToDestination(*addresses[i], dest);
+			destinations.DeleteElement(dest);
+		}
 	}
-	
-	int status = destinations.AddElement(dest);
 
 	MAINMUTEX_UNLOCK
 	return status;
 }
 
-int RTPUDPv4Transmitter::DeleteDestination(const RTPAddress &addr)
+int RTPUDPv4Transmitter::DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses)
 {
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
 	MAINMUTEX_LOCK
-	
+
 	if (!created)
 	{
 		MAINMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
-	RTPIPv4Destination dest;
-	if (!RTPIPv4Destination::AddressToDestination(addr, dest))
+
+	int status = 0;
+	size_t num = 0;
+
+	while (num < numaddresses)
 	{
-		MAINMUTEX_UNLOCK
-		return ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
+		RTPIPv4Destination dest;
+		if (!RTPIPv4Destination::AddressToDestination(*addresses[num], dest))
+		{
+			status = ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
+			break;
+		}
+		if ((status = destinations.DeleteElement(dest)) < 0)
+			break;
+		num++;
 	}
-	
-	int status = destinations.DeleteElement(dest);
-	
+
+	if (status >= 0 && num > 0)
+		status = PublishDestinations();
+
+	// Either all of the addresses are processed, or none of them
+	if (status < 0)
+	{
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			RTPIPv4Destination dest;
+
+			RTPIPv4Destination::AddressToDestination(*addresses[i], dest);
+			destinations.AddElement(dest);
+		}
+	}
+
 	MAINMUTEX_UNLOCK
 	return status;
 }
 
-void RTPUDPv4Transmitter::ClearDestinations()
+int RTPUDPv4Transmitter::PublishDestinations()
 {
-	if (!init)
-		return;
-	
-	MAINMUTEX_LOCK
-	if (created)
-		destinations.Clear();
-	MAINMUTEX_UNLOCK
+	RTPUDPDestinationSnapshot *snapshot = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_DESTINATIONSNAPSHOT) RTPUDPDestinationSnapshot(GetMemoryManager());
+	if (snapshot == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	size_t num = 0;
+	int status;
+
+	destinations.GotoFirstElement();
+	while (destinations.HasCurrentElement())
+	{
+		num++;
+		destinations.GotoNextElement();
+	}
+
+	if ((status = snapshot->Create(num,sizeof(struct sockaddr_in))) < 0)
+	{
+		RTPDelete(snapshot,GetMemoryManager());
+		return status;
+	}
+
+	num = 0;
+	destinations.GotoFirstElement();
+	while (destinations.HasCurrentElement())
+	{
+		const RTPIPv4Destination &dest = destinations.GetCurrentElement();
+
+		snapshot->SetDestination(num++,(const struct sockaddr *)dest.GetRTPSockAddr(),(const struct sockaddr *)dest.GetRTCPSockAddr());
+		destinations.GotoNextElement();
+	}
+
+	// If the send path didn't pick up the previously published snapshot yet,
+	// it's simply replaced by the new one
+#ifdef RTP_HAVE_STDATOMIC
+	RTPUDPDestinationSnapshot *prev = publisheddestinations.Exchange(snapshot);
+#else
+	SENDMUTEX_LOCK
+	RTPUDPDestinationSnapshot *prev = publisheddestinations.Exchange(snapshot);
+	SENDMUTEX_UNLOCK
+#endif // RTP_HAVE_STDATOMIC
+	if (prev)
+		RTPDelete(prev,GetMemoryManager());
+	return 0;
 }
 
 bool RTPUDPv4Transmitter::SupportsMulticasting()
@@ -1191,18 +1549,19 @@ int RTPUDPv4Transmitter::SetReceiveMode(RTPTransmitter::ReceiveMode m)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (m != receivemode)
 	{
 		receivemode = m;
-		acceptignoreinfo.Clear();
+		ClearAcceptIgnoreInfo();
+		UpdateSocketFilter();
 	}
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return 0;
 }
 
@@ -1211,30 +1570,32 @@ int RTPUDPv4Transmitter::AddToIgnoreList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv4Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::IgnoreSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv4Address &address = (const RTPIPv4Address &)addr;
 	status = ProcessAddAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1243,30 +1604,32 @@ int RTPUDPv4Transmitter::DeleteFromIgnoreList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv4Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::IgnoreSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv4Address &address = (const RTPIPv4Address &)addr;	
 	status = ProcessDeleteAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1275,10 +1638,13 @@ void RTPUDPv4Transmitter::ClearIgnoreList()
 	if (!init)
 		return;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (created && receivemode == RTPTransmitter::IgnoreSome)
+	{
 		ClearAcceptIgnoreInfo();
-	MAINMUTEX_UNLOCK
+		UpdateSocketFilter();
+	}
+	RECEIVEMUTEX_UNLOCK
 }
 
 int RTPUDPv4Transmitter::AddToAcceptList(const RTPAddress &addr)
@@ -1286,30 +1652,32 @@ int RTPUDPv4Transmitter::AddToAcceptList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv4Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::AcceptSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv4Address &address = (const RTPIPv4Address &)addr;
 	status = ProcessAddAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1318,30 +1686,32 @@ int RTPUDPv4Transmitter::DeleteFromAcceptList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv4Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::AcceptSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv4Address &address = (const RTPIPv4Address &)addr;
 	status = ProcessDeleteAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1350,10 +1720,13 @@ void RTPUDPv4Transmitter::ClearAcceptList()
 	if (!init)
 		return;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (created && receivemode == RTPTransmitter::AcceptSome)
+	{
 		ClearAcceptIgnoreInfo();
-	MAINMUTEX_UNLOCK
+		UpdateSocketFilter();
+	}
+	RECEIVEMUTEX_UNLOCK
 }
 
 int RTPUDPv4Transmitter::SetMaximumPacketSize(size_t s)	
@@ -1361,19 +1734,19 @@ int RTPUDPv4Transmitter::SetMaximumPacketSize(size_t s)
 	if (!init)
 		return ERR_RTP_UDPV4TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	SENDMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_NOTCREATED;
 	}
 	if (s > RTPUDPV4TRANS_MAXPACKSIZE)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV4TRANS_SPECIFIEDSIZETOOBIG;
 	}
 	maxpacksize = s;
-	MAINMUTEX_UNLOCK
+	SENDMUTEX_UNLOCK
 	return 0;
 }
 
@@ -1382,7 +1755,7 @@ bool RTPUDPv4Transmitter::NewDataAvailable()
 	if (!init)
 		return false;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	bool v;
 		
@@ -1396,7 +1769,7 @@ bool RTPUDPv4Transmitter::NewDataAvailable()
 			v = true;
 	}
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return v;
 }
 
@@ -1405,28 +1778,88 @@ RTPRawPacket *RTPUDPv4Transmitter::GetNextPacket()
 	if (!init)
 		return 0;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	RTPRawPacket *p;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return 0;
 	}
 	if (rawpacketlist.empty())
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return 0;
 	}
 
 	p = *(rawpacketlist.begin());
 	rawpacketlist.pop_front();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return p;
 }
 
+int RTPUDPv4Transmitter::GetReceiveBatchStatistics(RTPReceiveBatchStatistics &stats)
+{
+	if (!init)
+		return ERR_RTP_UDPV4TRANS_NOTINIT;
+	
+	RECEIVEMUTEX_LOCK
+	if (!created)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_NOTCREATED;
+	}
+	stats = recvbatch.GetStatistics();
+	RECEIVEMUTEX_UNLOCK
+	return 0;
+}
+
+void RTPUDPv4Transmitter::ClearReceiveBatchStatistics()
+{
+	if (!init)
+		return;
+	
+	RECEIVEMUTEX_LOCK
+	recvbatch.ClearStatistics();
+	RECEIVEMUTEX_UNLOCK
+}
+
+bool RTPUDPv4Transmitter::GetNextSendError(RTPIPv4Address &addr,bool &rtp,int &errorcode)
+{
+	if (!init)
+		return false;
+
+	SENDMUTEX_LOCK
+	if (senderrors.empty())
+	{
+		SENDMUTEX_UNLOCK
+		return false;
+	}
+
+	const SendErrorInfo &info = senderrors.front();
+	addr.SetIP(info.ip);
+	addr.SetPort(info.port);
+	rtp = info.rtp;
+	errorcode = info.errorcode;
+	senderrors.pop_front();
+
+	SENDMUTEX_UNLOCK
+	return true;
+}
+
+uint64_t RTPUDPv4Transmitter::GetNumberOfSendErrors()
+{
+	if (!init)
+		return 0;
+
+	SENDMUTEX_LOCK
+	uint64_t num = numsenderrors;
+	SENDMUTEX_UNLOCK
+	return num;
+}
+
 // Here the private functions start...
 
 #ifdef RTP_SUPPORT_IPV4MULTICAST
@@ -1472,6 +1905,9 @@ int RTPUDPv4Transmitter::PollSocket(bool rtp)
 #endif // RTP_SOCKETTYPE_WINSOCK
 	struct sockaddr_in srcaddr;
 	bool dataavailable;
+
+	if (recvbatch.IsCreated())
+		return PollSocketBatched(rtp);
 	
 	if (rtp)
 		sock = rtpsock;
@@ -1503,67 +1939,431 @@ int RTPUDPv4Transmitter::PollSocket(bool rtp)
 		else
 			dataavailable = true;
 		
-		if (dataavailable)
+		if (dataavailable && bufferpool && len > 0 && (size_t)len+RTPPacket::GetEmbeddedSize() <= bufferpool->GetBufferSize())
+		{
+			// The size of the packet is known and it fits in a buffer of the
+			// pool, so there's no need to read it into a temporary buffer first.
+			// Note that on some platforms the reported length is the total amount
+			// of queued data, which can only be larger than the first packet.
+			uint8_t *buf = AllocateReceiveBuffer(rtp,(size_t)len);
+			if (buf == 0)
+				return ERR_RTP_OUTOFMEM;
+			
+			RTPTime curtime = RTPTime::CurrentTime();
+			fromlen = sizeof(struct sockaddr_in);
+			recvlen = recvfrom(sock,(char *)buf,(int)len,0,(struct sockaddr *)&srcaddr,&fromlen);
+			if (recvlen > 0)
+			{
+				uint32_t srcip = ntohl(srcaddr.sin_addr.s_addr);
+				uint16_t srcport = ntohs(srcaddr.sin_port);
+				
+				if (receivemode == RTPTransmitter::AcceptAll || ShouldAcceptData(srcip,srcport))
+				{
+					int status = StoreReceivedData(rtp,buf,(size_t)recvlen,srcip,srcport,curtime);
+					if (status < 0)
+						return status;
+				}
+				else
+					ReleaseReceiveBuffer(buf);
+			}
+			else
+				ReleaseReceiveBuffer(buf);
+		}
+		else if (dataavailable)
 		{
 			RTPTime curtime = RTPTime::CurrentTime();
 			fromlen = sizeof(struct sockaddr_in);
 			recvlen = recvfrom(sock,packetbuffer,RTPUDPV4TRANS_MAXPACKSIZE,0,(struct sockaddr *)&srcaddr,&fromlen);
 			if (recvlen > 0)
 			{
-				bool acceptdata;
+				int status = ProcessReceivedData(rtp,(const uint8_t *)packetbuffer,(size_t)recvlen,ntohl(srcaddr.sin_addr.s_addr),ntohs(srcaddr.sin_port),curtime);
+				if (status < 0)
+					return status;
+			}
+		}
+	} while (dataavailable);
 
-				// got data, process it
-				if (receivemode == RTPTransmitter::AcceptAll)
-					acceptdata = true;
-				else
-					acceptdata = ShouldAcceptData(ntohl(srcaddr.sin_addr.s_addr),ntohs(srcaddr.sin_port));
-				
-				if (acceptdata)
+	return 0;
+}
+
+int RTPUDPv4Transmitter::PollSocketBatched(bool rtp)
+{
+	SocketType sock = (rtp)?rtpsock:rtcpsock;
+	size_t num;
+	
+	// The socket is read without blocking, so we can just keep reading until
+	// a batch isn't filled completely
+	do
+	{
+		num = (size_t)recvbatch.Receive(sock);
+		if (num == 0)
+			break;
+
+		// Only when the kernel didn't provide a timestamp for a datagram, the
+		// current time is used as its receive time
+		RTPTime curtime(0);
+		bool havecurtime = false;
+
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			size_t datalen = recvbatch.GetDatagramLength(i);
+			const struct sockaddr *addr = recvbatch.GetSourceAddress(i);
+
+			// make sure a packet of length zero is not queued, and that truncated
+			// packets are dropped just like they would be in the normal case
+			if (datalen == 0 || recvbatch.IsDatagramTruncated(i) || addr->sa_family != AF_INET)
+				continue;
+
+			const struct sockaddr_in *srcaddr = (const struct sockaddr_in *)addr;
+			const uint8_t *data = recvbatch.GetDatagramData(i);
+			size_t segsize = recvbatch.GetDatagramSegmentSize(i);
+
+			// If the kernel coalesced several datagrams, split them up again
+			if (segsize == 0 || segsize > datalen)
+				segsize = datalen;
+
+			RTPTime recvtime(0);
+			bool kerneltime = recvbatch.GetDatagramReceiveTime(i,recvtime);
+
+			if (!kerneltime)
+			{
+				if (!havecurtime)
 				{
-					RTPRawPacket *pack;
-					RTPIPv4Address *addr;
-					uint8_t *datacopy;
+					curtime = RTPTime::CurrentTime();
+					havecurtime = true;
+				}
+				recvtime = curtime;
+			}
 
-					addr = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPADDRESS) RTPIPv4Address(ntohl(srcaddr.sin_addr.s_addr),ntohs(srcaddr.sin_port));
-					if (addr == 0)
-						return ERR_RTP_OUTOFMEM;
-					datacopy = RTPNew(GetMemoryManager(),(rtp)?RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET:RTPMEM_TYPE_BUFFER_RECEIVEDRTCPPACKET) uint8_t[recvlen];
-					if (datacopy == 0)
-					{
-						RTPDelete(addr,GetMemoryManager());
-						return ERR_RTP_OUTOFMEM;
-					}
-					memcpy(datacopy,packetbuffer,recvlen);
-					
-					bool isrtp = rtp;
-					if (rtpsock == rtcpsock) // check payload type when multiplexing
-					{
-						isrtp = true;
+			for (size_t offset = 0 ; offset < datalen ; offset += segsize)
+			{
+				size_t seglen = (datalen-offset < segsize)?(datalen-offset):segsize;
+				int status = ProcessReceivedData(rtp,data+offset,seglen,ntohl(srcaddr->sin_addr.s_addr),ntohs(srcaddr->sin_port),recvtime,kerneltime);
+				if (status < 0)
+					return status;
+			}
+		}
+	} while (num == recvbatch.GetBatchSize());
 
-						if ((size_t)recvlen > sizeof(RTCPCommonHeader))
-						{
-							RTCPCommonHeader *rtcpheader = (RTCPCommonHeader *)datacopy;
-							uint8_t packettype = rtcpheader->packettype;
+	return 0;
+}
 
-    						if (packettype >= 200 && packettype <= 204)
-								isrtp = false;
-						}
-					}
-						
-					pack = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPRAWPACKET) RTPRawPacket(datacopy,recvlen,addr,curtime,isrtp,GetMemoryManager());
-					if (pack == 0)
-					{
-						RTPDelete(addr,GetMemoryManager());
-						RTPDeleteByteArray(datacopy,GetMemoryManager());
-						return ERR_RTP_OUTOFMEM;
-					}
-					rawpacketlist.push_back(pack);	
+int RTPUDPv4Transmitter::ProcessReceivedData(bool rtp,const uint8_t *data,size_t datalen,uint32_t srcip,uint16_t srcport,RTPTime &receivetime,bool kerneltime)
+{
+	bool acceptdata;
+
+	// got data, process it
+	if (receivemode == RTPTransmitter::AcceptAll)
+		acceptdata = true;
+	else
+		acceptdata = ShouldAcceptData(srcip,srcport);
+	
+	if (!acceptdata)
+		return 0;
+
+	uint8_t *datacopy;
+
+	datacopy = AllocateReceiveBuffer(rtp,datalen);
+	if (datacopy == 0)
+		return ERR_RTP_OUTOFMEM;
+	memcpy(datacopy,data,datalen);
+	
+	return StoreReceivedData(rtp,datacopy,datalen,srcip,srcport,receivetime,kerneltime);
+}
+
+int RTPUDPv4Transmitter::StoreReceivedData(bool rtp,uint8_t *data,size_t datalen,uint32_t srcip,uint16_t srcport,RTPTime &receivetime,bool kerneltime)
+{
+	// The data buffer was obtained using AllocateReceiveBuffer and is owned
+	// by the raw packet if this succeeds, so this doesn't allocate anything
+	// besides the raw packet itself
+	RTPRawPacket *pack;
+	RTPIPv4Address addr(srcip,srcport);
+	
+	bool isrtp = rtp;
+	if (rtpsock == rtcpsock) // check payload type when multiplexing
+	{
+		isrtp = true;
+
+		if (datalen > sizeof(RTCPCommonHeader))
+		{
+			RTCPCommonHeader *rtcpheader = (RTCPCommonHeader *)data;
+			uint8_t packettype = rtcpheader->packettype;
+
+			if (packettype >= 200 && packettype <= 204)
+				isrtp = false;
+		}
+	}
+		
+	// The address is stored inside the raw packet instance
+	pack = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPRAWPACKET) RTPRawPacket(data,datalen,addr,receivetime,isrtp,GetMemoryManager());
+	if (pack == 0)
+	{
+		ReleaseReceiveBuffer(data);
+		return ERR_RTP_OUTOFMEM;
+	}
+	pack->SetBufferPool(bufferpool);
+	pack->SetDataHeadroom(RTPPacket::GetEmbeddedSize());
+	pack->SetKernelReceiveTime(kerneltime);
+	rawpacketlist.push_back(pack);	
+	return 0;
+}
+
+uint8_t *RTPUDPv4Transmitter::AllocateReceiveBuffer(bool rtp,size_t len)
+{
+	// Room is reserved in front of the data, so that the RTPPacket instance
+	// can be stored in the same memory block
+	size_t headroom = RTPPacket::GetEmbeddedSize();
+	uint8_t *block;
+
+	if (bufferpool)
+		block = bufferpool->GetBuffer(headroom+len,rtp);
+	else
+		block = RTPNew(GetMemoryManager(),(rtp)?RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET:RTPMEM_TYPE_BUFFER_RECEIVEDRTCPPACKET) uint8_t[headroom+len];
+	if (block == 0)
+		return 0;
+	return block+headroom;
+}
+
+void RTPUDPv4Transmitter::ReleaseReceiveBuffer(uint8_t *data)
+{
+	uint8_t *block = data-RTPPacket::GetEmbeddedSize();
+
+	if (bufferpool)
+		bufferpool->ReleaseBuffer(block);
+	else
+		RTPDeleteByteArray(block,GetMemoryManager());
+}
+
+int RTPUDPv4Transmitter::SetReceiveBufferPool(RTPReceiveBufferPool *pool)
+{
+	if (!init)
+		return ERR_RTP_UDPV4TRANS_NOTINIT;
+	
+	RECEIVEMUTEX_LOCK
+	if (!created)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_NOTCREATED;
+	}
+	if (pool)
+		pool->AddReference();
+	if (bufferpool)
+		bufferpool->Release();
+	bufferpool = pool;
+	RECEIVEMUTEX_UNLOCK
+	return 0;
+}
+
+int RTPUDPv4Transmitter::GetReceiveSockets(SocketType *sockets,size_t *numsockets)
+{
+	if (!init)
+		return ERR_RTP_UDPV4TRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_NOTCREATED;
+	}
+
+	size_t num = (rtcpsock == rtpsock)?1:2;
+
+	if (*numsockets < num)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_TRANSMITTER_SOCKETARRAYTOOSMALL;
+	}
+	sockets[0] = rtpsock;
+	if (num > 1)
+		sockets[1] = rtcpsock;
+	*numsockets = num;
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+bool RTPUDPv4Transmitter::IsUsingSocketFilter()
+{
+	if (!init)
+		return false;
+
+	RECEIVEMUTEX_LOCK
+	bool active = (created && socketfilteractive);
+	RECEIVEMUTEX_UNLOCK
+	return active;
+}
+
+int RTPUDPv4Transmitter::GetNumberOfKernelDrops(uint64_t &num)
+{
+	if (!init)
+		return ERR_RTP_UDPV4TRANS_NOTINIT;
+
+	RECEIVEMUTEX_LOCK
+	if (!created)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV4TRANS_NOTCREATED;
+	}
+
+	uint32_t numrtp = 0, numrtcp = 0;
+	int status;
+
+	if ((status = RTPUDPSocketFilter::GetNumberOfDroppedPackets(rtpsock,numrtp)) < 0 ||
+	    (rtcpsock != rtpsock && (status = RTPUDPSocketFilter::GetNumberOfDroppedPackets(rtcpsock,numrtcp)) < 0))
+	{
+		RECEIVEMUTEX_UNLOCK
+		return status;
+	}
+	RECEIVEMUTEX_UNLOCK
+
+	num = (uint64_t)numrtp + (uint64_t)numrtcp;
+	return 0;
+}
+
+void RTPUDPv4Transmitter::UpdateSendDestinations()
+{
+	RTPUDPDestinationSnapshot *snapshot = publisheddestinations.Exchange(0);
+	if (snapshot == 0)
+		return;
+
+	if (senddestinations)
+		RTPDelete(senddestinations,GetMemoryManager());
+	senddestinations = snapshot;
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+}
+
+int RTPUDPv4Transmitter::SendToDestinations(bool rtp,const void *data,size_t len)
+{
+	SocketType sock = (rtp)?rtpsock:rtcpsock;
+
+	UpdateSendDestinations();
+	if (senddestinations == 0)
+		return 0;
+
+	const RTPUDPDestinationSnapshot &dests = *senddestinations;
+
+#ifdef RTP_HAVE_SENDMMSG
+	// The message headers for all destinations are kept until the destination
+	// list changes, so that a packet can be sent to all of them using a single
+	// system call
+	RTPUDPSendBatch &batch = (rtp)?rtpsendbatch:rtcpsendbatch;
+	bool &batchvalid = (rtp)?rtpsendbatchvalid:rtcpsendbatchvalid;
+
+	if (!batchvalid)
+	{
+		size_t num = dests.GetNumberOfDestinations();
+		int status;
+
+		if ((status = batch.Create(num)) < 0)
+			return status;
+
+		for (size_t i = 0 ; i < num ; i++)
+			batch.SetDestination(i,(rtp)?dests.GetRTPAddress(i):dests.GetRTCPAddress(i),sizeof(struct sockaddr_in));
+		batchvalid = true;
+	}
+
+	size_t numfailures = batch.Send(sock,data,len);
+	for (size_t i = 0 ; i < numfailures ; i++)
+		RecordSendError((const struct sockaddr_in *)batch.GetFailedDestination(i),rtp,batch.GetFailureErrorCode(i));
+#else
+	for (size_t i = 0 ; i < dests.GetNumberOfDestinations() ; i++)
+	{
+		const struct sockaddr_in *addr = (const struct sockaddr_in *)((rtp)?dests.GetRTPAddress(i):dests.GetRTCPAddress(i));
+
+		if (sendto(sock,(const char *)data,len,0,(const struct sockaddr *)addr,sizeof(struct sockaddr_in)) < 0)
+			RecordSendError(addr,rtp,RTPSOCKERRNO);
+	}
+#endif // RTP_HAVE_SENDMMSG
+	return 0;
+}
+
+int RTPUDPv4Transmitter::SendSegmented(const void * const *packets,const size_t *lengths,size_t numpackets)
+{
+#ifdef RTP_HAVE_UDP_SEGMENT
+	struct iovec iov[RTPUDPV4TRANS_MAXSEGMENTS];
+	char control[CMSG_SPACE(sizeof(uint16_t))];
+	struct msghdr msg;
+	uint16_t segsize = (uint16_t)lengths[0];
+
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		iov[i].iov_base = (void *)packets[i];
+		iov[i].iov_len = lengths[i];
+	}
+
+	memset(&msg,0,sizeof(struct msghdr));
+	memset(control,0,sizeof(control));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = numpackets;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+	cm->cmsg_level = SOL_UDP;
+	cm->cmsg_type = UDP_SEGMENT;
+	cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+	memcpy(CMSG_DATA(cm),&segsize,sizeof(uint16_t));
+
+	UpdateSendDestinations();
+	if (senddestinations == 0)
+		return 0;
+
+	for (size_t d = 0 ; d < senddestinations->GetNumberOfDestinations() ; d++)
+	{
+		const struct sockaddr_in *addr = (const struct sockaddr_in *)senddestinations->GetRTPAddress(d);
+		bool sendseparately = true;
+
+		if (usesegmentation)
+		{
+			msg.msg_name = (void *)addr;
+			msg.msg_namelen = sizeof(struct sockaddr_in);
+
+			if (sendmsg(rtpsock,&msg,0) >= 0)
+				sendseparately = false;
+			else
+			{
+				int errcode = RTPSOCKERRNO;
+
+				// These indicate that either the kernel or the outgoing interface
+				// can't handle segmentation offload; in that case we'll just stop
+				// using it and send the packets one by one
+				if (errcode == EIO || errcode == EINVAL || errcode == ENOPROTOOPT || errcode == EOPNOTSUPP)
+					usesegmentation = false;
+				else
+				{
+					RecordSendError(addr,true,errcode);
+					sendseparately = false;
 				}
 			}
 		}
-	} while (dataavailable);
 
+		if (sendseparately)
+		{
+			for (size_t i = 0 ; i < numpackets ; i++)
+			{
+				if (sendto(rtpsock,(const char *)packets[i],lengths[i],0,(const struct sockaddr *)addr,sizeof(struct sockaddr_in)) < 0)
+					RecordSendError(addr,true,RTPSOCKERRNO);
+			}
+		}
+	}
 	return 0;
+#else
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		int status = SendToDestinations(true,packets[i],lengths[i]);
+		if (status < 0)
+			return status;
+	}
+	return 0;
+#endif // RTP_HAVE_UDP_SEGMENT
+}
+
+void RTPUDPv4Transmitter::RecordSendError(const struct sockaddr_in *addr,bool rtp,int errorcode)
+{
+	numsenderrors++;
+	if (senderrors.size() >= RTPUDPV4TRANS_MAXSENDERRORS)
+		return;
+	senderrors.push_back(SendErrorInfo(ntohl(addr->sin_addr.s_addr),ntohs(addr->sin_port),rtp,errorcode));
 }
 
 int RTPUDPv4Transmitter::ProcessAddAcceptIgnoreEntry(uint32_t ip,uint16_t port)
@@ -1576,32 +2376,26 @@ int RTPUDPv4Transmitter::ProcessAddAcceptIgnoreEntry(uint32_t ip,uint16_t port)
 		if (port == 0) // select all ports
 		{
 			portinf->all = true;
-			portinf->portlist.clear();
+			portinf->ports.Clear();
 		}
 		else if (!portinf->all)
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = portinf->portlist.begin();
-			end = portinf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == port) // already in list
-					return 0;
-			}
-			portinf->portlist.push_front(port);
-		}
+			return portinf->ports.Add(port); // nothing happens if it's already in the set
 	}
 	else // got to create an entry for this IP address
 	{
 		PortInfo *portinf;
 		int status;
 		
-		portinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREPORTINFO) PortInfo();
+		portinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREPORTINFO) PortInfo(GetMemoryManager());
+		if (portinf == 0)
+			return ERR_RTP_OUTOFMEM;
 		if (port == 0) // select all ports
 			portinf->all = true;
-		else
-			portinf->portlist.push_front(port);
+		else if ((status = portinf->ports.Add(port)) < 0)
+		{
+			RTPDelete(portinf,GetMemoryManager());
+			return status;
+		}
 		
 		status = acceptignoreinfo.AddElement(ip,portinf);
 		if (status < 0)
@@ -1640,120 +2434,86 @@ int RTPUDPv4Transmitter::ProcessDeleteAcceptIgnoreEntry(uint32_t ip,uint16_t por
 	if (port == 0) // delete all entries
 	{
 		inf->all = false;
-		inf->portlist.clear();
+		inf->ports.Clear();
 	}
 	else // a specific port was selected
 	{
-		if (inf->all) // currently, all ports are selected. Add the one to remove to the list
+		if (inf->all) // currently, all ports are selected. Add the one to remove to the set
 		{
-			// we have to check if the list doesn't contain the port already
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == port) // already in list: this means we already deleted the entry
-					return ERR_RTP_UDPV4TRANS_NOSUCHENTRY;
-			}
-			inf->portlist.push_front(port);
-		}
-		else // check if we can find the port in the list
-		{
-			std::list<uint16_t>::iterator it,begin,end;
-			
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; ++it)
-			{
-				if (*it == port) // found it!
-				{
-					inf->portlist.erase(it);
-					return 0;
-				}
-			}
-			// didn't find it
-			return ERR_RTP_UDPV4TRANS_NOSUCHENTRY;			
+			if (inf->ports.Contains(port)) // this means we already deleted the entry
+				return ERR_RTP_UDPV4TRANS_NOSUCHENTRY;
+			return inf->ports.Add(port);
 		}
+		else if (!inf->ports.Remove(port)) // didn't find it
+			return ERR_RTP_UDPV4TRANS_NOSUCHENTRY;
 	}
 	return 0;
 }
 
 bool RTPUDPv4Transmitter::ShouldAcceptData(uint32_t srcip,uint16_t srcport)
 {
+	PortInfo *inf;
+
+	acceptignoreinfo.GotoElement(srcip);
 	if (receivemode == RTPTransmitter::AcceptSome)
 	{
-		PortInfo *inf;
-
-		acceptignoreinfo.GotoElement(srcip);
 		if (!acceptignoreinfo.HasCurrentElement())
 			return false;
 		
+		// If 'all' is set, accept all ports except the ones in the set,
+		// otherwise only accept the ones in the set
 		inf = acceptignoreinfo.GetCurrentElement();
-		if (!inf->all) // only accept the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return true;
-			}
-			return false;
-		}
-		else // accept all, except the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return false;
-			}
-			return true;
-		}
+		return (inf->ports.Contains(srcport) != inf->all);
 	}
 	else // IgnoreSome
 	{
-		PortInfo *inf;
-
-		acceptignoreinfo.GotoElement(srcip);
 		if (!acceptignoreinfo.HasCurrentElement())
 			return true;
 		
+		// If 'all' is set, ignore all ports except the ones in the set,
+		// otherwise only ignore the ones in the set
 		inf = acceptignoreinfo.GetCurrentElement();
-		if (!inf->all) // ignore the ports in the list
+		return (inf->ports.Contains(srcport) == inf->all);
+	}
+}
+
+void RTPUDPv4Transmitter::UpdateSocketFilter()
+{
+	if (!usesocketfilter)
+		return;
+
+	if (receivemode != RTPTransmitter::AcceptAll)
+	{
+		socketfilter.Start(receivemode,1);
+
+		acceptignoreinfo.GotoFirstElement();
+		while (acceptignoreinfo.HasCurrentElement())
 		{
-			std::list<uint16_t>::const_iterator it,begin,end;
+			uint32_t ip = acceptignoreinfo.GetCurrentKey();
+			PortInfo *inf = acceptignoreinfo.GetCurrentElement();
 
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return false;
-			}
-			return true;
+			socketfilter.AddEntry(&ip,inf->all,inf->ports);
+			acceptignoreinfo.GotoNextElement();
 		}
-		else // ignore all, except the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
 
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return true;
-			}
-			return false;
+		if (socketfilter.Attach(rtpsock) >= 0)
+		{
+			socketfilteractive = true;
+			if (rtcpsock == rtpsock || socketfilter.Attach(rtcpsock) >= 0)
+				return;
+			// The RTP socket is filtered now, so it's detached again below
 		}
 	}
-	return true;
+
+	// Either all packets need to be accepted, or the filter couldn't be attached,
+	// in which case the packets are only checked after reading them
+	if (socketfilteractive)
+	{
+		RTPUDPSocketFilter::Detach(rtpsock);
+		if (rtcpsock != rtpsock)
+			RTPUDPSocketFilter::Detach(rtcpsock);
+		socketfilteractive = false;
+	}
 }
 
 int RTPUDPv4Transmitter::CreateLocalIPList()
@@ -1953,6 +2713,8 @@ void RTPUDPv4Transmitter::Dump()
 	else
 	{
 		MAINMUTEX_LOCK
+		RECEIVEMUTEX_LOCK
+		SENDMUTEX_LOCK
 	
 		if (!created)
 			std::cout << "Not created" << std::endl;
@@ -2002,17 +2764,15 @@ void RTPUDPv4Transmitter::Dump()
 					if (pinfo->all)
 					{
 						std::cout << "All ports";
-						if (!pinfo->portlist.empty())
+						if (!pinfo->ports.IsEmpty())
 							std::cout << ", except ";
 					}
 					
-					std::list<uint16_t>::const_iterator it;
-					
-					for (it = pinfo->portlist.begin() ; it != pinfo->portlist.end() ; )
+					for (int port = pinfo->ports.GetNextPort(-1) ; port >= 0 ; )
 					{
-						std::cout << (*it);
-						it++;
-						if (it != pinfo->portlist.end())
+						std::cout << port;
+						port = pinfo->ports.GetNextPort(port);
+						if (port >= 0)
 							std::cout << ", ";
 					}
 					std::cout << std::endl;
@@ -2063,6 +2823,8 @@ void RTPUDPv4Transmitter::Dump()
 			std::cout << "Maximum allowed packet size:    " << maxpacksize << std::endl;
 		}
 		
+		SENDMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		MAINMUTEX_UNLOCK
 	}
 }
@@ -40,6 +40,7 @@
 #ifdef RTP_SUPPORT_IPV6
 
 #include "rtprawpacket.h"
+#include "rtppacket.h"
 #include "rtpipv6address.h"
 #include "rtptimeutilities.h"
 #include "rtpdefines.h"
@@ -47,6 +48,10 @@
 #include "rtpinternalutils.h"
 #include "rtpselect.h"
 #include <stdio.h>
+#if defined(RTP_HAVE_UDP_SEGMENT) || defined(RTP_HAVE_UDP_GRO)
+	#include <netinet/udp.h>
+#endif // RTP_HAVE_UDP_SEGMENT || RTP_HAVE_UDP_GRO
+#include <algorithm>
 
 #include "rtpdebug.h"
 
@@ -65,11 +70,19 @@
 #ifdef RTP_SUPPORT_THREAD
 	#define MAINMUTEX_LOCK 		{ if (threadsafe) mainmutex.Lock(); }
 	#define MAINMUTEX_UNLOCK	{ if (threadsafe) mainmutex.Unlock(); }
+	#define SENDMUTEX_LOCK		{ if (threadsafe) sendmutex.Lock(); }
+	#define SENDMUTEX_UNLOCK	{ if (threadsafe) sendmutex.Unlock(); }
+	#define RECEIVEMUTEX_LOCK	{ if (threadsafe) receivemutex.Lock(); }
+	#define RECEIVEMUTEX_UNLOCK	{ if (threadsafe) receivemutex.Unlock(); }
 	#define WAITMUTEX_LOCK		{ if (threadsafe) waitmutex.Lock(); }
 	#define WAITMUTEX_UNLOCK	{ if (threadsafe) waitmutex.Unlock(); }
 #else
 	#define MAINMUTEX_LOCK
 	#define MAINMUTEX_UNLOCK
+	#define SENDMUTEX_LOCK
+	#define SENDMUTEX_UNLOCK
+	#define RECEIVEMUTEX_LOCK
+	#define RECEIVEMUTEX_UNLOCK
 	#define WAITMUTEX_LOCK
 	#define WAITMUTEX_UNLOCK
 #endif // RTP_SUPPORT_THREAD
@@ -87,10 +100,21 @@ namespace jrtplib
 RTPUDPv6Transmitter::RTPUDPv6Transmitter(RTPMemoryManager *mgr) : RTPTransmitter(mgr),
 								  destinations(GetMemoryManager(),RTPMEM_TYPE_CLASS_DESTINATIONLISTHASHELEMENT),
 								  multicastgroups(GetMemoryManager(),RTPMEM_TYPE_CLASS_MULTICASTHASHELEMENT),
-								  acceptignoreinfo(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREHASHELEMENT)
+								  acceptignoreinfo(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREHASHELEMENT),
+								  recvbatch(GetMemoryManager()),
+								  rtpsendbatch(GetMemoryManager()),
+								  rtcpsendbatch(GetMemoryManager())
 {
 	created = false;
 	init = false;
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+	usesegmentation = false;
+	numsenderrors = 0;
+	bufferpool = 0;
+	senddestinations = 0;
+	usesocketfilter = false;
+	socketfilteractive = false;
 }
 
 RTPUDPv6Transmitter::~RTPUDPv6Transmitter()
@@ -110,6 +134,12 @@ int RTPUDPv6Transmitter::Init(bool tsafe)
 		int status;
 		
 		status = mainmutex.Init();
+		if (status < 0)
+			return ERR_RTP_UDPV6TRANS_CANTINITMUTEX;
+		status = sendmutex.Init();
+		if (status < 0)
+			return ERR_RTP_UDPV6TRANS_CANTINITMUTEX;
+		status = receivemutex.Init();
 		if (status < 0)
 			return ERR_RTP_UDPV6TRANS_CANTINITMUTEX;
 		status = waitmutex.Init();
@@ -125,6 +155,18 @@ int RTPUDPv6Transmitter::Init(bool tsafe)
 	return 0;
 }
 
+static bool EnableReusePort(SocketType s)
+{
+#ifdef RTP_HAVE_SO_REUSEPORT
+	int enable = 1;
+
+	return (setsockopt(s,SOL_SOCKET,SO_REUSEPORT,(const char *)&enable,sizeof(int)) == 0);
+#else
+	JRTPLIB_UNUSED(s);
+	return false;
+#endif // RTP_HAVE_SO_REUSEPORT
+}
+
 int RTPUDPv6Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionParams *transparams)
 {
 	const RTPUDPv6TransmissionParams *params,defaultparams;
@@ -179,6 +221,15 @@ int RTPUDPv6Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		MAINMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_CANTCREATESOCKET;
 	}
+
+	// This needs to be set before binding the sockets
+	if (params->GetReusePortShards() > 0 && (!EnableReusePort(rtpsock) || !EnableReusePort(rtcpsock)))
+	{
+		RTPCLOSE(rtpsock);
+		RTPCLOSE(rtcpsock);
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_CANTSETREUSEPORT;
+	}
 	
 	// set socket buffer sizes
 	
@@ -243,6 +294,20 @@ int RTPUDPv6Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		return ERR_RTP_UDPV6TRANS_CANTBINDRTCPSOCKET;
 	}
 
+	// The program is shared by all sockets bound to the same port, each
+	// transmitter sets the same one
+	if (params->GetReusePortShards() > 0 && params->GetUseSSRCSteering())
+	{
+		if ((status = RTPUDPSocketFilter::AttachSSRCSteering(rtpsock,params->GetReusePortShards(),true,false)) < 0 ||
+		    (status = RTPUDPSocketFilter::AttachSSRCSteering(rtcpsock,params->GetReusePortShards(),false,true)) < 0)
+		{
+			RTPCLOSE(rtpsock);
+			RTPCLOSE(rtcpsock);
+			MAINMUTEX_UNLOCK
+			return status;
+		}
+	}
+
 	// Try to obtain local IP addresses
 
 	localIPs = params->GetLocalIPList();
@@ -288,11 +353,68 @@ int RTPUDPv6Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		MAINMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_SPECIFIEDSIZETOOBIG;
 	}
+
+	// A batch size of zero reads each datagram separately, just like a batch size of one
+	if (params->GetReceiveBatchSize() > RTPUDPV6TRANS_MAXRECEIVEBATCHSIZE)
+	{
+		RTPCLOSE(rtpsock);
+		RTPCLOSE(rtcpsock);
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_ILLEGALRECEIVEBATCHSIZE;
+	}
+
+#ifdef RTP_HAVE_RECVMMSG
+	// When generic receive offload is enabled, the segment size needs to be
+	// obtained for each datagram, for which the batch receive code is used
+	// (even if the batch size is one)
+	bool receiveoffload = false;
+#ifdef RTP_HAVE_UDP_GRO
+	if (params->GetUseReceiveOffload())
+	{
+		int enable = 1;
+
+		if (setsockopt(rtpsock,SOL_UDP,UDP_GRO,(const char *)&enable,sizeof(int)) == 0)
+			receiveoffload = true;
+	}
+#endif // RTP_HAVE_UDP_GRO
+
+	// The same goes for the kernel's receive timestamps, which are delivered
+	// as control messages as well
+	bool kerneltimestamps = false;
+#ifdef RTP_HAVE_SO_TIMESTAMPNS
+	if (params->GetUseKernelTimestamps())
+	{
+		int enable = 1;
+
+		if (setsockopt(rtpsock,SOL_SOCKET,SO_TIMESTAMPNS,(const char *)&enable,sizeof(int)) == 0)
+		{
+			kerneltimestamps = true;
+			if (rtcpsock != rtpsock && setsockopt(rtcpsock,SOL_SOCKET,SO_TIMESTAMPNS,(const char *)&enable,sizeof(int)) != 0)
+				kerneltimestamps = false;
+		}
+	}
+#endif // RTP_HAVE_SO_TIMESTAMPNS
+
+	// Without recvmmsg support, the datagrams are simply read one by one
+	if (params->GetReceiveBatchSize() > 1 || receiveoffload || kerneltimestamps)
+	{
+		if ((status = recvbatch.Create(std::max((size_t)1,params->GetReceiveBatchSize()),RTPUDPV6TRANS_MAXPACKSIZE,receiveoffload,kerneltimestamps)) < 0)
+		{
+			RTPCLOSE(rtpsock);
+			RTPCLOSE(rtcpsock);
+			MAINMUTEX_UNLOCK
+			return status;
+		}
+	}
+#endif // RTP_HAVE_RECVMMSG
 	
-	if (!params->GetCreatedAbortDescriptors())
+	if (!params->GetUseAbortDescriptors())
+		m_pAbortDesc = 0;
+	else if (!params->GetCreatedAbortDescriptors())
 	{
 		if ((status = m_abortDesc.Init()) < 0)
 		{
+			recvbatch.Destroy();
 			RTPCLOSE(rtpsock);
 			RTPCLOSE(rtcpsock);
 			MAINMUTEX_UNLOCK
@@ -305,6 +427,7 @@ int RTPUDPv6Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 		m_pAbortDesc = params->GetCreatedAbortDescriptors();
 		if (!m_pAbortDesc->IsInitialized())
 		{
+			recvbatch.Destroy();
 			RTPCLOSE(rtpsock);
 			RTPCLOSE(rtcpsock);
 			MAINMUTEX_UNLOCK
@@ -320,8 +443,22 @@ int RTPUDPv6Transmitter::Create(size_t maximumpacketsize,const RTPTransmissionPa
 	localhostname = 0;
 	localhostnamelength = 0;
 
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+	senderrors.clear();
+	numsenderrors = 0;
+	usesegmentation = params->GetUseSegmentationOffload();
+	usesocketfilter = params->GetUseSocketFilter();
+	socketfilteractive = false;
+
+	// The send and receive paths only check the 'created' flag while holding
+	// their own mutex, so all of them need to be locked to change it
+	RECEIVEMUTEX_LOCK
+	SENDMUTEX_LOCK
 	waitingfordata = false;
 	created = true;
+	SENDMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	MAINMUTEX_UNLOCK
 	return 0;
 }
@@ -337,6 +474,8 @@ void RTPUDPv6Transmitter::Destroy()
 		MAINMUTEX_UNLOCK;
 		return;
 	}
+	RECEIVEMUTEX_LOCK
+	SENDMUTEX_LOCK
 
 	if (localhostname)
 	{
@@ -352,20 +491,45 @@ void RTPUDPv6Transmitter::Destroy()
 	multicastgroups.Clear();
 #endif // RTP_SUPPORT_IPV6MULTICAST
 	FlushPackets();
+	recvbatch.Destroy();
+	rtpsendbatch.Destroy();
+	rtcpsendbatch.Destroy();
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+	if (senddestinations)
+	{
+		RTPDelete(senddestinations,GetMemoryManager());
+		senddestinations = 0;
+	}
+	RTPUDPDestinationSnapshot *published = publisheddestinations.Exchange(0);
+	if (published)
+		RTPDelete(published,GetMemoryManager());
+	senderrors.clear();
+	if (bufferpool)
+	{
+		bufferpool->Release();
+		bufferpool = 0;
+	}
 	ClearAcceptIgnoreInfo();
+	socketfilteractive = false;
 	localIPs.clear();
 	created = false;
+	SENDMUTEX_UNLOCK
 	
 	if (waitingfordata)
 	{
-		m_pAbortDesc->SendAbortSignal();
+		if (m_pAbortDesc) // otherwise the wait ends when its timeout expires
+			m_pAbortDesc->SendAbortSignal();
 		m_abortDesc.Destroy(); // Doesn't do anything if not initialized
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		WAITMUTEX_LOCK // to make sure that the WaitForIncomingData function ended
 		WAITMUTEX_UNLOCK
 	}
 	else
+	{
 		m_abortDesc.Destroy(); // Doesn't do anything if not initialized
+		RECEIVEMUTEX_UNLOCK
+	}
 
 	MAINMUTEX_UNLOCK
 }
@@ -582,16 +746,16 @@ int RTPUDPv6Transmitter::Poll()
 
 	int status;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	status = PollSocket(true); // poll RTP socket
 	if (status >= 0)
 		status = PollSocket(false); // poll RTCP socket
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -600,21 +764,22 @@ int RTPUDPv6Transmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavai
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 		
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (waitingfordata)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_ALREADYWAITING;
 	}
 	
-	SocketType abortSocket = m_pAbortDesc->GetAbortSocket();
+	SocketType abortSocket = (m_pAbortDesc)?m_pAbortDesc->GetAbortSocket():RTPSOCKERR;
 	SocketType socks[3] = { rtpsock, rtcpsock, abortSocket };
+	size_t numsocks = (m_pAbortDesc)?3:2;
 	int8_t readflags[3] = { 0, 0, 0 };
 	const int idxRTP = 0;
 	const int idxRTCP = 1;
@@ -623,23 +788,23 @@ int RTPUDPv6Transmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavai
 	waitingfordata = true;
 	
 	WAITMUTEX_LOCK
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 
-	int status = RTPSelect(socks, readflags, 3, delay);
+	int status = RTPSelect(socks, readflags, numsocks, delay);
 	if (status < 0)
 	{
-		MAINMUTEX_LOCK
+		RECEIVEMUTEX_LOCK
 		waitingfordata = false;
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		WAITMUTEX_UNLOCK
 		return status;
 	}
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	waitingfordata = false;
 	if (!created) // destroy called
 	{
-		MAINMUTEX_UNLOCK;
+		RECEIVEMUTEX_UNLOCK;
 		WAITMUTEX_UNLOCK
 		return 0;
 	}
@@ -656,7 +821,7 @@ int RTPUDPv6Transmitter::WaitForIncomingData(const RTPTime &delay,bool *dataavai
 			*dataavailable = false;
 	}	
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	WAITMUTEX_UNLOCK
 	return 0;
 }
@@ -666,21 +831,26 @@ int RTPUDPv6Transmitter::AbortWait()
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (!waitingfordata)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTWAITING;
 	}
+	if (!m_pAbortDesc)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_NOABORTDESCRIPTORS;
+	}
 
 	m_pAbortDesc->SendAbortSignal();
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return 0;
 }
 
@@ -689,28 +859,23 @@ int RTPUDPv6Transmitter::SendRTPData(const void *data,size_t len)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 
-	MAINMUTEX_LOCK
+	SENDMUTEX_LOCK
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (len > maxpacksize)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_SPECIFIEDSIZETOOBIG;
 	}
 	
-	destinations.GotoFirstElement();
-	while (destinations.HasCurrentElement())
-	{
-		sendto(rtpsock,(const char *)data,len,0,(const struct sockaddr *)destinations.GetCurrentElement().GetRTPSockAddr(),sizeof(struct sockaddr_in6));
-		destinations.GotoNextElement();
-	}
+	int status = SendToDestinations(true,data,len);
 	
-	MAINMUTEX_UNLOCK
-	return 0;
+	SENDMUTEX_UNLOCK
+	return status;
 }
 
 int RTPUDPv6Transmitter::SendRTCPData(const void *data,size_t len)
@@ -718,31 +883,132 @@ int RTPUDPv6Transmitter::SendRTCPData(const void *data,size_t len)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 
-	MAINMUTEX_LOCK
+	SENDMUTEX_LOCK
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (len > maxpacksize)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_SPECIFIEDSIZETOOBIG;
 	}
 	
-	destinations.GotoFirstElement();
-	while (destinations.HasCurrentElement())
+	int status = SendToDestinations(false,data,len);
+	
+	SENDMUTEX_UNLOCK
+	return status;
+}
+
+int RTPUDPv6Transmitter::SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets)
+{
+	if (!init)
+		return ERR_RTP_UDPV6TRANS_NOTINIT;
+
+	SENDMUTEX_LOCK
+	
+	if (!created)
 	{
-		sendto(rtcpsock,(const char *)data,len,0,(const struct sockaddr *)destinations.GetCurrentElement().GetRTCPSockAddr(),sizeof(struct sockaddr_in6));
-		destinations.GotoNextElement();
+		SENDMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_NOTCREATED;
+	}
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		if (lengths[i] > maxpacksize)
+		{
+			SENDMUTEX_UNLOCK
+			return ERR_RTP_UDPV6TRANS_SPECIFIEDSIZETOOBIG;
+		}
+	}
+
+	size_t pos = 0;
+	while (pos < numpackets)
+	{
+		size_t num = 1;
+		int status;
+
+#ifdef RTP_HAVE_UDP_SEGMENT
+		if (usesegmentation)
+		{
+			// The kernel splits the data into segments of the size of the first
+			// packet, so only the last packet in a group may be shorter
+			size_t segsize = lengths[pos];
+			size_t totalsize = segsize;
+
+			while (pos+num < numpackets && num < RTPUDPV6TRANS_MAXSEGMENTS && lengths[pos+num] > 0 && lengths[pos+num] <= segsize &&
+			       totalsize+lengths[pos+num] <= RTPUDPV6TRANS_MAXSEGMENTEDSIZE)
+			{
+				totalsize += lengths[pos+num];
+				num++;
+				if (lengths[pos+num-1] < segsize)
+					break;
+			}
+		}
+#endif // RTP_HAVE_UDP_SEGMENT
+
+		if (num > 1)
+			status = SendSegmented(packets+pos,lengths+pos,num);
+		else
+			status = SendToDestinations(true,packets[pos],lengths[pos]);
+		if (status < 0)
+		{
+			SENDMUTEX_UNLOCK
+			return status;
+		}
+		pos += num;
 	}
 	
-	MAINMUTEX_UNLOCK
+	SENDMUTEX_UNLOCK
 	return 0;
 }
 
 int RTPUDPv6Transmitter::AddDestination(const RTPAddress &addr)
+{
+	const RTPAddress *addresses[1] = { &addr };
+
+	return AddDestinations(addresses,1);
+}
+
+int RTPUDPv6Transmitter::DeleteDestination(const RTPAddress &addr)
+{
+	const RTPAddress *addresses[1] = { &addr };
+
+	return DeleteDestinations(addresses,1);
+}
+
+void RTPUDPv6Transmitter::ClearDestinations()
+{
+	if (!init)
+		return;
+	
+	MAINMUTEX_LOCK
+	if (created)
+	{
+		destinations.Clear();
+		if (PublishDestinations() < 0)
+		{
+			// Not even an empty snapshot could be allocated, but we must make
+			// sure that nothing is sent to the old destinations anymore
+			SENDMUTEX_LOCK
+			RTPUDPDestinationSnapshot *published = publisheddestinations.Exchange(0);
+			if (published)
+				RTPDelete(published,GetMemoryManager());
+			if (senddestinations)
+			{
+				RTPDelete(senddestinations,GetMemoryManager());
+				senddestinations = 0;
+			}
+			rtpsendbatchvalid = false;
+			rtcpsendbatchvalid = false;
+			SENDMUTEX_UNLOCK
+		}
+	}
+	MAINMUTEX_UNLOCK
+}
+
+int RTPUDPv6Transmitter::AddDestinations(const RTPAddress * const *addresses,size_t numaddresses)
 {
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
@@ -754,55 +1020,136 @@ int RTPUDPv6Transmitter::AddDestination(const RTPAddress &addr)
 		MAINMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
-	if (addr.GetAddressType() != RTPAddress::IPv6Address)
+
+	int status = 0;
+	size_t num = 0;
+
+	while (num < numaddresses)
 	{
-		MAINMUTEX_UNLOCK
-		return ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
+		if (addresses[num]->GetAddressType() != RTPAddress::IPv6Address)
+		{
+			status = ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
+			break;
+		}
+
+		const RTPIPv6Address *address = (const RTPIPv6Address *)addresses[num];
+		RTPIPv6Destination dest(address->GetIP(),address->GetPort());
+		if ((status = destinations.AddElement(dest)) < 0)
+			break;
+		num++;
+	}
+
+	if (status >= 0 && num > 0)
+		status = PublishDestinations();
+
+	// Either all of the addresses are processed, or none of them
+	if (status < 0)
+	{
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			const RTPIPv6Address *address = (const RTPIPv6Address *)addresses[i];
+			RTPIPv6Destination dest(address->GetIP(),address->GetPort());
+			destinations.DeleteElement(dest);
+		}
 	}
-	
-	RTPIPv6Address &address = (RTPIPv6Address &)addr;
-	RTPIPv6Destination dest(address.GetIP(),address.GetPort());
-	int status = destinations.AddElement(dest);
 
 	MAINMUTEX_UNLOCK
 	return status;
 }
 
-int RTPUDPv6Transmitter::DeleteDestination(const RTPAddress &addr)
+int RTPUDPv6Transmitter::DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses)
 {
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
 	MAINMUTEX_LOCK
-	
+
 	if (!created)
 	{
 		MAINMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
-	if (addr.GetAddressType() != RTPAddress::IPv6Address)
+
+	int status = 0;
+	size_t num = 0;
+
+	while (num < numaddresses)
 	{
-		MAINMUTEX_UNLOCK
-		return ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
+		if (addresses[num]->GetAddressType() != RTPAddress::IPv6Address)
+		{
+			status = ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
+			break;
+		}
+
+		const RTPIPv6Address *address = (const RTPIPv6Address *)addresses[num];
+		RTPIPv6Destination dest(address->GetIP(),address->GetPort());
+		if ((status = destinations.DeleteElement(dest)) < 0)
+			break;
+		num++;
 	}
-	
-	RTPIPv6Address &address = (RTPIPv6Address &)addr;	
-	RTPIPv6Destination dest(address.GetIP(),address.GetPort());
-	int status = destinations.DeleteElement(dest);
-	
+
+	if (status >= 0 && num > 0)
+		status = PublishDestinations();
+
+	// Either all of the addresses are processed, or none of them
+	if (status < 0)
+	{
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			const RTPIPv6Address *address = (const RTPIPv6Address *)addresses[i];
+			RTPIPv6Destination dest(address->GetIP(),address->GetPort());
+			destinations.AddElement(dest);
+		}
+	}
+
 	MAINMUTEX_UNLOCK
 	return status;
 }
 
-void RTPUDPv6Transmitter::ClearDestinations()
+int RTPUDPv6Transmitter::PublishDestinations()
 {
-	if (!init)
-		return;
-	
-	MAINMUTEX_LOCK
-	if (created)
-		destinations.Clear();
-	MAINMUTEX_UNLOCK
+	RTPUDPDestinationSnapshot *snapshot = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_DESTINATIONSNAPSHOT) RTPUDPDestinationSnapshot(GetMemoryManager());
+	if (snapshot == 0)
+		return ERR_RTP_OUTOFMEM;
+
+	size_t num = 0;
+	int status;
+
+	destinations.GotoFirstElement();
+	while (destinations.HasCurrentElement())
+	{
+		num++;
+		destinations.GotoNextElement();
+	}
+
+	if ((status = snapshot->Create(num,sizeof(struct sockaddr_in6))) < 0)
+	{
+		RTPDelete(snapshot,GetMemoryManager());
+		return status;
+	}
+
+	num = 0;
+	destinations.GotoFirstElement();
+	while (destinations.HasCurrentElement())
+	{
+		const RTPIPv6Destination &dest = destinations.GetCurrentElement();
+
+		snapshot->SetDestination(num++,(const struct sockaddr *)dest.GetRTPSockAddr(),(const struct sockaddr *)dest.GetRTCPSockAddr());
+		destinations.GotoNextElement();
+	}
+
+	// If the send path didn't pick up the previously published snapshot yet,
+	// it's simply replaced by the new one
+#ifdef RTP_HAVE_STDATOMIC
+	RTPUDPDestinationSnapshot *prev = publisheddestinations.Exchange(snapshot);
+#else
+	SENDMUTEX_LOCK
+	RTPUDPDestinationSnapshot *prev = publisheddestinations.Exchange(snapshot);
+	SENDMUTEX_UNLOCK
+#endif // RTP_HAVE_STDATOMIC
+	if (prev)
+		RTPDelete(prev,GetMemoryManager());
+	return 0;
 }
 
 bool RTPUDPv6Transmitter::SupportsMulticasting()
@@ -966,18 +1313,19 @@ int RTPUDPv6Transmitter::SetReceiveMode(RTPTransmitter::ReceiveMode m)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (m != receivemode)
 	{
 		receivemode = m;
-		acceptignoreinfo.Clear();
+		ClearAcceptIgnoreInfo();
+		UpdateSocketFilter();
 	}
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return 0;
 }
 
@@ -986,30 +1334,32 @@ int RTPUDPv6Transmitter::AddToIgnoreList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv6Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::IgnoreSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv6Address &address = (const RTPIPv6Address &)addr;
 	status = ProcessAddAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1018,30 +1368,32 @@ int RTPUDPv6Transmitter::DeleteFromIgnoreList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv6Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::IgnoreSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv6Address &address = (const RTPIPv6Address &)addr;	
 	status = ProcessDeleteAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1050,10 +1402,13 @@ void RTPUDPv6Transmitter::ClearIgnoreList()
 	if (!init)
 		return;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (created && receivemode == RTPTransmitter::IgnoreSome)
+	{
 		ClearAcceptIgnoreInfo();
-	MAINMUTEX_UNLOCK
+		UpdateSocketFilter();
+	}
+	RECEIVEMUTEX_UNLOCK
 }
 
 int RTPUDPv6Transmitter::AddToAcceptList(const RTPAddress &addr)
@@ -1061,30 +1416,32 @@ int RTPUDPv6Transmitter::AddToAcceptList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv6Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::AcceptSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv6Address &address = (const RTPIPv6Address &)addr;
 	status = ProcessAddAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1093,30 +1450,32 @@ int RTPUDPv6Transmitter::DeleteFromAcceptList(const RTPAddress &addr)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	int status;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (addr.GetAddressType() != RTPAddress::IPv6Address)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_INVALIDADDRESSTYPE;
 	}
 	if (receivemode != RTPTransmitter::AcceptSome)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_DIFFERENTRECEIVEMODE;
 	}
 	
 	const RTPIPv6Address &address = (const RTPIPv6Address &)addr;
 	status = ProcessDeleteAcceptIgnoreEntry(address.GetIP(),address.GetPort());
+	if (status >= 0)
+		UpdateSocketFilter();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return status;
 }
 
@@ -1125,10 +1484,13 @@ void RTPUDPv6Transmitter::ClearAcceptList()
 	if (!init)
 		return;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	if (created && receivemode == RTPTransmitter::AcceptSome)
+	{
 		ClearAcceptIgnoreInfo();
-	MAINMUTEX_UNLOCK
+		UpdateSocketFilter();
+	}
+	RECEIVEMUTEX_UNLOCK
 }
 
 int RTPUDPv6Transmitter::SetMaximumPacketSize(size_t s)	
@@ -1136,19 +1498,19 @@ int RTPUDPv6Transmitter::SetMaximumPacketSize(size_t s)
 	if (!init)
 		return ERR_RTP_UDPV6TRANS_NOTINIT;
 	
-	MAINMUTEX_LOCK
+	SENDMUTEX_LOCK
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_NOTCREATED;
 	}
 	if (s > RTPUDPV6TRANS_MAXPACKSIZE)
 	{
-		MAINMUTEX_UNLOCK
+		SENDMUTEX_UNLOCK
 		return ERR_RTP_UDPV6TRANS_SPECIFIEDSIZETOOBIG;
 	}
 	maxpacksize = s;
-	MAINMUTEX_UNLOCK
+	SENDMUTEX_UNLOCK
 	return 0;
 }
 
@@ -1157,7 +1519,7 @@ bool RTPUDPv6Transmitter::NewDataAvailable()
 	if (!init)
 		return false;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	bool v;
 		
@@ -1171,7 +1533,7 @@ bool RTPUDPv6Transmitter::NewDataAvailable()
 			v = true;
 	}
 	
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return v;
 }
 
@@ -1180,28 +1542,88 @@ RTPRawPacket *RTPUDPv6Transmitter::GetNextPacket()
 	if (!init)
 		return 0;
 	
-	MAINMUTEX_LOCK
+	RECEIVEMUTEX_LOCK
 	
 	RTPRawPacket *p;
 	
 	if (!created)
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return 0;
 	}
 	if (rawpacketlist.empty())
 	{
-		MAINMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		return 0;
 	}
 
 	p = *(rawpacketlist.begin());
 	rawpacketlist.pop_front();
 
-	MAINMUTEX_UNLOCK
+	RECEIVEMUTEX_UNLOCK
 	return p;
 }
 
+int RTPUDPv6Transmitter::GetReceiveBatchStatistics(RTPReceiveBatchStatistics &stats)
+{
+	if (!init)
+		return ERR_RTP_UDPV6TRANS_NOTINIT;
+	
+	RECEIVEMUTEX_LOCK
+	if (!created)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_NOTCREATED;
+	}
+	stats = recvbatch.GetStatistics();
+	RECEIVEMUTEX_UNLOCK
+	return 0;
+}
+
+void RTPUDPv6Transmitter::ClearReceiveBatchStatistics()
+{
+	if (!init)
+		return;
+	
+	RECEIVEMUTEX_LOCK
+	recvbatch.ClearStatistics();
+	RECEIVEMUTEX_UNLOCK
+}
+
+bool RTPUDPv6Transmitter::GetNextSendError(RTPIPv6Address &addr,bool &rtp,int &errorcode)
+{
+	if (!init)
+		return false;
+
+	SENDMUTEX_LOCK
+	if (senderrors.empty())
+	{
+		SENDMUTEX_UNLOCK
+		return false;
+	}
+
+	const SendErrorInfo &info = senderrors.front();
+	addr.SetIP(info.ip);
+	addr.SetPort(info.port);
+	rtp = info.rtp;
+	errorcode = info.errorcode;
+	senderrors.pop_front();
+
+	SENDMUTEX_UNLOCK
+	return true;
+}
+
+uint64_t RTPUDPv6Transmitter::GetNumberOfSendErrors()
+{
+	if (!init)
+		return 0;
+
+	SENDMUTEX_LOCK
+	uint64_t num = numsenderrors;
+	SENDMUTEX_UNLOCK
+	return num;
+}
+
 // Here the private functions start...
 
 
@@ -1245,6 +1667,9 @@ int RTPUDPv6Transmitter::PollSocket(bool rtp)
 #endif // RTP_SOCKETTYPE_WINSOCK
 	struct sockaddr_in6 srcaddr;
 	bool dataavailable;
+
+	if (recvbatch.IsCreated())
+		return PollSocketBatched(rtp);
 	
 	if (rtp)
 		sock = rtpsock;
@@ -1271,44 +1696,38 @@ int RTPUDPv6Transmitter::PollSocket(bool rtp)
 
 	while (dataavailable)
 	{
-		RTPTime curtime = RTPTime::CurrentTime();
-		fromlen = sizeof(struct sockaddr_in6);
-		recvlen = recvfrom(sock,packetbuffer,RTPUDPV6TRANS_MAXPACKSIZE,0,(struct sockaddr *)&srcaddr,&fromlen);
-		if (recvlen > 0)
+		if (bufferpool && len > 0 && (size_t)len+RTPPacket::GetEmbeddedSize() <= bufferpool->GetBufferSize())
 		{
-			bool acceptdata;
-
-			// got data, process it
-			if (receivemode == RTPTransmitter::AcceptAll)
-				acceptdata = true;
-			else
-				acceptdata = ShouldAcceptData(srcaddr.sin6_addr,ntohs(srcaddr.sin6_port));
+			// The size of the packet is known and it fits in a buffer of the
+			// pool, so there's no need to read it into a temporary buffer first.
+			// Note that on some platforms the reported length is the total amount
+			// of queued data, which can only be larger than the first packet.
+			uint8_t *buf = AllocateReceiveBuffer(rtp,(size_t)len);
+			if (buf == 0)
+				return ERR_RTP_OUTOFMEM;
 			
-			if (acceptdata)
+			RTPTime curtime = RTPTime::CurrentTime();
+			fromlen = sizeof(struct sockaddr_in6);
+			recvlen = recvfrom(sock,(char *)buf,(int)len,0,(struct sockaddr *)&srcaddr,&fromlen);
+			if (recvlen > 0 && (receivemode == RTPTransmitter::AcceptAll || ShouldAcceptData(srcaddr.sin6_addr,ntohs(srcaddr.sin6_port))))
 			{
-				RTPRawPacket *pack;
-				RTPIPv6Address *addr;
-				uint8_t *datacopy;
-
-				addr = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPADDRESS) RTPIPv6Address(srcaddr.sin6_addr,ntohs(srcaddr.sin6_port));
-				if (addr == 0)
-					return ERR_RTP_OUTOFMEM;
-				datacopy = RTPNew(GetMemoryManager(),(rtp)?RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET:RTPMEM_TYPE_BUFFER_RECEIVEDRTCPPACKET) uint8_t[recvlen];
-				if (datacopy == 0)
-				{
-					RTPDelete(addr,GetMemoryManager());
-					return ERR_RTP_OUTOFMEM;
-				}
-				memcpy(datacopy,packetbuffer,recvlen);
-				
-				pack = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPRAWPACKET) RTPRawPacket(datacopy,recvlen,addr,curtime,rtp,GetMemoryManager());
-				if (pack == 0)
-				{
-					RTPDelete(addr,GetMemoryManager());
-					RTPDeleteByteArray(datacopy,GetMemoryManager());
-					return ERR_RTP_OUTOFMEM;
-				}
-				rawpacketlist.push_back(pack);	
+				int status = StoreReceivedData(rtp,buf,(size_t)recvlen,srcaddr.sin6_addr,ntohs(srcaddr.sin6_port),curtime);
+				if (status < 0)
+					return status;
+			}
+			else
+				ReleaseReceiveBuffer(buf);
+		}
+		else
+		{
+			RTPTime curtime = RTPTime::CurrentTime();
+			fromlen = sizeof(struct sockaddr_in6);
+			recvlen = recvfrom(sock,packetbuffer,RTPUDPV6TRANS_MAXPACKSIZE,0,(struct sockaddr *)&srcaddr,&fromlen);
+			if (recvlen > 0)
+			{
+				int status = ProcessReceivedData(rtp,(const uint8_t *)packetbuffer,(size_t)recvlen,srcaddr.sin6_addr,ntohs(srcaddr.sin6_port),curtime);
+				if (status < 0)
+					return status;
 			}
 		}
 		len = 0;
@@ -1332,6 +1751,371 @@ int RTPUDPv6Transmitter::PollSocket(bool rtp)
 	return 0;
 }
 
+int RTPUDPv6Transmitter::PollSocketBatched(bool rtp)
+{
+	SocketType sock = (rtp)?rtpsock:rtcpsock;
+	size_t num;
+	
+	// The socket is read without blocking, so we can just keep reading until
+	// a batch isn't filled completely
+	do
+	{
+		num = (size_t)recvbatch.Receive(sock);
+		if (num == 0)
+			break;
+
+		// Only when the kernel didn't provide a timestamp for a datagram, the
+		// current time is used as its receive time
+		RTPTime curtime(0);
+		bool havecurtime = false;
+
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			size_t datalen = recvbatch.GetDatagramLength(i);
+			const struct sockaddr *addr = recvbatch.GetSourceAddress(i);
+
+			// make sure a packet of length zero is not queued, and that truncated
+			// packets are dropped just like they would be in the normal case
+			if (datalen == 0 || recvbatch.IsDatagramTruncated(i) || addr->sa_family != AF_INET6)
+				continue;
+
+			const struct sockaddr_in6 *srcaddr = (const struct sockaddr_in6 *)addr;
+			const uint8_t *data = recvbatch.GetDatagramData(i);
+			size_t segsize = recvbatch.GetDatagramSegmentSize(i);
+
+			// If the kernel coalesced several datagrams, split them up again
+			if (segsize == 0 || segsize > datalen)
+				segsize = datalen;
+
+			RTPTime recvtime(0);
+			bool kerneltime = recvbatch.GetDatagramReceiveTime(i,recvtime);
+
+			if (!kerneltime)
+			{
+				if (!havecurtime)
+				{
+					curtime = RTPTime::CurrentTime();
+					havecurtime = true;
+				}
+				recvtime = curtime;
+			}
+
+			for (size_t offset = 0 ; offset < datalen ; offset += segsize)
+			{
+				size_t seglen = (datalen-offset < segsize)?(datalen-offset):segsize;
+				int status = ProcessReceivedData(rtp,data+offset,seglen,srcaddr->sin6_addr,ntohs(srcaddr->sin6_port),recvtime,kerneltime);
+				if (status < 0)
+					return status;
+			}
+		}
+	} while (num == recvbatch.GetBatchSize());
+
+	return 0;
+}
+
+int RTPUDPv6Transmitter::ProcessReceivedData(bool rtp,const uint8_t *data,size_t datalen,in6_addr srcip,uint16_t srcport,RTPTime &receivetime,bool kerneltime)
+{
+	bool acceptdata;
+
+	// got data, process it
+	if (receivemode == RTPTransmitter::AcceptAll)
+		acceptdata = true;
+	else
+		acceptdata = ShouldAcceptData(srcip,srcport);
+	
+	if (!acceptdata)
+		return 0;
+
+	uint8_t *datacopy;
+
+	datacopy = AllocateReceiveBuffer(rtp,datalen);
+	if (datacopy == 0)
+		return ERR_RTP_OUTOFMEM;
+	memcpy(datacopy,data,datalen);
+	
+	return StoreReceivedData(rtp,datacopy,datalen,srcip,srcport,receivetime,kerneltime);
+}
+
+int RTPUDPv6Transmitter::StoreReceivedData(bool rtp,uint8_t *data,size_t datalen,in6_addr srcip,uint16_t srcport,RTPTime &receivetime,bool kerneltime)
+{
+	// The data buffer was obtained using AllocateReceiveBuffer and is owned
+	// by the raw packet if this succeeds, so this doesn't allocate anything
+	// besides the raw packet itself
+	RTPRawPacket *pack;
+	RTPIPv6Address addr(srcip,srcport);
+	
+	// The address is stored inside the raw packet instance
+	pack = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_RTPRAWPACKET) RTPRawPacket(data,datalen,addr,receivetime,rtp,GetMemoryManager());
+	if (pack == 0)
+	{
+		ReleaseReceiveBuffer(data);
+		return ERR_RTP_OUTOFMEM;
+	}
+	pack->SetBufferPool(bufferpool);
+	pack->SetDataHeadroom(RTPPacket::GetEmbeddedSize());
+	pack->SetKernelReceiveTime(kerneltime);
+	rawpacketlist.push_back(pack);	
+	return 0;
+}
+
+uint8_t *RTPUDPv6Transmitter::AllocateReceiveBuffer(bool rtp,size_t len)
+{
+	// Room is reserved in front of the data, so that the RTPPacket instance
+	// can be stored in the same memory block
+	size_t headroom = RTPPacket::GetEmbeddedSize();
+	uint8_t *block;
+
+	if (bufferpool)
+		block = bufferpool->GetBuffer(headroom+len,rtp);
+	else
+		block = RTPNew(GetMemoryManager(),(rtp)?RTPMEM_TYPE_BUFFER_RECEIVEDRTPPACKET:RTPMEM_TYPE_BUFFER_RECEIVEDRTCPPACKET) uint8_t[headroom+len];
+	if (block == 0)
+		return 0;
+	return block+headroom;
+}
+
+void RTPUDPv6Transmitter::ReleaseReceiveBuffer(uint8_t *data)
+{
+	uint8_t *block = data-RTPPacket::GetEmbeddedSize();
+
+	if (bufferpool)
+		bufferpool->ReleaseBuffer(block);
+	else
+		RTPDeleteByteArray(block,GetMemoryManager());
+}
+
+int RTPUDPv6Transmitter::SetReceiveBufferPool(RTPReceiveBufferPool *pool)
+{
+	if (!init)
+		return ERR_RTP_UDPV6TRANS_NOTINIT;
+	
+	RECEIVEMUTEX_LOCK
+	if (!created)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_NOTCREATED;
+	}
+	if (pool)
+		pool->AddReference();
+	if (bufferpool)
+		bufferpool->Release();
+	bufferpool = pool;
+	RECEIVEMUTEX_UNLOCK
+	return 0;
+}
+
+int RTPUDPv6Transmitter::GetReceiveSockets(SocketType *sockets,size_t *numsockets)
+{
+	if (!init)
+		return ERR_RTP_UDPV6TRANS_NOTINIT;
+
+	MAINMUTEX_LOCK
+	if (!created)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_NOTCREATED;
+	}
+
+	size_t num = (rtcpsock == rtpsock)?1:2;
+
+	if (*numsockets < num)
+	{
+		MAINMUTEX_UNLOCK
+		return ERR_RTP_TRANSMITTER_SOCKETARRAYTOOSMALL;
+	}
+	sockets[0] = rtpsock;
+	if (num > 1)
+		sockets[1] = rtcpsock;
+	*numsockets = num;
+	MAINMUTEX_UNLOCK
+	return 0;
+}
+
+bool RTPUDPv6Transmitter::IsUsingSocketFilter()
+{
+	if (!init)
+		return false;
+
+	RECEIVEMUTEX_LOCK
+	bool active = (created && socketfilteractive);
+	RECEIVEMUTEX_UNLOCK
+	return active;
+}
+
+int RTPUDPv6Transmitter::GetNumberOfKernelDrops(uint64_t &num)
+{
+	if (!init)
+		return ERR_RTP_UDPV6TRANS_NOTINIT;
+
+	RECEIVEMUTEX_LOCK
+	if (!created)
+	{
+		RECEIVEMUTEX_UNLOCK
+		return ERR_RTP_UDPV6TRANS_NOTCREATED;
+	}
+
+	uint32_t numrtp = 0, numrtcp = 0;
+	int status;
+
+	if ((status = RTPUDPSocketFilter::GetNumberOfDroppedPackets(rtpsock,numrtp)) < 0 ||
+	    (rtcpsock != rtpsock && (status = RTPUDPSocketFilter::GetNumberOfDroppedPackets(rtcpsock,numrtcp)) < 0))
+	{
+		RECEIVEMUTEX_UNLOCK
+		return status;
+	}
+	RECEIVEMUTEX_UNLOCK
+
+	num = (uint64_t)numrtp + (uint64_t)numrtcp;
+	return 0;
+}
+
+void RTPUDPv6Transmitter::UpdateSendDestinations()
+{
+	RTPUDPDestinationSnapshot *snapshot = publisheddestinations.Exchange(0);
+	if (snapshot == 0)
+		return;
+
+	if (senddestinations)
+		RTPDelete(senddestinations,GetMemoryManager());
+	senddestinations = snapshot;
+	rtpsendbatchvalid = false;
+	rtcpsendbatchvalid = false;
+}
+
+int RTPUDPv6Transmitter::SendToDestinations(bool rtp,const void *data,size_t len)
+{
+	SocketType sock = (rtp)?rtpsock:rtcpsock;
+
+	UpdateSendDestinations();
+	if (senddestinations == 0)
+		return 0;
+
+	const RTPUDPDestinationSnapshot &dests = *senddestinations;
+
+#ifdef RTP_HAVE_SENDMMSG
+	// The message headers for all destinations are kept until the destination
+	// list changes, so that a packet can be sent to all of them using a single
+	// system call
+	RTPUDPSendBatch &batch = (rtp)?rtpsendbatch:rtcpsendbatch;
+	bool &batchvalid = (rtp)?rtpsendbatchvalid:rtcpsendbatchvalid;
+
+	if (!batchvalid)
+	{
+		size_t num = dests.GetNumberOfDestinations();
+		int status;
+
+		if ((status = batch.Create(num)) < 0)
+			return status;
+
+		for (size_t i = 0 ; i < num ; i++)
+			batch.SetDestination(i,(rtp)?dests.GetRTPAddress(i):dests.GetRTCPAddress(i),sizeof(struct sockaddr_in6));
+		batchvalid = true;
+	}
+
+	size_t numfailures = batch.Send(sock,data,len);
+	for (size_t i = 0 ; i < numfailures ; i++)
+		RecordSendError((const struct sockaddr_in6 *)batch.GetFailedDestination(i),rtp,batch.GetFailureErrorCode(i));
+#else
+	for (size_t i = 0 ; i < dests.GetNumberOfDestinations() ; i++)
+	{
+		const struct sockaddr_in6 *addr = (const struct sockaddr_in6 *)((rtp)?dests.GetRTPAddress(i):dests.GetRTCPAddress(i));
+
+		if (sendto(sock,(const char *)data,len,0,(const struct sockaddr *)addr,sizeof(struct sockaddr_in6)) < 0)
+			RecordSendError(addr,rtp,RTPSOCKERRNO);
+	}
+#endif // RTP_HAVE_SENDMMSG
+	return 0;
+}
+
+int RTPUDPv6Transmitter::SendSegmented(const void * const *packets,const size_t *lengths,size_t numpackets)
+{
+#ifdef RTP_HAVE_UDP_SEGMENT
+	struct iovec iov[RTPUDPV6TRANS_MAXSEGMENTS];
+	char control[CMSG_SPACE(sizeof(uint16_t))];
+	struct msghdr msg;
+	uint16_t segsize = (uint16_t)lengths[0];
+
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		iov[i].iov_base = (void *)packets[i];
+		iov[i].iov_len = lengths[i];
+	}
+
+	memset(&msg,0,sizeof(struct msghdr));
+	memset(control,0,sizeof(control));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = numpackets;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+	cm->cmsg_level = SOL_UDP;
+	cm->cmsg_type = UDP_SEGMENT;
+	cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+	memcpy(CMSG_DATA(cm),&segsize,sizeof(uint16_t));
+
+	UpdateSendDestinations();
+	if (senddestinations == 0)
+		return 0;
+
+	for (size_t d = 0 ; d < senddestinations->GetNumberOfDestinations() ; d++)
+	{
+		const struct sockaddr_in6 *addr = (const struct sockaddr_in6 *)senddestinations->GetRTPAddress(d);
+		bool sendseparately = true;
+
+		if (usesegmentation)
+		{
+			msg.msg_name = (void *)addr;
+			msg.msg_namelen = sizeof(struct sockaddr_in6);
+
+			if (sendmsg(rtpsock,&msg,0) >= 0)
+				sendseparately = false;
+			else
+			{
+				int errcode = RTPSOCKERRNO;
+
+				// These indicate that either the kernel or the outgoing interface
+				// can't handle segmentation offload; in that case we'll just stop
+				// using it and send the packets one by one
+				if (errcode == EIO || errcode == EINVAL || errcode == ENOPROTOOPT || errcode == EOPNOTSUPP)
+					usesegmentation = false;
+				else
+				{
+					RecordSendError(addr,true,errcode);
+					sendseparately = false;
+				}
+			}
+		}
+
+		if (sendseparately)
+		{
+			for (size_t i = 0 ; i < numpackets ; i++)
+			{
+				if (sendto(rtpsock,(const char *)packets[i],lengths[i],0,(const struct sockaddr *)addr,sizeof(struct sockaddr_in6)) < 0)
+					RecordSendError(addr,true,RTPSOCKERRNO);
+			}
+		}
+	}
+	return 0;
+#else
+	for (size_t i = 0 ; i < numpackets ; i++)
+	{
+		int status = SendToDestinations(true,packets[i],lengths[i]);
+		if (status < 0)
+			return status;
+	}
+	return 0;
+#endif // RTP_HAVE_UDP_SEGMENT
+}
+
+void RTPUDPv6Transmitter::RecordSendError(const struct sockaddr_in6 *addr,bool rtp,int errorcode)
+{
+	numsenderrors++;
+	if (senderrors.size() >= RTPUDPV6TRANS_MAXSENDERRORS)
+		return;
+	senderrors.push_back(SendErrorInfo(addr->sin6_addr,ntohs(addr->sin6_port),rtp,errorcode));
+}
+
 int RTPUDPv6Transmitter::ProcessAddAcceptIgnoreEntry(in6_addr ip,uint16_t port)
 {
 	acceptignoreinfo.GotoElement(ip);
@@ -1342,32 +2126,26 @@ int RTPUDPv6Transmitter::ProcessAddAcceptIgnoreEntry(in6_addr ip,uint16_t port)
 		if (port == 0) // select all ports
 		{
 			portinf->all = true;
-			portinf->portlist.clear();
+			portinf->ports.Clear();
 		}
 		else if (!portinf->all)
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = portinf->portlist.begin();
-			end = portinf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == port) // already in list
-					return 0;
-			}
-			portinf->portlist.push_front(port);
-		}
+			return portinf->ports.Add(port); // nothing happens if it's already in the set
 	}
 	else // got to create an entry for this IP address
 	{
 		PortInfo *portinf;
 		int status;
 		
-		portinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREPORTINFO) PortInfo();
+		portinf = RTPNew(GetMemoryManager(),RTPMEM_TYPE_CLASS_ACCEPTIGNOREPORTINFO) PortInfo(GetMemoryManager());
+		if (portinf == 0)
+			return ERR_RTP_OUTOFMEM;
 		if (port == 0) // select all ports
 			portinf->all = true;
-		else
-			portinf->portlist.push_front(port);
+		else if ((status = portinf->ports.Add(port)) < 0)
+		{
+			RTPDelete(portinf,GetMemoryManager());
+			return status;
+		}
 		
 		status = acceptignoreinfo.AddElement(ip,portinf);
 		if (status < 0)
@@ -1376,6 +2154,7 @@ int RTPUDPv6Transmitter::ProcessAddAcceptIgnoreEntry(in6_addr ip,uint16_t port)
 			return status;
 		}
 	}
+
 	return 0;
 }
 
@@ -1405,120 +2184,90 @@ int RTPUDPv6Transmitter::ProcessDeleteAcceptIgnoreEntry(in6_addr ip,uint16_t por
 	if (port == 0) // delete all entries
 	{
 		inf->all = false;
-		inf->portlist.clear();
+		inf->ports.Clear();
 	}
 	else // a specific port was selected
 	{
-		if (inf->all) // currently, all ports are selected. Add the one to remove to the list
+		if (inf->all) // currently, all ports are selected. Add the one to remove to the set
 		{
-			// we have to check if the list doesn't contain the port already
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == port) // already in list: this means we already deleted the entry
-					return ERR_RTP_UDPV6TRANS_NOSUCHENTRY;
-			}
-			inf->portlist.push_front(port);
-		}
-		else // check if we can find the port in the list
-		{
-			std::list<uint16_t>::iterator it,begin,end;
-			
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; ++it)
-			{
-				if (*it == port) // found it!
-				{
-					inf->portlist.erase(it);
-					return 0;
-				}
-			}
-			// didn't find it
-			return ERR_RTP_UDPV6TRANS_NOSUCHENTRY;			
+			if (inf->ports.Contains(port)) // this means we already deleted the entry
+				return ERR_RTP_UDPV6TRANS_NOSUCHENTRY;
+			return inf->ports.Add(port);
 		}
+		else if (!inf->ports.Remove(port)) // didn't find it
+			return ERR_RTP_UDPV6TRANS_NOSUCHENTRY;
 	}
 	return 0;
 }
 
 bool RTPUDPv6Transmitter::ShouldAcceptData(in6_addr srcip,uint16_t srcport)
 {
+	PortInfo *inf;
+
+	acceptignoreinfo.GotoElement(srcip);
 	if (receivemode == RTPTransmitter::AcceptSome)
 	{
-		PortInfo *inf;
-
-		acceptignoreinfo.GotoElement(srcip);
 		if (!acceptignoreinfo.HasCurrentElement())
 			return false;
 		
+		// If 'all' is set, accept all ports except the ones in the set,
+		// otherwise only accept the ones in the set
 		inf = acceptignoreinfo.GetCurrentElement();
-		if (!inf->all) // only accept the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return true;
-			}
-			return false;
-		}
-		else // accept all, except the ones in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
-
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return false;
-			}
-			return true;
-		}
+		return (inf->ports.Contains(srcport) != inf->all);
 	}
 	else // IgnoreSome
 	{
-		PortInfo *inf;
-
-		acceptignoreinfo.GotoElement(srcip);
 		if (!acceptignoreinfo.HasCurrentElement())
 			return true;
 		
+		// If 'all' is set, ignore all ports except the ones in the set,
+		// otherwise only ignore the ones in the set
 		inf = acceptignoreinfo.GetCurrentElement();
-		if (!inf->all) // ignore the ports in the list
-		{
-			std::list<uint16_t>::const_iterator it,begin,end;
+		return (inf->ports.Contains(srcport) == inf->all);
+	}
+}
 
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return false;
-			}
-			return true;
-		}
-		else // ignore all, except the ones in the list
+void RTPUDPv6Transmitter::UpdateSocketFilter()
+{
+	if (!usesocketfilter)
+		return;
+
+	if (receivemode != RTPTransmitter::AcceptAll)
+	{
+		// IPv4 packets that arrive on the socket are left for ShouldAcceptData
+		socketfilter.Start(receivemode,4,true);
+
+		acceptignoreinfo.GotoFirstElement();
+		while (acceptignoreinfo.HasCurrentElement())
 		{
-			std::list<uint16_t>::const_iterator it,begin,end;
+			in6_addr ip = acceptignoreinfo.GetCurrentKey();
+			PortInfo *inf = acceptignoreinfo.GetCurrentElement();
+			uint32_t words[4];
+
+			for (int i = 0 ; i < 4 ; i++)
+				words[i] = ((uint32_t)ip.s6_addr[i*4] << 24)|((uint32_t)ip.s6_addr[i*4+1] << 16)|((uint32_t)ip.s6_addr[i*4+2] << 8)|((uint32_t)ip.s6_addr[i*4+3]);
+			socketfilter.AddEntry(words,inf->all,inf->ports);
+			acceptignoreinfo.GotoNextElement();
+		}
 
-			begin = inf->portlist.begin();
-			end = inf->portlist.end();
-			for (it = begin ; it != end ; it++)
-			{
-				if (*it == srcport)
-					return true;
-			}
-			return false;
+		if (socketfilter.Attach(rtpsock) >= 0)
+		{
+			socketfilteractive = true;
+			if (rtcpsock == rtpsock || socketfilter.Attach(rtcpsock) >= 0)
+				return;
+			// The RTP socket is filtered now, so it's detached again below
 		}
 	}
-	return true;
+
+	// Either all packets need to be accepted, or the filter couldn't be attached,
+	// in which case the packets are only checked after reading them
+	if (socketfilteractive)
+	{
+		RTPUDPSocketFilter::Detach(rtpsock);
+		if (rtcpsock != rtpsock)
+			RTPUDPSocketFilter::Detach(rtcpsock);
+		socketfilteractive = false;
+	}
 }
 
 int RTPUDPv6Transmitter::CreateLocalIPList()
@@ -1659,6 +2408,8 @@ void RTPUDPv6Transmitter::Dump()
 	else
 	{
 		MAINMUTEX_LOCK
+		RECEIVEMUTEX_LOCK
+		SENDMUTEX_LOCK
 	
 		if (!created)
 			std::cout << "Not created" << std::endl;
@@ -1713,17 +2464,15 @@ void RTPUDPv6Transmitter::Dump()
 					if (pinfo->all)
 					{
 						std::cout << "All ports";
-						if (!pinfo->portlist.empty())
+						if (!pinfo->ports.IsEmpty())
 							std::cout << ", except ";
 					}
 					
-					std::list<uint16_t>::const_iterator it;
-					
-					for (it = pinfo->portlist.begin() ; it != pinfo->portlist.end() ; )
+					for (int port = pinfo->ports.GetNextPort(-1) ; port >= 0 ; )
 					{
-						std::cout << (*it);
-						it++;
-						if (it != pinfo->portlist.end())
+						std::cout << port;
+						port = pinfo->ports.GetNextPort(port);
+						if (port >= 0)
 							std::cout << ", ";
 					}
 					std::cout << std::endl;
@@ -1775,6 +2524,8 @@ void RTPUDPv6Transmitter::Dump()
 			std::cout << "Maximum allowed packet size:    " << maxpacksize << std::endl;
 		}
 		
+		SENDMUTEX_UNLOCK
+		RECEIVEMUTEX_UNLOCK
 		MAINMUTEX_UNLOCK
 	}
 
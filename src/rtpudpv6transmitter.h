@@ -44,10 +44,20 @@
 
 #include "rtptransmitter.h"
 #include "rtpipv6destination.h"
+#include "rtphashutilities.h"
+#include "rtpipv6address.h"
 #include "rtphashtable.h"
 #include "rtpkeyhashtable.h"
+#include "rtpopenhashtable.h"
+#include "rtpopenkeyhashtable.h"
+#include "rtpportset.h"
 #include "rtpsocketutil.h"
 #include "rtpabortdescriptors.h"
+#include "rtpudpreceivebatch.h"
+#include "rtpudpsocketfilter.h"
+#include "rtpudpsendbatch.h"
+#include "rtpudpdestinationsnapshot.h"
+#include "rtpreceivebufferpool.h"
 #include <string.h>
 #include <list>
 
@@ -62,6 +72,11 @@
 #define RTPUDPV6TRANS_RTCPRECEIVEBUFFER							32768
 #define RTPUDPV6TRANS_RTPTRANSMITBUFFER							32768
 #define RTPUDPV6TRANS_RTCPTRANSMITBUFFER						32768
+#define RTPUDPV6TRANS_DEFAULTRECEIVEBATCHSIZE						1
+#define RTPUDPV6TRANS_MAXRECEIVEBATCHSIZE						1024
+#define RTPUDPV6TRANS_MAXSENDERRORS							256
+#define RTPUDPV6TRANS_MAXSEGMENTS							64
+#define RTPUDPV6TRANS_MAXSEGMENTEDSIZE						65527
 
 namespace jrtplib
 {
@@ -120,11 +135,61 @@ public:
 	/** Sets the RTCP socket's receive buffer size. */
 	void SetRTCPReceiveBuffer(int s)							{ rtcprecvbuf = s; }
 
+	/** Sets the maximum number of datagrams that are read from a socket using a
+	 *  single system call (\c recvmmsg); with the default value of one (or with zero),
+	 *  each datagram is read separately. */
+	void SetReceiveBatchSize(size_t n)							{ recvbatchsize = n; }
+
+	/** If set to \c true (the default), bursts of RTP packets sent using RTPUDPv6Transmitter::SendRTPDataBurst
+	 *  are handed to the kernel as one large buffer which is split into separate datagrams by the
+	 *  kernel or network card (UDP segmentation offload), when the platform supports this. */
+	void SetUseSegmentationOffload(bool f)							{ usesegmentation = f; }
+
+	/** If set to \c true, the kernel is allowed to coalesce datagrams that arrive on the RTP socket
+	 *  (UDP generic receive offload); these are split into the original packets again by the
+	 *  transmitter. When the platform doesn't support this, the datagrams are received normally.
+	 *  By default this is \c false. */
+	void SetUseReceiveOffload(bool f)							{ usereceiveoffload = f; }
+
+	/** If set to \c true, the time at which the kernel received a datagram (\c SO_TIMESTAMPNS)
+	 *  is used as the receive time of a packet, instead of the time at which the transmitter
+	 *  read it from the socket. When several packets are read at once, this keeps them from
+	 *  all getting the same receive time, which would distort the jitter calculations. When
+	 *  the platform doesn't support this, the time of reading is used. By default this is \c false. */
+	void SetUseKernelTimestamps(bool f)							{ usekerneltimestamps = f; }
+
+	/** If set to \c true, the accept or ignore list is converted into a socket filter each time
+	 *  it changes, so that the kernel can drop unwanted packets before they are copied to
+	 *  userspace. Packets are still checked against the lists after reading them. By default
+	 *  this is \c true; it has no effect on platforms without support for socket filters. */
+	void SetUseSocketFilter(bool f)								{ usesocketfilter = f; }
+
+	/** If \c n is larger than zero, the sockets are created with the \c SO_REUSEPORT option, so that
+	 *  \c n transmitters can be bound to the same ports and the kernel distributes the incoming packets
+	 *  over them. This can be used to spread the processing of the packets arriving on a single busy
+	 *  port over several cores, by creating a separate RTPSession (with its own poll thread and source
+	 *  table) for each of these transmitters. Note that any socket of the same user can join such a
+	 *  group of sockets. By default this is zero. */
+	void SetReusePortShards(uint32_t n)							{ reuseportshards = n; }
+
+	/** If set to \c true when sharing ports using RTPUDPv6TransmissionParams::SetReusePortShards, packets
+	 *  are not distributed over the transmitters based on the address they came from, but based on their
+	 *  SSRC. This way, each transmitter (and the session that uses it) receives all RTP and RTCP packets of
+	 *  a specific source, in order. Only supported on Linux; by default this is \c false. */
+	void SetUseSSRCSteering(bool f)								{ usessrcsteering = f; }
+
 	/** If non null, the specified abort descriptors will be used to cancel
 	 *  the function that's waiting for packets to arrive; set to null (the default
 	 *  to let the transmitter create its own instance. */
 	void SetCreatedAbortDescriptors(RTPAbortDescriptors *desc) { m_pAbortDesc = desc; }
 
+	/** If set to \c false, the transmitter doesn't use abort descriptors at all, which saves the
+	 *  two descriptors of the pipe that's otherwise created for each transmitter. This is meant for
+	 *  sessions that are driven by an external event loop (see RTPSession::Step): 
+	 *  RTPTransmitter::AbortWait will return an error, so it can't be used together with a poll
+	 *  thread. By default this is \c true. */
+	void SetUseAbortDescriptors(bool f)							{ useabortdescriptors = f; }
+
 	/** Returns the RTP socket's send buffer size. */
 	int GetRTPSendBuffer() const								{ return rtpsendbuf; }
 
@@ -137,10 +202,34 @@ public:
 	/** Returns the RTCP socket's receive buffer size. */
 	int GetRTCPReceiveBuffer() const							{ return rtcprecvbuf; }
 
+	/** Returns the maximum number of datagrams that are read using a single system call (default is 1). */
+	size_t GetReceiveBatchSize() const							{ return recvbatchsize; }
+
+	/** Returns \c true if UDP segmentation offload will be used when possible (default is \c true). */
+	bool GetUseSegmentationOffload() const							{ return usesegmentation; }
+
+	/** Returns \c true if UDP generic receive offload will be enabled when possible (default is \c false). */
+	bool GetUseReceiveOffload() const							{ return usereceiveoffload; }
+
+	/** Returns \c true if the kernel's receive timestamps will be used when possible (default is \c false). */
+	bool GetUseKernelTimestamps() const							{ return usekerneltimestamps; }
+
+	/** Returns \c true if the accept or ignore list will be passed to the kernel as a socket filter (default is \c true). */
+	bool GetUseSocketFilter() const								{ return usesocketfilter; }
+
+	/** Returns the number of transmitters that will share the same ports, or zero if the ports are not shared (the default). */
+	uint32_t GetReusePortShards() const							{ return reuseportshards; }
+
+	/** Returns \c true if packets will be distributed over transmitters that share the same ports based on their SSRC (default is \c false). */
+	bool GetUseSSRCSteering() const								{ return usessrcsteering; }
+
 	/** If non-null, this RTPAbortDescriptors instance will be used internally,
 	 *  which can be useful when creating your own poll thread for multiple
 	 *  sessions. */
 	RTPAbortDescriptors *GetCreatedAbortDescriptors() const		{ return m_pAbortDesc; }
+
+	/** Returns \c false if the transmitter won't use abort descriptors (default is \c true). */
+	bool GetUseAbortDescriptors() const							{ return useabortdescriptors; }
 private:
 	uint16_t portbase;
 	in6_addr bindIP;
@@ -150,7 +239,16 @@ private:
 	int rtpsendbuf, rtprecvbuf;
 	int rtcpsendbuf, rtcprecvbuf;
 
+	size_t recvbatchsize;
+	bool usesegmentation;
+	bool usereceiveoffload;
+	bool usekerneltimestamps;
+	bool usesocketfilter;
+	uint32_t reuseportshards;
+	bool usessrcsteering;
+
 	RTPAbortDescriptors *m_pAbortDesc;
+	bool useabortdescriptors;
 };
 
 inline RTPUDPv6TransmissionParams::RTPUDPv6TransmissionParams()
@@ -167,7 +265,15 @@ inline RTPUDPv6TransmissionParams::RTPUDPv6TransmissionParams()
 	rtcpsendbuf = RTPUDPV6TRANS_RTCPTRANSMITBUFFER; 
 	rtcprecvbuf = RTPUDPV6TRANS_RTCPRECEIVEBUFFER; 
 
+	recvbatchsize = RTPUDPV6TRANS_DEFAULTRECEIVEBATCHSIZE;
+	usesegmentation = true;
+	usereceiveoffload = false;
+	usekerneltimestamps = false;
+	usesocketfilter = true;
+	reuseportshards = 0;
+	usessrcsteering = false;
 	m_pAbortDesc = 0;
+	useabortdescriptors = true;
 }
 
 /** Additional information about the UDP over IPv6 transmitter. */
@@ -203,13 +309,15 @@ private:
 class JRTPLIB_IMPORTEXPORT RTPUDPv6Trans_GetHashIndex_IPv6Dest
 {
 public:
-	static int GetIndex(const RTPIPv6Destination &d)					{ in6_addr ip = d.GetIP(); return ((((uint32_t)ip.s6_addr[12])<<24)|(((uint32_t)ip.s6_addr[13])<<16)|(((uint32_t)ip.s6_addr[14])<<8)|((uint32_t)ip.s6_addr[15]))%RTPUDPV6TRANS_HASHSIZE; }
+	static uint32_t GetHash(const RTPIPv6Destination &d)					{ return RTPHashCombine(RTPHashIPv6Address(d.GetRTPSockAddr()->sin6_addr.s6_addr),ntohs(d.GetRTPSockAddr()->sin6_port)); }
+	static int GetIndex(const RTPIPv6Destination &d)					{ return (int)(GetHash(d)%RTPUDPV6TRANS_HASHSIZE); }
 };
 
 class JRTPLIB_IMPORTEXPORT RTPUDPv6Trans_GetHashIndex_in6_addr
 {
 public:
-	static int GetIndex(const in6_addr &ip)							{ return ((((uint32_t)ip.s6_addr[12])<<24)|(((uint32_t)ip.s6_addr[13])<<16)|(((uint32_t)ip.s6_addr[14])<<8)|((uint32_t)ip.s6_addr[15]))%RTPUDPV6TRANS_HASHSIZE; }
+	static uint32_t GetHash(const in6_addr &ip)						{ return RTPHashIPv6Address(ip.s6_addr); }
+	static int GetIndex(const in6_addr &ip)							{ return (int)(GetHash(ip)%RTPUDPV6TRANS_HASHSIZE); }
 };
 
 #define RTPUDPV6TRANS_HEADERSIZE								(40+8)
@@ -249,6 +357,15 @@ public:
 	int DeleteDestination(const RTPAddress &addr);
 	void ClearDestinations();
 
+	/** Adds several destinations at once: the destination list that's used for sending
+	 *  is only updated once, after all of them have been added. If one of the addresses
+	 *  can't be added, none of them are. */
+	int AddDestinations(const RTPAddress * const *addresses,size_t numaddresses);
+
+	/** Deletes several destinations at once; like RTPUDPv6Transmitter::AddDestinations, the
+	 *  destination list that's used for sending is only updated once. */
+	int DeleteDestinations(const RTPAddress * const *addresses,size_t numaddresses);
+
 	bool SupportsMulticasting();
 	int JoinMulticastGroup(const RTPAddress &addr);
 	int LeaveMulticastGroup(const RTPAddress &addr);
@@ -265,6 +382,45 @@ public:
 	
 	bool NewDataAvailable();
 	RTPRawPacket *GetNextPacket();
+
+	/** Sends a burst of RTP packets to all destinations. When UDP segmentation offload is available
+	 *  and enabled, consecutive packets of equal length (the last one of such a group may be shorter)
+	 *  are passed to the kernel using a single system call per destination, in groups of at most
+	 *  RTPUDPV6TRANS_MAXSEGMENTS packets. If the kernel or the outgoing interface turns out not to support
+	 *  this, segmentation offload is disabled and the packets are sent one by one. */
+	int SendRTPDataBurst(const void * const *packets,const size_t *lengths,size_t numpackets);
+
+	/** Stores the fill statistics of the batched receive calls in \c stats; these are
+	 *  only gathered when a receive batch size larger than one is used. */
+	int GetReceiveBatchStatistics(RTPReceiveBatchStatistics &stats);
+
+	/** Resets the fill statistics of the batched receive calls. */
+	void ClearReceiveBatchStatistics();
+
+	/** When a packet could not be sent to one of the destinations, this is recorded
+	 *  (at most RTPUDPV6TRANS_MAXSENDERRORS entries are kept). This function retrieves and removes
+	 *  the oldest entry: \c addr is set to the destination, \c rtp indicates if it was
+	 *  an RTP or RTCP packet and \c errorcode is the error reported by the system.
+	 *  Returns \c false if no such entry is available. */
+	bool GetNextSendError(RTPIPv6Address &addr,bool &rtp,int &errorcode);
+
+	/** Returns the total number of times sending a packet to a destination failed. */
+	uint64_t GetNumberOfSendErrors();
+
+	/** Incoming packets will be stored in buffers from \c pool; when the size of a waiting
+	 *  packet can be determined in advance and it fits in such a buffer, it is read into the
+	 *  buffer directly instead of being copied. Specify null to stop using a pool. */
+	int SetReceiveBufferPool(RTPReceiveBufferPool *pool);
+	int GetReceiveSockets(SocketType *sockets,size_t *numsockets);
+
+	/** Returns \c true if the current accept or ignore list has been attached to the sockets
+	 *  as a socket filter, so that the kernel drops the unwanted packets. */
+	bool IsUsingSocketFilter();
+
+	/** Stores the number of packets the kernel dropped for the sockets of this transmitter in
+	 *  \c num. This includes the packets that were rejected by the socket filter, but also the
+	 *  packets that were dropped because a receive buffer was full. */
+	int GetNumberOfKernelDrops(uint64_t &num);
 #ifdef RTPDEBUG
 	void Dump();
 #endif // RTPDEBUG
@@ -275,6 +431,16 @@ private:
 	void AddLoopbackAddress();
 	void FlushPackets();
 	int PollSocket(bool rtp);
+	int PollSocketBatched(bool rtp);
+	int PublishDestinations();
+	void UpdateSendDestinations();
+	int SendToDestinations(bool rtp,const void *data,size_t len);
+	int SendSegmented(const void * const *packets,const size_t *lengths,size_t numpackets);
+	void RecordSendError(const struct sockaddr_in6 *addr,bool rtp,int errorcode);
+	int ProcessReceivedData(bool rtp,const uint8_t *data,size_t datalen,in6_addr srcip,uint16_t srcport,RTPTime &receivetime,bool kerneltime = false);
+	int StoreReceivedData(bool rtp,uint8_t *data,size_t datalen,in6_addr srcip,uint16_t srcport,RTPTime &receivetime,bool kerneltime = false);
+	uint8_t *AllocateReceiveBuffer(bool rtp,size_t len);
+	void ReleaseReceiveBuffer(uint8_t *data);
 	int ProcessAddAcceptIgnoreEntry(in6_addr ip,uint16_t port);
 	int ProcessDeleteAcceptIgnoreEntry(in6_addr ip,uint16_t port);
 #ifdef RTP_SUPPORT_IPV6MULTICAST
@@ -282,6 +448,7 @@ private:
 #endif // RTP_SUPPORT_IPV6MULTICAST
 	bool ShouldAcceptData(in6_addr srcip,uint16_t srcport);
 	void ClearAcceptIgnoreInfo();
+	void UpdateSocketFilter();
 	
 	bool init;
 	bool created;
@@ -297,9 +464,9 @@ private:
 	uint8_t *localhostname;
 	size_t localhostnamelength;
 	
-	RTPHashTable<const RTPIPv6Destination,RTPUDPv6Trans_GetHashIndex_IPv6Dest,RTPUDPV6TRANS_HASHSIZE> destinations;
+	RTPOpenHashTable<const RTPIPv6Destination,RTPUDPv6Trans_GetHashIndex_IPv6Dest> destinations;
 #ifdef RTP_SUPPORT_IPV6MULTICAST
-	RTPHashTable<const in6_addr,RTPUDPv6Trans_GetHashIndex_in6_addr,RTPUDPV6TRANS_HASHSIZE> multicastgroups;
+	RTPOpenHashTable<const in6_addr,RTPUDPv6Trans_GetHashIndex_in6_addr> multicastgroups;
 #endif // RTP_SUPPORT_IPV6MULTICAST
 	std::list<RTPRawPacket*> rawpacketlist;
 
@@ -309,18 +476,48 @@ private:
 	class PortInfo
 	{
 	public:
-		PortInfo() { all = false; }
+		PortInfo(RTPMemoryManager *mgr) : ports(mgr) { all = false; }
 		
 		bool all;
-		std::list<uint16_t> portlist;
+		RTPPortSet ports;
+	};
+
+	RTPOpenKeyHashTable<const in6_addr,PortInfo*,RTPUDPv6Trans_GetHashIndex_in6_addr> acceptignoreinfo;
+	RTPUDPReceiveBatch recvbatch;
+	RTPUDPSocketFilter socketfilter;
+	bool usesocketfilter, socketfilteractive;
+	RTPUDPDestinationSnapshotSlot publisheddestinations;
+	RTPUDPDestinationSnapshot *senddestinations;
+	RTPUDPSendBatch rtpsendbatch, rtcpsendbatch;
+	bool rtpsendbatchvalid, rtcpsendbatchvalid;
+	bool usesegmentation;
+
+	class SendErrorInfo
+	{
+	public:
+		SendErrorInfo(in6_addr ip,uint16_t port,bool rtp,int errorcode) : ip(ip), port(port), rtp(rtp), errorcode(errorcode) { }
+
+		in6_addr ip;
+		uint16_t port;
+		bool rtp;
+		int errorcode;
 	};
 
-	RTPKeyHashTable<const in6_addr,PortInfo*,RTPUDPv6Trans_GetHashIndex_in6_addr,RTPUDPV6TRANS_HASHSIZE> acceptignoreinfo;
+	std::list<SendErrorInfo> senderrors;
+	uint64_t numsenderrors;
+
+	RTPReceiveBufferPool *bufferpool;
+
 	RTPAbortDescriptors m_abortDesc;
 	RTPAbortDescriptors *m_pAbortDesc;
 
 #ifdef RTP_SUPPORT_THREAD
-	jthread::JMutex mainmutex,waitmutex;
+	// The main mutex protects the configuration (sockets, destinations, multicast
+	// groups, local addresses), the send mutex the destination snapshot that's
+	// in use and the send errors, and the receive mutex the incoming packets and
+	// the accept/ignore lists. When more than one is needed, they're locked in
+	// this order.
+	jthread::JMutex mainmutex,sendmutex,receivemutex,waitmutex;
 	int threadsafe;
 #endif // RTP_SUPPORT_THREAD
 };
@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <iostream>
 #include <vector>
+#include <memory>
 #include <thread>
 #include <netinet/tcp.h>
 
@@ -0,0 +1,127 @@
+#include "rtpudpv4transmitter.h"
+#ifdef RTP_SUPPORT_IPV6
+	#include "rtpudpv6transmitter.h"
+#endif // RTP_SUPPORT_IPV6
+#include "rtphashtable.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+using namespace jrtplib;
+using namespace std;
+
+// The hash function that was used before, which only looks at the IP address
+class IPOnlyHashIndex
+{
+public:
+	static int GetIndex(const RTPIPv4Destination &d)			{ return d.GetIP()%RTPUDPV4TRANS_HASHSIZE; }
+};
+
+#define NUMLOOKUPS 100000
+
+// Fills a hash table with destinations and returns the average time a lookup takes,
+// in nanoseconds
+template<class Dest, class HashIndex, int hashsize>
+double MeasureLookups(const std::vector<Dest> &dests)
+{
+	RTPHashTable<const Dest,HashIndex,hashsize> table;
+
+	for (size_t i = 0 ; i < dests.size() ; i++)
+		table.AddElement(dests[i]);
+
+	size_t numfound = 0;
+	RTPTime start = RTPTime::CurrentTime();
+	for (size_t i = 0 ; i < NUMLOOKUPS ; i++)
+	{
+		if (table.HasElement(dests[(i*7919)%dests.size()]))
+			numfound++;
+	}
+	RTPTime elapsed = RTPTime::CurrentTime();
+	elapsed -= start;
+
+	if (numfound != NUMLOOKUPS)
+		cout << "ERROR: not all destinations were found" << endl;
+	return elapsed.GetDouble()*1e9/(double)NUMLOOKUPS;
+}
+
+template<class Dest, class HashIndex>
+size_t CountUsedBuckets(const std::vector<Dest> &dests, int hashsize)
+{
+	std::vector<bool> used(hashsize,false);
+	size_t num = 0;
+
+	for (size_t i = 0 ; i < dests.size() ; i++)
+	{
+		int idx = HashIndex::GetIndex(dests[i]);
+		if (!used[idx])
+		{
+			used[idx] = true;
+			num++;
+		}
+	}
+	return num;
+}
+
+int main(void)
+{
+	// Many destinations on the same host, e.g. a media gateway, which only
+	// differ in their port numbers
+	const size_t sizes[] = { 100, 1000, 10000 };
+	const uint32_t gatewayip = 0x0A000001;
+	int status = 0;
+
+	for (size_t s = 0 ; s < sizeof(sizes)/sizeof(size_t) ; s++)
+	{
+		std::vector<RTPIPv4Destination> dests;
+
+		for (size_t i = 0 ; i < sizes[s] ; i++)
+		{
+			uint16_t port = (uint16_t)(10000+i*2);
+			dests.push_back(RTPIPv4Destination(gatewayip,port,port+1));
+		}
+
+		double t = MeasureLookups<RTPIPv4Destination,RTPUDPv4Trans_GetHashIndex_IPv4Dest,RTPUDPV4TRANS_HASHSIZE>(dests);
+		double told = MeasureLookups<RTPIPv4Destination,IPOnlyHashIndex,RTPUDPV4TRANS_HASHSIZE>(dests);
+		size_t buckets = CountUsedBuckets<RTPIPv4Destination,RTPUDPv4Trans_GetHashIndex_IPv4Dest>(dests,RTPUDPV4TRANS_HASHSIZE);
+
+		cout << "IPv4, " << sizes[s] << " destinations: " << t << " ns per lookup (" << told << " ns hashing only the IP address), "
+		     << buckets << " hash buckets used" << endl;
+
+		// With a decent hash function, most destinations should end up in a
+		// bucket of their own
+		if (buckets < sizes[s]/2)
+		{
+			cout << "ERROR: destinations are not spread over the hash table" << endl;
+			status = -1;
+		}
+	}
+
+#ifdef RTP_SUPPORT_IPV6
+	for (size_t s = 0 ; s < sizeof(sizes)/sizeof(size_t) ; s++)
+	{
+		std::vector<RTPIPv6Destination> dests;
+		in6_addr ip;
+
+		memset(&ip,0,sizeof(in6_addr));
+		ip.s6_addr[0] = 0x20;
+		ip.s6_addr[1] = 0x01;
+		ip.s6_addr[15] = 0x01;
+		for (size_t i = 0 ; i < sizes[s] ; i++)
+			dests.push_back(RTPIPv6Destination(ip,(uint16_t)(10000+i*2)));
+
+		double t = MeasureLookups<RTPIPv6Destination,RTPUDPv6Trans_GetHashIndex_IPv6Dest,RTPUDPV6TRANS_HASHSIZE>(dests);
+		size_t buckets = CountUsedBuckets<RTPIPv6Destination,RTPUDPv6Trans_GetHashIndex_IPv6Dest>(dests,RTPUDPV6TRANS_HASHSIZE);
+
+		cout << "IPv6, " << sizes[s] << " destinations: " << t << " ns per lookup, " << buckets << " hash buckets used" << endl;
+		if (buckets < sizes[s]/2)
+		{
+			cout << "ERROR: destinations are not spread over the hash table" << endl;
+			status = -1;
+		}
+	}
+#endif // RTP_SUPPORT_IPV6
+
+	return status;
+}
@@ -0,0 +1,226 @@
+#include "rtpkeyhashtable.h"
+#include "rtpopenkeyhashtable.h"
+#include "rtpopenhashtable.h"
+#include "rtpsources.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+using namespace jrtplib;
+using namespace std;
+
+typedef RTPKeyHashTable<const uint32_t,void*,RTPSources_GetHashIndex,RTPSOURCES_HASHSIZE> OldTable;
+typedef RTPOpenKeyHashTable<const uint32_t,void*,RTPSources_GetHashIndex> NewTable;
+
+uint32_t RandomKey()
+{
+	return (((uint32_t)rand()) << 16) ^ (uint32_t)rand();
+}
+
+void fail(const char *msg)
+{
+	cout << "FAILED: " << msg << endl;
+	exit(-1);
+}
+
+template<class Table>
+void GetContents(Table &t, vector<uint32_t> &keys)
+{
+	keys.clear();
+	for (t.GotoFirstElement() ; t.HasCurrentElement() ; t.GotoNextElement())
+	{
+		keys.push_back(t.GetCurrentKey());
+		if ((void*)(size_t)t.GetCurrentKey() != t.GetCurrentElement())
+			fail("Element doesn't match key");
+	}
+}
+
+// Performs the same operations on the original and the new table and checks
+// that both behave the same, including the order of iteration
+void TestEquivalence()
+{
+	OldTable *oldtable = new OldTable();
+	NewTable newtable;
+	vector<uint32_t> present, oldkeys, newkeys;
+
+	for (int step = 0 ; step < 2000 ; step++)
+	{
+		int r = rand()%10;
+
+		if (r < 5 || present.empty())
+		{
+			uint32_t k = (rand()%4 == 0 && !present.empty())?present[rand()%present.size()]:(RandomKey()%5000);
+			int s1 = oldtable->AddElement(k,(void*)(size_t)k);
+			int s2 = newtable.AddElement(k,(void*)(size_t)k);
+
+			if (s1 != s2)
+				fail("AddElement results differ");
+			if (s1 == 0)
+				present.push_back(k);
+		}
+		else if (r < 7)
+		{
+			size_t idx = rand()%present.size();
+			uint32_t k = present[idx];
+
+			if (oldtable->DeleteElement(k) < 0 || newtable.DeleteElement(k) < 0)
+				fail("Couldn't delete element");
+			present.erase(present.begin()+idx);
+		}
+		else if (r < 8)
+		{
+			// Delete elements while iterating, as the timeout functions do
+			oldtable->GotoFirstElement();
+			newtable.GotoFirstElement();
+			while (oldtable->HasCurrentElement())
+			{
+				if (!newtable.HasCurrentElement() || oldtable->GetCurrentKey() != newtable.GetCurrentKey())
+					fail("Iteration differs");
+
+				uint32_t k = oldtable->GetCurrentKey();
+
+				if (k%7 == 0)
+				{
+					oldtable->DeleteCurrentElement();
+					newtable.DeleteCurrentElement();
+					for (size_t i = 0 ; i < present.size() ; i++)
+					{
+						if (present[i] == k)
+						{
+							present.erase(present.begin()+i);
+							break;
+						}
+					}
+				}
+				else
+				{
+					oldtable->GotoNextElement();
+					newtable.GotoNextElement();
+				}
+			}
+			if (newtable.HasCurrentElement())
+				fail("Iteration differs");
+		}
+		else
+		{
+			uint32_t k = RandomKey()%5000;
+
+			if (oldtable->HasElement(k) != newtable.HasElement(k))
+				fail("HasElement results differ");
+			if ((oldtable->GotoElement(k) < 0) != (newtable.GotoElement(k) < 0))
+				fail("GotoElement results differ");
+			if (oldtable->HasCurrentElement())
+			{
+				oldtable->GotoPreviousElement();
+				newtable.GotoPreviousElement();
+				if (oldtable->HasCurrentElement() != newtable.HasCurrentElement() ||
+				    (oldtable->HasCurrentElement() && oldtable->GetCurrentKey() != newtable.GetCurrentKey()))
+					fail("GotoPreviousElement results differ");
+			}
+		}
+
+		GetContents(*oldtable,oldkeys);
+		GetContents(newtable,newkeys);
+		if (oldkeys != newkeys || newkeys.size() != present.size() || newtable.GetNumberOfElements() != present.size())
+			fail("Table contents differ");
+	}
+	delete oldtable;
+}
+
+template<class Table>
+void Measure(Table &table, const vector<uint32_t> &keys, const vector<uint32_t> &otherkeys, double &tadd, double &tfind, double &tmiss, double &titer)
+{
+	const size_t numlookups = 1000000;
+	RTPTime start = RTPTime::CurrentTime();
+
+	for (size_t i = 0 ; i < keys.size() ; i++)
+		table.AddElement(keys[i],(void*)(size_t)i);
+
+	RTPTime t1 = RTPTime::CurrentTime();
+	size_t found = 0;
+
+	for (size_t i = 0 ; i < numlookups ; i++)
+	{
+		if (table.GotoElement(keys[(i*7919)%keys.size()]) == 0)
+			found++;
+	}
+
+	RTPTime t2 = RTPTime::CurrentTime();
+
+	for (size_t i = 0 ; i < numlookups ; i++)
+	{
+		if (table.HasElement(otherkeys[(i*7919)%otherkeys.size()]))
+			found++;
+	}
+
+	RTPTime t3 = RTPTime::CurrentTime();
+	size_t iterated = 0;
+	size_t numiterations = 1 + numlookups/keys.size();
+
+	for (size_t j = 0 ; j < numiterations ; j++)
+	{
+		for (table.GotoFirstElement() ; table.HasCurrentElement() ; table.GotoNextElement())
+			iterated += (size_t)table.GetCurrentElement();
+	}
+
+	RTPTime t4 = RTPTime::CurrentTime();
+
+	if (found != numlookups)
+		fail("Lookups failed");
+
+	tadd = (t1.GetDouble()-start.GetDouble())*1e9/(double)keys.size();
+	tfind = (t2.GetDouble()-t1.GetDouble())*1e9/(double)numlookups;
+	tmiss = (t3.GetDouble()-t2.GetDouble())*1e9/(double)numlookups;
+	titer = (t4.GetDouble()-t3.GetDouble())*1e9/(double)(numiterations*keys.size());
+	if (iterated == 1) // keep the loop from being optimized away
+		cout << endl;
+}
+
+int main(void)
+{
+	srand(1234);
+	TestEquivalence();
+
+	const size_t sizes[] = { 1, 16, 1000, 10000, 100000 };
+
+	cout << "All times in ns per element or per lookup" << endl;
+	for (size_t s = 0 ; s < sizeof(sizes)/sizeof(size_t) ; s++)
+	{
+		vector<uint32_t> keys, otherkeys;
+		OldTable *oldtable = new OldTable();
+		NewTable *newtable = new NewTable();
+
+		for (size_t i = 0 ; i < sizes[s] ; i++)
+		{
+			uint32_t k;
+			do
+			{
+				k = RandomKey()&~1U; // odd keys are used for the lookups that fail
+			} while (oldtable->HasElement(k));
+			oldtable->AddElement(k,0);
+			keys.push_back(k);
+		}
+		oldtable->Clear();
+		for (size_t i = 0 ; i < 1000 ; i++)
+			otherkeys.push_back(RandomKey()|1);
+
+		double oldadd, oldfind, oldmiss, olditer;
+		double newadd, newfind, newmiss, newiter;
+
+		Measure(*oldtable,keys,otherkeys,oldadd,oldfind,oldmiss,olditer);
+		Measure(*newtable,keys,otherkeys,newadd,newfind,newmiss,newiter);
+
+		// The original table allocates a separate entry with four link pointers for each element
+		size_t oldmem = sizeof(OldTable) + keys.size()*(2*sizeof(int)+sizeof(void*)+4*sizeof(void*));
+		size_t newmem = sizeof(NewTable) + newtable->GetAllocatedSize();
+
+		cout << sizes[s] << " elements:" << endl;
+		cout << "  original: add " << oldadd << ", lookup " << oldfind << ", miss " << oldmiss << ", iterate " << olditer << ", about " << oldmem << " bytes" << endl;
+		cout << "  open:     add " << newadd << ", lookup " << newfind << ", miss " << newmiss << ", iterate " << newiter << ", " << newmem << " bytes" << endl;
+
+		delete oldtable;
+		delete newtable;
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "rtpsources.h"
+#include "rtpsourcedata.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+void fail(const char *msg)
+{
+	cout << "FAILED: " << msg << endl;
+	exit(-1);
+}
+
+#define NUMLOOKUPS 2000000
+
+uint32_t RandomSSRC()
+{
+	return (((uint32_t)rand()) << 16) ^ (uint32_t)rand();
+}
+
+// Entries in the lookup cache must disappear together with their source
+void TestInvalidation()
+{
+	RTPSources sources;
+	RTPTime t0(1000, 0);
+
+	checkerror(sources.UpdateReceiveTime(1234, t0, 0));
+	if (!sources.GotEntry(1234))
+		fail("Source not found");
+
+	sources.Timeout(RTPTime(1100, 0), RTPTime(10, 0));
+	if (sources.GotEntry(1234) || sources.GetSourceInfo(1234) != 0)
+		fail("Removed source is still found");
+
+	checkerror(sources.UpdateReceiveTime(1234, RTPTime(1200, 0), 0));
+	RTPSourceData *s = sources.GetSourceInfo(1234);
+	if (s == 0 || s->INF_GetLastMessageTime().GetDouble() != 1200.0)
+		fail("New source for the same SSRC not found");
+
+	sources.MultipleTimeouts(RTPTime(1300, 0), RTPTime(10, 0), RTPTime(10, 0), RTPTime(10, 0), RTPTime(10, 0));
+	if (sources.GotEntry(1234))
+		fail("Removed source is still found");
+
+	checkerror(sources.CreateOwnSSRC(5678));
+	if (!sources.GotEntry(5678))
+		fail("Own source not found");
+	checkerror(sources.DeleteOwnSSRC());
+	if (sources.GotEntry(5678))
+		fail("Removed own source is still found");
+}
+
+int main(void)
+{
+	srand(1234);
+	TestInvalidation();
+
+	const int sizes[] = { 1, 16, 4096 };
+
+	cout << "All times in ns per lookup" << endl;
+	for (size_t s = 0 ; s < sizeof(sizes)/sizeof(int) ; s++)
+	{
+		RTPSources sources;
+		vector<uint32_t> ssrcs;
+		RTPTime t(1000, 0);
+
+		while (ssrcs.size() < (size_t)sizes[s])
+		{
+			uint32_t ssrc = RandomSSRC();
+
+			if (sources.GotEntry(ssrc))
+				continue;
+			checkerror(sources.UpdateReceiveTime(ssrc, t, 0));
+			ssrcs.push_back(ssrc);
+		}
+
+		// Packets of the participants arrive interleaved
+		RTPTime start = RTPTime::CurrentTime();
+		size_t found = 0;
+
+		for (size_t i = 0 ; i < NUMLOOKUPS ; i++)
+		{
+			if (sources.GotEntry(ssrcs[i%ssrcs.size()]))
+				found++;
+		}
+
+		RTPTime t1 = RTPTime::CurrentTime();
+
+		for (size_t i = 0 ; i < NUMLOOKUPS ; i++)
+		{
+			if (sources.GetSourceInfo(ssrcs[i%ssrcs.size()]))
+				found++;
+		}
+
+		RTPTime t2 = RTPTime::CurrentTime();
+
+		// The path an incoming RTCP packet takes
+		for (size_t i = 0 ; i < NUMLOOKUPS ; i++)
+			checkerror(sources.UpdateReceiveTime(ssrcs[i%ssrcs.size()], t, 0));
+
+		RTPTime t3 = RTPTime::CurrentTime();
+
+		if (found != 2*NUMLOOKUPS || sources.GetTotalCount() != sizes[s])
+			fail("Not all sources were found");
+
+		double tcached = (t1.GetDouble()-start.GetDouble())*1e9/(double)NUMLOOKUPS;
+		double ttable = (t2.GetDouble()-t1.GetDouble())*1e9/(double)NUMLOOKUPS;
+		double tupdate = (t3.GetDouble()-t2.GetDouble())*1e9/(double)NUMLOOKUPS;
+
+		cout << sizes[s] << " SSRCs: " << tcached << " through the lookup cache, " << ttable
+		     << " through the source table only, " << tupdate << " per receive time update" << endl;
+	}
+	return 0;
+}
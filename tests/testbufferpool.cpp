@@ -0,0 +1,202 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpreceivebufferpool.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtppacket.h"
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+void printstats(const RTPReceiveBufferPoolStatistics &stats)
+{
+	cout << "Buffers:         " << stats.GetNumberOfBuffers() << " of " << stats.GetBufferSize() << " bytes" << endl;
+	cout << "In use:          " << stats.GetNumberOfBuffersInUse() << endl;
+	cout << "Hits:            " << stats.GetNumberOfHits() << endl;
+	cout << "Misses:          " << stats.GetNumberOfMisses() << endl;
+	cout << "Hit ratio:       " << stats.GetHitRatio() << endl;
+}
+
+#define NUMBUFFERS 16
+
+int testtransmitter()
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter trans(0);
+	RTPUDPv4TransmissionParams params;
+	RTPReceiveBufferPool *pool = new RTPReceiveBufferPool();
+	uint8_t packet[100] = { 0x80, 0 };
+	uint8_t largepacket[1000] = { 0x80, 0 };
+	int num = 40;
+
+	params.SetPortbase(5000);
+	params.SetBindIP(localip);
+	params.SetRTPReceiveBuffer(1024*1024);
+	checkerror(trans.Init(false));
+	checkerror(trans.Create(1400,&params));
+	checkerror(trans.AddDestination(RTPIPv4Address(localip,5000)));
+
+	checkerror(pool->Create(NUMBUFFERS,500,false));
+	checkerror(trans.SetReceiveBufferPool(pool));
+
+	// The packets are kept, so the pool will run out of buffers; the large
+	// packet doesn't fit in a buffer of the pool at all
+	for (int i = 0 ; i < num ; i++)
+	{
+		packet[1] = (uint8_t)i;
+		checkerror(trans.SendRTPData(packet,sizeof(packet)));
+	}
+	checkerror(trans.SendRTPData(largepacket,sizeof(largepacket)));
+
+	RTPTime::Wait(RTPTime(0,100000));
+	checkerror(trans.Poll());
+
+	std::vector<RTPRawPacket *> packets;
+	RTPRawPacket *pack;
+	int errors = 0;
+
+	while ((pack = trans.GetNextPacket()) != 0)
+	{
+		size_t idx = packets.size();
+		size_t expectedlen = (idx < (size_t)num)?sizeof(packet):sizeof(largepacket);
+
+		if (pack->GetDataLength() != expectedlen || (idx < (size_t)num && pack->GetData()[1] != (uint8_t)idx))
+		{
+			cout << "ERROR: packet " << idx << " has unexpected contents" << endl;
+			errors++;
+		}
+		packets.push_back(pack);
+	}
+	cout << "Received " << packets.size() << "/" << (num+1) << " packets" << endl;
+
+	RTPReceiveBufferPoolStatistics stats;
+
+	pool->GetStatistics(stats);
+	printstats(stats);
+	if (packets.size() != (size_t)(num+1) || stats.GetNumberOfHits() != NUMBUFFERS || stats.GetNumberOfMisses() != (uint64_t)(num+1-NUMBUFFERS) 
+	    || stats.GetNumberOfBuffersInUse() != NUMBUFFERS)
+	{
+		cout << "ERROR: unexpected pool statistics" << endl;
+		errors++;
+	}
+
+	// Turn the first packet into an RTPPacket, which takes over the buffer
+	RTPPacket *rtppack = new RTPPacket(*packets[0]);
+	checkerror(rtppack->GetCreationError());
+
+	for (size_t i = 0 ; i < packets.size() ; i++)
+		delete packets[i];
+
+	pool->GetStatistics(stats);
+	if (stats.GetNumberOfBuffersInUse() != 1)
+	{
+		cout << "ERROR: buffer wasn't kept by RTPPacket" << endl;
+		errors++;
+	}
+
+	// The transmitter and the packet still hold a reference, the pool
+	// will be deleted when the last one is gone
+	pool->Release();
+	trans.Destroy();
+	delete rtppack;
+
+	return errors;
+}
+
+int testsession()
+{
+	RTPSession sess;
+	RTPSessionParams sessparams;
+	RTPUDPv4TransmissionParams transparams;
+	uint8_t data[100] = { 0 };
+	int num = 10;
+
+	sessparams.SetOwnTimestampUnit(1.0/8000.0);
+	sessparams.SetAcceptOwnPackets(true);
+	sessparams.SetReceiveBufferPoolSize(NUMBUFFERS);
+	transparams.SetPortbase(5002);
+	checkerror(sess.Create(sessparams,&transparams));
+	checkerror(sess.AddDestination(RTPIPv4Address(ntohl(inet_addr("127.0.0.1")),5002)));
+
+	for (int i = 0 ; i < num ; i++)
+		checkerror(sess.SendPacket(data,sizeof(data),0,false,160));
+
+	RTPTime::Wait(RTPTime(0,100000));
+#ifndef RTP_SUPPORT_THREAD
+	checkerror(sess.Poll());
+#endif // RTP_SUPPORT_THREAD
+
+	int count = 0, embeddederrors = 0;
+
+	sess.BeginDataAccess();
+	if (sess.GotoFirstSourceWithData())
+	{
+		do
+		{
+			RTPPacket *pack;
+
+			while ((pack = sess.GetNextPacket()) != 0)
+			{
+				// The packet should be stored right in front of its data
+				if ((uint8_t *)pack + RTPPacket::GetEmbeddedSize() != pack->GetPacketData())
+					embeddederrors++;
+				count++;
+				sess.DeletePacket(pack);
+			}
+		} while (sess.GotoNextSourceWithData());
+	}
+	sess.EndDataAccess();
+	cout << "Session received " << count << "/" << num << " packets" << endl;
+
+	RTPReceiveBufferPoolStatistics stats;
+
+	checkerror(sess.GetReceiveBufferPoolStatistics(stats));
+	printstats(stats);
+	sess.BYEDestroy(RTPTime(0,0),0,0);
+
+	if (count != num || stats.GetNumberOfHits() < (uint64_t)num || stats.GetBufferSize() != sessparams.GetMaximumPacketSize()+RTPPacket::GetEmbeddedSize())
+	{
+		cout << "ERROR: packets weren't stored in the pool" << endl;
+		return 1;
+	}
+	if (embeddederrors != 0)
+	{
+		cout << "ERROR: " << embeddederrors << " packets weren't stored in the same memory block as their data" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	int errors = testtransmitter();
+	errors += testsession();
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	if (errors != 0)
+		return -1;
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMRECEIVERS 4
+
+RTPUDPv4Transmitter *receivers[NUMRECEIVERS];
+
+// Sends a packet and checks which receivers got it
+int SendAndCount(RTPUDPv4Transmitter &sender, const char *description, int expected)
+{
+	uint8_t packet[100] = { 0x80, 0 };
+	int total = 0;
+
+	checkerror(sender.SendRTPData(packet,sizeof(packet)));
+	RTPTime::Wait(RTPTime(0,50000));
+
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		RTPRawPacket *pack;
+
+		checkerror(receivers[r]->Poll());
+		while ((pack = receivers[r]->GetNextPacket()) != 0)
+		{
+			total++;
+			delete pack;
+		}
+	}
+	cout << description << ": packet received by " << total << " receivers" << endl;
+	if (total != expected)
+	{
+		cout << "ERROR: expected " << expected << " receivers" << endl;
+		return -1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter sender(0);
+	RTPUDPv4TransmissionParams params;
+	RTPIPv4Address addresses[NUMRECEIVERS];
+	const RTPAddress *addrptrs[NUMRECEIVERS];
+	int status = 0;
+
+	params.SetPortbase(5000);
+	params.SetBindIP(localip);
+	checkerror(sender.Init(false));
+	checkerror(sender.Create(1400,&params));
+
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		RTPUDPv4TransmissionParams recvparams;
+
+		recvparams.SetPortbase(5002+r*2);
+		recvparams.SetBindIP(localip);
+		receivers[r] = new RTPUDPv4Transmitter(0);
+		checkerror(receivers[r]->Init(false));
+		checkerror(receivers[r]->Create(1400,&recvparams));
+		addresses[r].SetIP(localip);
+		addresses[r].SetPort(5002+r*2);
+		addrptrs[r] = &addresses[r];
+	}
+
+	checkerror(sender.AddDestinations(addrptrs,3));
+	if (SendAndCount(sender,"After adding three destinations",3) < 0)
+		status = -1;
+
+	// The third address is already in the list, so the fourth one must not
+	// be added either
+	const RTPAddress *overlap[2] = { addrptrs[3], addrptrs[2] };
+	if (sender.AddDestinations(overlap,2) >= 0)
+	{
+		cout << "ERROR: adding an existing destination should fail" << endl;
+		status = -1;
+	}
+	if (SendAndCount(sender,"After failing to add an existing destination",3) < 0)
+		status = -1;
+
+	checkerror(sender.AddDestination(addresses[3]));
+	if (SendAndCount(sender,"After adding the fourth destination",4) < 0)
+		status = -1;
+
+	// Deleting an unknown destination fails, the others stay in the list
+	RTPIPv4Address unknown(localip,6000);
+	const RTPAddress *withunknown[2] = { addrptrs[0], &unknown };
+	if (sender.DeleteDestinations(withunknown,2) >= 0)
+	{
+		cout << "ERROR: deleting an unknown destination should fail" << endl;
+		status = -1;
+	}
+	if (SendAndCount(sender,"After failing to delete an unknown destination",4) < 0)
+		status = -1;
+
+	checkerror(sender.DeleteDestinations(addrptrs,2));
+	if (SendAndCount(sender,"After deleting two destinations",2) < 0)
+		status = -1;
+
+	sender.ClearDestinations();
+	if (SendAndCount(sender,"After clearing the destinations",0) < 0)
+		status = -1;
+
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		receivers[r]->Destroy();
+		delete receivers[r];
+	}
+	sender.Destroy();
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	return status;
+}
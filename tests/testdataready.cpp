@@ -0,0 +1,152 @@
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include "rtpdefines.h"
+#include <poll.h>
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMPACKETS 10
+#define PORTBASE 35000
+
+class ReceiverSession : public RTPSession
+{
+public:
+	ReceiverSession() : numcalls(0), numnotified(0)				{ }
+
+	int numcalls;
+	size_t numnotified;
+protected:
+	void OnDataReady(size_t numpackets)							{ numcalls++; numnotified += numpackets; }
+};
+
+bool IsReadable(SocketType desc, int timeout)
+{
+	struct pollfd fds;
+
+	fds.fd = desc;
+	fds.events = POLLIN;
+	fds.revents = 0;
+	return poll(&fds, 1, timeout) > 0 && (fds.revents & POLLIN);
+}
+
+int main(void)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	ReceiverSession receiver;
+	RTPSession sender;
+	RTPSessionParams sessparams;
+	RTPUDPv4TransmissionParams transparams;
+	int status = 0;
+
+	// With thread support, the poll thread of the receiver processes the incoming packets
+	sessparams.SetOwnTimestampUnit(1.0/8000.0);
+	transparams.SetBindIP(localip);
+	transparams.SetPortbase(PORTBASE);
+	sessparams.SetUseDataReadyNotification(true);
+	checkerror(receiver.Create(sessparams,&transparams));
+
+	transparams.SetPortbase(PORTBASE+2);
+	sessparams.SetUseDataReadyNotification(false);
+	checkerror(sender.Create(sessparams,&transparams));
+	checkerror(sender.AddDestination(RTPIPv4Address(localip,PORTBASE)));
+
+	SocketType desc;
+
+	if (sender.GetDataReadyDescriptor(&desc) != ERR_RTP_SESSION_NODATAREADYNOTIFICATION)
+	{
+		cout << "ERROR: got a data ready descriptor without requesting one" << endl;
+		status = -1;
+	}
+	checkerror(receiver.GetDataReadyDescriptor(&desc));
+	if (IsReadable(desc, 100))
+	{
+		cout << "ERROR: descriptor readable before any data arrived" << endl;
+		status = -1;
+	}
+
+	uint8_t payload[160] = { 0 };
+
+	for (int i = 0 ; i < NUMPACKETS ; i++)
+		checkerror(sender.SendPacket(payload,sizeof(payload),0,false,160));
+
+	// Wait for the notification, clear it and only then fetch the packets, so that
+	// packets that are stored in the meantime signal the descriptor again
+	int numpackets = 0;
+	RTPTime starttime = RTPTime::CurrentTime();
+
+	while (numpackets < NUMPACKETS && RTPTime::CurrentTime().GetDouble() - starttime.GetDouble() < 5.0)
+	{
+#ifndef RTP_SUPPORT_THREAD
+		RTPTime::Wait(RTPTime(0,10000));
+		checkerror(receiver.Poll());
+#endif // RTP_SUPPORT_THREAD
+		if (!IsReadable(desc, 1000))
+			continue;
+
+		checkerror(receiver.ClearDataReadyNotification());
+
+		receiver.BeginDataAccess();
+		if (receiver.GotoFirstSourceWithData())
+		{
+			do
+			{
+				RTPPacket *pack;
+
+				while ((pack = receiver.GetNextPacket()) != 0)
+				{
+					numpackets++;
+					receiver.DeletePacket(pack);
+				}
+			} while (receiver.GotoNextSourceWithData());
+		}
+		receiver.EndDataAccess();
+	}
+
+	if (numpackets != NUMPACKETS)
+	{
+		cout << "ERROR: received " << numpackets << " of " << NUMPACKETS << " packets" << endl;
+		status = -1;
+	}
+	if (IsReadable(desc, 100))
+	{
+		cout << "ERROR: descriptor still readable after all packets were retrieved" << endl;
+		status = -1;
+	}
+
+	receiver.BeginDataAccess();
+	int numcalls = receiver.numcalls;
+	size_t numnotified = receiver.numnotified;
+	receiver.EndDataAccess();
+
+	// The first packets of the sender arrive while it's still on probation; they only become 
+	// available together with the packet that validates the sender, and aren't counted separately
+	if (numcalls < 1 || numcalls > NUMPACKETS || numnotified < NUMPACKETS-RTP_PROBATIONCOUNT || numnotified > NUMPACKETS)
+	{
+		cout << "ERROR: " << numcalls << " notifications for " << numnotified << " packets" << endl;
+		status = -1;
+	}
+
+	sender.BYEDestroy(RTPTime(0,0),0,0);
+	receiver.BYEDestroy(RTPTime(0,0),0,0);
+
+	if (status == 0)
+		cout << "Got " << numcalls << " notifications for " << numpackets << " packets" << endl;
+	return status;
+}
@@ -0,0 +1,271 @@
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <poll.h>
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define QUEUESIZE 8
+#define NUMPACKETS QUEUESIZE
+#define NUMOVERFLOWPACKETS 20
+#define PORTBASE 35100
+
+bool IsReadable(SocketType desc, int timeout)
+{
+	struct pollfd fds;
+
+	fds.fd = desc;
+	fds.events = POLLIN;
+	fds.revents = 0;
+	return poll(&fds, 1, timeout) > 0 && (fds.revents & POLLIN);
+}
+
+int CountStoredPackets(RTPSession &sess)
+{
+	int num = 0;
+
+	sess.BeginDataAccess();
+	if (sess.GotoFirstSourceWithData())
+	{
+		do
+		{
+			RTPPacket *pack;
+
+			while ((pack = sess.GetNextPacket()) != 0)
+			{
+				num++;
+				sess.DeletePacket(pack);
+			}
+		} while (sess.GotoNextSourceWithData());
+	}
+	sess.EndDataAccess();
+	return num;
+}
+
+int CountDeliveredPackets(RTPSession &sess)
+{
+	int num = 0;
+	RTPPacket *pack;
+
+	while ((pack = sess.GetDeliveredPacket()) != 0)
+	{
+		num++;
+		sess.DeletePacket(pack);
+	}
+	return num;
+}
+
+class CountingSession : public RTPSession
+{
+public:
+	CountingSession() : numready(0)									{ }
+
+	size_t numready;
+protected:
+	void OnDataReady(size_t numpackets)								{ numready += numpackets; }
+};
+
+// Duplicates aren't stored in the source table, nor pushed into the delivery queue if
+// there is one, so they mustn't be reported as new packets either
+int TestNewPacketCount(uint32_t localip, bool usequeue, uint16_t portbase)
+{
+	CountingSession receiver;
+	RTPSessionParams sessparams;
+	RTPUDPv4TransmissionParams transparams;
+	RTPUDPv4Transmitter sender(0);
+	const uint16_t seqnrs[] = { 1, 2, 3, 4, 3, 5, 4, 6 };
+	const int numseqnrs = sizeof(seqnrs)/sizeof(uint16_t);
+	const int numunique = 6;
+
+	sessparams.SetOwnTimestampUnit(1.0/8000.0);
+	sessparams.SetUsePollThread(false);
+	sessparams.SetProbationType(RTPSources::NoProbation);
+	if (usequeue)
+		sessparams.SetDeliveryQueueSize(QUEUESIZE);
+	transparams.SetBindIP(localip);
+	transparams.SetPortbase(portbase);
+	checkerror(receiver.Create(sessparams,&transparams));
+
+	transparams.SetPortbase(portbase+2);
+	checkerror(sender.Init(false));
+	checkerror(sender.Create(1400,&transparams));
+	checkerror(sender.AddDestination(RTPIPv4Address(localip,portbase)));
+
+	for (int i = 0 ; i < numseqnrs ; i++)
+	{
+		RTPPacket pack(0, "x", 1, seqnrs[i], 0, 1234, false, 0, 0, false, 0, 0, 0, 1400);
+
+		checkerror(pack.GetCreationError());
+		checkerror(sender.SendRTPData(pack.GetPacketData(), pack.GetPacketLength()));
+	}
+
+	RTPTime starttime = RTPTime::CurrentTime();
+	int numstored = 0;
+
+	while (numstored < numunique && RTPTime::CurrentTime().GetDouble() - starttime.GetDouble() < 5.0)
+	{
+		RTPTime::Wait(RTPTime(0,10000));
+		checkerror(receiver.Poll());
+		numstored += CountStoredPackets(receiver) + CountDeliveredPackets(receiver);
+	}
+
+	// Give the duplicates that might still be underway some time
+	RTPTime::Wait(RTPTime(0,50000));
+	checkerror(receiver.Poll());
+	numstored += CountStoredPackets(receiver) + CountDeliveredPackets(receiver);
+
+	sender.Destroy();
+	receiver.BYEDestroy(RTPTime(0,0),0,0);
+
+	if (numstored != numunique || receiver.numready != (size_t)numunique)
+	{
+		cout << "ERROR: " << numstored << " packets stored" << ((usequeue)?" or queued":"") << ", " << receiver.numready << " reported as new" << endl;
+		return -1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPSession receiver, sender;
+	RTPSessionParams sessparams;
+	RTPUDPv4TransmissionParams transparams;
+	uint64_t numdelivered = 0, numoverflows = 0;
+	int status = 0;
+
+	sessparams.SetOwnTimestampUnit(1.0/8000.0);
+	transparams.SetBindIP(localip);
+	transparams.SetPortbase(PORTBASE);
+	sessparams.SetUseDataReadyNotification(true);
+	sessparams.SetDeliveryQueueSize(QUEUESIZE);
+	sessparams.SetDeliveryQueueOverflowPolicy(RTPSessionParams::DropNewPacket);
+	sessparams.SetProbationType(RTPSources::ProbationStore);
+	checkerror(receiver.Create(sessparams,&transparams));
+
+	transparams.SetPortbase(PORTBASE+2);
+	sessparams.SetUseDataReadyNotification(false);
+	sessparams.SetDeliveryQueueSize(0);
+	checkerror(sender.Create(sessparams,&transparams));
+	checkerror(sender.AddDestination(RTPIPv4Address(localip,PORTBASE)));
+
+	if (sender.GetDeliveryQueueCounters(&numdelivered, &numoverflows) != ERR_RTP_SESSION_NODELIVERYQUEUE ||
+	    sender.GetDeliveredPacket() != 0)
+	{
+		cout << "ERROR: delivery queue present without requesting one" << endl;
+		status = -1;
+	}
+
+	SocketType desc;
+	uint8_t payload[160] = { 0 };
+
+	checkerror(receiver.GetDataReadyDescriptor(&desc));
+
+	// All packets arrive through the queue, in sequence: the ones that arrive while 
+	// the sender is still on probation are delivered once it's validated
+	for (int i = 0 ; i < NUMPACKETS ; i++)
+		checkerror(sender.SendPacket(payload,sizeof(payload),0,false,160));
+
+	int numqueued = 0, numstored = 0;
+	bool first = true;
+	uint16_t prevseqnr = 0;
+	RTPTime starttime = RTPTime::CurrentTime();
+
+	while (numqueued + numstored < NUMPACKETS && RTPTime::CurrentTime().GetDouble() - starttime.GetDouble() < 5.0)
+	{
+#ifndef RTP_SUPPORT_THREAD
+		RTPTime::Wait(RTPTime(0,10000));
+		checkerror(receiver.Poll());
+#endif // RTP_SUPPORT_THREAD
+		if (!IsReadable(desc, 1000))
+			continue;
+
+		checkerror(receiver.ClearDataReadyNotification());
+
+		RTPPacket *pack;
+
+		while ((pack = receiver.GetDeliveredPacket()) != 0)
+		{
+			if (!first && pack->GetSequenceNumber() != (uint16_t)(prevseqnr+1))
+			{
+				cout << "ERROR: packet " << pack->GetSequenceNumber() << " follows " << prevseqnr << endl;
+				status = -1;
+			}
+			first = false;
+			prevseqnr = pack->GetSequenceNumber();
+			numqueued++;
+			receiver.DeletePacket(pack);
+		}
+		numstored += CountStoredPackets(receiver);
+	}
+
+	checkerror(receiver.GetDeliveryQueueCounters(&numdelivered, &numoverflows));
+	if (numqueued != NUMPACKETS || numstored != 0 || numdelivered != (uint64_t)numqueued || numoverflows != 0)
+	{
+		cout << "ERROR: " << numqueued << " packets from the queue (counter " << numdelivered << "), " 
+		     << numstored << " from the source table, " << numoverflows << " overflows" << endl;
+		status = -1;
+	}
+
+	// Without a consumer, the queue fills up and the rest of the packets are dropped
+	for (int i = 0 ; i < NUMOVERFLOWPACKETS ; i++)
+		checkerror(sender.SendPacket(payload,sizeof(payload),0,false,160));
+
+	uint64_t prevdelivered = numdelivered;
+
+	starttime = RTPTime::CurrentTime();
+	while (numdelivered + numoverflows - prevdelivered < NUMOVERFLOWPACKETS && RTPTime::CurrentTime().GetDouble() - starttime.GetDouble() < 5.0)
+	{
+		RTPTime::Wait(RTPTime(0,10000));
+#ifndef RTP_SUPPORT_THREAD
+		checkerror(receiver.Poll());
+#endif // RTP_SUPPORT_THREAD
+		checkerror(receiver.GetDeliveryQueueCounters(&numdelivered, &numoverflows));
+	}
+
+	int numafteroverflow = 0;
+	RTPPacket *pack;
+
+	while ((pack = receiver.GetDeliveredPacket()) != 0)
+	{
+		numafteroverflow++;
+		receiver.DeletePacket(pack);
+	}
+	numstored = CountStoredPackets(receiver);
+
+	if (numdelivered - prevdelivered != QUEUESIZE || numoverflows != NUMOVERFLOWPACKETS-QUEUESIZE || 
+	    numafteroverflow != QUEUESIZE || numstored != 0)
+	{
+		cout << "ERROR: " << numafteroverflow << " packets in the full queue (counter " << (numdelivered - prevdelivered) 
+		     << "), " << numoverflows << " overflows, " << numstored << " packets in the source table" << endl;
+		status = -1;
+	}
+
+	sender.BYEDestroy(RTPTime(0,0),0,0);
+	receiver.BYEDestroy(RTPTime(0,0),0,0);
+
+	if (TestNewPacketCount(localip, false, PORTBASE+4) < 0)
+		status = -1;
+	if (TestNewPacketCount(localip, true, PORTBASE+8) < 0)
+		status = -1;
+
+	if (status == 0)
+		cout << "Got " << numqueued << " packets through the queue, dropped " << numoverflows << " when it was full" << endl;
+	return status;
+}
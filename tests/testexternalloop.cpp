@@ -0,0 +1,226 @@
+#include "rtpconfig.h"
+#include <iostream>
+
+#ifdef RTP_HAVE_EPOLL
+
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtpsourcedata.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <sys/epoll.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMSESSIONS 8
+#define PORTBASE 34000
+#define SENDINTERVAL 0.02
+#define MAXRUNTIME 15.0
+
+int CountDescriptors()
+{
+	DIR *dir = opendir("/proc/self/fd");
+	int num = 0;
+
+	if (!dir)
+		return -1;
+	while (readdir(dir) != 0)
+		num++;
+	closedir(dir);
+	return num;
+}
+
+int main(void)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPSession sessions[NUMSESSIONS];
+	int status = 0;
+
+	int epollfd = epoll_create1(0);
+	if (epollfd < 0)
+	{
+		cout << "ERROR: can't create epoll instance" << endl;
+		return -1;
+	}
+
+	int numdesc = CountDescriptors();
+
+	// The sessions are driven by our own event loop below, so they don't need a 
+	// poll thread nor the pipe that's used to abort waiting for data
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+	{
+		RTPSessionParams sessparams;
+		RTPUDPv4TransmissionParams transparams;
+
+		sessparams.SetOwnTimestampUnit(1.0/8000.0);
+		sessparams.SetUsePollThread(false);
+		sessparams.SetMinimumRTCPTransmissionInterval(RTPTime(1,0));
+		transparams.SetBindIP(localip);
+		transparams.SetPortbase(PORTBASE+2*i);
+		transparams.SetUseAbortDescriptors(false);
+		checkerror(sessions[i].Create(sessparams,&transparams));
+		checkerror(sessions[i].AddDestination(RTPIPv4Address(localip,PORTBASE+2*((i+1)%NUMSESSIONS))));
+
+		SocketType sockets[2];
+		size_t numsockets = 2;
+
+		checkerror(sessions[i].GetReceiveSockets(sockets,&numsockets));
+		for (size_t j = 0 ; j < numsockets ; j++)
+		{
+			struct epoll_event ev;
+
+			ev.events = EPOLLIN;
+			ev.data.u32 = i;
+			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, sockets[j], &ev) < 0)
+			{
+				cout << "ERROR: can't add socket to epoll instance" << endl;
+				return -1;
+			}
+		}
+	}
+
+	int extradesc = CountDescriptors() - numdesc;
+
+	if (numdesc < 0 || extradesc != 2*NUMSESSIONS)
+	{
+		cout << "ERROR: " << NUMSESSIONS << " sessions use " << extradesc << " descriptors" << endl;
+		status = -1;
+	}
+
+	RTPTime starttime = RTPTime::CurrentTime();
+	RTPTime nextsend = starttime;
+	uint8_t payload[160] = { 0 };
+	int numsent = 0;
+	int numsteps = 0;
+
+	int numpackets[NUMSESSIONS] = { 0 };
+	bool gotsr[NUMSESSIONS] = { false };
+	RTPTime nextcheck = starttime;
+
+	while (true)
+	{
+		RTPTime now = RTPTime::CurrentTime();
+
+		if (now.GetDouble() - starttime.GetDouble() > MAXRUNTIME)
+			break;
+
+		// Keep running until every session has received a sender report from its neighbour
+		if (now >= nextcheck)
+		{
+			bool done = true;
+
+			for (int i = 0 ; i < NUMSESSIONS ; i++)
+			{
+				sessions[i].BeginDataAccess();
+				if (sessions[i].GotoFirstSource())
+				{
+					do
+					{
+						RTPPacket *pack;
+
+						while ((pack = sessions[i].GetNextPacket()) != 0)
+						{
+							numpackets[i]++;
+							sessions[i].DeletePacket(pack);
+						}
+						if (sessions[i].GetCurrentSourceInfo()->SR_HasInfo())
+							gotsr[i] = true;
+					} while (sessions[i].GotoNextSource());
+				}
+				sessions[i].EndDataAccess();
+
+				if (!gotsr[i])
+					done = false;
+			}
+			if (done)
+				break;
+			nextcheck += RTPTime(0.5);
+		}
+
+		if (now >= nextsend)
+		{
+			for (int i = 0 ; i < NUMSESSIONS ; i++)
+				checkerror(sessions[i].SendPacket(payload,sizeof(payload),0,false,160));
+			numsent++;
+			nextsend += RTPTime(SENDINTERVAL);
+		}
+
+		// Wait until a socket becomes readable, or until the earliest deadline
+		RTPTime deadline = nextsend;
+
+		for (int i = 0 ; i < NUMSESSIONS ; i++)
+		{
+			RTPTime d = sessions[i].GetNextDeadline();
+			if (d < deadline)
+				deadline = d;
+		}
+
+		double diff = deadline.GetDouble() - now.GetDouble();
+		int timeout = (diff <= 0)?0:(int)(diff*1000.0+1.0);
+		struct epoll_event events[NUMSESSIONS*2];
+		int num = epoll_wait(epollfd, events, NUMSESSIONS*2, timeout);
+		bool ready[NUMSESSIONS] = { false };
+
+		for (int i = 0 ; i < num ; i++)
+			ready[events[i].data.u32] = true;
+
+		now = RTPTime::CurrentTime();
+		for (int i = 0 ; i < NUMSESSIONS ; i++)
+		{
+			if (ready[i] || sessions[i].GetNextDeadline() <= now)
+			{
+				checkerror(sessions[i].Step(now));
+				numsteps++;
+			}
+		}
+	}
+
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+	{
+		// The last packets may still be underway
+		if (numpackets[i] < numsent-2 || numpackets[i] > numsent)
+		{
+			cout << "ERROR: session " << i << " received " << numpackets[i] << " of " << numsent << " packets" << endl;
+			status = -1;
+		}
+		if (!gotsr[i])
+		{
+			cout << "ERROR: session " << i << " didn't receive a sender report" << endl;
+			status = -1;
+		}
+	}
+
+	close(epollfd);
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+		sessions[i].BYEDestroy(RTPTime(0,0),0,0);
+
+	if (status == 0)
+		cout << NUMSESSIONS << " sessions were driven by an external loop using " << numsteps << " steps" << endl;
+	return status;
+}
+
+#else
+
+int main(void)
+{
+	std::cout << "No epoll support, skipping the external event loop test" << std::endl;
+	return 0;
+}
+
+#endif // RTP_HAVE_EPOLL
@@ -0,0 +1,164 @@
+#include "rtpconfig.h"
+#include <iostream>
+
+using namespace std;
+
+#ifdef RTP_SUPPORT_IOURING
+
+#include "rtpiouringtransmitter.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace jrtplib;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMPACKETS 200
+#define NUMBURSTPACKETS 20
+
+int receivepackets(RTPIoUringTransmitter &trans, int expected, int &numrtcp)
+{
+	RTPTime endtime = RTPTime::CurrentTime();
+	int count = 0;
+
+	endtime += RTPTime(2.0);
+	numrtcp = 0;
+	while (count < expected && RTPTime::CurrentTime() < endtime)
+	{
+		RTPRawPacket *pack;
+		bool avail = false;
+
+		checkerror(trans.WaitForIncomingData(RTPTime(0.5),&avail));
+		checkerror(trans.Poll());
+		while ((pack = trans.GetNextPacket()) != 0)
+		{
+			if (!pack->IsRTP())
+				numrtcp++;
+			count++;
+			delete pack;
+		}
+	}
+	return count;
+}
+
+int main(void)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPIoUringTransmitter sender(0), receiver(0);
+	RTPIoUringTransmissionParams params;
+	uint8_t packet[200] = { 0x80, 0 };
+	uint8_t rtcppacket[8] = { 0x80, 200, 0, 1, 0, 0, 0, 0 };
+	int status, numrtcp;
+
+	// Use few send buffers, so that we also check what happens when they run out
+	params.SetPortbase(5000);
+	params.SetBindIP(localip);
+	params.SetNumberOfSendBuffers(4);
+	params.SetQueueDepth(16);
+	status = sender.Init(false);
+	checkerror(status);
+	status = sender.Create(1400,&params);
+	if (status == ERR_RTP_IOURINGTRANS_CANTSETUPRING || status == ERR_RTP_IOURINGTRANS_CANTREGISTERBUFFERS)
+	{
+		cout << "The kernel does not provide the required io_uring features: " << RTPGetErrorString(status) << endl;
+		return 0;
+	}
+	checkerror(status);
+
+	params = RTPIoUringTransmissionParams();
+	params.SetPortbase(5002);
+	params.SetBindIP(localip);
+	params.SetRTPReceiveBuffer(1024*1024);
+	params.SetRTCPMultiplexing(true);
+	params.SetNumberOfReceiveBuffers(64); // fewer than the number of packets that are sent
+	checkerror(receiver.Init(false));
+	checkerror(receiver.Create(1400,&params));
+
+	// Nothing has been sent yet, so this should time out
+	bool avail = true;
+	checkerror(receiver.WaitForIncomingData(RTPTime(0.1),&avail));
+	if (avail)
+	{
+		cout << "ERROR: data available before anything was sent" << endl;
+		return -1;
+	}
+
+	checkerror(sender.AddDestination(RTPIPv4Address(localip,5002,true)));
+	for (int i = 0 ; i < NUMPACKETS ; i++)
+	{
+		packet[1] = (uint8_t)i;
+		checkerror(sender.SendRTPData(packet,sizeof(packet)));
+		if (i%10 == 0)
+			checkerror(sender.SendRTCPData(rtcppacket,sizeof(rtcppacket)));
+	}
+
+	int count = receivepackets(receiver,NUMPACKETS+NUMPACKETS/10,numrtcp);
+	cout << "Received " << count << "/" << (NUMPACKETS+NUMPACKETS/10) << " packets, of which " << numrtcp << " RTCP" << endl;
+	if (count != NUMPACKETS+NUMPACKETS/10 || numrtcp != NUMPACKETS/10)
+	{
+		cout << "ERROR: unexpected number of packets" << endl;
+		return -1;
+	}
+
+	uint8_t burstdata[NUMBURSTPACKETS][1000];
+	const void *burstpackets[NUMBURSTPACKETS];
+	size_t burstlengths[NUMBURSTPACKETS];
+
+	for (int i = 0 ; i < NUMBURSTPACKETS ; i++)
+	{
+		memset(burstdata[i],i,sizeof(burstdata[i]));
+		burstdata[i][0] = 0x80;
+		burstpackets[i] = burstdata[i];
+		burstlengths[i] = 1000;
+	}
+	checkerror(sender.SendRTPDataBurst(burstpackets,burstlengths,NUMBURSTPACKETS));
+
+	count = receivepackets(receiver,NUMBURSTPACKETS,numrtcp);
+	cout << "Received " << count << "/" << NUMBURSTPACKETS << " packets from burst" << endl;
+	if (count != NUMBURSTPACKETS)
+	{
+		cout << "ERROR: unexpected number of packets" << endl;
+		return -1;
+	}
+
+	// Sending to the broadcast address is not allowed, this should be reported
+	RTPIPv4Address addr;
+	bool rtp;
+	int errcode;
+
+	sender.ClearDestinations();
+	checkerror(sender.AddDestination(RTPIPv4Address(0xffffffff,5010)));
+	checkerror(sender.SendRTPData(packet,sizeof(packet)));
+	RTPTime::Wait(RTPTime(0.1));
+	if (!sender.GetNextSendError(addr,rtp,errcode) || addr.GetIP() != 0xffffffff || !rtp)
+	{
+		cout << "ERROR: send error was not reported" << endl;
+		return -1;
+	}
+	cout << "Send error for port " << addr.GetPort() << ": " << strerror(errcode) << endl;
+
+	sender.Destroy();
+	receiver.Destroy();
+	return 0;
+}
+
+#else
+
+int main(void)
+{
+	cout << "io_uring support was not enabled at compile time" << endl;
+	return 0;
+}
+
+#endif // RTP_SUPPORT_IOURING
@@ -0,0 +1,133 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMPACKETS 5
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter sender(0), receiver(0);
+	RTPUDPv4TransmissionParams params, recvparams;
+	uint8_t packet[100] = { 0x80, 0 };
+	double sendtimes[NUMPACKETS];
+
+	params.SetPortbase(5000);
+	params.SetBindIP(localip);
+	checkerror(sender.Init(false));
+	checkerror(sender.Create(1400,&params));
+
+	recvparams.SetPortbase(5002);
+	recvparams.SetBindIP(localip);
+	recvparams.SetUseKernelTimestamps(true);
+	checkerror(receiver.Init(false));
+	checkerror(receiver.Create(1400,&recvparams));
+	checkerror(sender.AddDestination(RTPIPv4Address(localip,5002)));
+
+	// The kernel may only start recording timestamps a little while after the
+	// socket option was set, so the first packet is only used to warm up
+	packet[1] = 0xff;
+	checkerror(sender.SendRTPData(packet,sizeof(packet)));
+	RTPTime::Wait(RTPTime(0,100000));
+	checkerror(receiver.Poll());
+
+	RTPRawPacket *pack;
+	int count = 0, numok = 0, numkernel = 0;
+
+	while ((pack = receiver.GetNextPacket()) != 0)
+		delete pack;
+
+	// Send the packets with some time in between, but only read them all at
+	// once some time later
+	for (int i = 0 ; i < NUMPACKETS ; i++)
+	{
+		packet[1] = (uint8_t)i;
+		sendtimes[i] = RTPTime::CurrentTime().GetDouble();
+		checkerror(sender.SendRTPData(packet,sizeof(packet)));
+		RTPTime::Wait(RTPTime(0,50000));
+	}
+
+	RTPTime::Wait(RTPTime(0,200000));
+	checkerror(receiver.Poll());
+
+	while ((pack = receiver.GetNextPacket()) != 0)
+	{
+		int idx = pack->GetData()[1];
+		RTPTime diff = pack->GetReceiveTime();
+
+		if (idx >= NUMPACKETS) // the warm-up packet
+		{
+			delete pack;
+			continue;
+		}
+
+		count++;
+		diff -= RTPTime(sendtimes[idx]);
+		cout << "Packet " << idx << " received " << diff.GetDouble()*1000.0 << " ms after it was sent";
+
+		// A packet without a kernel timestamp gets the time at which it was read
+		if (!pack->HasKernelReceiveTime())
+			cout << " (no kernel timestamp)" << endl;
+		else
+		{
+			cout << endl;
+			numkernel++;
+
+			// Without kernel timestamps, all packets would only appear to be received
+			// after the final wait
+			if (diff.GetDouble() > -0.005 && diff.GetDouble() < 0.1)
+				numok++;
+		}
+		delete pack;
+	}
+
+	receiver.Destroy();
+	sender.Destroy();
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	if (count != NUMPACKETS)
+	{
+		cout << "ERROR: not all packets were received" << endl;
+		return -1;
+	}
+
+#if defined(RTP_HAVE_SO_TIMESTAMPNS) && defined(RTP_HAVE_RECVMMSG)
+	if (numkernel == 0)
+	{
+		cout << "ERROR: none of the packets had a kernel timestamp" << endl;
+		return -1;
+	}
+	if (numok != numkernel)
+	{
+		cout << "ERROR: receive times don't match the kernel's timestamps" << endl;
+		return -1;
+	}
+#else
+	cout << "Kernel receive timestamps are not supported on this platform" << endl;
+#endif // RTP_HAVE_SO_TIMESTAMPNS && RTP_HAVE_RECVMMSG
+	return 0;
+}
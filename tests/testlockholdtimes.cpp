@@ -0,0 +1,219 @@
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtpholdtimehistogram.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#ifdef RTP_SUPPORT_THREAD
+	#include <jthread/jthread.h>
+	#include <jthread/jmutex.h>
+#endif // RTP_SUPPORT_THREAD
+
+using namespace jrtplib;
+using namespace std;
+#ifdef RTP_SUPPORT_THREAD
+using namespace jthread;
+#endif // RTP_SUPPORT_THREAD
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define PORTBASE 35200
+#define SOURCESHOLDTIME 0.5
+#define MAXSENDTIME 0.05
+
+#ifdef RTP_SUPPORT_THREAD
+
+// Keeps the source table locked for a while, just like the poll thread does while it is
+// building an RTCP compound packet
+class SourcesLockThread : public JThread
+{
+public:
+	SourcesLockThread(RTPSession &s) : m_sess(s), m_locked(false)
+	{
+		m_mutex.Init();
+	}
+
+	~SourcesLockThread()
+	{
+		while (IsRunning())
+			RTPTime::Wait(RTPTime(0,10000));
+	}
+
+	bool IsLocked()
+	{
+		m_mutex.Lock();
+		bool l = m_locked;
+		m_mutex.Unlock();
+		return l;
+	}
+private:
+	void *Thread()
+	{
+		JThread::ThreadStarted();
+
+		m_sess.BeginDataAccess();
+		m_mutex.Lock();
+		m_locked = true;
+		m_mutex.Unlock();
+
+		RTPTime::Wait(RTPTime(SOURCESHOLDTIME));
+
+		m_mutex.Lock();
+		m_locked = false;
+		m_mutex.Unlock();
+		m_sess.EndDataAccess();
+		return 0;
+	}
+
+	RTPSession &m_sess;
+	JMutex m_mutex;
+	bool m_locked;
+};
+
+#endif // RTP_SUPPORT_THREAD
+
+void PrintHistogram(const char *name, const RTPHoldTimeHistogram &hist)
+{
+	cout << name << ": " << hist.GetTotalCount() << " times, max " << hist.GetMaximumTime().GetDouble()*1000000.0 << " us" << endl;
+	for (size_t i = 0 ; i < hist.GetNumberOfBuckets() ; i++)
+	{
+		if (hist.GetCount(i) != 0)
+			cout << "    < " << RTPHoldTimeHistogram::GetBucketLimit(i) << " us: " << hist.GetCount(i) << endl;
+	}
+}
+
+int main(void)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPSession sess1, sess2;
+	RTPSessionParams sessparams;
+	RTPUDPv4TransmissionParams transparams;
+	RTPHoldTimeHistogram hist;
+	int status = 0;
+
+	sessparams.SetOwnTimestampUnit(1.0/8000.0);
+	sessparams.SetCollectLockHoldTimes(true);
+	transparams.SetBindIP(localip);
+	transparams.SetPortbase(PORTBASE);
+	checkerror(sess1.Create(sessparams,&transparams));
+	transparams.SetPortbase(PORTBASE+2);
+	checkerror(sess2.Create(sessparams,&transparams));
+	checkerror(sess1.AddDestination(RTPIPv4Address(localip,PORTBASE+2)));
+	checkerror(sess2.AddDestination(RTPIPv4Address(localip,PORTBASE)));
+
+	int err = sess1.GetLockHoldTimes(RTPSession::SourcesLock, hist);
+
+	if (err == ERR_RTP_SESSION_NOLOCKHOLDTIMES)
+	{
+		// Without thread support there are no locks
+		cout << "Lock hold times are not available" << endl;
+		sess1.Destroy();
+		sess2.Destroy();
+		return 0;
+	}
+	checkerror(err);
+
+	// Keep sending packets until both sessions have built a few RTCP compound packets, 
+	// and keep track of how long sending an RTP packet can take
+	uint8_t payload[160] = { 0 };
+	RTPTime starttime = RTPTime::CurrentTime();
+	double maxsendtime = 0;
+	bool done = false;
+
+	while (!done && RTPTime::CurrentTime().GetDouble() - starttime.GetDouble() < 15.0)
+	{
+		RTPTime t0 = RTPTime::CurrentTime();
+
+		checkerror(sess1.SendPacket(payload,sizeof(payload),0,false,160));
+
+		double t = RTPTime::CurrentTime().GetDouble() - t0.GetDouble();
+
+		if (t > maxsendtime)
+			maxsendtime = t;
+		checkerror(sess2.SendPacket(payload,sizeof(payload),0,false,160));
+
+		RTPTime::Wait(RTPTime(0,1000));
+
+		RTPHoldTimeHistogram hist1, hist2;
+
+		checkerror(sess1.GetLockHoldTimes(RTPSession::RTCPBuilderLock, hist1));
+		checkerror(sess2.GetLockHoldTimes(RTPSession::RTCPBuilderLock, hist2));
+		if (hist1.GetTotalCount() >= 2 && hist2.GetTotalCount() >= 2)
+			done = true;
+	}
+
+	if (!done)
+	{
+		cout << "ERROR: no RTCP packets were built" << endl;
+		status = -1;
+	}
+
+	const char *names[] = { "Sources lock", "RTP packet builder lock", "RTCP packet builder lock", "Scheduler lock", "Packet sent lock" };
+	RTPSession::SessionLock locks[] = { RTPSession::SourcesLock, RTPSession::PacketBuilderLock, RTPSession::RTCPBuilderLock,
+	                                    RTPSession::SchedulerLock, RTPSession::PacketSentLock };
+
+	for (int i = 0 ; i < 5 ; i++)
+	{
+		checkerror(sess1.GetLockHoldTimes(locks[i], hist));
+		if (hist.GetTotalCount() == 0)
+		{
+			cout << "ERROR: no hold times for the " << names[i] << endl;
+			status = -1;
+		}
+		PrintHistogram(names[i], hist);
+	}
+	cout << "Longest SendPacket call: " << maxsendtime*1000000.0 << " us" << endl;
+
+#ifdef RTP_SUPPORT_THREAD
+	// Sending an RTP packet must not have to wait until the source table is released again,
+	// otherwise each RTCP compound packet that's built stalls the sender
+	SourcesLockThread lockthread(sess1);
+
+	if (lockthread.Start() < 0)
+	{
+		cout << "ERROR: can't start thread" << endl;
+		status = -1;
+	}
+	else
+	{
+		while (!lockthread.IsLocked())
+			RTPTime::Wait(RTPTime(0,1000));
+
+		RTPTime lockedtime = RTPTime::CurrentTime();
+		double maxlockedsendtime = 0;
+
+		while (RTPTime::CurrentTime().GetDouble() - lockedtime.GetDouble() < SOURCESHOLDTIME/2.0)
+		{
+			RTPTime t0 = RTPTime::CurrentTime();
+
+			checkerror(sess1.SendPacket(payload,sizeof(payload),0,false,160));
+
+			double t = RTPTime::CurrentTime().GetDouble() - t0.GetDouble();
+
+			if (t > maxlockedsendtime)
+				maxlockedsendtime = t;
+			RTPTime::Wait(RTPTime(0,1000));
+		}
+		cout << "Longest SendPacket call while the source table is locked: " << maxlockedsendtime*1000000.0 << " us" << endl;
+		if (maxlockedsendtime > MAXSENDTIME)
+		{
+			cout << "ERROR: SendPacket waited for the source table" << endl;
+			status = -1;
+		}
+	}
+#endif // RTP_SUPPORT_THREAD
+
+	sess1.BYEDestroy(RTPTime(0,0),0,0);
+	sess2.BYEDestroy(RTPTime(0,0),0,0);
+	return status;
+}
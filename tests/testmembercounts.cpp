@@ -0,0 +1,123 @@
+#include "rtpsources.h"
+#include "rtpsourcedata.h"
+#include "rtppacket.h"
+#include "rtcpsdespacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+// Compares the counts that are kept up to date by RTPSources with the ones
+// obtained by iterating over all participants
+void CheckCounts(RTPSources &sources, const char *step)
+{
+	int total = 0, senders = 0, active = 0;
+
+	if (sources.GotoFirstSource())
+	{
+		do
+		{
+			RTPSourceData *s = sources.GetCurrentSourceInfo();
+
+			total++;
+			if (s->IsSender())
+				senders++;
+			if (s->IsActive())
+				active++;
+		} while (sources.GotoNextSource());
+	}
+
+	if (total != sources.GetTotalCount() || senders != sources.GetSenderCount() || active != sources.GetActiveMemberCount())
+	{
+		cout << "FAILED after " << step << ": counted " << total << "/" << senders << "/" << active
+		     << " participants/senders/active, but got " << sources.GetTotalCount() << "/"
+		     << sources.GetSenderCount() << "/" << sources.GetActiveMemberCount() << endl;
+		exit(-1);
+	}
+	cout << step << ": " << total << " participants, " << senders << " senders, " << active << " active" << endl;
+}
+
+void SendRTP(RTPSources &sources, uint32_t ssrc, uint16_t seqnr, const RTPTime &t, int numcsrcs = 0, const uint32_t *csrcs = 0)
+{
+	RTPPacket *pack = new RTPPacket(0, "x", 1, seqnr, 0, ssrc, false, numcsrcs, csrcs, false, 0, 0, 0, 1500);
+	bool stored;
+
+	checkerror(pack->GetCreationError());
+	checkerror(sources.ProcessRTPPacket(pack, t, 0, &stored));
+	if (!stored)
+		delete pack;
+}
+
+int main(void)
+{
+	RTPSources sources(RTPSources::NoProbation);
+	RTPTime t0(1000, 0), t1(1005, 0);
+	const char cname[] = "user@host";
+
+	checkerror(sources.CreateOwnSSRC(1));
+	sources.SentRTPPacket();
+	CheckCounts(sources, "own SSRC");
+
+	// Participants that are only known through RTCP aren't validated
+	for (uint32_t ssrc = 100 ; ssrc < 120 ; ssrc++)
+		checkerror(sources.UpdateReceiveTime(ssrc, t0, 0));
+	CheckCounts(sources, "RTCP");
+
+	// A CNAME validates a participant
+	for (uint32_t ssrc = 100 ; ssrc < 105 ; ssrc++)
+		checkerror(sources.ProcessSDESNormalItem(ssrc, RTCPSDESPacket::CNAME, sizeof(cname)-1, cname, t0, 0));
+	CheckCounts(sources, "CNAME");
+
+	// RTP packets create senders, some of them for participants known from RTCP
+	for (uint32_t ssrc = 110 ; ssrc < 130 ; ssrc++)
+		SendRTP(sources, ssrc, 1, t0);
+	CheckCounts(sources, "RTP");
+
+	// Contributing sources, both new ones and ones known from RTCP
+	uint32_t csrcs[] = { 115, 116, 200, 201 };
+
+	SendRTP(sources, 105, 1, t0, 4, csrcs);
+	uint32_t csrcs2[] = { 107, 108, 109 };
+	SendRTP(sources, 106, 1, t0, 3, csrcs2);
+	CheckCounts(sources, "CSRC");
+
+	// BYE packets, some for senders
+	for (uint32_t ssrc = 100 ; ssrc < 130 ; ssrc += 3)
+		checkerror(sources.ProcessBYE(ssrc, 0, 0, t0, 0));
+	CheckCounts(sources, "BYE");
+
+	// Some senders continue
+	for (uint32_t ssrc = 120 ; ssrc < 125 ; ssrc++)
+		SendRTP(sources, ssrc, 2, t1);
+	CheckCounts(sources, "RTP");
+
+	RTPTime sendertimeout(2, 0), byetimeout(1, 0), generaltimeout(20, 0), notetimeout(30, 0);
+
+	sources.MultipleTimeouts(RTPTime(1006, 0), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	CheckCounts(sources, "sender and BYE timeouts");
+
+	sources.SenderTimeout(RTPTime(1010, 0), sendertimeout);
+	CheckCounts(sources, "SenderTimeout");
+
+	sources.Timeout(RTPTime(1021, 0), generaltimeout);
+	CheckCounts(sources, "Timeout");
+
+	sources.MultipleTimeouts(RTPTime(1100, 0), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	CheckCounts(sources, "all timeouts");
+
+	checkerror(sources.DeleteOwnSSRC());
+	CheckCounts(sources, "own SSRC removed");
+	return 0;
+}
@@ -0,0 +1,183 @@
+#include "rtpportset.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#include <set>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+// Checks that the port set contains exactly the ports in the reference set
+bool CompareSets(const RTPPortSet &ports, const std::set<uint16_t> &reference)
+{
+	if (ports.GetNumberOfPorts() != reference.size())
+		return false;
+
+	std::set<uint16_t>::const_iterator it = reference.begin();
+
+	for (int port = ports.GetNextPort(-1) ; port >= 0 ; port = ports.GetNextPort(port), ++it)
+	{
+		if (it == reference.end() || *it != (uint16_t)port)
+			return false;
+	}
+	if (it != reference.end())
+		return false;
+
+	for (it = reference.begin() ; it != reference.end() ; ++it)
+	{
+		if (!ports.Contains(*it))
+			return false;
+	}
+	return true;
+}
+
+int TestPortSet()
+{
+	RTPPortSet ports;
+	std::set<uint16_t> reference;
+
+	srand(1234);
+
+	// First use a small range of ports so that the inline array is used and
+	// ports are removed again, then use more and more ports so the set
+	// switches to a bitmap
+	for (int round = 0 ; round < 4 ; round++)
+	{
+		int range = (round == 0)?(RTPPORTSET_INLINESIZE*2):(100 << (round*4));
+		if (range > 65536)
+			range = 65536;
+
+		for (int i = 0 ; i < 2000 ; i++)
+		{
+			uint16_t port = (uint16_t)(rand()%range);
+
+			if (rand()%3 == 0)
+			{
+				bool removed = ports.Remove(port);
+				if (removed != (reference.erase(port) != 0))
+				{
+					cout << "ERROR: unexpected result when removing port " << port << endl;
+					return -1;
+				}
+			}
+			else
+			{
+				checkerror(ports.Add(port));
+				reference.insert(port);
+			}
+		}
+
+		if (!CompareSets(ports,reference))
+		{
+			cout << "ERROR: port set differs from reference in round " << round << endl;
+			return -1;
+		}
+		cout << "Round " << round << ": " << ports.GetNumberOfPorts() << " ports in set" << endl;
+	}
+
+	ports.Clear();
+	reference.clear();
+	if (!CompareSets(ports,reference) || ports.Contains(0))
+	{
+		cout << "ERROR: port set not empty after clearing it" << endl;
+		return -1;
+	}
+	return 0;
+}
+
+#define NUMGATEWAYPORTS 5000
+
+int TestAcceptList()
+{
+	// Accept a large number of ports from one host, as can be the case for a
+	// gateway which uses a different port for each call
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter receiver(0), sender1(0), sender2(0);
+	RTPUDPv4TransmissionParams params;
+	uint8_t packet[100] = { 0x80, 0 };
+
+	params.SetBindIP(localip);
+	params.SetPortbase(5000);
+	checkerror(receiver.Init(false));
+	checkerror(receiver.Create(1400,&params));
+	params.SetPortbase(5002);
+	checkerror(sender1.Init(false));
+	checkerror(sender1.Create(1400,&params));
+	params.SetPortbase(5004);
+	checkerror(sender2.Init(false));
+	checkerror(sender2.Create(1400,&params));
+	checkerror(sender1.AddDestination(RTPIPv4Address(localip,5000)));
+	checkerror(sender2.AddDestination(RTPIPv4Address(localip,5000)));
+
+	checkerror(receiver.SetReceiveMode(RTPTransmitter::AcceptSome));
+	for (int i = 0 ; i < NUMGATEWAYPORTS ; i++)
+	{
+		uint16_t port = (uint16_t)(20000+i);
+		if (port == 5004)
+			continue;
+		checkerror(receiver.AddToAcceptList(RTPIPv4Address(localip,port)));
+	}
+	checkerror(receiver.AddToAcceptList(RTPIPv4Address(localip,5002)));
+
+	checkerror(sender1.SendRTPData(packet,sizeof(packet)));
+	checkerror(sender2.SendRTPData(packet,sizeof(packet)));
+	RTPTime::Wait(RTPTime(0,100000));
+	checkerror(receiver.Poll());
+
+	RTPRawPacket *pack;
+	int count = 0, status = 0;
+
+	while ((pack = receiver.GetNextPacket()) != 0)
+	{
+		if (((const RTPIPv4Address *)pack->GetSenderAddress())->GetPort() != 5002)
+		{
+			cout << "ERROR: received packet from port that isn't accepted" << endl;
+			status = -1;
+		}
+		count++;
+		delete pack;
+	}
+	cout << "Received " << count << " packets with " << NUMGATEWAYPORTS+1 << " accepted ports, socket filter in use: "
+	     << ((receiver.IsUsingSocketFilter())?"yes":"no") << endl;
+	if (count != 1)
+	{
+		cout << "ERROR: expected one packet" << endl;
+		status = -1;
+	}
+
+	receiver.Destroy();
+	sender1.Destroy();
+	sender2.Destroy();
+	return status;
+}
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	int status = TestPortSet();
+	if (status == 0)
+		status = TestAcceptList();
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	return status;
+}
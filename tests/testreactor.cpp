@@ -0,0 +1,198 @@
+#include "rtpconfig.h"
+#include <iostream>
+
+#if defined(RTP_SUPPORT_THREAD) && defined(RTP_HAVE_EPOLL)
+
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtpsourcedata.h"
+#include "rtppacket.h"
+#include "rtpreactor.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMSESSIONS 16
+#define NUMTHREADS 2
+#define NUMPACKETS 50
+#define PORTBASE 32000
+
+class CountingSession : public RTPSession
+{
+public:
+	CountingSession() : steps(0), errors(0)						{ }
+
+	int steps;
+	int errors;
+protected:
+	void OnPollThreadStep()										{ steps++; }
+	void OnPollThreadError(int)									{ errors++; }
+};
+
+int main(void)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	CountingSession sessions[NUMSESSIONS];
+	RTPReactor reactor;
+	int status = 0;
+
+	checkerror(reactor.Start(NUMTHREADS));
+
+	// Each session sends to the next one, none of them has a poll thread of its own
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+	{
+		RTPSessionParams sessparams;
+		RTPUDPv4TransmissionParams transparams;
+
+		sessparams.SetOwnTimestampUnit(1.0/8000.0);
+		sessparams.SetUsePollThread(false);
+		sessparams.SetMinimumRTCPTransmissionInterval(RTPTime(1,0));
+		transparams.SetBindIP(localip);
+		transparams.SetPortbase(PORTBASE+2*i);
+		checkerror(sessions[i].Create(sessparams,&transparams));
+
+		int nextport = PORTBASE+2*((i+1)%NUMSESSIONS);
+		checkerror(sessions[i].AddDestination(RTPIPv4Address(localip,nextport)));
+		checkerror(reactor.AddSession(sessions[i]));
+	}
+
+	if (reactor.GetNumberOfSessions() != NUMSESSIONS)
+	{
+		cout << "ERROR: expected " << NUMSESSIONS << " sessions, reactor has " << reactor.GetNumberOfSessions() << endl;
+		status = -1;
+	}
+	if (reactor.AddSession(sessions[0]) != ERR_RTP_REACTOR_SESSIONALREADYADDED)
+	{
+		cout << "ERROR: adding a session twice should fail" << endl;
+		status = -1;
+	}
+
+	// A session with its own poll thread can't be served by the reactor
+	{
+		RTPSession pollsession;
+		RTPSessionParams sessparams;
+		RTPUDPv4TransmissionParams transparams;
+
+		sessparams.SetOwnTimestampUnit(1.0/8000.0);
+		transparams.SetPortbase(PORTBASE+2*NUMSESSIONS);
+		checkerror(pollsession.Create(sessparams,&transparams));
+		if (reactor.AddSession(pollsession) != ERR_RTP_REACTOR_INVALIDSESSION)
+		{
+			cout << "ERROR: a session with a poll thread was accepted" << endl;
+			status = -1;
+		}
+		pollsession.BYEDestroy(RTPTime(0,0),0,0);
+	}
+
+	uint8_t payload[160] = { 0 };
+
+	for (int n = 0 ; n < NUMPACKETS ; n++)
+	{
+		for (int i = 0 ; i < NUMSESSIONS ; i++)
+			checkerror(sessions[i].SendPacket(payload,sizeof(payload),0,false,160));
+		RTPTime::Wait(RTPTime(0,2000));
+	}
+
+	// The RTCP deadlines of the sessions are handled by the reactor as well, wait
+	// until every session has received a sender report from its neighbour
+	int numpackets[NUMSESSIONS] = { 0 };
+	bool gotsr[NUMSESSIONS] = { false };
+	RTPTime starttime = RTPTime::CurrentTime();
+	bool done = false;
+
+	while (!done && RTPTime::CurrentTime().GetDouble() - starttime.GetDouble() < 10.0)
+	{
+		RTPTime::Wait(RTPTime(0,100000));
+
+		done = true;
+		for (int i = 0 ; i < NUMSESSIONS ; i++)
+		{
+			sessions[i].BeginDataAccess();
+			if (sessions[i].GotoFirstSource())
+			{
+				do
+				{
+					RTPPacket *pack;
+
+					while ((pack = sessions[i].GetNextPacket()) != 0)
+					{
+						numpackets[i]++;
+						sessions[i].DeletePacket(pack);
+					}
+					if (sessions[i].GetCurrentSourceInfo()->SR_HasInfo())
+						gotsr[i] = true;
+				} while (sessions[i].GotoNextSource());
+			}
+			sessions[i].EndDataAccess();
+
+			if (!gotsr[i])
+				done = false;
+		}
+	}
+
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+	{
+		if (numpackets[i] != NUMPACKETS)
+		{
+			cout << "ERROR: session " << i << " received " << numpackets[i] << " packets instead of " << NUMPACKETS << endl;
+			status = -1;
+		}
+		if (!gotsr[i])
+		{
+			cout << "ERROR: session " << i << " didn't receive a sender report" << endl;
+			status = -1;
+		}
+	}
+
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+	{
+		checkerror(reactor.RemoveSession(sessions[i]));
+		if (sessions[i].errors != 0 || sessions[i].steps == 0)
+		{
+			cout << "ERROR: session " << i << " had " << sessions[i].errors << " errors and " << sessions[i].steps << " steps" << endl;
+			status = -1;
+		}
+	}
+	if (reactor.RemoveSession(sessions[0]) != ERR_RTP_REACTOR_SESSIONNOTFOUND)
+	{
+		cout << "ERROR: removing a session twice should fail" << endl;
+		status = -1;
+	}
+	if (reactor.GetNumberOfSessions() != 0)
+	{
+		cout << "ERROR: sessions left in the reactor" << endl;
+		status = -1;
+	}
+	reactor.Stop();
+
+	for (int i = 0 ; i < NUMSESSIONS ; i++)
+		sessions[i].BYEDestroy(RTPTime(0,0),0,0);
+
+	if (status == 0)
+		cout << "All sessions were served by " << NUMTHREADS << " reactor threads" << endl;
+	return status;
+}
+
+#else
+
+int main(void)
+{
+	std::cout << "Thread support or epoll is not available, skipping the reactor test" << std::endl;
+	return 0;
+}
+
+#endif // RTP_SUPPORT_THREAD && RTP_HAVE_EPOLL
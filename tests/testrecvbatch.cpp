@@ -0,0 +1,86 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpudpreceivebatch.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	RTPUDPv4Transmitter trans(0);
+	RTPUDPv4TransmissionParams params;
+	uint8_t packet[100] = { 0x80, 0 };
+	int num = 100;
+	int status;
+
+	params.SetPortbase(5000);
+	params.SetBindIP(ntohl(inet_addr("127.0.0.1")));
+	params.SetRTPReceiveBuffer(1024*1024);
+	params.SetReceiveBatchSize(16);
+
+	checkerror(trans.Init(false));
+	checkerror(trans.Create(1400,&params));
+	checkerror(trans.AddDestination(RTPIPv4Address(ntohl(inet_addr("127.0.0.1")),5000)));
+
+	for (int i = 0 ; i < num ; i++)
+		checkerror(trans.SendRTPData(packet,sizeof(packet)));
+
+	RTPTime::Wait(RTPTime(0,100000));
+	checkerror(trans.Poll());
+
+	int count = 0;
+	RTPRawPacket *pack;
+
+	while ((pack = trans.GetNextPacket()) != 0)
+	{
+		if (pack->GetDataLength() != sizeof(packet))
+			cout << "Received packet with unexpected length " << pack->GetDataLength() << endl;
+		count++;
+		delete pack;
+	}
+	cout << "Received " << count << "/" << num << " packets" << endl;
+
+	RTPReceiveBatchStatistics stats;
+
+	status = trans.GetReceiveBatchStatistics(stats);
+	checkerror(status);
+
+	cout << "Batch size:      " << stats.GetBatchSize() << endl;
+	cout << "Batches:         " << stats.GetNumberOfBatches() << endl;
+	cout << "Full batches:    " << stats.GetNumberOfFullBatches() << endl;
+	cout << "Empty calls:     " << stats.GetNumberOfEmptyCalls() << endl;
+	cout << "Datagrams:       " << stats.GetNumberOfDatagrams() << endl;
+	cout << "Average fill:    " << stats.GetAverageFill() << endl;
+
+	trans.Destroy();
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	if (count != num)
+	{
+		cout << "ERROR: not all packets were received" << endl;
+		return -1;
+	}
+	return 0;
+}
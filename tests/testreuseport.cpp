@@ -0,0 +1,170 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#include <map>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMSHARDS 3
+#define NUMSOURCES 12
+#define NUMPACKETS 10
+
+static uint32_t GetSSRC(const uint8_t *data, size_t offset)
+{
+	return ((uint32_t)data[offset] << 24)|((uint32_t)data[offset+1] << 16)|((uint32_t)data[offset+2] << 8)|(uint32_t)data[offset+3];
+}
+
+int TestShards(uint16_t portbase, bool rtcpmux)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter *shards[NUMSHARDS];
+	RTPUDPv4Transmitter sender(0);
+	RTPUDPv4TransmissionParams params;
+
+	// All shards are bound to the same ports; the order in which they are
+	// created determines their position in the group
+	params.SetBindIP(localip);
+	params.SetPortbase(portbase);
+	params.SetRTCPMultiplexing(rtcpmux);
+	params.SetRTPReceiveBuffer(1024*1024);
+	params.SetReusePortShards(NUMSHARDS);
+#ifdef RTP_SUPPORT_REUSEPORTSTEERING
+	params.SetUseSSRCSteering(true);
+#endif // RTP_SUPPORT_REUSEPORTSTEERING
+	for (int i = 0 ; i < NUMSHARDS ; i++)
+	{
+		shards[i] = new RTPUDPv4Transmitter(0);
+		checkerror(shards[i]->Init(false));
+		checkerror(shards[i]->Create(1400,&params));
+	}
+
+	RTPUDPv4TransmissionParams senderparams;
+
+	senderparams.SetBindIP(localip);
+	senderparams.SetPortbase(portbase+100);
+	senderparams.SetRTCPMultiplexing(rtcpmux);
+	checkerror(sender.Init(false));
+	checkerror(sender.Create(1400,&senderparams));
+	checkerror(sender.AddDestination(RTPIPv4Address(localip,portbase,rtcpmux)));
+
+	// Send RTP packets with increasing sequence numbers for a number of
+	// sources, and an RTCP receiver report for each source
+	for (int n = 0 ; n < NUMPACKETS ; n++)
+	{
+		for (uint32_t src = 0 ; src < NUMSOURCES ; src++)
+		{
+			uint32_t ssrc = 0x10000000 + src*7;
+			uint8_t packet[20] = { 0x80, 96, 0, (uint8_t)n, 0, 0, 0, 0,
+			                       (uint8_t)(ssrc >> 24), (uint8_t)(ssrc >> 16), (uint8_t)(ssrc >> 8), (uint8_t)ssrc };
+			checkerror(sender.SendRTPData(packet,sizeof(packet)));
+		}
+	}
+	for (uint32_t src = 0 ; src < NUMSOURCES ; src++)
+	{
+		uint32_t ssrc = 0x10000000 + src*7;
+		uint8_t rr[8] = { 0x80, 201, 0, 1, (uint8_t)(ssrc >> 24), (uint8_t)(ssrc >> 16), (uint8_t)(ssrc >> 8), (uint8_t)ssrc };
+		checkerror(sender.SendRTCPData(rr,sizeof(rr)));
+	}
+
+	RTPTime::Wait(RTPTime(0,100000));
+
+	int status = 0, totalrtp = 0, totalrtcp = 0;
+
+	for (int i = 0 ; i < NUMSHARDS ; i++)
+	{
+		std::map<uint32_t,int> lastseqnr;
+		RTPRawPacket *pack;
+		int numrtp = 0, numrtcp = 0;
+
+		checkerror(shards[i]->Poll());
+		while ((pack = shards[i]->GetNextPacket()) != 0)
+		{
+			const uint8_t *data = pack->GetData();
+			uint32_t ssrc;
+
+			if (pack->IsRTP())
+			{
+				ssrc = GetSSRC(data,8);
+				numrtp++;
+
+				// The packets of a source should still be in order
+				std::map<uint32_t,int>::iterator it = lastseqnr.find(ssrc);
+				if (it != lastseqnr.end() && data[3] != it->second+1)
+				{
+					cout << "ERROR: packets of SSRC " << ssrc << " out of order" << endl;
+					status = -1;
+				}
+				lastseqnr[ssrc] = data[3];
+			}
+			else
+			{
+				ssrc = GetSSRC(data,4);
+				numrtcp++;
+			}
+#ifdef RTP_SUPPORT_REUSEPORTSTEERING
+			if (ssrc%NUMSHARDS != (uint32_t)i)
+			{
+				cout << "ERROR: packet for SSRC " << ssrc << " arrived at shard " << i << endl;
+				status = -1;
+			}
+#endif // RTP_SUPPORT_REUSEPORTSTEERING
+			delete pack;
+		}
+		cout << "Shard " << i << ": " << numrtp << " RTP packets, " << numrtcp << " RTCP packets" << endl;
+		totalrtp += numrtp;
+		totalrtcp += numrtcp;
+	}
+
+	for (int i = 0 ; i < NUMSHARDS ; i++)
+	{
+		shards[i]->Destroy();
+		delete shards[i];
+	}
+	sender.Destroy();
+
+	if (totalrtp != NUMSOURCES*NUMPACKETS || totalrtcp != NUMSOURCES)
+	{
+		cout << "ERROR: not all packets were received" << endl;
+		status = -1;
+	}
+	return status;
+}
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	int status = 0;
+
+#ifdef RTP_HAVE_SO_REUSEPORT
+	cout << "Separate RTCP port:" << endl;
+	status |= TestShards(5000,false);
+	cout << "RTCP multiplexing:" << endl;
+	status |= TestShards(5010,true);
+#else
+	cout << "SO_REUSEPORT is not supported, skipping test" << endl;
+#endif // RTP_HAVE_SO_REUSEPORT
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	return status;
+}
@@ -0,0 +1,155 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMRECEIVERS 4
+#define NUMBURSTPACKETS 41
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter sender(0);
+	RTPUDPv4Transmitter *receivers[NUMRECEIVERS];
+	RTPUDPv4TransmissionParams params;
+	uint8_t packet[100] = { 0x80, 0 };
+	int num = 10;
+
+	params.SetPortbase(5000);
+	params.SetBindIP(localip);
+	checkerror(sender.Init(false));
+	checkerror(sender.Create(1400,&params));
+
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		RTPUDPv4TransmissionParams recvparams;
+
+		recvparams.SetPortbase(5002+r*2);
+		recvparams.SetBindIP(localip);
+		recvparams.SetRTPReceiveBuffer(1024*1024);
+		recvparams.SetUseReceiveOffload(r%2 == 0); // let the kernel coalesce the packets for some receivers
+		if (r == 0)
+			recvparams.SetReceiveBatchSize(0); // reads datagrams one by one, also when offload is used
+		receivers[r] = new RTPUDPv4Transmitter(0);
+		checkerror(receivers[r]->Init(false));
+		checkerror(receivers[r]->Create(1400,&recvparams));
+		checkerror(sender.AddDestination(RTPIPv4Address(localip,5002+r*2)));
+	}
+
+	// Sending to the broadcast address is not allowed since SO_BROADCAST
+	// isn't set, which should be reported for this destination only
+	checkerror(sender.AddDestination(RTPIPv4Address(0xffffffff,5010)));
+
+	for (int i = 0 ; i < num ; i++)
+		checkerror(sender.SendRTPData(packet,sizeof(packet)));
+
+	RTPTime::Wait(RTPTime(0,100000));
+
+	int total = 0;
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		RTPRawPacket *pack;
+		int count = 0;
+
+		checkerror(receivers[r]->Poll());
+		while ((pack = receivers[r]->GetNextPacket()) != 0)
+		{
+			count++;
+			delete pack;
+		}
+		cout << "Receiver " << r << " got " << count << "/" << num << " packets" << endl;
+		total += count;
+	}
+
+	RTPIPv4Address addr;
+	bool rtp;
+	int errcode, numerrors = 0;
+
+	while (sender.GetNextSendError(addr,rtp,errcode))
+	{
+		cout << "Send error for port " << addr.GetPort() << ((rtp)?" (RTP): ":" (RTCP): ") << strerror(errcode) << endl;
+		if (addr.GetIP() != 0xffffffff)
+		{
+			cout << "ERROR: unexpected destination in send error" << endl;
+			return -1;
+		}
+		numerrors++;
+	}
+	cout << "Total number of send errors: " << sender.GetNumberOfSendErrors() << endl;
+
+	// Now send a burst of equally sized packets followed by a shorter one, like
+	// a video frame that's been split up; if possible this is handed to the
+	// kernel at once
+	uint8_t burstdata[NUMBURSTPACKETS][1200];
+	const void *burstpackets[NUMBURSTPACKETS];
+	size_t burstlengths[NUMBURSTPACKETS];
+
+	for (int i = 0 ; i < NUMBURSTPACKETS ; i++)
+	{
+		memset(burstdata[i],i,sizeof(burstdata[i]));
+		burstdata[i][0] = 0x80;
+		burstpackets[i] = burstdata[i];
+		burstlengths[i] = (i == NUMBURSTPACKETS-1)?500:1200;
+	}
+	checkerror(sender.SendRTPDataBurst(burstpackets,burstlengths,NUMBURSTPACKETS));
+
+	RTPTime::Wait(RTPTime(0,100000));
+
+	int bursttotal = 0;
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		RTPRawPacket *pack;
+		int count = 0;
+
+		checkerror(receivers[r]->Poll());
+		while ((pack = receivers[r]->GetNextPacket()) != 0)
+		{
+			if (count < NUMBURSTPACKETS && (pack->GetDataLength() != burstlengths[count] || pack->GetData()[1] != (uint8_t)count))
+				cout << "ERROR: packet " << count << " of burst has unexpected contents" << endl;
+			else
+				bursttotal++;
+			count++;
+			delete pack;
+		}
+		cout << "Receiver " << r << " got " << count << "/" << NUMBURSTPACKETS << " packets from burst" << endl;
+	}
+
+	for (int r = 0 ; r < NUMRECEIVERS ; r++)
+	{
+		receivers[r]->Destroy();
+		delete receivers[r];
+	}
+	sender.Destroy();
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	if (total != num*NUMRECEIVERS || numerrors != num || bursttotal != NUMBURSTPACKETS*NUMRECEIVERS)
+	{
+		cout << "ERROR: unexpected number of packets or send errors" << endl;
+		return -1;
+	}
+	return 0;
+}
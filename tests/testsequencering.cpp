@@ -0,0 +1,272 @@
+#include "rtpsequencering.h"
+#include "rtpsources.h"
+#include "rtpsourcedata.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+#include <list>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+void fail(const char *msg)
+{
+	cout << "FAILED: " << msg << endl;
+	exit(-1);
+}
+
+RTPPacket *CreatePacket(uint32_t extseqnr, uint32_t ssrc = 1234)
+{
+	RTPPacket *pack = new RTPPacket(0, "x", 1, (uint16_t)extseqnr, 0, ssrc, false, 0, 0, false, 0, 0, 0, 1500);
+
+	checkerror(pack->GetCreationError());
+	pack->SetExtendedSequenceNumber(extseqnr);
+	return pack;
+}
+
+// Compares the ring with a map that's kept up to date in the same way
+void TestRing(uint32_t windowsize, uint32_t startseqnr)
+{
+	RTPSequenceRing ring;
+	map<uint32_t, RTPPacket *> reference; // keyed by the distance to startseqnr
+	uint32_t highest = 0;
+
+	for (int step = 0 ; step < 20000 ; step++)
+	{
+		int r = rand()%10;
+
+		if (r < 7)
+		{
+			// Mostly packets around the highest one, sometimes a large jump
+			uint32_t dist = highest;
+			int r2 = rand()%20;
+
+			if (r2 == 0)
+				dist += rand()%(windowsize*3);
+			else if (r2 < 5 && dist > windowsize/2)
+				dist -= rand()%(windowsize/2+2);
+			else
+				dist += rand()%3;
+			if (dist > highest)
+				highest = dist;
+
+			RTPPacket *p = CreatePacket(startseqnr+dist);
+			bool stored;
+			bool expected = true;
+			
+			if (reference.find(dist) != reference.end())
+				expected = false;
+			else if (!reference.empty() && dist < reference.begin()->first && reference.rbegin()->first-dist+1 > windowsize)
+				expected = false;
+
+			checkerror(ring.Insert(p, windowsize, &stored));
+			if (stored != expected)
+				fail("Packet was stored unexpectedly or wasn't stored");
+			if (!stored)
+			{
+				delete p;
+				continue;
+			}
+
+			reference[dist] = p;
+			// Packets that fall out of the window are deleted by the ring
+			while (reference.rbegin()->first-reference.begin()->first+1 > windowsize)
+				reference.erase(reference.begin());
+		}
+		else
+		{
+			RTPPacket *p = ring.Pop();
+
+			if (reference.empty())
+			{
+				if (p != 0)
+					fail("Packet returned by empty ring");
+				continue;
+			}
+			if (p != reference.begin()->second)
+				fail("Wrong packet returned");
+			reference.erase(reference.begin());
+			delete p;
+		}
+
+		if (ring.GetNumberOfPackets() != reference.size())
+			fail("Wrong number of packets");
+		if (ring.GetCapacity() > windowsize)
+			fail("Ring is larger than the window");
+	}
+	ring.Clear();
+	if (!ring.IsEmpty() || ring.GetCapacity() != 0)
+		fail("Ring wasn't cleared");
+}
+
+// Checks the queue of a participant in a source table
+void TestSources()
+{
+	RTPSources sources(RTPSources::NoProbation);
+	const uint16_t seqnrs[] = { 10, 12, 11, 15, 12, 14, 10, 13, 9 };
+	const size_t numseqnrs = sizeof(seqnrs)/sizeof(uint16_t);
+	size_t numstored = 0;
+
+	sources.SetPacketWindowSize(100);
+	if (sources.GetPacketWindowSize() != 128)
+		fail("Window size wasn't rounded up");
+
+	for (size_t i = 0 ; i < numseqnrs ; i++)
+	{
+		RTPPacket *pack = CreatePacket(seqnrs[i]);
+		bool stored;
+
+		checkerror(sources.ProcessRTPPacket(pack, RTPTime(1000, 0), 0, &stored));
+		if (stored)
+			numstored++;
+		else
+			delete pack;
+	}
+	if (numstored != 7)
+		fail("Duplicates were stored");
+
+	RTPSourceData *srcdat = sources.GetSourceInfo(1234);
+	RTPPacket *p;
+	uint16_t expected = 9;
+
+	if (srcdat == 0 || !srcdat->HasData())
+		fail("No packets stored");
+	while ((p = srcdat->GetNextPacket()) != 0)
+	{
+		if (p->GetSequenceNumber() != expected)
+			fail("Packets are returned in the wrong order");
+		expected++;
+		delete p;
+	}
+	if (expected != 16)
+		fail("Not all packets were returned");
+
+	// A jump beyond the window removes the older packets
+	for (uint16_t s = 20 ; s < 30 ; s++)
+	{
+		RTPPacket *pack = CreatePacket(s);
+		bool stored;
+
+		checkerror(sources.ProcessRTPPacket(pack, RTPTime(1001, 0), 0, &stored));
+		if (!stored)
+			fail("Packet wasn't stored");
+	}
+	RTPPacket *pack = CreatePacket(500);
+	bool stored;
+
+	checkerror(sources.ProcessRTPPacket(pack, RTPTime(1002, 0), 0, &stored));
+	if (!stored)
+		fail("Packet wasn't stored");
+	p = srcdat->GetNextPacket();
+	if (p == 0 || p->GetSequenceNumber() != 500 || srcdat->HasData())
+		fail("Old packets are still queued");
+	delete p;
+}
+
+// Time needed to store and retrieve packets of which every fourth one arrives late
+template<class Queue>
+double Measure(Queue &queue, uint32_t distance)
+{
+	const uint32_t numpackets = 200000;
+	vector<RTPPacket *> packets;
+
+	for (uint32_t i = 0 ; i < numpackets ; i++)
+		packets.push_back(CreatePacket(i));
+	for (uint32_t i = 0 ; i+distance < numpackets ; i += 4)
+		rotate(packets.begin()+i, packets.begin()+i+1, packets.begin()+i+distance+1);
+
+	RTPTime start = RTPTime::CurrentTime();
+	uint32_t numreceived = 0;
+
+	for (uint32_t i = 0 ; i < numpackets ; i++)
+	{
+		queue.Insert(packets[i]);
+		if (i%64 == 63)
+			numreceived += queue.PopAll();
+	}
+	numreceived += queue.PopAll();
+
+	RTPTime t = RTPTime::CurrentTime();
+
+	for (uint32_t i = 0 ; i < numpackets ; i++)
+		delete packets[i];
+	if (numreceived != numpackets)
+		fail("Not all packets were retrieved");
+	return (t.GetDouble()-start.GetDouble())*1e9/(double)numpackets;
+}
+
+class RingQueue
+{
+public:
+	RingQueue() : windowsize(RTPSequenceRing::GetWindowSize(RTP_DEFAULTPACKETWINDOWSIZE))	{ }
+	void Insert(RTPPacket *p)										{ bool stored; ring.Insert(p, windowsize, &stored); }
+	uint32_t PopAll()												{ uint32_t n = 0; while (ring.Pop() != 0) n++; return n; }
+private:
+	RTPSequenceRing ring;
+	uint32_t windowsize;
+};
+
+// The insertion the participant's queue used to do
+class ListQueue
+{
+public:
+	void Insert(RTPPacket *p)
+	{
+		list<RTPPacket *>::iterator it = packetlist.end();
+		uint32_t newseqnr = p->GetExtendedSequenceNumber();
+
+		while (it != packetlist.begin())
+		{
+			--it;
+			if ((*it)->GetExtendedSequenceNumber() < newseqnr)
+			{
+				++it;
+				break;
+			}
+			if ((*it)->GetExtendedSequenceNumber() == newseqnr)
+				return;
+		}
+		packetlist.insert(it, p);
+	}
+	uint32_t PopAll()												{ uint32_t n = (uint32_t)packetlist.size(); packetlist.clear(); return n; }
+private:
+	list<RTPPacket *> packetlist;
+};
+
+int main(void)
+{
+	srand(1234);
+	TestRing(1, 0);
+	TestRing(16, 100);
+	TestRing(256, 0xFFFFFF00); // the extended sequence numbers wrap around
+	TestRing(RTPSequenceRing::GetWindowSize(RTP_DEFAULTPACKETWINDOWSIZE), 0);
+	TestSources();
+
+	const uint32_t distances[] = { 1, 8, 60 };
+
+	cout << "All times in ns per packet" << endl;
+	for (size_t i = 0 ; i < sizeof(distances)/sizeof(uint32_t) ; i++)
+	{
+		RingQueue ring;
+		ListQueue lst;
+		double tring = Measure(ring, distances[i]);
+		double tlist = Measure(lst, distances[i]);
+
+		cout << "Late packets " << distances[i] << " positions behind: ring " << tring << ", list " << tlist << endl;
+	}
+	return 0;
+}
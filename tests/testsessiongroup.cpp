@@ -0,0 +1,182 @@
+#include "rtpconfig.h"
+#include <iostream>
+
+#if defined(RTP_SUPPORT_THREAD) && defined(RTP_HAVE_EPOLL)
+
+#include "rtpsession.h"
+#include "rtpsessionparams.h"
+#include "rtpsessiongroup.h"
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#include "rtppacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <jthread/jmutex.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <set>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMWORKERS 4
+#define NUMIDLEPAIRS 6
+#define NUMIDLEPACKETS 20
+#define NUMBUSYPACKETS 5000
+#define PORTBASE 33000
+
+jthread::JMutex workermutex;
+std::set<pthread_t> workers;
+
+// Counts the packets that arrive, and remembers which workers processed the sessions
+class GroupSession : public RTPSession
+{
+public:
+	GroupSession() : received(0), errors(0)						{ }
+
+	int received;
+	int errors;
+protected:
+	void OnRTPPacket(RTPPacket *, const RTPTime &, const RTPAddress *)	{ received++; }
+	void OnPollThreadError(int)									{ errors++; }
+	void OnPollThreadStep()
+	{
+		workermutex.Lock();
+		workers.insert(pthread_self());
+		workermutex.Unlock();
+	}
+};
+
+GroupSession *CreateSession(RTPSessionGroup &group, int index, int destindex)
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	GroupSession *sess = new GroupSession();
+	RTPSessionParams sessparams;
+	RTPUDPv4TransmissionParams transparams;
+
+	sessparams.SetOwnTimestampUnit(1.0/8000.0);
+	sessparams.SetUsePollThread(false);
+	transparams.SetBindIP(localip);
+	transparams.SetPortbase(PORTBASE+2*index);
+	transparams.SetRTPReceiveBuffer(4*1024*1024);
+	checkerror(sess->Create(sessparams,&transparams));
+	checkerror(sess->AddDestination(RTPIPv4Address(localip,PORTBASE+2*destindex)));
+	checkerror(group.AddSession(sess));
+	return sess;
+}
+
+int main(void)
+{
+	RTPSessionGroup group;
+	GroupSession *busy[2];
+	GroupSession *idle[NUMIDLEPAIRS*2];
+	int status = 0;
+
+	workermutex.Init();
+	checkerror(group.Create(NUMWORKERS));
+
+	// One busy conference of two sessions, and a number of quiet ones
+	busy[0] = CreateSession(group,0,1);
+	busy[1] = CreateSession(group,1,0);
+	for (int i = 0 ; i < NUMIDLEPAIRS*2 ; i++)
+		idle[i] = CreateSession(group,2+i,2+(i^1));
+
+	if (group.GetNumberOfSessions() != 2+NUMIDLEPAIRS*2)
+	{
+		cout << "ERROR: group has " << group.GetNumberOfSessions() << " sessions" << endl;
+		status = -1;
+	}
+
+	uint8_t payload[160] = { 0 };
+
+	for (int n = 0 ; n < NUMBUSYPACKETS ; n++)
+	{
+		checkerror(busy[0]->SendPacket(payload,sizeof(payload),0,false,160));
+		checkerror(busy[1]->SendPacket(payload,sizeof(payload),0,false,160));
+
+		if (n%(NUMBUSYPACKETS/NUMIDLEPACKETS) == 0)
+		{
+			for (int i = 0 ; i < NUMIDLEPAIRS*2 ; i++)
+				checkerror(idle[i]->SendPacket(payload,sizeof(payload),0,false,160));
+		}
+		if (n%100 == 0)
+			RTPTime::Wait(RTPTime(0,1000));
+	}
+
+	RTPTime::Wait(RTPTime(1,0));
+
+	// Remove one session again, it's ours to delete then
+	GroupSession *removed = idle[0];
+
+	checkerror(group.RemoveSession(removed));
+	if (group.RemoveSession(removed) != ERR_RTP_REACTOR_SESSIONNOTFOUND)
+	{
+		cout << "ERROR: removing a session twice should fail" << endl;
+		status = -1;
+	}
+
+	for (int i = 0 ; i < NUMIDLEPAIRS*2 ; i++)
+	{
+		// The packets are counted in the worker threads, so only look at them under the session lock
+		idle[i]->BeginDataAccess();
+		int received = idle[i]->received;
+		int errors = idle[i]->errors;
+		idle[i]->EndDataAccess();
+
+		if (received != NUMIDLEPACKETS || errors != 0)
+		{
+			cout << "ERROR: quiet session " << i << " received " << received << " of " << NUMIDLEPACKETS << " packets, " << errors << " errors" << endl;
+			status = -1;
+		}
+	}
+	for (int i = 0 ; i < 2 ; i++)
+	{
+		busy[i]->BeginDataAccess();
+		int received = busy[i]->received;
+		busy[i]->EndDataAccess();
+
+		if (received == 0)
+		{
+			cout << "ERROR: busy session " << i << " didn't receive anything" << endl;
+			status = -1;
+		}
+		cout << "Busy session " << i << " received " << received << " of " << NUMBUSYPACKETS << " packets" << endl;
+	}
+
+	workermutex.Lock();
+	size_t numworkers = workers.size();
+	workermutex.Unlock();
+
+	cout << "Sessions were processed by " << numworkers << " of " << group.GetNumberOfThreads() << " workers" << endl;
+	if (numworkers < 2)
+	{
+		cout << "ERROR: the work wasn't spread over the workers" << endl;
+		status = -1;
+	}
+
+	// Deletes the sessions that are still part of the group
+	group.Destroy(RTPTime(0,0),0,0);
+
+	removed->BYEDestroy(RTPTime(0,0),0,0);
+	delete removed;
+	return status;
+}
+
+#else
+
+int main(void)
+{
+	std::cout << "Thread support or epoll is not available, skipping the session group test" << std::endl;
+	return 0;
+}
+
+#endif // RTP_SUPPORT_THREAD && RTP_HAVE_EPOLL
@@ -0,0 +1,193 @@
+#include "rtpudpv4transmitter.h"
+#include "rtpipv4address.h"
+#ifdef RTP_SUPPORT_IPV6
+	#include "rtpudpv6transmitter.h"
+	#include "rtpipv6address.h"
+#endif // RTP_SUPPORT_IPV6
+#include "rtprawpacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+#define NUMPACKETS 20
+
+// Sends NUMPACKETS packets from both senders and returns the number of packets
+// that were received from each of them
+template<class Transmitter, class Address>
+void SendAndReceive(Transmitter &receiver, Transmitter &sender1, Transmitter &sender2, uint16_t port1, int &count1, int &count2)
+{
+	uint8_t packet[100] = { 0x80, 0 };
+
+	for (int i = 0 ; i < NUMPACKETS ; i++)
+	{
+		checkerror(sender1.SendRTPData(packet,sizeof(packet)));
+		checkerror(sender2.SendRTPData(packet,sizeof(packet)));
+	}
+
+	RTPTime::Wait(RTPTime(0,100000));
+	checkerror(receiver.Poll());
+
+	RTPRawPacket *pack;
+
+	count1 = 0;
+	count2 = 0;
+	while ((pack = receiver.GetNextPacket()) != 0)
+	{
+		if (((const Address *)pack->GetSenderAddress())->GetPort() == port1)
+			count1++;
+		else
+			count2++;
+		delete pack;
+	}
+}
+
+int CheckResult(const char *desc, int count1, int count2, int expected1, int expected2)
+{
+	cout << desc << ": " << count1 << " and " << count2 << " packets received" << endl;
+	if (count1 != expected1 || count2 != expected2)
+	{
+		cout << "ERROR: expected " << expected1 << " and " << expected2 << " packets" << endl;
+		return -1;
+	}
+	return 0;
+}
+
+int TestIPv4()
+{
+	uint32_t localip = ntohl(inet_addr("127.0.0.1"));
+	RTPUDPv4Transmitter receiver(0), sender1(0), sender2(0);
+	RTPUDPv4TransmissionParams params;
+	int count1, count2, status = 0;
+
+	params.SetBindIP(localip);
+	params.SetRTPReceiveBuffer(1024*1024);
+	params.SetPortbase(5000);
+	checkerror(receiver.Init(false));
+	checkerror(receiver.Create(1400,&params));
+	params.SetPortbase(5002);
+	checkerror(sender1.Init(false));
+	checkerror(sender1.Create(1400,&params));
+	params.SetPortbase(5004);
+	checkerror(sender2.Init(false));
+	checkerror(sender2.Create(1400,&params));
+	checkerror(sender1.AddDestination(RTPIPv4Address(localip,5000)));
+	checkerror(sender2.AddDestination(RTPIPv4Address(localip,5000)));
+
+	uint64_t dropsbefore, dropsafter;
+
+	// Only accept the packets from the first sender
+	checkerror(receiver.SetReceiveMode(RTPTransmitter::AcceptSome));
+	checkerror(receiver.AddToAcceptList(RTPIPv4Address(localip,5002)));
+	checkerror(receiver.GetNumberOfKernelDrops(dropsbefore));
+	SendAndReceive<RTPUDPv4Transmitter,RTPIPv4Address>(receiver,sender1,sender2,5002,count1,count2);
+	checkerror(receiver.GetNumberOfKernelDrops(dropsafter));
+	status |= CheckResult("IPv4, accepting first sender",count1,count2,NUMPACKETS,0);
+
+	cout << "Socket filter in use: " << ((receiver.IsUsingSocketFilter())?"yes":"no") << ", kernel drops: " << (dropsafter-dropsbefore) << endl;
+#ifdef RTP_SUPPORT_SOCKETFILTER
+	// The packets of the second sender must have been dropped by the kernel
+	if (!receiver.IsUsingSocketFilter() || dropsafter-dropsbefore < NUMPACKETS)
+	{
+		cout << "ERROR: packets weren't dropped by the socket filter" << endl;
+		status = -1;
+	}
+#endif // RTP_SUPPORT_SOCKETFILTER
+
+	// Ignore all ports of this host, except for the first sender
+	checkerror(receiver.SetReceiveMode(RTPTransmitter::IgnoreSome));
+	checkerror(receiver.AddToIgnoreList(RTPIPv4Address(localip,0)));
+	checkerror(receiver.DeleteFromIgnoreList(RTPIPv4Address(localip,5002)));
+	SendAndReceive<RTPUDPv4Transmitter,RTPIPv4Address>(receiver,sender1,sender2,5002,count1,count2);
+	status |= CheckResult("IPv4, ignoring all but first sender",count1,count2,NUMPACKETS,0);
+
+	// Ignore the first sender only
+	receiver.ClearIgnoreList();
+	checkerror(receiver.AddToIgnoreList(RTPIPv4Address(localip,5002)));
+	SendAndReceive<RTPUDPv4Transmitter,RTPIPv4Address>(receiver,sender1,sender2,5002,count1,count2);
+	status |= CheckResult("IPv4, ignoring first sender",count1,count2,0,NUMPACKETS);
+
+	// Everything should be received again
+	checkerror(receiver.SetReceiveMode(RTPTransmitter::AcceptAll));
+	if (receiver.IsUsingSocketFilter())
+	{
+		cout << "ERROR: socket filter still in use" << endl;
+		status = -1;
+	}
+	SendAndReceive<RTPUDPv4Transmitter,RTPIPv4Address>(receiver,sender1,sender2,5002,count1,count2);
+	status |= CheckResult("IPv4, accepting all",count1,count2,NUMPACKETS,NUMPACKETS);
+
+	receiver.Destroy();
+	sender1.Destroy();
+	sender2.Destroy();
+	return status;
+}
+
+#ifdef RTP_SUPPORT_IPV6
+int TestIPv6()
+{
+	in6_addr localip = IN6ADDR_LOOPBACK_INIT;
+	RTPUDPv6Transmitter receiver(0), sender1(0), sender2(0);
+	RTPUDPv6TransmissionParams params;
+	int count1, count2, status = 0;
+
+	params.SetBindIP(localip);
+	params.SetPortbase(5010);
+	checkerror(receiver.Init(false));
+	if (receiver.Create(1400,&params) < 0)
+	{
+		cout << "IPv6 loopback not available, skipping IPv6 test" << endl;
+		return 0;
+	}
+	params.SetPortbase(5012);
+	checkerror(sender1.Init(false));
+	checkerror(sender1.Create(1400,&params));
+	params.SetPortbase(5014);
+	checkerror(sender2.Init(false));
+	checkerror(sender2.Create(1400,&params));
+	checkerror(sender1.AddDestination(RTPIPv6Address(localip,5010)));
+	checkerror(sender2.AddDestination(RTPIPv6Address(localip,5010)));
+
+	checkerror(receiver.SetReceiveMode(RTPTransmitter::AcceptSome));
+	checkerror(receiver.AddToAcceptList(RTPIPv6Address(localip,5014)));
+	SendAndReceive<RTPUDPv6Transmitter,RTPIPv6Address>(receiver,sender1,sender2,5012,count1,count2);
+	status |= CheckResult("IPv6, accepting second sender",count1,count2,0,NUMPACKETS);
+	cout << "Socket filter in use: " << ((receiver.IsUsingSocketFilter())?"yes":"no") << endl;
+
+	receiver.Destroy();
+	sender1.Destroy();
+	sender2.Destroy();
+	return status;
+}
+#endif // RTP_SUPPORT_IPV6
+
+int main(void)
+{
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSADATA dat;
+	WSAStartup(MAKEWORD(2,2),&dat);
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	int status = TestIPv4();
+#ifdef RTP_SUPPORT_IPV6
+	status |= TestIPv6();
+#endif // RTP_SUPPORT_IPV6
+
+#ifdef RTP_SOCKETTYPE_WINSOCK
+	WSACleanup();
+#endif // RTP_SOCKETTYPE_WINSOCK
+
+	return status;
+}
@@ -0,0 +1,238 @@
+#include "rtptimerwheel.h"
+#include "rtpsources.h"
+#include "rtpsourcedata.h"
+#include "rtppacket.h"
+#include "rtcpsdespacket.h"
+#include "rtperrors.h"
+#include "rtptimeutilities.h"
+#include <stdlib.h>
+#include <vector>
+#include <iostream>
+
+using namespace jrtplib;
+using namespace std;
+
+void checkerror(int rtperr)
+{
+	if (rtperr < 0)
+	{
+		std::cout << "ERROR: " << RTPGetErrorString(rtperr) << std::endl;
+		exit(-1);
+	}
+}
+
+void fail(const char *msg)
+{
+	cout << "FAILED: " << msg << endl;
+	exit(-1);
+}
+
+#define NUMENTRIES 2000
+#define NUMSTEPS 3000
+
+uint64_t RandomNumber()
+{
+	return (((uint64_t)rand()) << 31) ^ (uint64_t)rand();
+}
+
+// Compares the entries returned by the wheel with the ones that a full scan finds
+void TestWheel()
+{
+	RTPTimerWheel wheel;
+	vector<RTPTimerWheelEntry> entries(NUMENTRIES);
+	vector<bool> scheduled(NUMENTRIES, false);
+	vector<uint64_t> keys(NUMENTRIES, 0);
+	uint64_t now = 1000;
+
+	for (int i = 0 ; i < NUMENTRIES ; i++)
+		entries[i].SetOwner(&entries[i]);
+
+	// Before the first advance, everything is returned at once
+	wheel.Schedule(entries[0], 5000);
+	wheel.Advance(now);
+	if (wheel.PopExpired() != &entries[0] || wheel.PopExpired() != 0)
+		fail("Entry scheduled before the first advance was not returned");
+
+	for (int step = 0 ; step < NUMSTEPS ; step++)
+	{
+		// Schedule, reschedule or remove some entries, using both small and very large
+		// distances so that all levels and the far list get used
+		for (int j = 0 ; j < 10 ; j++)
+		{
+			int idx = rand()%NUMENTRIES;
+			int r = rand()%10;
+
+			if (r == 0)
+			{
+				entries[idx].Unschedule();
+				scheduled[idx] = false;
+			}
+			else
+			{
+				uint64_t dist;
+
+				if (r < 5)
+					dist = RandomNumber()%100;
+				else if (r < 8)
+					dist = RandomNumber()%100000;
+				else
+					dist = RandomNumber()%(((uint64_t)1) << 36);
+
+				// Some entries are scheduled in the past
+				uint64_t key = (r == 1 && now > dist) ? now-dist : now+dist;
+
+				wheel.Schedule(entries[idx], key);
+				keys[idx] = key;
+				scheduled[idx] = true;
+			}
+		}
+
+		int r = rand()%10;
+
+		if (r < 6)
+			now += RandomNumber()%64;
+		else if (r < 9)
+			now += RandomNumber()%100000;
+		else
+			now += RandomNumber()%(((uint64_t)1) << 33);
+
+		wheel.Advance(now);
+
+		vector<bool> popped(NUMENTRIES, false);
+		RTPTimerWheelEntry *e;
+
+		while ((e = wheel.PopExpired()) != 0)
+		{
+			int idx = (int)((RTPTimerWheelEntry *)e->GetOwner() - &entries[0]);
+
+			if (!scheduled[idx] || popped[idx] || keys[idx] >= now)
+				fail("Wheel returned an entry that hasn't expired");
+			if (e->IsScheduled())
+				fail("Returned entry is still scheduled");
+			popped[idx] = true;
+		}
+
+		size_t numleft = 0;
+
+		for (int i = 0 ; i < NUMENTRIES ; i++)
+		{
+			if (!scheduled[i])
+				continue;
+			if (keys[i] < now && !popped[i])
+				fail("Wheel did not return an expired entry");
+			if (popped[i])
+				scheduled[i] = false;
+			else
+				numleft++;
+		}
+		if (numleft != wheel.GetNumberOfEntries())
+			fail("Number of entries in wheel is wrong");
+	}
+}
+
+class MySources : public RTPSources
+{
+public:
+	MySources() : RTPSources(RTPSources::NoProbation), numtimeouts(0), numbyetimeouts(0), numnotetimeouts(0) { }
+
+	int numtimeouts, numbyetimeouts, numnotetimeouts;
+protected:
+	void OnTimeout(RTPSourceData *)									{ numtimeouts++; }
+	void OnBYETimeout(RTPSourceData *)								{ numbyetimeouts++; }
+	void OnNoteTimeout(RTPSourceData *)								{ numnotetimeouts++; }
+};
+
+#define NUMSOURCES 1000
+
+// Checks that the timeouts of the source table still behave like the full scans did
+void TestSources()
+{
+	MySources sources;
+	RTPTime t0(1000, 0);
+	RTPTime generaltimeout(10, 0), byetimeout(2, 0), sendertimeout(4, 0), notetimeout(6, 0);
+	const char note[] = "note";
+
+	checkerror(sources.CreateOwnSSRC(1));
+
+	for (uint32_t ssrc = 100 ; ssrc < 100+NUMSOURCES ; ssrc++)
+		checkerror(sources.UpdateReceiveTime(ssrc, t0, 0));
+
+	// A few senders
+	for (uint32_t ssrc = 100 ; ssrc < 110 ; ssrc++)
+	{
+		RTPPacket *pack = new RTPPacket(0, "x", 1, 1, 0, ssrc, false, 0, 0, false, 0, 0, 0, 1500);
+		bool stored;
+
+		checkerror(pack->GetCreationError());
+		checkerror(sources.ProcessRTPPacket(pack, t0, 0, &stored));
+		if (!stored)
+			delete pack;
+	}
+	if (sources.GetSenderCount() != 10)
+		fail("Unexpected sender count");
+
+	// Notes for some sources, BYE packets for others
+	for (uint32_t ssrc = 200 ; ssrc < 210 ; ssrc++)
+		checkerror(sources.ProcessSDESNormalItem(ssrc, RTCPSDESPacket::NOTE, sizeof(note)-1, note, t0, 0));
+	for (uint32_t ssrc = 300 ; ssrc < 310 ; ssrc++)
+		checkerror(sources.ProcessBYE(ssrc, 0, 0, RTPTime(1001, 0), 0));
+
+	// Half of the sources stay alive, the first senders keep sending
+	RTPTime t1(1005, 0);
+
+	for (uint32_t ssrc = 100 ; ssrc < 100+NUMSOURCES ; ssrc += 2)
+		checkerror(sources.UpdateReceiveTime(ssrc, t1, 0));
+	for (uint32_t ssrc = 100 ; ssrc < 110 ; ssrc += 2)
+	{
+		RTPPacket *pack = new RTPPacket(0, "x", 1, 2, 0, ssrc, false, 0, 0, false, 0, 0, 0, 1500);
+		bool stored;
+
+		checkerror(sources.ProcessRTPPacket(pack, t1, 0, &stored));
+		if (!stored)
+			delete pack;
+	}
+
+	// Nothing times out yet
+	sources.MultipleTimeouts(RTPTime(1002, 0), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	if (sources.GetTotalCount() != NUMSOURCES+1 || sources.numbyetimeouts != 0)
+		fail("Sources timed out too early");
+
+	// The BYE timeouts
+	sources.MultipleTimeouts(RTPTime(1003, 500000), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	if (sources.numbyetimeouts != 10 || sources.GetTotalCount() != NUMSOURCES+1-10)
+		fail("BYE timeouts are wrong");
+
+	// The senders that stopped, and the notes
+	sources.MultipleTimeouts(RTPTime(1007, 0), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	if (sources.GetSenderCount() != 5)
+		fail("Sender timeouts are wrong");
+	if (sources.numnotetimeouts != 10)
+		fail("Note timeouts are wrong");
+
+	// Member timeouts: the ones that weren't updated at t1 disappear
+	sources.MultipleTimeouts(RTPTime(1010, 1000), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	if (sources.numtimeouts != NUMSOURCES/2-5 || sources.GetTotalCount() != NUMSOURCES/2-5+1)
+		fail("Member timeouts are wrong");
+
+	for (uint32_t ssrc = 100 ; ssrc < 100+NUMSOURCES ; ssrc++)
+	{
+		bool shouldexist = (ssrc%2 == 0 && (ssrc < 300 || ssrc >= 310));
+
+		if (sources.GotEntry(ssrc) != shouldexist)
+			fail("Wrong sources were removed");
+	}
+
+	// The rest, except for our own entry
+	sources.MultipleTimeouts(RTPTime(1100, 0), sendertimeout, byetimeout, generaltimeout, notetimeout);
+	if (sources.GetTotalCount() != 1 || !sources.GotEntry(1) || sources.GetSenderCount() != 0)
+		fail("Final timeouts are wrong");
+}
+
+int main(void)
+{
+	srand(1234);
+	TestWheel();
+	TestSources();
+	cout << "Timer wheel tests passed" << endl;
+	return 0;
+}
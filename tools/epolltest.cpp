@@ -0,0 +1,12 @@
+#include <sys/epoll.h>
+
+int main(void)
+{
+	struct epoll_event ev;
+	int fd = epoll_create1(EPOLL_CLOEXEC);
+
+	ev.events = EPOLLIN|EPOLLONESHOT;
+	ev.data.u64 = 0;
+	epoll_ctl(fd, EPOLL_CTL_ADD, 0, &ev);
+	return epoll_wait(fd, &ev, 1, 0);
+}
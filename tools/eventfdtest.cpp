@@ -0,0 +1,16 @@
+#include <sys/eventfd.h>
+#include <stdint.h>
+#include <unistd.h>
+
+int main(void)
+{
+	int fd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+	uint64_t value = 1;
+
+	if (write(fd, &value, sizeof(uint64_t)) != sizeof(uint64_t))
+		return -1;
+	if (read(fd, &value, sizeof(uint64_t)) != sizeof(uint64_t))
+		return -1;
+	close(fd);
+	return 0;
+}
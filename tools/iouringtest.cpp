@@ -0,0 +1,29 @@
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#include <unistd.h>
+#include <string.h>
+
+int main(void)
+{
+	struct io_uring_params params;
+	struct io_uring_buf_reg reg;
+	struct io_uring_sqe sqe;
+
+	memset(&params, 0, sizeof(params));
+	memset(&reg, 0, sizeof(reg));
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_RECVMSG;
+	sqe.ioprio = IORING_RECV_MULTISHOT;
+	sqe.flags = IOSQE_BUFFER_SELECT;
+	sqe.buf_group = 0;
+	reg.ring_entries = 1;
+	(void)sizeof(struct io_uring_recvmsg_out);
+	(void)sizeof(struct io_uring_getevents_arg);
+	(void)IORING_REGISTER_PBUF_RING;
+	(void)IORING_ENTER_EXT_ARG;
+	(void)IORING_ASYNC_CANCEL_FD;
+	(void)eventfd(0, 0);
+	return (int)syscall(__NR_io_uring_setup, 1, &params);
+}
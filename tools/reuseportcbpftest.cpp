@@ -0,0 +1,13 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+
+int main(void)
+{
+	struct sock_filter code[] = { BPF_STMT(BPF_LD|BPF_W|BPF_ABS, 8), BPF_STMT(BPF_ALU|BPF_MOD|BPF_K, 2), BPF_STMT(BPF_RET|BPF_A, 0) };
+	struct sock_fprog prog;
+
+	prog.len = 3;
+	prog.filter = code;
+	return setsockopt(0, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+}
@@ -0,0 +1,8 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+
+int main(void)
+{
+	struct mmsghdr msgs[1];
+	return sendmmsg(0, msgs, 1, 0);
+}
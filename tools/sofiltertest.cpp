@@ -0,0 +1,16 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+
+int main(void)
+{
+	struct sock_filter code[] = { BPF_STMT(BPF_RET|BPF_K, 0xffffffff) };
+	struct sock_fprog prog;
+	int dummy = 0;
+
+	prog.len = 1;
+	prog.filter = code;
+	if (setsockopt(0, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) != 0)
+		return -1;
+	return setsockopt(0, SOL_SOCKET, SO_DETACH_FILTER, &dummy, sizeof(int)) + SKF_NET_OFF;
+}
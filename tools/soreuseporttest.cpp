@@ -0,0 +1,9 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+
+int main(void)
+{
+	int one = 1;
+
+	return setsockopt(0, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(int));
+}
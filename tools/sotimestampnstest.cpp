@@ -0,0 +1,13 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <time.h>
+
+int main(void)
+{
+	int one = 1;
+	int type = SCM_TIMESTAMPNS;
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return setsockopt(0, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(int)) + type;
+}
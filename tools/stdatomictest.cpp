@@ -0,0 +1,9 @@
+#include <atomic>
+
+int main(void)
+{
+	int x = 0;
+	std::atomic<int *> p(0);
+
+	return (p.exchange(&x) == 0)?0:1;
+}
@@ -0,0 +1,11 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+int main(void)
+{
+	int one = 1;
+
+	return setsockopt(0, SOL_UDP, UDP_GRO, &one, sizeof(int));
+}